@@ -1,6 +1,10 @@
 #include "config.h"
 #include "multiband_wdrc.h"
+#include "crossover_wdrc.h"
+#include "limiter.h"
 #include "i2s_handler.h"
+#include "dsp_kernels.h"
+#include "cycle_profiler.h"
 
 /*
  * SISTEMA DE PROCESAMIENTO DE AUDIO MULTIBAND WDRC
@@ -48,8 +52,30 @@
 // VARIABLES GLOBALES
 //================================================
 
+// Todo el estado del audio es estático (.bss en DRAM interna, buffers
+// alineados a 16): ninguna asignación de heap en el bucle de audio
 MultibandWDRC multiband_wdrc;
-float buffer_proc[BUFFER_SIZE];
+CrossoverWDRC crossover_wdrc;
+#if OUTPUT_LIMITER
+LookaheadLimiter output_limiter;
+#endif
+float buffer_proc[BUFFER_SIZE] __attribute__((aligned(16)));
+
+// Bloques I2S estáticos en ping-pong: cada vuelta lee el micrófono y
+// escribe el DAC sobre uno y la siguiente sobre el otro, así el bloque
+// recién entregado al driver no se toca mientras se lee el siguiente.
+// La salida se convierte directamente al tx del mismo bloque
+struct I2SBlock {
+    int32_t rx[BUFFER_SIZE] __attribute__((aligned(16)));
+    int16_t tx[BUFFER_SIZE * I2S_DAC_CHANNELS] __attribute__((aligned(16)));
+};
+I2SBlock i2s_blocks[2];
+int i2s_block_index = 0;
+float buffer_fade[BUFFER_SIZE] __attribute__((aligned(16)));     // Salida del motor entrante durante el cambio
+
+// Motor multibanda activo y pedido por el comando 'engine' (config.h)
+int active_engine = MULTIBAND_ENGINE_DEFAULT;
+int requested_engine = MULTIBAND_ENGINE_DEFAULT;
 
 //================================================
 // DEBUG Y MONITOREO
@@ -59,16 +85,183 @@ float buffer_proc[BUFFER_SIZE];
 unsigned long last_monitor = 0;
 uint32_t process_count = 0;
 uint32_t error_count = 0;
+uint32_t short_read_count = 0;   // Bloques leídos a medias (completados con silencio)
+unsigned long last_profile_report = 0;
+
+static const char* const PROFILE_STAGE_NAMES[PROF_STAGE_COUNT] = {
+    "I2S lectura", "int32 → float", "ventana", "FFT", "bandas WDRC",
+    "IFFT", "overlap-add", "cruces LR4", "limitador", "float → int16", "I2S escritura", "DSP total"
+};
 
 void monitor_performance() {
     unsigned long current_time = millis();
     if (current_time - last_monitor >= MONITOR_INTERVAL) {
         float fps = process_count * 1000.0f / MONITOR_INTERVAL;
-        Serial.printf("FPS: %.2f, Errores: %lu\n", fps, error_count);
+        Serial.printf("FPS: %.2f, Errores: %lu, Lecturas cortas: %lu\n",
+                      fps, error_count, short_read_count);
         process_count = 0;
         error_count = 0;
+        short_read_count = 0;
         last_monitor = current_time;
     }
+#if PROFILE_REPORT_MS > 0
+    if (current_time - last_profile_report >= PROFILE_REPORT_MS) {
+        profiler_print();
+        last_profile_report = current_time;
+    }
+#endif
+}
+
+//================================================
+// MOTOR MULTIBANDA
+//================================================
+
+static const char* engine_name(int engine) {
+    return engine == MULTIBAND_ENGINE_CROSSOVER ? "cruces LR4" : "FFT/WOLA";
+}
+
+// Retardo de la salida de cada motor: lo que tarda en dar audio tras reset()
+static int engine_latency_samples(int engine) {
+    if (engine == MULTIBAND_ENGINE_CROSSOVER) {
+        return (int)ceilf(crossover_wdrc.groupDelayMs() * SAMPLE_RATE / 1000.0f);
+    }
+    return MultibandWDRC::latencySamples();
+}
+
+static void print_engine_info(int engine) {
+    if (engine == MULTIBAND_ENGINE_CROSSOVER) {
+        Serial.printf("Motor: cruces LR4, %d bandas + 2 exteriores (retardo de grupo %.1f ms en DC)\n",
+                     crossover_wdrc.bands(), crossover_wdrc.groupDelayMs());
+    } else {
+        Serial.printf("Motor: FFT/WOLA %d puntos, hop %d (latencia algorítmica %.1f ms)\n",
+                     FFT_SIZE, STFT_HOP_SIZE,
+                     MultibandWDRC::latencySamples() * 1000.0f / SAMPLE_RATE);
+    }
+}
+
+static void AUDIO_IRAM run_engine(int engine, float* block) {
+    if (engine == MULTIBAND_ENGINE_CROSSOVER) {
+        crossover_wdrc.process(block, block, BUFFER_SIZE);
+    } else {
+        multiband_wdrc.process(block, block, BUFFER_SIZE);
+    }
+}
+
+/*
+ * Cambio de motor sin arrastrar audio viejo:
+ *
+ *              │◀── llenado ──▶│◀── fundido ──▶│
+ *   saliente   █████████████████▓▓▓▓▒▒▒▒░░░░
+ *   entrante   reset · · · · · ·░░░░▒▒▒▒▓▓▓▓██████ ▶ activo
+ *
+ *   llenado = latencia del entrante, fundido ≥ latencia (mínimo 1 bloque)
+ *
+ * El entrante arranca de cero (sus anillos y estados son de la última
+ * vez que estuvo activo) y suena solo cuando ya da audio del presente.
+ */
+static int fade_engine = -1;        // Motor entrante; -1 sin cambio en curso
+static int fade_warmup_blocks = 0;  // Bloques de llenado pendientes
+static int fade_length = 0;         // Muestras del fundido
+static int fade_pos = 0;
+
+static void start_engine_switch(int engine) {
+    if (engine == MULTIBAND_ENGINE_CROSSOVER) {
+        crossover_wdrc.reset();
+    } else {
+        multiband_wdrc.reset();
+    }
+    const int blocks = (engine_latency_samples(engine) + BUFFER_SIZE - 1) / BUFFER_SIZE;
+    fade_engine = engine;
+    fade_warmup_blocks = blocks;
+    fade_length = (blocks > 1 ? blocks : 1) * BUFFER_SIZE;
+    fade_pos = 0;
+}
+
+// Bloque por el motor activo; en un cambio, ambos motores hasta acabar el fundido
+void AUDIO_IRAM process_multiband(float* block) {
+    if (requested_engine == active_engine) {
+        fade_engine = -1;           // Cambio cancelado: el entrante se descarta
+        run_engine(active_engine, block);
+        return;
+    }
+    if (fade_engine != requested_engine) {
+        start_engine_switch(requested_engine);
+    }
+    memcpy(buffer_fade, block, sizeof(buffer_fade));
+    run_engine(active_engine, block);
+    run_engine(fade_engine, buffer_fade);
+    if (fade_warmup_blocks > 0) {
+        fade_warmup_blocks--;
+        return;
+    }
+    for (int i = 0; i < BUFFER_SIZE; i++) {
+        float w = (float)(fade_pos + i + 1) / fade_length;
+        block[i] += (buffer_fade[i] - block[i]) * w;
+    }
+    fade_pos += BUFFER_SIZE;
+    if (fade_pos >= fade_length) {
+        active_engine = fade_engine;
+        fade_engine = -1;
+    }
+}
+
+#if OUTPUT_LIMITER
+static void print_limiter_info() {
+    Serial.printf("Limitador: techo %.1f dBFS, anticipación %.2f ms (%d muestras), release %.0f ms | reducción %.1f dB\n",
+                 output_limiter.thresholdDb(), output_limiter.lookaheadMs(),
+                 output_limiter.lookaheadSamples(), LIMITER_RELEASE_MS, output_limiter.gainReductionDb());
+}
+#endif
+
+#if NOISE_REDUCTION
+static void print_noise_reduction_info() {
+    Serial.printf("Reducción de ruido: %s (hasta -%.0f dB, ruido estimado %.1f dBFS, solo motor FFT)\n",
+                 multiband_wdrc.noiseReduction() ? "activa" : "desactivada",
+                 NR_MAX_ATTENUATION_DB, multiband_wdrc.noiseFloorDb());
+}
+#endif
+
+// Comandos serie sin bloquear el audio: "engine fft" / "engine xover" / "nr on|off" / "limiter [ms]"
+void handle_serial_commands() {
+    static char line[32];
+    static int length = 0;
+    while (Serial.available()) {
+        char c = Serial.read();
+        if (c != '\n' && c != '\r') {
+            if (length < (int)sizeof(line) - 1) line[length++] = c;
+            continue;
+        }
+        if (length == 0) continue;
+        line[length] = '\0';
+        length = 0;
+
+#if OUTPUT_LIMITER
+        if (!strcmp(line, "limiter") || !strncmp(line, "limiter ", 8)) {
+            if (line[7] == ' ') {
+                output_limiter.setParameters(LIMITER_THRESHOLD_DB, atof(line + 8), LIMITER_RELEASE_MS);
+            }
+            print_limiter_info();
+            continue;
+        }
+#endif
+#if NOISE_REDUCTION
+        if (!strcmp(line, "nr") || !strncmp(line, "nr ", 3)) {
+            if (!strcmp(line, "nr on")) multiband_wdrc.setNoiseReduction(true);
+            else if (!strcmp(line, "nr off")) multiband_wdrc.setNoiseReduction(false);
+            print_noise_reduction_info();
+            continue;
+        }
+#endif
+        if (!strcmp(line, "engine fft")) {
+            requested_engine = MULTIBAND_ENGINE_FFT;
+        } else if (!strcmp(line, "engine xover")) {
+            requested_engine = MULTIBAND_ENGINE_CROSSOVER;
+        } else if (strcmp(line, "engine")) {
+            Serial.printf("Comando desconocido: '%s' (engine [fft|xover])\n", line);
+            continue;
+        }
+        print_engine_info(requested_engine);
+    }
 }
 
 //================================================
@@ -90,63 +283,104 @@ void setup() {
     Serial.println("Configuración:");
     Serial.printf("Sample Rate: %d Hz\n", SAMPLE_RATE);
     Serial.printf("Buffer Size: %d muestras\n", BUFFER_SIZE);
+    Serial.printf("Salida DAC: %s\n", I2S_DAC_CHANNELS == 1 ? "mono (canal izquierdo)" : "estéreo duplicado");
     Serial.printf("Bandas: %d\n", NUM_BANDS);
+    Serial.printf("Backend FFT: %s\n", multiband_wdrc.fftBackendName());
+    print_engine_info(MULTIBAND_ENGINE_FFT);
+    print_engine_info(MULTIBAND_ENGINE_CROSSOVER);
+    Serial.printf("Motor activo: %s ('engine fft' / 'engine xover' para cambiar)\n",
+                 engine_name(active_engine));
+#if NOISE_REDUCTION
+    Serial.printf("Reducción de ruido: %s ('nr on' / 'nr off'; ventana de mínimos %d ms)\n",
+                 multiband_wdrc.noiseReduction() ? "activa" : "desactivada", NR_WINDOW_MS);
+#endif
+#if OUTPUT_LIMITER
+    Serial.printf("Limitador: techo %.1f dBFS, anticipación %.2f ms ('limiter <%.1f-%.1f>' para cambiar)\n",
+                 output_limiter.thresholdDb(), output_limiter.lookaheadMs(),
+                 LIMITER_MIN_LOOKAHEAD_MS, LIMITER_MAX_LOOKAHEAD_MS);
+#endif
     Serial.println("Límites de bandas (Hz):");
     for(int i = 0; i < NUM_BANDS; i++) {
         Serial.printf("Banda %d: %.0f - %.0f Hz\n", 
                      i, BAND_LIMITS[i], BAND_LIMITS[i+1]);
     }
     Serial.println("=================================\n");
+    
+#if KERNEL_BENCHMARK
+    dsp_kernels_benchmark();
+#endif
+
+    // Presupuesto de tiempo real: ciclos de CPU que dura un bloque
+    profiler_init(PROFILE_STAGE_NAMES, PROF_STAGE_COUNT,
+                  (uint32_t)((uint64_t)getCpuFrequencyMhz() * 1000000ULL * BUFFER_SIZE / SAMPLE_RATE));
 }
 
 void loop() {
-    // Buffer para muestras de entrada (32-bit para INMP441)
-    int32_t samples_in[BUFFER_SIZE];
-    // Buffer para muestras de salida (16-bit para MAX98357A)
-    int16_t samples_out[BUFFER_SIZE * 2];
+    I2SBlock& block = i2s_blocks[i2s_block_index];
+    i2s_block_index ^= 1;
+    const size_t bytes_in = sizeof(block.rx);
+    const size_t bytes_out = sizeof(block.tx);
     size_t bytes_read = 0;
     size_t bytes_written = 0;
     
-    // Leer muestras del micrófono
-    esp_err_t read_result = i2s_read(I2S_NUM_0, samples_in, 
-                                    sizeof(samples_in), &bytes_read, 
+    // Leer muestras del micrófono (32-bit para INMP441)
+    uint32_t t = profiler_cycles();
+    esp_err_t read_result = i2s_read(I2S_NUM_0, block.rx, 
+                                    bytes_in, &bytes_read, 
                                     portMAX_DELAY);
                                     
     if (read_result != ESP_OK) {
         error_count++;
         return;
     }
-    
-    // Convertir muestras a float [-1,1]
-    for(int i = 0; i < BUFFER_SIZE; i++) {
-        buffer_proc[i] = (float)samples_in[i] / INT32_MAX;
+    if (bytes_read < bytes_in) {
+        // Lectura corta: se procesa lo que llegó y el resto es silencio,
+        // sin saltarse el bloque (un hueco entero se oiría)
+        const size_t samples_read = bytes_read / sizeof(int32_t);
+        memset(block.rx + samples_read, 0, bytes_in - samples_read * sizeof(int32_t));
+        short_read_count++;
     }
     
-    // Procesar con WDRC multibanda
-    multiband_wdrc.process(buffer_proc, buffer_proc, BUFFER_SIZE);
+    t = profiler_lap(PROF_I2S_READ, t);
+    const uint32_t dsp_start = t;
     
-    // Convertir de vuelta a int16 y duplicar para estéreo
-    for(int i = 0; i < BUFFER_SIZE; i++) {
-        // Limitar y escalar a INT16_MAX
-        float sample = buffer_proc[i];
-        if(sample > 1.0f) sample = 1.0f;
-        if(sample < -1.0f) sample = -1.0f;
-        
-        int16_t processed = (int16_t)(sample * INT16_MAX);
-        samples_out[i*2] = processed;      // Canal izquierdo
-        samples_out[i*2+1] = processed;    // Canal derecho
-    }
+    // Convertir muestras a float [-1,1)
+    dsp_int32_to_float(block.rx, buffer_proc, BUFFER_SIZE, 31);
+    profiler_lap(PROF_TO_FLOAT, t);
+    
+    // Procesar con el motor multibanda activo (mide sus etapas internamente)
+    process_multiband(buffer_proc);
+    
+    t = profiler_cycles();
+#if OUTPUT_LIMITER
+    // Techo de la salida sin recorte: la saturación a int16 ya no actúa
+    output_limiter.process(buffer_proc, buffer_proc, BUFFER_SIZE);
+    t = profiler_lap(PROF_LIMITER, t);
+#endif
+    
+    // Convertir de vuelta a int16 saturado en el tx del bloque
+    // (en estéreo, el canal derecho duplica el izquierdo)
+    dsp_float_to_int16(buffer_proc, block.tx, BUFFER_SIZE, 15, I2S_DAC_CHANNELS);
+#if I2S_DAC_CHANNELS == 2
+    dsp_float_to_int16(buffer_proc, block.tx + 1, BUFFER_SIZE, 15, 2);
+#endif
+    t = profiler_lap(PROF_TO_INT16, t);
+    profiler_record(PROF_DSP_TOTAL, t - dsp_start);
     
     // Enviar al MAX98357A
-    esp_err_t write_result = i2s_write(I2S_NUM_1, samples_out, 
-                                      bytes_read, &bytes_written, 
+    esp_err_t write_result = i2s_write(I2S_NUM_1, block.tx, 
+                                      bytes_out, &bytes_written, 
                                       portMAX_DELAY);
                                       
-    if (write_result != ESP_OK) {
+    profiler_lap(PROF_I2S_WRITE, t);
+    profiler_block_end();
+    
+    if (write_result != ESP_OK || bytes_written < bytes_out) {
         error_count++;
         return;
     }
     
     process_count++;
     monitor_performance();
+    handle_serial_commands();
 }
\ No newline at end of file
@@ -14,16 +14,135 @@
 
 // Configuración del sistema de audio
 #define SAMPLE_RATE     44100
-#define BUFFER_SIZE     512
-#define DMA_BUF_COUNT   8
-#define DMA_BUF_LEN     1024
+#ifndef BUFFER_SIZE
+#define BUFFER_SIZE     128   // Múltiplo de STFT_HOP_SIZE (ver abajo)
+#endif
+// Un buffer DMA = un bloque: i2s_read/i2s_write esperan un bloque cada vez
+// en lugar de vaciar de golpe un buffer largo y parar hasta el siguiente.
+// 3 buffers: uno en curso + margen por si loop() se retrasa (la cola de
+// salida suma DMA_BUF_COUNT × DMA_BUF_LEN muestras de latencia como máximo)
+#define DMA_BUF_COUNT   3
+#define DMA_BUF_LEN     BUFFER_SIZE
+
+#if DMA_BUF_LEN % BUFFER_SIZE != 0
+#error "DMA_BUF_LEN debe ser múltiplo de BUFFER_SIZE"
+#endif
+
+#if DMA_BUF_LEN < 8 || DMA_BUF_LEN > 1024
+#error "DMA_BUF_LEN fuera del rango del driver I2S (8-1024 tramas)"
+#endif
+
+// Canales hacia el DAC: 1 = mono (I2S_CHANNEL_FMT_ONLY_LEFT; el MAX98357A
+// reproduce el canal izquierdo con SD_MODE a nivel alto), 2 = la misma
+// señal duplicada en L/R (DAC estéreo como el PCM5102A)
+#ifndef I2S_DAC_CHANNELS
+#define I2S_DAC_CHANNELS  1
+#endif
+
+#if I2S_DAC_CHANNELS != 1 && I2S_DAC_CHANNELS != 2
+#error "I2S_DAC_CHANNELS debe ser 1 o 2"
+#endif
 
 // Definición de las bandas frecuenciales
-#define NUM_BANDS       3
+#ifndef NUM_BANDS
+#define NUM_BANDS       3     // 3, 6 u 8 (BandLayout<> abajo)
+#endif
 #define FFT_SIZE        512
 
-// Límites de las bandas frecuenciales (en Hz)
-const float BAND_LIMITS[NUM_BANDS + 1] = {250, 1000, 4000, 8000};
+// Backend de FFT (seleccionable en compilación para comparar A/B;
+// BUFFER_SIZE, NUM_BANDS, FFT_BACKEND, STFT_OVERLAP y WDRC_FAST_MATH admiten -D,
+// ver host/README.md)
+#define FFT_BACKEND_ARDUINOFFT  0   // ArduinoFFT<double> (referencia, emulación double)
+#define FFT_BACKEND_ESPDSP      1   // FFT real float32 sobre kernels ESP-DSP
+#ifndef FFT_BACKEND
+#define FFT_BACKEND             FFT_BACKEND_ESPDSP
+#endif
+#define FFT_ESPDSP_RADIX4       0   // 1 = núcleo radix-4 (FFT_SIZE/2 potencia de 4)
+
+// STFT con solape (weighted overlap-add, ventanas sqrt-Hann)
+#ifndef STFT_OVERLAP
+#define STFT_OVERLAP    4                           // 1 = bloque sin solape, 2 = 50%, 4 = 75%
+#endif
+#define STFT_HOP_SIZE   (FFT_SIZE / STFT_OVERLAP)   // Muestras nuevas por trama
+
+#if NUM_BANDS != 3 && NUM_BANDS != 6 && NUM_BANDS != 8
+#error "NUM_BANDS debe ser 3, 6 u 8"
+#endif
+
+#if STFT_OVERLAP != 1 && STFT_OVERLAP != 2 && STFT_OVERLAP != 4
+#error "STFT_OVERLAP debe ser 1, 2 o 4"
+#endif
+
+#if STFT_OVERLAP > 1 && (BUFFER_SIZE % STFT_HOP_SIZE) != 0
+#error "BUFFER_SIZE debe ser múltiplo de STFT_HOP_SIZE"
+#endif
+
+#if STFT_OVERLAP == 1 && BUFFER_SIZE > FFT_SIZE
+#error "En modo bloque BUFFER_SIZE no puede superar FFT_SIZE"
+#endif
+
+// Conversiones dB/lineal aproximadas en el WDRC (ver fast_math.h, error < 0.01 dB)
+#ifndef WDRC_FAST_MATH
+#define WDRC_FAST_MATH  0   // 1 = activado por defecto; también WDRC::setFastMath()
+#endif
+
+// Reducción de ruido espectral dentro de la pasada FFT de MultibandWDRCT
+// (minimum statistics + ganancia de Wiener por bin, ver multiband_wdrc.cpp)
+#ifndef NOISE_REDUCTION
+#define NOISE_REDUCTION         1       // 0 = etapa no compilada
+#endif
+#define NR_DEFAULT_ENABLED      true    // Estado al arrancar (comando serie 'nr on|off')
+#define NR_SMOOTHING_MS         20.0f   // Suavizado de |X|² por bin antes de buscar el mínimo
+#define NR_WINDOW_MS            1500    // Ventana de búsqueda del mínimo (> pausas del habla)
+#define NR_SUBWINDOWS           4       // La ventana avanza en pasos de NR_WINDOW_MS / 4
+#define NR_NOISE_BIAS           1.5f    // El mínimo queda por debajo de la media del ruido
+#define NR_MAX_ATTENUATION_DB   12.0f   // Suelo de la ganancia (limita el ruido musical)
+
+// Limitador de salida con anticipación (ver limiter.h): única protección
+// contra la saturación, tras el motor multibanda; retrasa la salida
+#ifndef OUTPUT_LIMITER
+#define OUTPUT_LIMITER              1       // 0 = sin limitador (satura la conversión a int16)
+#endif
+#define LIMITER_THRESHOLD_DB        -1.0f   // Techo de la salida (dBFS)
+#define LIMITER_LOOKAHEAD_MS        1.0f    // Anticipación por defecto (también comando 'limiter <ms>')
+#define LIMITER_MIN_LOOKAHEAD_MS    0.5f
+#define LIMITER_MAX_LOOKAHEAD_MS    2.0f    // Dimensiona la línea de retardo
+#define LIMITER_RELEASE_MS          50.0f
+
+// Muestras entre evaluaciones de la curva de ganancia en WDRC::processBlock()
+// (8/16/32; 1 = evaluación por muestra como process())
+#define WDRC_CONTROL_INTERVAL   16
+
+// Micro-benchmark de los kernels DSP al arrancar (ver dsp_kernels.h)
+#define KERNEL_BENCHMARK        0
+
+// Informe periódico del perfilador de ciclos en ms (ver cycle_profiler.h, 0 = nunca)
+#define PROFILE_REPORT_MS       10000
+
+// Etapas medidas por el perfilador (orden del informe). En modo WOLA las
+// etapas de la STFT se miden por hop; el resto, por bloque.
+enum ProfileStage {
+    PROF_I2S_READ,      // Incluye la espera del DMA
+    PROF_TO_FLOAT,
+    PROF_WINDOW,        // Anillo de entrada + ventana de análisis
+    PROF_FFT,
+    PROF_BANDS,         // Energía por banda + WDRC + ganancia de bins
+    PROF_IFFT,
+    PROF_OVERLAP_ADD,   // Ventana de síntesis + OLA + salida
+    PROF_CROSSOVER,     // Motor LR4: árbol de cruces + pasa-todo (WDRC y suma en PROF_BANDS)
+    PROF_LIMITER,       // Limitador con anticipación (línea de retardo + máximo deslizante)
+    PROF_TO_INT16,
+    PROF_I2S_WRITE,
+    PROF_DSP_TOTAL,     // Conversión → WDRC multibanda → conversión
+    PROF_STAGE_COUNT
+};
+
+// Motor multibanda (seleccionable en runtime con el comando serie 'engine')
+#define MULTIBAND_ENGINE_FFT        0   // STFT/WOLA: bins de 86 Hz, latencia FFT_SIZE - hop
+#define MULTIBAND_ENGINE_CROSSOVER  1   // Cruces LR4 en el tiempo: retardo de grupo de pocos ms
+#ifndef MULTIBAND_ENGINE_DEFAULT
+#define MULTIBAND_ENGINE_DEFAULT    MULTIBAND_ENGINE_FFT
+#endif
 
 // Estructura para los parámetros de cada banda
 struct BandParams {
@@ -35,14 +154,56 @@ struct BandParams {
     float release_time; // Tiempo de liberación en segundos
 };
 
-// Configuración específica para cada banda frecuencial
-const BandParams BAND_PARAMS[NUM_BANDS] = {
-    // Banda Baja (250-1000Hz)
-    {-50.0f, 2.0f, 10.0f, 15.0f, 0.010f, 0.100f},
-    // Banda Media (1000-4000Hz)
-    {-45.0f, 3.0f, 8.0f, 10.0f, 0.005f, 0.050f},
-    // Banda Alta (4000-8000Hz)
-    {-40.0f, 4.0f, 6.0f, 5.0f, 0.003f, 0.025f}
+/*
+ * Distribución de bandas por número de bandas (límites en Hz, crecientes).
+ * Constantes de compilación: MultibandWDRCT<> calcula con ellas el mapa
+ * bin → banda sin coste en el arranque ni por trama. Las variantes de 6 y
+ * 8 bandas parten las de 3 y heredan los parámetros de la banda original.
+ */
+template <int Bands> struct BandLayout;
+
+template <> struct BandLayout<3> {
+    static constexpr float limits[4] = {250, 1000, 4000, 8000};
+    static constexpr BandParams params[3] = {
+        // Banda Baja (250-1000Hz)
+        {-50.0f, 2.0f, 10.0f, 15.0f, 0.010f, 0.100f},
+        // Banda Media (1000-4000Hz)
+        {-45.0f, 3.0f, 8.0f, 10.0f, 0.005f, 0.050f},
+        // Banda Alta (4000-8000Hz)
+        {-40.0f, 4.0f, 6.0f, 5.0f, 0.003f, 0.025f}
+    };
+};
+
+// Octavas: más resolución en la zona de las vocales
+template <> struct BandLayout<6> {
+    static constexpr float limits[7] = {250, 500, 1000, 2000, 4000, 6000, 8000};
+    static constexpr BandParams params[6] = {
+        {-50.0f, 2.0f, 10.0f, 15.0f, 0.010f, 0.100f},   // 250-500
+        {-50.0f, 2.0f, 10.0f, 15.0f, 0.010f, 0.100f},   // 500-1000
+        {-45.0f, 3.0f, 8.0f, 10.0f, 0.005f, 0.050f},    // 1000-2000
+        {-45.0f, 3.0f, 8.0f, 10.0f, 0.005f, 0.050f},    // 2000-4000
+        {-40.0f, 4.0f, 6.0f, 5.0f, 0.003f, 0.025f},     // 4000-6000
+        {-40.0f, 4.0f, 6.0f, 5.0f, 0.003f, 0.025f}      // 6000-8000
+    };
 };
 
+// Medias octavas hasta 4 kHz (la banda más estrecha ocupa 3 bins de 86 Hz)
+template <> struct BandLayout<8> {
+    static constexpr float limits[9] = {250, 500, 750, 1000, 1500, 2000, 3000, 4000, 8000};
+    static constexpr BandParams params[8] = {
+        {-50.0f, 2.0f, 10.0f, 15.0f, 0.010f, 0.100f},   // 250-500
+        {-50.0f, 2.0f, 10.0f, 15.0f, 0.010f, 0.100f},   // 500-750
+        {-50.0f, 2.0f, 10.0f, 15.0f, 0.010f, 0.100f},   // 750-1000
+        {-45.0f, 3.0f, 8.0f, 10.0f, 0.005f, 0.050f},    // 1000-1500
+        {-45.0f, 3.0f, 8.0f, 10.0f, 0.005f, 0.050f},    // 1500-2000
+        {-45.0f, 3.0f, 8.0f, 10.0f, 0.005f, 0.050f},    // 2000-3000
+        {-45.0f, 3.0f, 8.0f, 10.0f, 0.005f, 0.050f},    // 3000-4000
+        {-40.0f, 4.0f, 6.0f, 5.0f, 0.003f, 0.025f}      // 4000-8000
+    };
+};
+
+// Límites (en Hz) y parámetros de la configuración activa
+static constexpr auto& BAND_LIMITS = BandLayout<NUM_BANDS>::limits;
+static constexpr auto& BAND_PARAMS = BandLayout<NUM_BANDS>::params;
+
 #endif
\ No newline at end of file
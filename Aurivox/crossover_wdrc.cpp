@@ -0,0 +1,168 @@
+#include "crossover_wdrc.h"
+#include <string.h>
+#include "cycle_profiler.h"
+
+/*
+ * BANCO DE FILTROS LINKWITZ-RILEY + WDRC EN EL TIEMPO
+ * =================================================
+ *
+ * Alternativa de baja latencia a MultibandWDRC: las bandas se separan
+ * con cruces IIR LR4 y cada una se comprime con su propio WDRC, sin
+ * tramas ni FFT. La latencia es el retardo de grupo de los filtros
+ * (pocos ms, mayor en graves) frente a FFT_SIZE - hop de la STFT.
+ *
+ * Separación en árbol (un cruce por límite de BAND_LIMITS):
+ * ======================================================
+ *
+ *          ┌──LP₀──▶ < f₀ ──────────────▶ AP₁·AP₂·AP₃ ──────────┐
+ *  x ──────┤                                                    │
+ *          └──HP₀──┬──LP₁──▶ banda 0 ───▶ AP₂·AP₃ ──▶ WDRC₀ ────┤
+ *                  └──HP₁──┬──LP₂──▶ banda 1 ──▶ AP₃ ──▶ WDRC₁ ─┤
+ *                          └──HP₂──┬──LP₃──▶ banda 2 ──▶ WDRC₂ ─┼──▶ Σ
+ *                                  └──HP₃──▶ > f₃ ──────────────┘
+ *
+ *  LPₖ / HPₖ: Butterworth 2º orden al cuadrado (LR4, -6 dB en fₖ)
+ *  APₖ: pasa-todo 2º orden con la misma fₖ (LPₖ + HPₖ = APₖ)
+ *
+ * Cada rama baja atraviesa el pasa-todo de los cruces que no la
+ * separaron, así todas las bandas llegan a la suma con la misma fase
+ * y, con WDRC neutro, Σ es un pasa-todo: magnitud plana.
+ *
+ * Las bandas exteriores (< BAND_LIMITS[0] y > BAND_LIMITS[N]) pasan sin
+ * compresión, como los bins fuera de banda en MultibandWDRC.
+ *
+ * Coste por muestra con C cruces: 4·C biquads + C·(C-1)/2 pasa-todo
+ * (3 bandas → 16 + 6 biquads).
+ */
+
+// Fórmulas RBJ "Audio EQ Cookbook" con a0 = 1 (transformada bilineal:
+// la identidad LP² + HP² = AP se conserva exacta en digital)
+static void design_section(float* lp, float* hp, float* ap, float freq) {
+    const float w0 = 2.0f * (float)M_PI * freq / SAMPLE_RATE;
+    const float cs = cosf(w0);
+    const float alpha = sinf(w0) / (2.0f * 0.70710678f);
+    const float a0 = 1.0f + alpha;
+
+    lp[0] = (1.0f - cs) / 2.0f / a0;
+    lp[1] = (1.0f - cs) / a0;
+    lp[2] = lp[0];
+    hp[0] = (1.0f + cs) / 2.0f / a0;
+    hp[1] = -(1.0f + cs) / a0;
+    hp[2] = hp[0];
+    ap[0] = (1.0f - alpha) / a0;
+    ap[1] = -2.0f * cs / a0;
+    ap[2] = 1.0f;
+
+    float* sections[3] = {lp, hp, ap};
+    for (int s = 0; s < 3; s++) {
+        sections[s][3] = -2.0f * cs / a0;
+        sections[s][4] = (1.0f - alpha) / a0;
+    }
+}
+
+CrossoverWDRC::CrossoverWDRC() : num_bands(0), num_crossovers(0) {
+    memset(xover, 0, sizeof(xover));
+    configure(BAND_LIMITS, BAND_PARAMS, NUM_BANDS);
+}
+
+bool CrossoverWDRC::configure(const float* band_limits, const BandParams* params, int bands) {
+    if (bands < 1 || bands > XOVER_MAX_BANDS) return false;
+    for (int k = 0; k <= bands; k++) {
+        if (band_limits[k] <= 0.0f || band_limits[k] >= 0.45f * SAMPLE_RATE) return false;
+        if (k > 0 && band_limits[k] <= band_limits[k - 1]) return false;
+    }
+
+    num_bands = bands;
+    num_crossovers = bands + 1;
+    for (int k = 0; k < num_crossovers; k++) {
+        limits[k] = band_limits[k];
+        design_section(xover[k].lp_coeffs, xover[k].hp_coeffs, xover[k].ap_coeffs, limits[k]);
+    }
+
+    // Detector RMS y ganancia a tasa de control (WDRC::processBlock)
+    for (int b = 0; b < num_bands; b++) {
+        wdrc_bands[b].setParameters(params[b], SAMPLE_RATE);
+    }
+    // Los estados de los coeficientes anteriores no valen para los nuevos
+    reset();
+    return true;
+}
+
+void CrossoverWDRC::reset() {
+    for (int k = 0; k <= XOVER_MAX_BANDS; k++) {
+        memset(xover[k].lp_state, 0, sizeof(xover[k].lp_state));
+        memset(xover[k].hp_state, 0, sizeof(xover[k].hp_state));
+    }
+    memset(ap_state, 0, sizeof(ap_state));
+    for (int b = 0; b < XOVER_MAX_BANDS; b++) {
+        wdrc_bands[b].reset();
+    }
+}
+
+float CrossoverWDRC::groupDelayMs() const {
+    /*
+     * Retardo de grupo en DC de un Butterworth de 2º orden: √2/ωc.
+     * LR4 y su pasa-todo valen el doble, 2√2/ωc; la banda más baja
+     * atraviesa un LR4 o pasa-todo de cada cruce:
+     *
+     *   τ(0) = Σ 2√2 / (2π·fₖ)  ≈  Σ 0.45 / fₖ
+     */
+    float delay = 0.0f;
+    for (int k = 0; k < num_crossovers; k++) {
+        delay += 2.0f * 1.41421356f / (2.0f * (float)M_PI * limits[k]);
+    }
+    return delay * 1000.0f;
+}
+
+void AUDIO_IRAM CrossoverWDRC::processChunk(const float* input, float* output, int n) {
+    uint32_t t = profiler_cycles();
+    const int top = num_crossovers;
+
+    // 1. Árbol de cruces: band_buf[k] = paso bajo del cruce k, el resto
+    //    sigue por el paso alto hasta quedar como banda superior
+    float* rest = band_buf[top];
+    memcpy(rest, input, n * sizeof(float));
+    for (int k = 0; k < num_crossovers; k++) {
+        Crossover& x = xover[k];
+        float* lp_coeffs[2] = {x.lp_coeffs, x.lp_coeffs};
+        float* lp_states[2] = {x.lp_state[0], x.lp_state[1]};
+        float* hp_coeffs[2] = {x.hp_coeffs, x.hp_coeffs};
+        float* hp_states[2] = {x.hp_state[0], x.hp_state[1]};
+
+        memcpy(band_buf[k], rest, n * sizeof(float));
+        dsp_biquad_cascade(band_buf[k], n, lp_coeffs, lp_states, 2);
+        dsp_biquad_cascade(rest, n, hp_coeffs, hp_states, 2);
+    }
+
+    // 2. Alinear fase: cada rama baja pasa por los cruces posteriores
+    for (int i = 0; i < num_crossovers - 1; i++) {
+        for (int k = i + 1; k < num_crossovers; k++) {
+            float* coeffs[1] = {xover[k].ap_coeffs};
+            float* states[1] = {ap_state[i][k]};
+            dsp_biquad_cascade(band_buf[i], n, coeffs, states, 1);
+        }
+    }
+    t = profiler_lap(PROF_CROSSOVER, t);
+
+    // 3. WDRC por banda (las dos exteriores, 0 y top, sin compresión)
+    for (int b = 0; b < num_bands; b++) {
+        wdrc_bands[b].processBlock(band_buf[b + 1], band_buf[b + 1], n);
+    }
+
+    // 4. Suma de bandas
+    memcpy(output, band_buf[0], n * sizeof(float));
+    for (int k = 1; k <= top; k++) {
+        const float* band = band_buf[k];
+        for (int i = 0; i < n; i++) {
+            output[i] += band[i];
+        }
+    }
+    profiler_lap(PROF_BANDS, t);
+}
+
+void AUDIO_IRAM CrossoverWDRC::process(float* input, float* output, int size) {
+    for (int offset = 0; offset < size; offset += BUFFER_SIZE) {
+        int n = size - offset < BUFFER_SIZE ? size - offset : BUFFER_SIZE;
+        processChunk(input + offset, output + offset, n);
+    }
+}
@@ -0,0 +1,47 @@
+#ifndef CROSSOVER_WDRC_H
+#define CROSSOVER_WDRC_H
+
+#include "wdrc.h"
+#include "dsp_kernels.h"
+#include "config.h"
+
+#define XOVER_MAX_BANDS     8   // Bandas con WDRC (más las dos exteriores sin compresión)
+
+class CrossoverWDRC {
+private:
+    // Un cruce LR4 = 2 biquads Butterworth en cascada por rama,
+    // más el pasa-todo equivalente para alinear la fase de las bandas bajas
+    struct Crossover {
+        float lp_coeffs[5];
+        float hp_coeffs[5];
+        float ap_coeffs[5];
+        float lp_state[2][2];
+        float hp_state[2][2];
+    };
+
+    Crossover xover[XOVER_MAX_BANDS + 1];
+    float ap_state[XOVER_MAX_BANDS + 1][XOVER_MAX_BANDS + 1][2];   // [banda][cruce]
+    WDRC wdrc_bands[XOVER_MAX_BANDS];
+    float band_buf[XOVER_MAX_BANDS + 2][BUFFER_SIZE] __attribute__((aligned(16)));
+    float limits[XOVER_MAX_BANDS + 1];
+    int num_bands;
+    int num_crossovers;             // num_bands + 1
+
+    void processChunk(const float* input, float* output, int n);
+
+public:
+    CrossoverWDRC();
+    // band_limits: bands + 1 frecuencias crecientes (Hz); params: bands.
+    // Devuelve false (sin cambios) si los límites no son válidos
+    bool configure(const float* band_limits, const BandParams* params, int bands);
+    // Estados de los filtros y de los WDRC a cero (coeficientes intactos)
+    void reset();
+    // Cualquier size; in-place permitido
+    void process(float* input, float* output, int size);
+    int bands() const { return num_bands; }
+    float crossoverFreq(int k) const { return limits[k]; }
+    // Retardo de grupo en DC de la banda más baja (≈ el máximo del banco)
+    float groupDelayMs() const;
+};
+
+#endif
@@ -0,0 +1,131 @@
+#include "Arduino.h"
+#include <string.h>
+#include <atomic>
+#include "cycle_profiler.h"
+#include "dsp_kernels.h"     // AUDIO_IRAM
+
+// ==================== ESTADO ====================
+
+struct StageStats {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t total;
+    uint32_t hist[PROFILER_HIST_BINS];
+};
+
+static StageStats stage_stats[PROFILER_MAX_STAGES];
+static const char* const* stage_names = nullptr;
+static int stage_count = 0;
+static uint32_t block_budget = 0;
+static std::atomic<bool> reset_pending(false);
+
+static void AUDIO_IRAM clear_stats() {
+    memset(stage_stats, 0, sizeof(stage_stats));
+    for (int s = 0; s < PROFILER_MAX_STAGES; s++) {
+        stage_stats[s].min = UINT32_MAX;
+    }
+}
+
+// ==================== HISTOGRAMA ====================
+
+/*
+ * Bin = 4·(octava - 4) + 2 bits siguientes al MSB:
+ *
+ *   ciclos  16..19 │ 20..23 │ 24..27 │ 28..31 │ 32..39 │ ...
+ *   bin       0    │   1    │   2    │   3    │   4    │ ...
+ */
+static inline int hist_bin(uint32_t cycles) {
+    if (cycles < 16) return 0;
+    int msb = 31 - __builtin_clz(cycles);
+    int bin = (msb - 4) * 4 + ((cycles >> (msb - 2)) & 3);
+    return bin < PROFILER_HIST_BINS ? bin : PROFILER_HIST_BINS - 1;
+}
+
+static uint32_t hist_bin_upper(int bin) {
+    int msb = bin / 4 + 4;
+    return (uint32_t)(5 + bin % 4) << (msb - 2);
+}
+
+// Borde superior del bin que alcanza el 99 % de las medidas
+static uint32_t hist_p99(const StageStats* s) {
+    uint32_t target = s->count - s->count / 100;
+    uint32_t acc = 0;
+    for (int b = 0; b < PROFILER_HIST_BINS - 1; b++) {
+        acc += s->hist[b];
+        if (acc >= target) {
+            uint32_t upper = hist_bin_upper(b);
+            return upper < s->max ? upper : s->max;
+        }
+    }
+    return s->max;
+}
+
+// Nombre alineado a 18 columnas (printf cuenta bytes, no caracteres UTF-8)
+static void print_stage_name(const char* name) {
+    int width = 0;
+    for (const char* c = name; *c; c++) {
+        if ((*c & 0xC0) != 0x80) width++;
+    }
+    Serial.printf("  %s%*s", name, width < 18 ? 18 - width : 0, "");
+}
+
+// ==================== API ====================
+
+void profiler_init(const char* const* names, int num_stages, uint32_t block_budget_cycles) {
+    stage_names = names;
+    stage_count = num_stages < PROFILER_MAX_STAGES ? num_stages : PROFILER_MAX_STAGES;
+    block_budget = block_budget_cycles;
+    clear_stats();
+}
+
+void profiler_set_budget(uint32_t block_budget_cycles) {
+    block_budget = block_budget_cycles;
+}
+
+void AUDIO_IRAM profiler_record(int stage, uint32_t cycles) {
+    StageStats& s = stage_stats[stage];
+    s.count++;
+    s.total += cycles;
+    if (cycles < s.min) s.min = cycles;
+    if (cycles > s.max) s.max = cycles;
+    s.hist[hist_bin(cycles)]++;
+}
+
+void AUDIO_IRAM profiler_block_end() {
+    if (reset_pending.load(std::memory_order_relaxed)) {
+        clear_stats();
+        reset_pending.store(false, std::memory_order_release);
+    }
+}
+
+void profiler_reset() {
+    reset_pending.store(true, std::memory_order_release);
+}
+
+void profiler_print() {
+    static StageStats snapshot;   // Copia por etapa: la tarea de audio sigue escribiendo
+    const float budget = block_budget > 0 ? (float)block_budget : 1.0f;
+
+    Serial.printf("\n⏱️ PERFIL DE CICLOS POR BLOQUE (presupuesto %lu ciclos = %.2f ms @ %lu MHz)\n",
+                  (unsigned long)block_budget, budget / (getCpuFrequencyMhz() * 1000.0f),
+                  (unsigned long)getCpuFrequencyMhz());
+    Serial.println("  etapa              bloques      min      avg      max      p99   %avg   %p99   %max");
+
+    for (int i = 0; i < stage_count; i++) {
+        memcpy(&snapshot, &stage_stats[i], sizeof(snapshot));
+        print_stage_name(stage_names[i]);
+        if (snapshot.count == 0) {
+            Serial.printf(" %8s\n", "-");
+            continue;
+        }
+        uint32_t avg = (uint32_t)(snapshot.total / snapshot.count);
+        uint32_t p99 = hist_p99(&snapshot);
+        Serial.printf(" %8lu %8lu %8lu %8lu %8lu %5.1f%% %5.1f%% %5.1f%%\n",
+                      (unsigned long)snapshot.count,
+                      (unsigned long)snapshot.min, (unsigned long)avg,
+                      (unsigned long)snapshot.max, (unsigned long)p99,
+                      100.0f * avg / budget, 100.0f * p99 / budget,
+                      100.0f * snapshot.max / budget);
+    }
+}
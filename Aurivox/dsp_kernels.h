@@ -0,0 +1,110 @@
+#ifndef DSP_KERNELS_H
+#define DSP_KERNELS_H
+
+#include <stdint.h>
+#include "sdkconfig.h"
+#include "esp_attr.h"
+
+/*
+ * KERNELS DSP POR BLOQUE
+ * =====================
+ *
+ * Bucles calientes del audio (conversión, ganancia, nivel, biquads)
+ * con dos implementaciones:
+ *
+ *   ESP32-S3 (DSP_KERNELS_OPTIMIZED = 1)
+ *     - enteros: extensión vectorial PIE (EE.*), 4 muestras int32 por
+ *       instrucción en registros q de 128 bits
+ *         int32 → int16: redondeo (EE.VADDS.S32), desplazamiento
+ *                        (EE.VSR.32), saturación (EE.VMIN/VMAX.S32) y
+ *                        empaquetado de 8 muestras (EE.VUNZIP.16)
+ *         pico int32:    EE.VMAX.S32 / EE.VMIN.S32 por carril
+ *     - float: rutinas aes3 de ESP-DSP (mulc, mul, dotprod, biquad) y
+ *       bucles desenrollados x4 donde ESP-DSP no tiene rutina (pico, axpy)
+ *     - conversiones float: FLOAT.S / TRUNC.S con escala 2^n incluida en
+ *       la instrucción + CLAMPS para saturar a 16 bits
+ *
+ *   ESP32 original y resto (DSP_KERNELS_OPTIMIZED = 0)
+ *     - C escalar portable
+ *
+ * PIE no tiene carriles float, así que los kernels float usan la FPU
+ * escalar con bucles sin overhead. Los kernels PIE necesitan punteros
+ * alineados a 16 bytes (los buffers del audio lo están) y procesan de 8
+ * en 8 muestras; el resto y los punteros sin alinear van por la versión
+ * escalar, con el mismo resultado bit a bit.
+ *
+ * Archivo idéntico en Aurivox/ y Aurivox2/: mantener ambas copias
+ * sincronizadas.
+ */
+
+#if CONFIG_IDF_TARGET_ESP32S3
+#define DSP_KERNELS_OPTIMIZED   1
+#else
+#define DSP_KERNELS_OPTIMIZED   0
+#endif
+
+#define DSP_KERNELS_BENCH_SIZE  128   // Muestras por bloque en el benchmark
+
+/*
+ * CÓDIGO DEL AUDIO EN IRAM
+ * ========================
+ *
+ * AUDIO_IRAM marca las funciones que corren en cada bloque (estos kernels,
+ * el perfilador y la cadena DSP de cada sketch). Desde flash, cada fallo
+ * de la caché de instrucciones cuesta una lectura SPI, y tras una
+ * escritura en flash (NVS) la caché vuelve vacía: el bloque siguiente
+ * tarda más y sin patrón fijo. En IRAM el coste del bloque es estable.
+ *
+ * No cubre lo que está fuera del sketch (ESP-DSP, libm, driver I2S), y
+ * mientras se escribe en flash los dos cores quedan parados igual: el
+ * colchón DMA tiene que cubrir la escritura (comando 'memory' en Aurivox2).
+ * AUDIO_CODE_IN_IRAM = 0 deja todo en flash (depuración, IRAM justa).
+ */
+#ifndef AUDIO_CODE_IN_IRAM
+#define AUDIO_CODE_IN_IRAM      1
+#endif
+
+#if AUDIO_CODE_IN_IRAM
+#define AUDIO_IRAM              IRAM_ATTR
+#else
+#define AUDIO_IRAM
+#endif
+
+// out[i] = in[i] · 2^-shift            (p.ej. shift = 31: int32 → [-1, 1))
+void dsp_int32_to_float(const int32_t* in, float* out, int n, int shift);
+
+// out[i·step] = sat16(in[i] · 2^shift) (p.ej. shift = 15: [-1, 1) → int16)
+void dsp_float_to_int16(const float* in, int16_t* out, int n, int shift, int out_step);
+
+// out[i·step] = sat16(round(in[i] · 2^-shift))  (p.ej. shift = 12: Q4.27 → int16)
+void dsp_int32_to_int16(const int32_t* in, int16_t* out, int n, int shift, int out_step);
+
+// max |x[i]| para int32, saturado a INT32_MAX
+int32_t dsp_peak_int32(const int32_t* x, int n);
+
+// out[i] = in[i] · gain  (in-place permitido)
+void dsp_gain(const float* in, float* out, int n, float gain);
+
+// out[i] = a[i] · b[i]   (in-place permitido)
+void dsp_multiply(const float* a, const float* b, float* out, int n);
+
+// max |x[i]|
+float dsp_peak(const float* x, int n);
+
+// Σ x[i]²  (RMS = sqrt(dsp_energy / n))
+float dsp_energy(const float* x, int n);
+
+// Σ a[i]·b[i]  (filtros FIR / NLMS)
+float dsp_dot(const float* a, const float* b, int n);
+
+// y[i] += k · x[i]  (actualización de coeficientes NLMS)
+void dsp_axpy(const float* x, float* y, int n, float k);
+
+// Cascada de biquads in-place, formato ESP-DSP:
+// coeffs[s] = {b0, b1, b2, a1, a2}, states[s] = {w[n-1], w[n-2]}
+void dsp_biquad_cascade(float* x, int n, float* const* coeffs, float* const* states, int stages);
+
+// Micro-benchmark de cada kernel frente a la versión escalar (ciclos por bloque)
+void dsp_kernels_benchmark();
+
+#endif
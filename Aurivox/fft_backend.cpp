@@ -0,0 +1,205 @@
+#include "fft_backend.h"
+#include "dsp_kernels.h"     // AUDIO_IRAM
+
+/*
+ * BACKENDS DE FFT PARA EL PROCESADOR MULTIBANDA
+ * ============================================
+ *
+ * ArduinoFFT<double>:
+ *   Referencia original. El ESP32 no tiene FPU de doble precisión, así
+ *   que cada butterfly se emula por software. Usa 2 × 4 KB de buffers.
+ *   compute() es código de la librería y se ejecuta desde flash.
+ *
+ * ESP-DSP float32 (FFT real):
+ *   Una FFT real de N puntos se calcula como una FFT compleja de N/2
+ *   puntos más un paso de separación (split):
+ *
+ *   x[n] ──▶ z[n] = x[2n] + j·x[2n+1] ──▶ FFT N/2 ──▶ split ──▶ X[k]
+ *
+ *   Con Z[k] la FFT de z:
+ *
+ *            Z[k] + Z*[N/2-k]             Z[k] - Z*[N/2-k]
+ *   Xe[k] = ──────────────────   Xo[k] = ──────────────────
+ *                   2                           2j
+ *
+ *   X[k] = Xe[k] + W^k · Xo[k]          W = e^(-j2π/N)
+ *
+ *   Todo ocurre en el mismo buffer de FFT_SIZE floats (2 KB). La inversa
+ *   deshace el split y usa IFFT(Z) = conj(FFT(conj(Z))) / (N/2).
+ *
+ * Tablas:
+ *   - Twiddles del núcleo complejo: tabla estática compartida por ESP-DSP
+ *   - Twiddles del split: N/4+1 pares cos/sin por instancia
+ */
+
+#if FFT_BACKEND == FFT_BACKEND_ARDUINOFFT
+
+// Objeto miembro, sin new: la instancia vive donde viva el backend (estática)
+FFTBackend::FFTBackend() : FFT(real, imag, FFT_SIZE, (double)SAMPLE_RATE) {
+}
+
+FFTBackend::~FFTBackend() {
+}
+
+void AUDIO_IRAM FFTBackend::forward(float* data) {
+    for(int i = 0; i < FFT_SIZE; i++) {
+        real[i] = (double)data[i];
+        imag[i] = 0.0;
+    }
+
+    FFT.compute(FFT_FORWARD);
+
+    // Empaquetar medio espectro
+    data[0] = (float)real[0];
+    data[1] = (float)real[FFT_SIZE/2];
+    for(int k = 1; k < FFT_SIZE/2; k++) {
+        data[2*k] = (float)real[k];
+        data[2*k + 1] = (float)imag[k];
+    }
+}
+
+void AUDIO_IRAM FFTBackend::inverse(float* data) {
+    // Reconstruir espectro completo con simetría conjugada
+    real[0] = data[0];
+    imag[0] = 0.0;
+    real[FFT_SIZE/2] = data[1];
+    imag[FFT_SIZE/2] = 0.0;
+    for(int k = 1; k < FFT_SIZE/2; k++) {
+        real[k] = data[2*k];
+        imag[k] = data[2*k + 1];
+        real[FFT_SIZE - k] = data[2*k];
+        imag[FFT_SIZE - k] = -data[2*k + 1];
+    }
+
+    FFT.compute(FFT_REVERSE);
+
+    for(int i = 0; i < FFT_SIZE; i++) {
+        data[i] = (float)(real[i] / FFT_SIZE);
+    }
+}
+
+const char* FFTBackend::name() {
+    return "ArduinoFFT<double>";
+}
+
+#else  // FFT_BACKEND_ESPDSP
+
+#include "esp_dsp.h"
+#include <math.h>
+
+#define FFT_HALF    (FFT_SIZE / 2)   // Puntos del núcleo complejo
+
+#if FFT_ESPDSP_RADIX4
+#if (FFT_HALF & 0x5555) == 0 || (FFT_HALF & (FFT_HALF - 1)) != 0
+#error "FFT_ESPDSP_RADIX4 requiere FFT_SIZE/2 potencia de 4"
+#endif
+#define FFT_CORE(data)      do { dsps_fft4r_fc32(data, FFT_HALF); \
+                                 dsps_bit_rev4r_fc32(data, FFT_HALF); } while(0)
+#else
+#define FFT_CORE(data)      do { dsps_fft2r_fc32(data, FFT_HALF); \
+                                 dsps_bit_rev_fc32(data, FFT_HALF); } while(0)
+#endif
+
+// Tabla de twiddles de ESP-DSP (global en la librería, se reserva aquí)
+static float fft_core_table[FFT_HALF] __attribute__((aligned(16)));
+static bool fft_core_ready = false;
+
+FFTBackend::FFTBackend() {
+    if (!fft_core_ready) {
+#if FFT_ESPDSP_RADIX4
+        dsps_fft4r_init_fc32(NULL, FFT_HALF);
+#else
+        dsps_fft2r_init_fc32(fft_core_table, FFT_HALF);
+#endif
+        fft_core_ready = true;
+    }
+
+    for(int k = 0; k <= FFT_SIZE/4; k++) {
+        double theta = 2.0 * M_PI * k / FFT_SIZE;
+        split_twiddle[2*k] = (float)cos(theta);
+        split_twiddle[2*k + 1] = (float)sin(theta);
+    }
+}
+
+FFTBackend::~FFTBackend() {
+}
+
+void AUDIO_IRAM FFTBackend::forward(float* data) {
+    // 1. FFT compleja de N/2 puntos sobre pares (par, impar)
+    FFT_CORE(data);
+
+    // 2. Split: DC y Nyquist quedan en data[0] / data[1]
+    float z0r = data[0];
+    float z0i = data[1];
+    data[0] = z0r + z0i;
+    data[1] = z0r - z0i;
+
+    for(int k = 1; k <= FFT_HALF/2; k++) {
+        int m = FFT_HALF - k;
+        float ar = data[2*k],  ai = data[2*k + 1];   // Z[k]
+        float br = data[2*m],  bi = -data[2*m + 1];  // Z*[N/2-k]
+
+        float er = 0.5f * (ar + br);                 // Xe[k]
+        float ei = 0.5f * (ai + bi);
+        float or_ = 0.5f * (ai - bi);                // Xo[k] = (a-b)/2j
+        float oi = -0.5f * (ar - br);
+
+        float c = split_twiddle[2*k];
+        float s = split_twiddle[2*k + 1];
+        float tr = c * or_ + s * oi;                 // W^k · Xo[k]
+        float ti = c * oi - s * or_;
+
+        data[2*k] = er + tr;                         // X[k]
+        data[2*k + 1] = ei + ti;
+        data[2*m] = er - tr;                         // X[N/2-k] = conj(Xe - W^k·Xo)
+        data[2*m + 1] = -(ei - ti);
+    }
+}
+
+void AUDIO_IRAM FFTBackend::inverse(float* data) {
+    const float scale = 1.0f / FFT_HALF;
+
+    // 1. Deshacer el split y conjugar para usar la FFT directa como IFFT
+    float x0 = data[0];
+    float xm = data[1];
+    data[0] = 0.5f * (x0 + xm) * scale;
+    data[1] = -0.5f * (x0 - xm) * scale;
+
+    for(int k = 1; k <= FFT_HALF/2; k++) {
+        int m = FFT_HALF - k;
+        float ar = data[2*k],  ai = data[2*k + 1];   // X[k]
+        float br = data[2*m],  bi = -data[2*m + 1];  // X*[N/2-k]
+
+        float er = 0.5f * (ar + br);                 // Xe[k]
+        float ei = 0.5f * (ai + bi);
+        float dr = 0.5f * (ar - br);                 // W^k · Xo[k]
+        float di = 0.5f * (ai - bi);
+
+        float c = split_twiddle[2*k];
+        float s = split_twiddle[2*k + 1];
+        float or_ = c * dr - s * di;                 // Xo[k] = conj(W^k) · d
+        float oi = c * di + s * dr;
+
+        // Z[k] = Xe + j·Xo,  Z[N/2-k] = conj(Xe) + j·conj(Xo); se guardan conjugados
+        data[2*k] = (er - oi) * scale;
+        data[2*k + 1] = -(ei + or_) * scale;
+        data[2*m] = (er + oi) * scale;
+        data[2*m + 1] = -(-ei + or_) * scale;
+    }
+
+    // 2. FFT compleja y conjugado final: z = x[2n] + j·x[2n+1]
+    FFT_CORE(data);
+    for(int n = 1; n < FFT_SIZE; n += 2) {
+        data[n] = -data[n];
+    }
+}
+
+const char* FFTBackend::name() {
+#if FFT_ESPDSP_RADIX4
+    return "ESP-DSP float32 radix-4";
+#else
+    return "ESP-DSP float32 radix-2";
+#endif
+}
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef FFT_BACKEND_H
+#define FFT_BACKEND_H
+
+#include "config.h"
+
+#if FFT_BACKEND == FFT_BACKEND_ARDUINOFFT
+#include <arduinoFFT.h>
+#endif
+
+/*
+ * Formato espectral empaquetado (señal real, N = FFT_SIZE):
+ * ======================================================
+ *
+ *  data[0]    = Re X[0]         (DC)
+ *  data[1]    = Re X[N/2]       (Nyquist)
+ *  data[2k]   = Re X[k]    ┐
+ *  data[2k+1] = Im X[k]    ┘    k = 1 .. N/2-1
+ *
+ * Los bins N/2+1 .. N-1 son el conjugado de los anteriores y no se
+ * almacenan. forward() y inverse() trabajan en el mismo buffer de
+ * FFT_SIZE floats; inverse() incluye el factor 1/N.
+ */
+class FFTBackend {
+private:
+#if FFT_BACKEND == FFT_BACKEND_ARDUINOFFT
+    double real[FFT_SIZE];
+    double imag[FFT_SIZE];
+    ArduinoFFT<double> FFT;     // Trabaja sobre real/imag (declarados antes)
+#else
+    // W_N^k = cos(2πk/N) - j·sin(2πk/N), k = 0 .. N/4 (pares cos, sin)
+    float split_twiddle[FFT_SIZE/2 + 2];
+#endif
+
+public:
+    FFTBackend();
+    ~FFTBackend();
+    void forward(float* data);
+    void inverse(float* data);
+    const char* name();
+};
+
+#endif
@@ -32,7 +32,11 @@ void setup_i2s_dac() {
         .mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_TX),
         .sample_rate = SAMPLE_RATE,
         .bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT,  // Cambiado a 16-bit
+#if I2S_DAC_CHANNELS == 1
+        .channel_format = I2S_CHANNEL_FMT_ONLY_LEFT,   // Solo canal izquierdo
+#else
         .channel_format = I2S_CHANNEL_FMT_RIGHT_LEFT,
+#endif
         .communication_format = I2S_COMM_FORMAT_STAND_I2S,
         .intr_alloc_flags = ESP_INTR_FLAG_LEVEL1,
         .dma_buf_count = DMA_BUF_COUNT,
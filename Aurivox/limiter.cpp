@@ -0,0 +1,138 @@
+#include "limiter.h"
+#include "dsp_kernels.h"
+#include <math.h>
+
+/*
+ * LIMITADOR CON ANTICIPACIÓN (LOOK-AHEAD)
+ * ======================================
+ *
+ * Sustituye al recorte por muestra: la ganancia baja ANTES de que llegue
+ * el pico, así que la salida no se recorta ni se distorsiona.
+ *
+ *   x ──┬──────────────▶ [retardo D] ──────────────▶ (×) ──▶ y
+ *       │                                             ▲
+ *       └─▶ máx |x| en D+1 ─▶ T/máx ─▶ release ─▶ media D+1
+ *           (deque monotónica)  g_obj      env        g
+ *
+ * Ganancia para una muestra que entra en n:
+ *
+ *   g_obj[n] = min(1, T / máx |x[n-D .. n]|)
+ *   env[n]   = g_obj[n] si baja (instantáneo), si no release exponencial
+ *              (sobre 1 - env: sin estancarse cerca de 1)
+ *   g[n]     = media de env[n-D .. n]        → rampa de D muestras
+ *   y[n]     = x[n-D] · g[n]
+ *
+ * Cada env[m] con m en [p, p+D] ve el pico x[p] en su ventana, así que
+ * la media que se aplica a x[p] es ≤ T/|x[p]|: techo garantizado, con una
+ * rampa de ataque suave de D muestras (0.5-2 ms).
+ *
+ * Máximo deslizante en O(1) amortizado por muestra:
+ *
+ *   deque (cabeza → cola): niveles decrecientes, posiciones crecientes
+ *   - entra x: se descartan por la cola los niveles ≤ |x| (nunca serán máximo)
+ *   - caduca por la cabeza la posición más antigua que la ventana
+ *   - máximo = cabeza
+ *
+ * Solo entran niveles sobre el umbral: sin picos el deque está vacío y,
+ * con la media ya en 1, el bloque se reduce a la línea de retardo.
+ */
+
+LookaheadLimiter::LookaheadLimiter() {
+    setParameters(LIMITER_THRESHOLD_DB, LIMITER_LOOKAHEAD_MS, LIMITER_RELEASE_MS);
+}
+
+void LookaheadLimiter::setParameters(float threshold_db, float lookahead_ms, float release_ms) {
+    if (lookahead_ms < LIMITER_MIN_LOOKAHEAD_MS) lookahead_ms = LIMITER_MIN_LOOKAHEAD_MS;
+    if (lookahead_ms > LIMITER_MAX_LOOKAHEAD_MS) lookahead_ms = LIMITER_MAX_LOOKAHEAD_MS;
+    threshold = pow(10.0f, threshold_db / 20.0f);
+    delay = (int)(lookahead_ms * SAMPLE_RATE / 1000.0f + 0.5f);
+    alpha_release = exp(-1.0f / (SAMPLE_RATE * release_ms / 1000.0f));
+    reset();
+}
+
+void LookaheadLimiter::reset() {
+    for (int i = 0; i < RING; i++) {
+        delay_line[i] = 0.0f;
+        gain_line[i] = 1.0f;
+    }
+    peak_head = 0;
+    peak_tail = 0;
+    pos = 0;
+    reduction = 0.0f;
+    hold = 0;
+    block_min_gain = 1.0f;
+}
+
+void AUDIO_IRAM LookaheadLimiter::process(const float* input, float* output, int n) {
+    // Sin picos pendientes ni reducción en la ventana: solo retardo
+    if (peak_head == peak_tail && hold == 0 && dsp_peak(input, n) <= threshold) {
+        for (int i = 0; i < n; i++) {
+            delay_line[pos & MASK] = input[i];
+            gain_line[pos & MASK] = 1.0f;
+            output[i] = delay_line[(pos - delay) & MASK];
+            pos++;
+        }
+        block_min_gain = 1.0f;
+        return;
+    }
+
+    // Suma de la ventana recalculada por bloque: sin deriva de redondeo
+    const int window = delay + 1;
+    const float inv_window = 1.0f / window;
+    float gain_sum = 0.0f;
+    for (int k = 1; k <= window; k++) {
+        gain_sum += gain_line[(pos - k) & MASK];
+    }
+
+    float min_gain = 1.0f;
+    for (int i = 0; i < n; i++) {
+        const float x = input[i];
+        const float level = fabsf(x);
+
+        // Máximo deslizante de los niveles sobre el umbral en [pos-D, pos]
+        while (peak_head != peak_tail && pos - peak_pos[peak_head & MASK] > (uint32_t)delay) {
+            peak_head++;
+        }
+        if (level > threshold) {
+            while (peak_head != peak_tail && peak_level[(peak_tail - 1) & MASK] <= level) {
+                peak_tail--;
+            }
+            peak_pos[peak_tail & MASK] = pos;
+            peak_level[peak_tail & MASK] = level;
+            peak_tail++;
+        }
+        const float target = peak_head != peak_tail ? 1.0f - threshold / peak_level[peak_head & MASK] : 0.0f;
+
+        // Ataque instantáneo (la media de D+1 lo suaviza), release exponencial.
+        // Sobre la reducción y no la ganancia: 1 - (1 - g)·α se estanca a
+        // ~0.5/(1-α) ulp de 1 y el release no terminaría nunca
+        if (target > reduction) {
+            reduction = target;
+        } else {
+            reduction = target + (reduction - target) * alpha_release;
+            if (target == 0.0f && reduction < 1e-6f) reduction = 0.0f;
+        }
+        hold = reduction > 0.0f ? window : (hold > 0 ? hold - 1 : 0);
+        const float envelope = 1.0f - reduction;
+
+        gain_sum += envelope - gain_line[(pos - window) & MASK];
+        gain_line[pos & MASK] = envelope;
+        delay_line[pos & MASK] = x;
+
+        // La suma corrida deriva unos ulp en el bloque: el recorte al umbral solo cubre esa deriva
+        const float gain = hold > 0 ? gain_sum * inv_window : 1.0f;
+        const float y = delay_line[(pos - delay) & MASK] * gain;
+        output[i] = fminf(fmaxf(y, -threshold), threshold);
+        if (gain < min_gain) min_gain = gain;
+        pos++;
+    }
+    block_min_gain = min_gain;
+}
+
+float LookaheadLimiter::thresholdDb() const {
+    return 20.0f * log10f(threshold);
+}
+
+float LookaheadLimiter::gainReductionDb() const {
+    return -20.0f * log10f(block_min_gain);
+}
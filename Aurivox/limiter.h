@@ -0,0 +1,43 @@
+#ifndef LIMITER_H
+#define LIMITER_H
+
+#include "config.h"
+#include <stdint.h>
+
+// Limitador brick-wall con anticipación: la salida nunca supera el umbral.
+// Por bloques; in-place permitido. Añade lookaheadMs() de latencia.
+class LookaheadLimiter {
+private:
+    static constexpr int MAX_DELAY = (int)(LIMITER_MAX_LOOKAHEAD_MS * SAMPLE_RATE / 1000.0f) + 1;
+    static constexpr int RING = 128;            // Potencia de 2 > MAX_DELAY + 1
+    static constexpr uint32_t MASK = RING - 1;
+    static_assert(MAX_DELAY + 1 < RING, "LIMITER_MAX_LOOKAHEAD_MS no cabe en la línea de retardo");
+
+    float delay_line[RING];     // Entrada, se lee con delay muestras de retraso
+    float gain_line[RING];      // Ganancia por muestra (tras el release) para la media
+    uint32_t peak_pos[RING];    // Deque monotónica de picos sobre el umbral:
+    float peak_level[RING];     //   posición creciente, nivel decreciente
+    uint32_t peak_head;
+    uint32_t peak_tail;
+    uint32_t pos;               // Muestras procesadas (índice del anillo con MASK)
+
+    int delay;                  // Anticipación en muestras (= ventana del máximo - 1)
+    float threshold;            // Lineal
+    float alpha_release;
+    float reduction;            // 1 - ganancia objetivo con release (≥ 0)
+    int hold;                   // Muestras hasta que la media vuelve a 1
+    float block_min_gain;       // Menor ganancia del último bloque (diagnóstico)
+
+public:
+    LookaheadLimiter();
+    // lookahead_ms se acota a [LIMITER_MIN_LOOKAHEAD_MS, LIMITER_MAX_LOOKAHEAD_MS]
+    void setParameters(float threshold_db, float lookahead_ms, float release_ms);
+    void reset();
+    void process(const float* input, float* output, int n);
+    float thresholdDb() const;
+    float lookaheadMs() const { return delay * 1000.0f / SAMPLE_RATE; }
+    int lookaheadSamples() const { return delay; }
+    float gainReductionDb() const;
+};
+
+#endif
@@ -1,4 +1,8 @@
 #include "multiband_wdrc.h"
+#include <string.h>
+#include <math.h>
+#include <float.h>
+#include "cycle_profiler.h"
 
 /*
  * PROCESAMIENTO MULTIBANDA CON FFT Y WDRC
@@ -40,7 +44,10 @@
  * Proceso de Ventaneo (Windowing):
  * ==============================
  *
- * Amplitud          Ventana Hamming
+ * Modo bloque (STFT_OVERLAP = 1): ventana Hamming solo en análisis.
+ * Modo WOLA (STFT_OVERLAP = 2/4): sqrt-Hann en análisis y síntesis.
+ *
+ * Amplitud          Ventana
  *    ↑     ___________________________
  *1.0 │   ╱╲                    
  *    │  ╱   ╲        Reduce el
@@ -67,57 +74,265 @@
  */
 
 // Constructor: inicializa FFT y WDRC para cada banda
-MultibandWDRC::MultibandWDRC() {
+template <int Bands, int FFTSize, int SampleRate>
+MultibandWDRCT<Bands, FFTSize, SampleRate>::MultibandWDRCT() {
     /*
      * Inicialización:
      * -------------
      * - FFT para análisis espectral
      * - Array de procesadores WDRC
-     * - Buffers para datos reales e imaginarios
+     * - Buffer de trama float32 (espectro real empaquetado)
      *
      * Configuración FFT:
      * ----------------
      * - Tamaño: 512 puntos
      * - Frecuencia muestreo: 44100 Hz
      * - Resolución: 44100/512 = 86.13 Hz/bin
+     * - Backend: FFT_BACKEND en config.h (ver fft_backend.cpp)
      */
-    FFT = new ArduinoFFT<double>(real, imag, FFT_SIZE, (double)SAMPLE_RATE);
+    
+    // La envolvente de cada banda se actualiza una vez por trama,
+    // por lo que attack/release se calculan a la frecuencia de tramas
+    const float frame_rate = (float)SampleRate / HOP_SIZE;
     
     // Inicializar cada banda con sus parámetros específicos
-    for(int i = 0; i < NUM_BANDS; i++) {
-        wdrc_bands[i].setParameters(BAND_PARAMS[i]);
+    for(int i = 0; i < Bands; i++) {
+        wdrc_bands[i].setParameters(BAND_PARAMS[i], frame_rate);
     }
-}
 
-// Destructor: libera memoria
-MultibandWDRC::~MultibandWDRC() {
-    if (FFT != nullptr) {
-        delete FFT;
+#if NOISE_REDUCTION
+    // Reducción de ruido: constantes a la frecuencia de tramas, como el WDRC
+    nr_alpha = expf(-1000.0f / (NR_SMOOTHING_MS * frame_rate));
+    nr_gain_floor = powf(10.0f, -NR_MAX_ATTENUATION_DB / 20.0f);
+    nr_subwindow_frames = (int)(NR_WINDOW_MS * frame_rate / (1000.0f * NR_SUBWINDOWS));
+    if(nr_subwindow_frames < 1) nr_subwindow_frames = 1;
+    nr_enabled = NR_DEFAULT_ENABLED;
+    resetNoiseEstimate();
+#endif
+    
+    /*
+     * Normalización de energía (Parseval):
+     * ----------------------------------
+     *
+     *   1   N-1            2     N/2-1
+     *  ─── · Σ x²[n]  ≈  ────── ·  Σ  |X[k]|²
+     *   N   n=0         N·Σw²    k=1
+     *
+     * Así el nivel de cada banda queda en dBFS (seno a escala completa
+     * ≈ -3 dB), comparable con los umbrales de BAND_PARAMS.
+     */
+    double window_energy = 0.0;
+    for(int i = 0; i < FFTSize; i++) {
+#if STFT_OVERLAP > 1
+        // sqrt-Hann periódica: análisis · síntesis = Hann
+        double w = sqrt(0.5 - 0.5 * cos(2.0 * M_PI * i / FFTSize));
+#else
+        double w = 0.54 - 0.46 * cos(2.0 * M_PI * i / (FFTSize - 1));
+#endif
+        window[i] = (float)w;
+        window_energy += w * w;
     }
+    power_norm = (float)(2.0 / (FFTSize * window_energy));
+    
+#if STFT_OVERLAP > 1
+    /*
+     * Reconstrucción perfecta WOLA:
+     * ---------------------------
+     *
+     *   Σ  hann(n - m·hop) = N / (2·hop)
+     *   m
+     *
+     * 50% → 1.0, 75% → 2.0; ola_scale lo lleva a ganancia unitaria.
+     */
+    ola_scale = 2.0f * HOP_SIZE / FFTSize;
+    for(int i = 0; i < FFTSize; i++) {
+        in_ring[i] = 0.0f;
+        ola_ring[i] = 0.0f;
+    }
+    ring_pos = 0;
+#endif
 }
 
-// Determina a qué banda pertenece cada frecuencia
-int MultibandWDRC::getBandIndex(double frequency) {
+// Procesamiento por bandas sobre el espectro de la trama actual
+template <int Bands, int FFTSize, int SampleRate>
+void MultibandWDRCT<Bands, FFTSize, SampleRate>::processSpectrum() {
     /*
-     * Mapeo de Frecuencias a Bandas:
-     * ===========================
+     * Detección a nivel de banda:
+     * -------------------------
+     *
+     *  bins ──▶ Σ|X|² por banda ──▶ WDRC (1 vez/trama) ──▶ G[banda]
+     *                                                         │
+     *  bins ◀──────────── X[k] · G[banda(k)] ◀────────────────┘
      *
-     * Banda │ Rango (Hz) │ Relevancia
-     * ──────┼───────────┼────────────
-     *   0   │ 250-1000  │ Graves, fundamentales
-     *   1   │ 1000-4000 │ Medios, vocales
-     *   2   │ 4000-8000 │ Agudos, consonantes
+     * Escalar real e imaginario por la misma ganancia conserva la
+     * fase, así que no hace falta atan2/cos/sin por bin.
+     *
+     * BAND_LIMITS es creciente, así que cada banda ocupa un rango
+     * contiguo de bins (BINS, calculado en compilación) y sus Re/Im son
+     * contiguos en el espectro empaquetado.
      */
-    for(int i = 0; i < NUM_BANDS; i++) {
-        if(frequency >= BAND_LIMITS[i] && frequency < BAND_LIMITS[i + 1]) {
-            return i;
+#if NOISE_REDUCTION
+    if(nr_enabled) {
+        // Ganancia de ruido por bin y energía de banda ya reducida en una pasada
+        noiseReductionPass();
+    } else
+#endif
+    {
+        // Σ|X|² de cada banda = producto escalar de su tramo Re/Im consigo mismo
+        for(int b = 0; b < Bands; b++) {
+            int len = 2 * (BINS.end[b] - BINS.first[b]);
+            band_power[b] = len > 0 ? dsp_energy(frame + 2 * BINS.first[b], len) : 0.0f;
+        }
+    }
+    
+    // Una envolvente y una ganancia por banda
+    for(int b = 0; b < Bands; b++) {
+        band_gain[b] = wdrc_bands[b].processBandPower(band_power[b] * power_norm);
+    }
+    
+    // Aplicar la ganancia de cada banda a sus bins
+    // (solo se guarda medio espectro: la simetría conjugada es implícita)
+    for(int b = 0; b < Bands; b++) {
+        int len = 2 * (BINS.end[b] - BINS.first[b]);
+        if(len > 0) {
+            float* bins = frame + 2 * BINS.first[b];
+#if NOISE_REDUCTION
+            if(nr_enabled) {
+                // Ganancia de banda × ganancia de ruido: un producto más por bin
+                const float* nr = nr_gain + (BINS.first[b] - NR_FIRST);
+                for(int k = 0; k < len / 2; k++) {
+                    const float g = band_gain[b] * nr[k];
+                    bins[2 * k] *= g;
+                    bins[2 * k + 1] *= g;
+                }
+                continue;
+            }
+#endif
+            dsp_gain(bins, bins, len, band_gain[b]);
         }
     }
-    return -1;  // Frecuencia fuera de rango
+}
+
+#if NOISE_REDUCTION
+/*
+ * Reducción de ruido en la misma trama (sin FFT adicional):
+ * ========================================================
+ *
+ *  |X[k]|² ──▶ suavizado ──▶ P[k] ──▶ mínimo por subventana ──▶ N[k]
+ *                             │                                  │
+ *                             └───▶ G[k] = max(1 - N/P, suelo) ◀──┘
+ *
+ *  Minimum statistics: en NR_WINDOW_MS siempre hay pausas del habla, así
+ *  que el mínimo de P sigue al ruido estacionario sin detector de voz.
+ *  La ventana se desliza por subventanas: cada bin guarda NR_SUBWINDOWS
+ *  mínimos en lugar de la historia de tramas. N = sesgo · mínimo.
+ *
+ *  G es la ganancia de Wiener con la SNR a priori estimada como P/N - 1.
+ *  El WDRC mide la energía de banda ya reducida (Σ|X|²·G²), así que no
+ *  devuelve con su ganancia el ruido que se acaba de quitar.
+ */
+template <int Bands, int FFTSize, int SampleRate>
+void MultibandWDRCT<Bands, FFTSize, SampleRate>::noiseReductionPass() {
+    const bool estimating = nr_history_filled > 0;
+    const float smoothing = 1.0f - nr_alpha;
+    
+    for(int b = 0; b < Bands; b++) {
+        float power = 0.0f;
+        for(int k = BINS.first[b]; k < BINS.end[b]; k++) {
+            const int i = k - NR_FIRST;
+            const float re = frame[2 * k];
+            const float im = frame[2 * k + 1];
+            const float p = re * re + im * im;
+            const float ps = nr_primed ? nr_power[i] + smoothing * (p - nr_power[i]) : p;
+            nr_power[i] = ps;
+            nr_min_current[i] = fminf(nr_min_current[i], ps);
+            
+            float g = 1.0f;
+            if(estimating) {
+                const float noise = NR_NOISE_BIAS * fminf(nr_min_window[i], nr_min_current[i]);
+                g = ps > noise ? fmaxf(1.0f - noise / ps, nr_gain_floor) : nr_gain_floor;
+            }
+            nr_gain[i] = g;
+            power += p * g * g;
+        }
+        band_power[b] = power;
+    }
+    nr_primed = true;
+    
+    // Subventana completa: pasa a la historia y se renueva el mínimo de la ventana
+    if(++nr_frame_count >= nr_subwindow_frames) {
+        memcpy(nr_min_history[nr_history_pos], nr_min_current, sizeof(nr_min_current));
+        nr_history_pos = (nr_history_pos + 1) % NR_SUBWINDOWS;
+        if(nr_history_filled < NR_SUBWINDOWS) nr_history_filled++;
+        for(int i = 0; i < NR_BINS; i++) {
+            float m = FLT_MAX;
+            for(int w = 0; w < nr_history_filled; w++) {
+                m = fminf(m, nr_min_history[w][i]);
+            }
+            nr_min_window[i] = m;
+            nr_min_current[i] = FLT_MAX;
+        }
+        nr_frame_count = 0;
+    }
+}
+
+template <int Bands, int FFTSize, int SampleRate>
+void MultibandWDRCT<Bands, FFTSize, SampleRate>::resetNoiseEstimate() {
+    for(int i = 0; i < NR_BINS; i++) {
+        nr_power[i] = 0.0f;
+        nr_min_current[i] = FLT_MAX;
+        nr_min_window[i] = FLT_MAX;
+        nr_gain[i] = 1.0f;
+    }
+    nr_frame_count = 0;
+    nr_history_pos = 0;
+    nr_history_filled = 0;
+    nr_primed = false;
+}
+
+template <int Bands, int FFTSize, int SampleRate>
+void MultibandWDRCT<Bands, FFTSize, SampleRate>::setNoiseReduction(bool enabled) {
+    if(enabled && !nr_enabled) resetNoiseEstimate();
+    nr_enabled = enabled;
+}
+
+template <int Bands, int FFTSize, int SampleRate>
+float MultibandWDRCT<Bands, FFTSize, SampleRate>::noiseFloorDb() const {
+    if(nr_history_filled == 0) return -INFINITY;
+    float total = 0.0f;
+    for(int i = 0; i < NR_BINS; i++) {
+        total += NR_NOISE_BIAS * fminf(nr_min_window[i], nr_min_current[i]);
+    }
+    return 10.0f * log10f(fmaxf(total * power_norm, 1e-12f));
+}
+#endif
+
+template <int Bands, int FFTSize, int SampleRate>
+void MultibandWDRCT<Bands, FFTSize, SampleRate>::reset() {
+    for(int b = 0; b < Bands; b++) {
+        wdrc_bands[b].reset();
+    }
+#if NOISE_REDUCTION
+    resetNoiseEstimate();
+#endif
+#if STFT_OVERLAP > 1
+    for(int i = 0; i < FFTSize; i++) {
+        in_ring[i] = 0.0f;
+        ola_ring[i] = 0.0f;
+    }
+    ring_pos = 0;
+#endif
 }
 
 // Procesamiento principal
-void MultibandWDRC::process(float* input, float* output, int size) {
+template <int Bands, int FFTSize, int SampleRate>
+void MultibandWDRCT<Bands, FFTSize, SampleRate>::process(float* input, float* output, int size) {
+#if STFT_OVERLAP > 1
+    // Modo WOLA: una trama por cada hop de entrada
+    for(int offset = 0; offset + HOP_SIZE <= size; offset += HOP_SIZE) {
+        processHop(input + offset, output + offset);
+    }
+#else
     /*
      * Pipeline de Procesamiento:
      * =======================
@@ -129,47 +344,102 @@ void MultibandWDRC::process(float* input, float* output, int size) {
      * 5. Normalización
      */
 
-    // 1. Preparación: copiar entrada y aplicar padding
-    for(int i = 0; i < FFT_SIZE; i++) {
-        real[i] = i < size ? (double)input[i] : 0.0;
-        imag[i] = 0.0;
+    // 1. Preparación: copiar entrada con ventana y aplicar padding
+    uint32_t t = profiler_cycles();
+    dsp_multiply(input, window, frame, size);
+    for(int i = size; i < FFTSize; i++) {
+        frame[i] = 0.0f;
     }
+    t = profiler_lap(PROF_WINDOW, t);
     
-    // 2. Análisis: ventana y FFT
-    FFT->windowing(FFT_WIN_TYP_HAMMING, FFT_FORWARD);
-    FFT->compute(FFT_FORWARD);
+    // 2. Análisis: FFT real (espectro empaquetado, ver fft_backend.h)
+    fft.forward(frame);
+    t = profiler_lap(PROF_FFT, t);
     
     // 3. Procesamiento por bandas
-    for(int i = 0; i < FFT_SIZE/2; i++) {
-        // Calcular frecuencia del bin actual
-        double frequency = (double)i * SAMPLE_RATE / FFT_SIZE;
-        int band = getBandIndex(frequency);
-        
-        if(band >= 0) {  // Si la frecuencia pertenece a alguna banda
-            // Obtener magnitud y fase
-            double mag = sqrt(real[i] * real[i] + imag[i] * imag[i]);
-            double phase = atan2(imag[i], real[i]);
-            
-            // Aplicar WDRC de la banda correspondiente
-            mag = (double)wdrc_bands[band].process((float)mag);
-            
-            // Reconstruir componente frecuencial
-            real[i] = mag * cos(phase);
-            imag[i] = mag * sin(phase);
-            
-            // Mantener simetría conjugada para IFFT
-            if(i != 0) {
-                real[FFT_SIZE - i] = real[i];
-                imag[FFT_SIZE - i] = -imag[i];
-            }
-        }
+    processSpectrum();
+    t = profiler_lap(PROF_BANDS, t);
+    
+    // 4. Síntesis: IFFT (incluye la normalización 1/N)
+    fft.inverse(frame);
+    t = profiler_lap(PROF_IFFT, t);
+    
+    // 5. Copia a salida
+    memcpy(output, frame, size * sizeof(float));
+    profiler_lap(PROF_OVERLAP_ADD, t);
+#endif
+}
+
+#if STFT_OVERLAP > 1
+// Procesamiento STFT de un hop (weighted overlap-add)
+template <int Bands, int FFTSize, int SampleRate>
+void MultibandWDRCT<Bands, FFTSize, SampleRate>::processHop(const float* input, float* output) {
+    /*
+     * Streaming WOLA con anillos de FFTSize muestras:
+     * ==============================================
+     *
+     *  entrada ──▶ in_ring ──▶ ·w ──▶ FFT ──▶ bandas ──▶ IFFT ──▶ ·w ──┐
+     *                                                                  │
+     *  salida ◀── hop finalizado ◀── ola_ring (Σ tramas solapadas) ◀──┘
+     *
+     *  ring_pos: muestra más antigua de la trama en ambos anillos
+     *
+     *        │◀────────── FFTSize ───────────▶│
+     *  in:   [ oldest .............. newest   ]  ← hop nuevo al final
+     *  ola:  [ hop listo │ acumulación parcial ]
+     *
+     * Latencia algorítmica: FFTSize - HOP_SIZE muestras.
+     */
+    const int mask = FFTSize - 1;
+    uint32_t t = profiler_cycles();
+    
+    // 1. Las muestras nuevas sustituyen al hop más antiguo
+    for(int i = 0; i < HOP_SIZE; i++) {
+        in_ring[(ring_pos + i) & mask] = input[i];
+    }
+    ring_pos = (ring_pos + HOP_SIZE) & mask;
+    
+    // 2. Trama de análisis (más antigua → más nueva) con ventana,
+    //    en dos tramos contiguos del anillo
+    const int head = FFTSize - ring_pos;
+    dsp_multiply(in_ring + ring_pos, window, frame, head);
+    if(ring_pos > 0) {
+        dsp_multiply(in_ring, window + head, frame + head, ring_pos);
     }
+    t = profiler_lap(PROF_WINDOW, t);
     
-    // 4. Síntesis: IFFT
-    FFT->compute(FFT_REVERSE);
+    // 3. FFT → bandas → IFFT
+    fft.forward(frame);
+    t = profiler_lap(PROF_FFT, t);
+    processSpectrum();
+    t = profiler_lap(PROF_BANDS, t);
+    fft.inverse(frame);
+    t = profiler_lap(PROF_IFFT, t);
     
-    // 5. Normalización y copia a salida
-    for(int i = 0; i < size; i++) {
-        output[i] = (float)(real[i] / FFT_SIZE);
+    // 4. Ventana de síntesis y overlap-add
+    for(int i = 0; i < FFTSize; i++) {
+        ola_ring[(ring_pos + i) & mask] += frame[i] * window[i] * ola_scale;
     }
-}
\ No newline at end of file
+    
+    // 5. El primer hop ya recibió todas sus contribuciones
+    for(int i = 0; i < HOP_SIZE; i++) {
+        int idx = (ring_pos + i) & mask;
+        output[i] = ola_ring[idx];
+        ola_ring[idx] = 0.0f;
+    }
+    profiler_lap(PROF_OVERLAP_ADD, t);
+}
+#endif
+
+// Instancia de config.h; añadir aquí otras combinaciones <bandas, FFT, fs>.
+// GCC ignora la sección (AUDIO_IRAM) en la definición de una plantilla:
+// el proceso por bloque se instancia antes, miembro a miembro, con ella
+template void AUDIO_IRAM MultibandWDRC::process(float* input, float* output, int size);
+template void AUDIO_IRAM MultibandWDRC::processSpectrum();
+#if NOISE_REDUCTION
+template void AUDIO_IRAM MultibandWDRC::noiseReductionPass();
+#endif
+#if STFT_OVERLAP > 1
+template void AUDIO_IRAM MultibandWDRC::processHop(const float* input, float* output);
+#endif
+template class MultibandWDRCT<NUM_BANDS, FFT_SIZE, SAMPLE_RATE>;
@@ -1,23 +1,123 @@
 #ifndef MULTIBAND_WDRC_H
 #define MULTIBAND_WDRC_H
 
-#include <arduinoFFT.h>
+#include "fft_backend.h"
 #include "wdrc.h"
+#include "dsp_kernels.h"
 #include "config.h"
 
-class MultibandWDRC {
+// Rango contiguo de bins [first, end) de cada banda; end == first si vacía
+template <int Bands>
+struct BandBins {
+    int first[Bands];
+    int end[Bands];
+};
+
+// Mapa bin → banda resuelto en compilación a partir de BandLayout<Bands>.
+// El bin 0 (DC + Nyquist empaquetados) no pertenece a ninguna banda
+template <int Bands, int FFTSize, int SampleRate>
+constexpr BandBins<Bands> make_band_bins() {
+    BandBins<Bands> bins = {};
+    for (int k = 1; k < FFTSize/2; k++) {
+        const double frequency = (double)k * SampleRate / FFTSize;
+        for (int b = 0; b < Bands; b++) {
+            if (frequency >= BandLayout<Bands>::limits[b] &&
+                frequency < BandLayout<Bands>::limits[b + 1]) {
+                if (bins.end[b] == 0) bins.first[b] = k;
+                bins.end[b] = k + 1;
+                break;
+            }
+        }
+    }
+    return bins;
+}
+
+template <int Bands>
+constexpr bool band_bins_valid(const BandBins<Bands>& bins) {
+    for (int b = 0; b < Bands; b++) {
+        if (bins.end[b] <= bins.first[b]) return false;
+    }
+    return true;
+}
+
+/*
+ * Procesador multibanda especializado en compilación: el número de bandas,
+ * el tamaño de FFT y la frecuencia de muestreo fijan el tamaño de todos
+ * los buffers y los rangos de bins, así que los bucles de processSpectrum()
+ * tienen límites constantes. MultibandWDRC es la instancia de config.h;
+ * otras combinaciones se instancian al final de multiband_wdrc.cpp.
+ */
+template <int Bands, int FFTSize, int SampleRate>
+class MultibandWDRCT {
+    static_assert(FFTSize == FFT_SIZE, "FFTBackend solo implementa FFT_SIZE puntos");
+
+public:
+    static constexpr int HOP_SIZE = FFTSize / STFT_OVERLAP;
+    static constexpr BandBins<Bands> BINS = make_band_bins<Bands, FFTSize, SampleRate>();
+    static_assert(band_bins_valid<Bands>(BINS), "Alguna banda no contiene ningún bin de la FFT");
+
 private:
-    ArduinoFFT<double>* FFT;
-    WDRC wdrc_bands[NUM_BANDS];
-    double real[FFT_SIZE];
-    double imag[FFT_SIZE];
-    
-    int getBandIndex(double frequency);
+    FFTBackend fft;
+    WDRC wdrc_bands[Bands];
+    float frame[FFTSize] __attribute__((aligned(16)));  // Espectro empaquetado
+    float window[FFTSize];         // Ventana de análisis (y síntesis en WOLA)
+    float band_power[Bands];       // Energía acumulada por banda en la trama
+    float band_gain[Bands];        // Ganancia lineal calculada por banda
+    float power_norm;              // Σ|X|² → potencia media temporal
+
+#if NOISE_REDUCTION
+    // Bins de las bandas (contiguos: cada banda empieza donde acaba la anterior)
+    static constexpr int NR_FIRST = BINS.first[0];
+    static constexpr int NR_BINS = BINS.end[Bands - 1] - BINS.first[0];
+
+    float nr_power[NR_BINS];       // |X|² suavizado por bin
+    float nr_min_current[NR_BINS]; // Mínimo de la subventana en curso
+    float nr_min_window[NR_BINS];  // Mínimo de las NR_SUBWINDOWS subventanas completas
+    float nr_min_history[NR_SUBWINDOWS][NR_BINS];
+    float nr_gain[NR_BINS];        // Ganancia de Wiener de la trama actual
+    float nr_alpha;                // Suavizado a la frecuencia de tramas
+    float nr_gain_floor;
+    int nr_subwindow_frames;
+    int nr_frame_count;            // Tramas de la subventana en curso
+    int nr_history_pos;
+    int nr_history_filled;         // 0 = calentando: ganancia 1
+    bool nr_enabled;
+    bool nr_primed;                // nr_power ya parte de una trama real
+
+    void resetNoiseEstimate();
+    void noiseReductionPass();
+#endif
+
+#if STFT_OVERLAP > 1
+    float in_ring[FFTSize];        // Últimas FFTSize muestras de entrada
+    float ola_ring[FFTSize];       // Acumulador overlap-add
+    int ring_pos;                  // Muestra más antigua de ambos anillos
+    float ola_scale;               // Compensa Σ w²[n - m·hop]
+
+    void processHop(const float* input, float* output);
+#endif
+
+    void processSpectrum();
 
 public:
-    MultibandWDRC();
-    ~MultibandWDRC();
+    MultibandWDRCT();
+    // En modo WOLA size debe ser múltiplo de HOP_SIZE
     void process(float* input, float* output, int size);
+    // Anillos WOLA, WDRC y estimación de ruido a cero (parámetros intactos)
+    void reset();
+    // Muestras que la salida va retrasada respecto a la entrada
+    static constexpr int latencySamples() { return STFT_OVERLAP > 1 ? FFTSize - HOP_SIZE : 0; }
+    const char* fftBackendName() { return fft.name(); }
+#if NOISE_REDUCTION
+    // Al activarla la estimación de ruido empieza de cero (NR_WINDOW_MS / NR_SUBWINDOWS sin efecto)
+    void setNoiseReduction(bool enabled);
+    bool noiseReduction() const { return nr_enabled; }
+    // Ruido estimado en el rango de las bandas (dBFS, potencia media como band_power)
+    float noiseFloorDb() const;
+#endif
+    static constexpr int bands() { return Bands; }
 };
 
-#endif
\ No newline at end of file
+using MultibandWDRC = MultibandWDRCT<NUM_BANDS, FFT_SIZE, SAMPLE_RATE>;
+
+#endif
@@ -1,4 +1,6 @@
 #include "wdrc.h"
+#include "fast_math.h"
+#include "dsp_kernels.h"     // AUDIO_IRAM
 
 /*
  * WIDE DYNAMIC RANGE COMPRESSION (WDRC)
@@ -52,15 +54,20 @@
  */
 
 // Constructor: inicializa el detector de envolvente
-WDRC::WDRC() : envelope(0.0f) {
+WDRC::WDRC() : alpha_attack(0.0f), alpha_release(0.0f), envelope(0.0f),
+               fast_math(WDRC_FAST_MATH),
+               control_interval(WDRC_CONTROL_INTERVAL), control_count(WDRC_CONTROL_INTERVAL),
+               alpha_attack_ctrl(0.0f), alpha_release_ctrl(0.0f),
+               block_energy(0.0f), current_gain(0.0f), gain_step(0.0f) {
     /* 
      * El envelope se inicia en 0 para partir del silencio
-     * y evitar artefactos al inicio del procesamiento
+     * y evitar artefactos al inicio del procesamiento.
+     * En processBlock() la ganancia también parte de 0 (fade-in).
      */
 }
 
 // Configuración de parámetros para cada banda
-void WDRC::setParameters(const BandParams& params) {
+void WDRC::setParameters(const BandParams& params, float update_rate) {
     /*
      * Parámetros de compresión:
      * ------------------------
@@ -77,7 +84,8 @@ void WDRC::setParameters(const BandParams& params) {
      *
      * Donde:
      * τ = tiempo de ataque/liberación (s)
-     * fs = frecuencia de muestreo (Hz)
+     * fs = frecuencia de actualización de la envolvente (Hz):
+     *      SAMPLE_RATE por muestra, o SAMPLE_RATE/hop por trama FFT
      */
     
     threshold = params.threshold;
@@ -86,12 +94,19 @@ void WDRC::setParameters(const BandParams& params) {
     band_gain = params.gain;
     
     // Cálculo de coeficientes temporales
-    alpha_attack = exp(-1.0f / (SAMPLE_RATE * params.attack_time));
-    alpha_release = exp(-1.0f / (SAMPLE_RATE * params.release_time));
+    alpha_attack = exp(-1.0f / (update_rate * params.attack_time));
+    alpha_release = exp(-1.0f / (update_rate * params.release_time));
+    update_control_alphas();
+}
+
+// Coeficientes equivalentes a tasa de control: α_ctrl = α^N
+void WDRC::update_control_alphas() {
+    alpha_attack_ctrl = pow(alpha_attack, (float)control_interval);
+    alpha_release_ctrl = pow(alpha_release, (float)control_interval);
 }
 
 // Conversión de decibelios a escala lineal
-float WDRC::db_to_linear(float db) {
+float AUDIO_IRAM WDRC::db_to_linear(float db) {
     /*
      * Conversión dB a lineal:
      * ----------------------
@@ -105,11 +120,12 @@ float WDRC::db_to_linear(float db) {
      *  -6  |   0.5
      *  -20 |   0.1
      */
+    if (fast_math) return fast_db_to_linear(db);
     return pow(10.0f, db / 20.0f);
 }
 
 // Conversión de escala lineal a decibelios
-float WDRC::linear_to_db(float linear) {
+float AUDIO_IRAM WDRC::linear_to_db(float linear) {
     /*
      * Conversión lineal a dB:
      * ----------------------
@@ -119,21 +135,13 @@ float WDRC::linear_to_db(float linear) {
      *
      * Se añade un pequeño offset (1e-9) para evitar log(0)
      */
+    if (fast_math) return fast_linear_to_db(linear);
     return 20.0f * log10(fabs(linear) + 1e-9f);
 }
 
-// Procesamiento de una muestra
-float WDRC::process(float input) {
+// Actualización del detector de envolvente (dominio dB)
+void AUDIO_IRAM WDRC::update_envelope(float level_db, float attack, float release) {
     /*
-     * Proceso de compresión WDRC:
-     * =========================
-     *
-     * 1. Conversión a dB
-     * 2. Detección de envolvente
-     * 3. Cálculo de ganancia
-     * 4. Aplicación de ganancia
-     * 5. Limitación de salida
-     *
      * Diagrama de estados del detector de envolvente:
      * -------------------------------------------
      *
@@ -145,23 +153,17 @@ float WDRC::process(float input) {
      *      └────────────────┘
      *           input < env
      */
-
-    // 1. Convertir entrada a dB
-    float input_db = linear_to_db(input);
-    
-    // 2. Actualizar detector de envolvente
-    if (input_db > envelope) {
+    if (level_db > envelope) {
         // Fase de ataque (nivel aumentando)
-        envelope = alpha_attack * envelope + (1.0f - alpha_attack) * input_db;
+        envelope = attack * envelope + (1.0f - attack) * level_db;
     } else {
         // Fase de liberación (nivel disminuyendo)
-        envelope = alpha_release * envelope + (1.0f - alpha_release) * input_db;
+        envelope = release * envelope + (1.0f - release) * level_db;
     }
-    
-    // 3. Calcular ganancia de compresión
-    float gain_db = 0.0f;
-    float diff = envelope - threshold;
-    
+}
+
+// Cálculo de la reducción de ganancia a partir de la envolvente actual
+float AUDIO_IRAM WDRC::compute_gain_db() {
     /*
      * Zonas de compresión:
      * ------------------
@@ -178,7 +180,9 @@ float WDRC::process(float input) {
      *           t-w  t   t+w    t = threshold
      *                           w = knee_width
      */
-    
+    float gain_db = 0.0f;
+    float diff = envelope - threshold;
+
     if (fabs(diff) <= knee_width/2) {
         // Región de la rodilla (transición suave)
         float knee_factor = diff + knee_width/2;
@@ -187,13 +191,133 @@ float WDRC::process(float input) {
         // Región de compresión completa
         gain_db = (ratio - 1) * diff;
     }
+
+    return gain_db;
+}
+
+// Procesamiento de una muestra
+float AUDIO_IRAM WDRC::process(float input) {
+    /*
+     * Proceso de compresión WDRC:
+     * =========================
+     *
+     * 1. Conversión a dB
+     * 2. Detección de envolvente
+     * 3. Cálculo de ganancia
+     * 4. Aplicación de ganancia
+     *
+     * Sin recorte: la salida la acota el limitador con anticipación
+     * (limiter.h) tras el motor multibanda
+     */
+
+    // 1. Convertir entrada a dB
+    float input_db = linear_to_db(input);
     
-    // 4. Aplicar ganancia de compresión y ganancia de banda
-    float output = input * db_to_linear(-gain_db + band_gain);
+    // 2. Actualizar detector de envolvente
+    update_envelope(input_db, alpha_attack, alpha_release);
     
-    // 5. Limitar salida para evitar distorsión
-    if (output > 0.99f) output = 0.99f;
-    if (output < -0.99f) output = -0.99f;
+    // 3. Calcular ganancia de compresión
+    float gain_db = compute_gain_db();
     
-    return output;
-}
\ No newline at end of file
+    // 4. Aplicar ganancia de compresión y ganancia de banda
+    return input * db_to_linear(-gain_db + band_gain);
+}
+
+// Procesamiento a nivel de banda (una vez por trama FFT)
+float AUDIO_IRAM WDRC::processBandPower(float power) {
+    /*
+     * En el procesador multibanda la envolvente sigue la energía total
+     * de la banda, no cada bin por separado:
+     *
+     *   P_banda = Σ|X[k]|² (normalizada a potencia media temporal)
+     *   nivel   = 10·log10(P_banda)          → 1 log10 por banda
+     *   ganancia = 10^((band_gain - G)/20)   → 1 pow por banda
+     *
+     * Requiere setParameters() con la frecuencia de tramas como
+     * update_rate para que attack/release conserven su escala temporal.
+     * La ganancia devuelta se aplica multiplicando todos los bins de la
+     * banda (la fase no cambia).
+     */
+    float level_db = fast_math ? fast_power_to_db(power)
+                               : 10.0f * log10(power + 1e-18f);
+    update_envelope(level_db, alpha_attack, alpha_release);
+    return db_to_linear(-compute_gain_db() + band_gain);
+}
+
+// Intervalo de control para processBlock()
+void WDRC::setControlInterval(int samples) {
+    control_interval = samples < 1 ? 1 : samples;
+    control_count = control_interval;
+    block_energy = 0.0f;
+    gain_step = 0.0f;       // La rampa era para el intervalo anterior: mantener hasta evaluar
+    update_control_alphas();
+}
+
+// Estado del constructor: el bloque siguiente vuelve a entrar con fade-in
+void WDRC::reset() {
+    envelope = 0.0f;
+    control_count = control_interval;
+    block_energy = 0.0f;
+    current_gain = 0.0f;
+    gain_step = 0.0f;
+}
+
+// Procesamiento por bloques a tasa de control
+void AUDIO_IRAM WDRC::processBlock(const float* in, float* out, int n) {
+    /*
+     * Ganancia a tasa de control:
+     * =========================
+     *
+     *  x² ──▶ Σ por sub-bloque (por muestra, 1 MAC)
+     *                │
+     *                ▼  cada control_interval muestras
+     *   RMS dB ──▶ envolvente attack/release (α^N) ──▶ knee/ratio
+     *                                                     │
+     *                                            lineal = G_objetivo
+     *  Ganancia   G_prev ─────╲                           │
+     *     ↑                    ╲─────── G_objetivo ◀──────┘
+     *     └──────┴──────────────┴─────→ muestras
+     *            │◀── interval ──▶│
+     *
+     * Pasa de 2 funciones trascendentes por muestra a 2 por sub-bloque.
+     * Con α^N la envolvente conserva las constantes de tiempo en dB
+     * de process(); la ganancia llega a su objetivo al final de cada
+     * sub-bloque, con un sub-bloque de retardo en el detector.
+     */
+    if (control_interval <= 1) {
+        for (int i = 0; i < n; i++) {
+            out[i] = process(in[i]);
+        }
+        return;
+    }
+
+    int i = 0;
+    while (i < n) {
+        int m = n - i < control_count ? n - i : control_count;
+        float energy = block_energy;
+        float g = current_gain;
+        const float step = gain_step;
+        for (int j = i; j < i + m; j++) {
+            float x = in[j];
+            energy += x * x;
+            g += step;
+            out[j] = x * g;
+        }
+        block_energy = energy;
+        current_gain = g;
+        control_count -= m;
+        i += m;
+
+        if (control_count == 0) {
+            // Evaluar detector RMS y curva de ganancia del sub-bloque completo
+            float power = block_energy / control_interval;
+            float level_db = fast_math ? fast_power_to_db(power)
+                                       : 10.0f * log10(power + 1e-18f);
+            update_envelope(level_db, alpha_attack_ctrl, alpha_release_ctrl);
+            float target = db_to_linear(-compute_gain_db() + band_gain);
+            gain_step = (target - current_gain) / control_interval;
+            block_energy = 0.0f;
+            control_count = control_interval;
+        }
+    }
+}
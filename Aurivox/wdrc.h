@@ -13,15 +13,42 @@ private:
     float ratio;
     float knee_width;
     float band_gain;
+    bool fast_math;     // true: conversiones de fast_math.h
+    
+    // Modo de control (processBlock)
+    int control_interval;   // Muestras por sub-bloque de ganancia
+    int control_count;      // Muestras restantes del sub-bloque actual
+    float alpha_attack_ctrl;   // alpha^control_interval
+    float alpha_release_ctrl;
+    float block_energy;     // Σx² del sub-bloque actual (detector RMS)
+    float current_gain;     // Ganancia lineal interpolada
+    float gain_step;        // Incremento por muestra hacia la ganancia objetivo
 
     // Solo declaramos las funciones, sin implementarlas aquí
     float db_to_linear(float db);
     float linear_to_db(float linear);
+    void update_envelope(float level_db, float attack, float release);
+    void update_control_alphas();
+    float compute_gain_db();
 
 public:
     WDRC();
-    void setParameters(const BandParams& params);
+    // update_rate: frecuencia (Hz) a la que se actualiza la envolvente.
+    // SAMPLE_RATE para process(), frecuencia de tramas para processBandPower()
+    void setParameters(const BandParams& params, float update_rate = SAMPLE_RATE);
     float process(float input);
+    // Conversiones dB/lineal aproximadas (opt-in, error < 0.01 dB)
+    void setFastMath(bool enabled) { fast_math = enabled; }
+    
+    // Bloque: envolvente y curva de ganancia una vez por sub-bloque de
+    // control_interval muestras (RMS del sub-bloque, un sub-bloque de
+    // retardo) e interpolación lineal de la ganancia entre evaluaciones
+    void setControlInterval(int samples);
+    // Vuelve al estado inicial (envolvente y ganancia a 0) sin tocar parámetros
+    void reset();
+    void processBlock(const float* in, float* out, int n);
+    // Una actualización por trama: potencia media de la banda -> ganancia lineal
+    float processBandPower(float power);
 };
 
 #endif
\ No newline at end of file
@@ -3,32 +3,56 @@
 // Hardware: XIAO ESP32S3, micrófono ICS-43434, DAC MAX98357A
 // Arquitectura: Dual-core especializado + módulos separados
 
-#include "driver/i2s.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include <atomic>
 #include "esp_wifi.h"
 #include "esp_bt.h"
+#include "audio_config.h"
+#include "dsp_pipeline.h"
+#include "dsp_kernels.h"
+#include "dsp_fixed.h"
+#include "cycle_profiler.h"
+#include "latency_test.h"
+#include "freq_response.h"
+#include "feedback_canceller.h"
+#include "telemetry.h"
+#include "cros_link.h"
+#include "memory_plan.h"
+#include "power_governor.h"
 
 // ==================== CONFIGURACIONES GLOBALES ====================
 
-// Audio settings
-#define SAMPLE_RATE     16000
-#define BUFFER_SIZE     128
-#define I2S_PORT_MIC    I2S_NUM_0
-#define I2S_PORT_DAC    I2S_NUM_1
+// Audio settings: SAMPLE_RATE, BUFFER_SIZE, I2S_PORT_* y AUDIO_I2S_DRIVER en audio_config.h
 
-// Buffers de audio
-int32_t mic_buffer[BUFFER_SIZE];
-int16_t dac_buffer[BUFFER_SIZE];
+#define AUDIO_PARK_TIMEOUT_MS   100   // > 1 bloque de MAX_BUFFER_SIZE a 16 kHz (32 ms)
+
+// Buffers de audio (dimensionados para el mayor bloque; se usan BUFFER_SIZE muestras)
+// Estáticos en DRAM interna y alineados: ver memory_plan.h
+int32_t mic_buffer[MAX_BUFFER_SIZE] __attribute__((aligned(16)));
+int16_t dac_buffer[MAX_BUFFER_SIZE] __attribute__((aligned(16)));
+dsp_sample_t dsp_buffer[MAX_BUFFER_SIZE] __attribute__((aligned(16)));   // float o Q4.27
+#if DSP_FIXED_POINT
+float afc_buffer[MAX_BUFFER_SIZE] __attribute__((aligned(16)));          // El AFC trabaja en float
+#endif
 
 // Estado del sistema
 volatile bool audio_processing_active = true;
 volatile bool system_sleeping = false;
 
-// Ganancia básica (será expandido por módulos)
+// Core 0 entre bloques y fuera de la E/S I2S (lo pone a true solo la tarea de audio)
+static std::atomic<bool> audio_task_parked(false);
+
+// Ganancia seleccionada (estado de UI en Core 1; el audio la recibe
+// publicada en el set de parámetros DSP, ver set_dsp_output_gain())
 volatile int current_gain_level = 2;
-const float gain_levels[5] = {0.0, 0.25, 0.50, 0.75, 1.0};
-volatile float gain_factor = 0.5;
+volatile float gain_factor = 0.5;   // gain_levels[] definido en audio_config.cpp
+
+// Nombres de las etapas del perfilador (orden de AudioProfileStage)
+static const char* const PROFILE_STAGE_NAMES[PROF_STAGE_COUNT] = {
+    "I2S lectura", "int32 → " DSP_SAMPLE_FORMAT, "AFC filtro", "HPF", "EQ", "WDRC", "limitador",
+    "ganancia", "pips", DSP_SAMPLE_FORMAT " → int16", "I2S escritura", "AFC adaptación", "DSP total"
+};
 
 // Handles para tareas dual-core
 TaskHandle_t audioTaskHandle = NULL;
@@ -38,73 +62,119 @@ TaskHandle_t controlTaskHandle = NULL;
 
 // audio_hardware.cpp
 extern void initialize_i2s_hardware();
+extern void deinitialize_i2s_hardware();
+extern bool is_i2s_hardware_ready();
 extern void start_audio_streams();
 extern void stop_audio_streams();
+extern void reset_audio_stream_stats();
+extern size_t audio_read_block(int32_t* buffer, size_t bytes);
+extern size_t audio_write_block(const int16_t* buffer, size_t bytes);
+extern void account_audio_block_done();
+extern float get_audio_loop_latency_ms();
 
 // button_control.cpp
 extern void initialize_buttons();
 extern void handle_button_events();
-extern bool process_pip_audio(int16_t* buffer, int num_samples);
+extern void mix_pip_audio(dsp_sample_t* block, int num_samples);
+extern void update_pip_timing();
 
 // serial_commands.cpp
 extern void initialize_serial_interface();
 extern void handle_serial_commands();
+extern bool load_boot_config(AudioConfig* config);
 
 // ==================== TAREA CORE 0: PROCESAMIENTO DE AUDIO ====================
 
-void audioTask(void* parameter) {
+void AUDIO_IRAM audioTask(void* parameter) {
     Serial.println("🎵 Core 0: Tarea de audio iniciada");
 
-    // Variables locales para la tarea de audio
-    size_t bytes_read = 0;
-    size_t bytes_written = 0;
-
     while (true) {
         // Solo procesar si el sistema está activo
         if (!audio_processing_active || system_sleeping) {
+            audio_task_parked.store(true, std::memory_order_release);
             vTaskDelay(pdMS_TO_TICKS(10));
             continue;
         }
+        audio_task_parked.store(false, std::memory_order_relaxed);
 
-        // Leer del micrófono
-        esp_err_t read_result = i2s_read(I2S_PORT_MIC, mic_buffer, sizeof(mic_buffer), &bytes_read, pdMS_TO_TICKS(10));
-        if (read_result != ESP_OK) {
-            continue;
+        // Leer del micrófono (con i2s_std, la tarea duerme hasta la ISR del DMA)
+        uint32_t t = profiler_cycles();
+        size_t bytes_read = audio_read_block(mic_buffer, BUFFER_SIZE * sizeof(int32_t));
+        if (bytes_read == 0) {
+            continue;   // Contado como timeout (ver 'i2s_stats')
         }
+        t = profiler_lap(PROF_I2S_READ, t);
+        const uint32_t dsp_start = t;
 
         int num_samples = bytes_read / sizeof(int32_t);
 
-        // Procesar cada muestra
-        for (int i = 0; i < num_samples; i++) {
-            int16_t sample_16;
-
-            // Verificar si hay pips activos (del sistema de botones)
-            if (process_pip_audio(&sample_16, 1)) {
-                // Usar muestra del pip
-                dac_buffer[i] = sample_16;
-            } else {
-                // Procesar audio normal del micrófono
-                sample_16 = mic_buffer[i] >> 16;  // Convertir 32-bit a 16-bit
-
-                // ==================== PIPELINE DSP (A IMPLEMENTAR) ====================
-                // TODO: 1. Filtro Pasa-Altos (ESP-DSP)
-                // TODO: 2. Ecualizador 6 Bandas (ESP-DSP)
-                // TODO: 3. WDRC (Wide Dynamic Range Compression)
-                // TODO: 4. Limitador Anti-Clipping
-
-                // Por ahora: solo ganancia básica
-                float sample_float = (float)sample_16 * gain_factor;
-
-                // Limitación básica para evitar clipping
-                if (sample_float > 32767.0) sample_float = 32767.0;
-                if (sample_float < -32768.0) sample_float = -32768.0;
-
-                dac_buffer[i] = (int16_t)sample_float;
-            }
+        // CROS emisor: copia del micrófono hacia la tarea de radio (Core 1)
+        cros_link_capture(mic_buffer, num_samples);
+
+        // ==================== PIPELINE DSP POR BLOQUES ====================
+        // AFC → CROS → HPF → EQ 6 bandas → WDRC → Limitador → Ganancia (ver dsp_pipeline.cpp)
+        const bool afc_active = afc_begin_block();
+#if DSP_FIXED_POINT
+        if (afc_active) {
+            dsp_int32_to_float(mic_buffer, afc_buffer, num_samples, 31);
+            t = profiler_lap(PROF_TO_FLOAT, t);
+            afc_cancel(afc_buffer, num_samples);
+            dsp_q_from_float(afc_buffer, dsp_buffer, num_samples);
+            profiler_lap(PROF_AFC_FILTER, t);
+        } else {
+            dsp_q_from_mic(mic_buffer, dsp_buffer, num_samples);
+            profiler_lap(PROF_TO_FLOAT, t);
+        }
+#else
+        dsp_int32_to_float(mic_buffer, dsp_buffer, num_samples, 31);
+        t = profiler_lap(PROF_TO_FLOAT, t);
+        if (afc_active) {
+            afc_cancel(dsp_buffer, num_samples);
+            profiler_lap(PROF_AFC_FILTER, t);
         }
+#endif
+        // CROS/BiCROS receptor: micrófono remoto en lugar del local o sumado a él
+        cros_link_mix(dsp_buffer, num_samples);
+        process_dsp_pipeline(dsp_buffer, num_samples);   // Mide sus etapas internamente
+
+        // Pips del sistema de botones mezclados sobre la salida procesada
+        t = profiler_cycles();
+        mix_pip_audio(dsp_buffer, num_samples);
+        t = profiler_lap(PROF_PIPS, t);
+        // Sin recorte propio: el limitador con anticipación ya deja el pipeline
+        // bajo su umbral; la saturación de la conversión es solo la red de los
+        // pips y de los presets con el limitador desactivado
+#if DSP_FIXED_POINT
+        dsp_q_to_int16(dsp_buffer, dac_buffer, num_samples, 1);
+#else
+        dsp_float_to_int16(dsp_buffer, dac_buffer, num_samples, 15, 1);
+#endif
+        t = profiler_lap(PROF_TO_INT16, t);
+        const uint32_t dsp_cycles = t - dsp_start;
+        profiler_record(PROF_DSP_TOTAL, dsp_cycles);
+
+        // Medida de latencia en curso: MLS en la salida, captura del micrófono
+        latency_test_block(mic_buffer, dac_buffer, num_samples);
+        // Respuesta en frecuencia / calibración: multitono en la salida, Goertzel del micrófono
+        freq_response_block(mic_buffer, dac_buffer, num_samples);
 
         // Enviar al DAC
-        i2s_write(I2S_PORT_DAC, dac_buffer, num_samples * sizeof(int16_t), &bytes_written, pdMS_TO_TICKS(10));
+        audio_write_block(dac_buffer, num_samples * sizeof(int16_t));
+        t = profiler_lap(PROF_I2S_WRITE, t);
+
+        // Referencia del AFC: el bloque tal como sale (también sin AFC, para alinear la línea)
+        afc_push_output(dac_buffer, num_samples);
+        if (afc_active) profiler_lap(PROF_AFC_ADAPT, t);
+        profiler_block_end();
+
+        // Medidas y toma de audio hacia Core 1 (anillo SPSC, sin esperas)
+        telemetry_audio_block(mic_buffer, dac_buffer, num_samples, dsp_cycles);
+
+        // Carga del bloque para el gobernador de reloj: todo menos las esperas de I2S
+        power_governor_block(dsp_cycles + (profiler_cycles() - t));
+
+        // Periodo entre bloques + eventos de underrun/overflow del driver
+        account_audio_block_done();
 
         // Yield para permitir otras tareas
         taskYIELD();
@@ -113,13 +183,26 @@ void audioTask(void* parameter) {
 
 // ==================== TAREA CORE 1: CONTROL Y COMUNICACIÓN ====================
 
+#if AUDIO_FAST_BOOT
+static void finish_fast_boot();
+#endif
+
 void controlTask(void* parameter) {
+#if AUDIO_FAST_BOOT
+    finish_fast_boot();
+#endif
     Serial.println("🎛️ Core 1: Tarea de control iniciada");
 
     while (true) {
         // Manejar comandos seriales
         handle_serial_commands();
 
+        // Tramas binarias pendientes de Core 0 (solo lo que cabe en el buffer USB)
+        telemetry_service();
+
+        // Reloj de la CPU según la carga medida en Core 0
+        power_governor_service();
+
         // Manejar eventos de botones
         handle_button_events();
 
@@ -128,12 +211,128 @@ void controlTask(void* parameter) {
     }
 }
 
-// ==================== SETUP ====================
+// ==================== CAMBIO DE FORMATO (CORE 1) ====================
+
+/*
+ * SAMPLE_RATE / BUFFER_SIZE en marcha (comando 'format'):
+ *
+ *   aparcar Core 0 ──▶ liberar I2S ──▶ set_audio_format() ──▶ crear I2S
+ *        ──▶ coeficientes DSP, pips y presupuesto ──▶ streams ──▶ reanudar
+ *
+ * Core 0 se aparca entre dos bloques, fuera de la E/S I2S, así que ningún
+ * bloque mezcla formatos y todo el recálculo (biquads, constantes de
+ * tiempo, pasos de fase) corre en este core. El audio se corta unos ms.
+ */
+
+// Ciclos de CPU que dura un bloque del formato activo
+static uint32_t block_budget_cycles() {
+    return (uint32_t)((uint64_t)getCpuFrequencyMhz() * 1000000ULL * BUFFER_SIZE / SAMPLE_RATE);
+}
 
-void setup() {
-    Serial.begin(115200);
-    delay(2000);
+// Detener Core 0 entre bloques (Core 1; también lo usa el sleep)
+bool park_audio_task() {
+    audio_task_parked.store(false, std::memory_order_relaxed);
+    audio_processing_active = false;
+    const uint32_t start = millis();
+    while (!audio_task_parked.load(std::memory_order_acquire)) {
+        if (millis() - start > AUDIO_PARK_TIMEOUT_MS) return false;
+        vTaskDelay(pdMS_TO_TICKS(1));
+    }
+    return true;
+}
+
+// Reanudar Core 0 sin esperar al final de su vTaskDelay de aparcado
+void resume_audio_task() {
+    audio_processing_active = true;
+    if (audioTaskHandle && audio_task_parked.load(std::memory_order_acquire)) {
+        xTaskAbortDelay(audioTaskHandle);
+    }
+}
 
+bool switch_audio_format(int sample_rate, int buffer_size) {
+    if (!is_supported_audio_format(sample_rate, buffer_size)) {
+        Serial.printf("❌ Formato no soportado: %d Hz / %d muestras\n", sample_rate, buffer_size);
+        return false;
+    }
+    if (system_sleeping) {
+        Serial.println("❌ Sistema en sleep: despertar antes de cambiar el formato");
+        return false;
+    }
+    if (!park_audio_task()) {
+        resume_audio_task();
+        Serial.println("❌ La tarea de audio no se detiene: formato sin cambios");
+        return false;
+    }
+
+    const uint32_t start = millis();
+    const int old_rate = SAMPLE_RATE;
+    const int old_size = BUFFER_SIZE;
+    deinitialize_i2s_hardware();
+    set_audio_format(sample_rate, buffer_size);
+    initialize_i2s_hardware();
+    if (!is_i2s_hardware_ready()) {
+        Serial.println("❌ I2S no acepta el formato: se restaura el anterior");
+        set_audio_format(old_rate, old_size);
+        initialize_i2s_hardware();
+    }
+
+    rebuild_dsp_pipeline();
+    afc_init(afc_delay_for_latency(get_audio_loop_latency_ms()));
+    cros_link_reset();
+    update_pip_timing();
+    power_governor_boost("formato");   // Bloque nuevo sin medir todavía
+    profiler_init(PROFILE_STAGE_NAMES, PROF_STAGE_COUNT, block_budget_cycles());
+    reset_audio_stream_stats();
+
+    start_audio_streams();
+    resume_audio_task();
+    if (telemetry_active()) telemetry_start(0);   // INFO y bloques por trama del formato nuevo
+
+    Serial.printf("🔄 Formato: %d Hz, bloque %d (%.1f ms) | cambio en %lu ms\n",
+                  SAMPLE_RATE, BUFFER_SIZE, samples_to_ms(BUFFER_SIZE),
+                  (unsigned long)(millis() - start));
+    return SAMPLE_RATE == sample_rate && BUFFER_SIZE == buffer_size;
+}
+
+// ==================== ARRANQUE ====================
+
+/*
+ * Con AUDIO_FAST_BOOT (audio_config.h) el primer sonido no espera a la UI:
+ *
+ *   setup()                                      ControlTask (Core 1)
+ *   Serial.begin ──▶ DSP (config RTC / firmware)
+ *     ──▶ I2S ──▶ AudioTask ──▶ streams ─ ─ ─ ─▶ banner ──▶ NVS + comandos
+ *                                  ▲                     ──▶ botones ──▶ informe
+ *                            primer sonido
+ *
+ * La configuración de NVS llega después y entra con el fundido normal de
+ * configure_dsp_pipeline(). Tras un reset por software la memoria RTC ya
+ * trae la última configuración aplicada y no hay cambio audible.
+ */
+
+enum BootPhase {
+    BOOT_STARTUP,       // Arranque de la app hasta setup()
+    BOOT_DSP,
+    BOOT_I2S,
+    BOOT_AUDIO,         // AudioTask + streams
+    BOOT_INTERFACE,     // NVS + comandos seriales
+    BOOT_BUTTONS,
+    BOOT_PHASE_COUNT
+};
+
+static const char* const BOOT_PHASE_NAMES[BOOT_PHASE_COUNT] = {
+    "app → setup()", "DSP", "I2S", "tarea de audio + streams", "NVS + comandos", "botones"
+};
+
+static uint32_t boot_phase_us[BOOT_PHASE_COUNT];
+static uint32_t boot_sound_us = 0;      // micros() con los streams ya arrancados
+static bool boot_config_from_rtc = false;
+
+static void boot_phase_end(BootPhase phase, uint32_t start_us) {
+    boot_phase_us[phase] = micros() - start_us;
+}
+
+static void print_boot_banner() {
     Serial.println("════════════════════════════════════════");
     Serial.println("🎧 AURIVOX v3.0 - INICIALIZANDO");
     Serial.println("════════════════════════════════════════");
@@ -141,55 +340,202 @@ void setup() {
     Serial.println("🎵 Core 0: Procesamiento de audio");
     Serial.println("🎛️ Core 1: Control y comunicación");
     Serial.println("════════════════════════════════════════");
+}
 
-    // DESHABILITAR WiFi y Bluetooth para máximo rendimiento
-    esp_wifi_stop();
-    esp_wifi_deinit();
-    esp_bt_controller_disable();
-    Serial.println("📡 WiFi/Bluetooth: DESHABILITADOS");
+static void print_boot_report() {
+    Serial.printf("\n⏱️ ARRANQUE %s (config inicial: %s)\n",
+                  AUDIO_FAST_BOOT ? "RÁPIDO" : "CLÁSICO",
+                  AUDIO_FAST_BOOT ? (boot_config_from_rtc ? "RTC" : "firmware") : "NVS");
+    for (int p = 0; p < BOOT_PHASE_COUNT; p++) {
+        Serial.printf("   %-26s %8.1f ms\n", BOOT_PHASE_NAMES[p], boot_phase_us[p] / 1000.0f);
+    }
+    Serial.printf("🔊 Primer audio a los %.1f ms del arranque de la app\n", boot_sound_us / 1000.0f);
+}
 
-    // Inicializar módulos de hardware
-    Serial.println("\n🔧 INICIALIZANDO HARDWARE:");
-    initialize_i2s_hardware();
-    initialize_buttons();
-    initialize_serial_interface();
+static void print_ready_summary() {
+    Serial.println("\n🎯 SISTEMA LISTO");
+    Serial.printf("💾 RAM libre: %d bytes\n", ESP.getFreeHeap());
+    Serial.printf("🔊 Ganancia inicial: %.0f%% (Nivel %d/5)\n",
+                  gain_factor * 100, current_gain_level + 1);
+    Serial.println("💬 Escribe 'help' para ver comandos disponibles");
+    Serial.println("════════════════════════════════════════");
+}
 
-    Serial.println("\n🚀 CONFIGURANDO DUAL-CORE:");
+#if AUDIO_FAST_BOOT
+// Publicar la configuración de arranque antes de que exista la tarea de audio
+static void apply_boot_config() {
+    AudioConfig config = DEFAULT_CONFIG;
+    boot_config_from_rtc = load_boot_config(&config);
+    current_gain_level = config.gain_level;
+    gain_factor = gain_levels[current_gain_level];
+    configure_dsp_pipeline(&config);
+}
+#endif
 
+static void create_audio_task() {
     // Crear tarea de audio en Core 0 (dedicado a DSP)
     xTaskCreatePinnedToCore(
         audioTask,           // Función de la tarea
         "AudioTask",         // Nombre de la tarea
-        4096,               // Tamaño del stack (4KB)
+        STACK_SIZE_AUDIO,    // Tamaño del stack (4KB)
     NULL,               // Parámetro de la tarea
-    2,                  // Prioridad (alta para audio)
+    PRIORITY_AUDIO_TASK, // Prioridad (alta para audio)
     &audioTaskHandle,   // Handle de la tarea
     0                   // Core 0 (dedicado a audio)
     );
+    memory_register_task(audioTaskHandle, "AudioTask", STACK_SIZE_AUDIO, true);
+}
 
+static void create_control_task() {
     // Crear tarea de control en Core 1 (para UI y comunicación)
     xTaskCreatePinnedToCore(
         controlTask,        // Función de la tarea
         "ControlTask",      // Nombre de la tarea
-        4096,              // Tamaño del stack (4KB)
+        STACK_SIZE_CONTROL, // Tamaño del stack (6KB con arranque rápido)
     NULL,              // Parámetro de la tarea
-    1,                 // Prioridad (menor que audio)
+    PRIORITY_CONTROL_TASK, // Prioridad (menor que audio)
     &controlTaskHandle, // Handle de la tarea
     1                  // Core 1 (para control)
     );
+    memory_register_task(controlTaskHandle, "ControlTask", STACK_SIZE_CONTROL, false);
+}
+
+// Buffers del bloque y funciones del camino de audio para el plan de memoria
+static void register_memory_plan() {
+    memory_register_task(NULL, "loopTask", getArduinoLoopTaskStackSize(), false);
+
+    memory_register_buffer("mic_buffer", mic_buffer, sizeof(mic_buffer));
+    memory_register_buffer("dac_buffer", dac_buffer, sizeof(dac_buffer));
+    memory_register_buffer("dsp_buffer", dsp_buffer, sizeof(dsp_buffer));
+#if DSP_FIXED_POINT
+    memory_register_buffer("afc_buffer", afc_buffer, sizeof(afc_buffer));
+#endif
+
+    memory_register_code("audioTask", (const void*)audioTask);
+    memory_register_code("audio_read_block", (const void*)audio_read_block);
+    memory_register_code("afc_cancel", (const void*)afc_cancel);
+    memory_register_code("cros_link_mix", (const void*)cros_link_mix);
+    memory_register_code("process_dsp_pipeline", (const void*)process_dsp_pipeline);
+#if DSP_FIXED_POINT
+    memory_register_code("dsp_q_biquad_cascade", (const void*)dsp_q_biquad_cascade);
+#else
+    memory_register_code("dsp_biquad_cascade", (const void*)dsp_biquad_cascade);
+#endif
+    memory_register_code("mix_pip_audio", (const void*)mix_pip_audio);
+    memory_register_code("latency_test_block", (const void*)latency_test_block);
+    memory_register_code("freq_response_block", (const void*)freq_response_block);
+    memory_register_code("telemetry_audio_block", (const void*)telemetry_audio_block);
+    memory_register_code("profiler_record", (const void*)profiler_record);
+    memory_register_code("account_audio_block_done", (const void*)account_audio_block_done);
+    memory_register_code("power_governor_block", (const void*)power_governor_block);
+}
+
+#if AUDIO_FAST_BOOT
+// Resto del arranque rápido, ya con audio (ControlTask, antes de su bucle)
+static void finish_fast_boot() {
+    print_boot_banner();
+
+    uint32_t t = micros();
+    initialize_serial_interface();
+    boot_phase_end(BOOT_INTERFACE, t);
+
+    t = micros();
+    initialize_buttons();
+    boot_phase_end(BOOT_BUTTONS, t);
+
+    print_boot_report();
+    print_ready_summary();
+    memory_plan_seal();   // Sin asignaciones en Core 0 a partir de aquí
+}
+#endif
+
+// ==================== SETUP ====================
+
+void setup() {
+    boot_phase_us[BOOT_STARTUP] = micros();
+    Serial.begin(115200);
+    register_memory_plan();
+    power_governor_init();   // Nivel máximo hasta medir la carga
+    uint32_t t;
+
+#if AUDIO_FAST_BOOT
+    // Audio primero: sin espera del monitor serie ni banner
+    t = micros();
+    initialize_dsp_pipeline();
+    afc_init(afc_delay_for_latency(get_audio_loop_latency_ms()));
+    apply_boot_config();
+    boot_phase_end(BOOT_DSP, t);
+
+    t = micros();
+    initialize_i2s_hardware();
+    boot_phase_end(BOOT_I2S, t);
+
+    // Presupuesto de tiempo real: ciclos de CPU que dura un bloque
+    profiler_init(PROFILE_STAGE_NAMES, PROF_STAGE_COUNT, block_budget_cycles());
+
+    t = micros();
+    create_audio_task();
+    start_audio_streams();
+    boot_sound_us = micros();
+    boot_phase_end(BOOT_AUDIO, t);
+
+    // DESHABILITAR WiFi y Bluetooth para máximo rendimiento
+    // (el enlace CROS enciende solo ESP-NOW si la configuración lo pide)
+    esp_wifi_stop();
+    esp_wifi_deinit();
+    esp_bt_controller_disable();
+
+    // NVS, comandos, botones e informe de arranque: finish_fast_boot()
+    create_control_task();
+#else
+    delay(2000);
+    print_boot_banner();
+
+    // DESHABILITAR WiFi y Bluetooth para máximo rendimiento
+    // (el enlace CROS enciende solo ESP-NOW si la configuración lo pide)
+    esp_wifi_stop();
+    esp_wifi_deinit();
+    esp_bt_controller_disable();
+    Serial.println("📡 WiFi/Bluetooth: DESHABILITADOS");
+
+    // Inicializar módulos de hardware
+    Serial.println("\n🔧 INICIALIZANDO HARDWARE:");
+    t = micros();
+    initialize_i2s_hardware();
+    boot_phase_end(BOOT_I2S, t);
 
+    t = micros();
+    initialize_buttons();
+    boot_phase_end(BOOT_BUTTONS, t);
+
+    t = micros();
+    initialize_dsp_pipeline();
+    afc_init(afc_delay_for_latency(get_audio_loop_latency_ms()));
+    boot_phase_end(BOOT_DSP, t);
+
+    t = micros();
+    initialize_serial_interface();
+    boot_phase_end(BOOT_INTERFACE, t);
+
+    // Presupuesto de tiempo real: ciclos de CPU que dura un bloque
+    profiler_init(PROFILE_STAGE_NAMES, PROF_STAGE_COUNT, block_budget_cycles());
+
+    Serial.println("\n🚀 CONFIGURANDO DUAL-CORE:");
+    t = micros();
+    create_audio_task();
+    create_control_task();
     Serial.println("✅ Core 0: Tarea de audio creada");
     Serial.println("✅ Core 1: Tarea de control creada");
 
     // Iniciar streams de audio
     start_audio_streams();
+    boot_sound_us = micros();
+    boot_phase_end(BOOT_AUDIO, t);
 
-    Serial.println("\n🎯 SISTEMA LISTO");
-    Serial.printf("💾 RAM libre: %d bytes\n", ESP.getFreeHeap());
-    Serial.printf("🔊 Ganancia inicial: %.0f%% (Nivel %d/5)\n",
-                  gain_factor * 100, current_gain_level + 1);
-    Serial.println("💬 Escribe 'help' para ver comandos disponibles");
-    Serial.println("════════════════════════════════════════");
+    print_boot_report();
+    print_ready_summary();
+    memory_plan_seal();   // Sin asignaciones en Core 0 a partir de aquí
+#endif
 }
 
 // ==================== LOOP PRINCIPAL ====================
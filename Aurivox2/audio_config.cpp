@@ -8,20 +8,22 @@
 
 // ==================== CONSTANTES GLOBALES REQUERIDAS ====================
 
-// Primero undefine los macros para evitar conflictos
-//#undef SAMPLE_RATE
-//#undef BUFFER_SIZE
-//#undef I2S_PORT_MIC  
-//#undef I2S_PORT_DAC
-
-// Ahora definir las variables que los otros archivos necesitan
-//const int SAMPLE_RATE = 16000;
-//const int BUFFER_SIZE = 128;
+// Formato activo: lo cambia set_audio_format() con la tarea de audio parada
+int SAMPLE_RATE = DEFAULT_SAMPLE_RATE;
+int BUFFER_SIZE = DEFAULT_BUFFER_SIZE;
+const int SUPPORTED_SAMPLE_RATES[SAMPLE_RATE_COUNT] = {16000, 22050, 32000, 44100};
+
 const i2s_port_t I2S_PORT_MIC = I2S_NUM_0;
+#if AUDIO_I2S_FULL_DUPLEX
+const i2s_port_t I2S_PORT_DAC = I2S_NUM_0;   // Mismo controlador que el micrófono
+#else
 const i2s_port_t I2S_PORT_DAC = I2S_NUM_1;
+#endif
 
-// Calcular PIP_SAMPLES usando las variables
-const int PIP_SAMPLES = (SAMPLE_RATE * 200) / 1000;  // 200ms = PIP_DURATION_MS
+// Calcular PIP_SAMPLES usando las variables (recalculados en set_audio_format)
+int PIP_SAMPLES = (DEFAULT_SAMPLE_RATE * PIP_DURATION_MS) / 1000;
+int PIP_GAP_SAMPLES = (DEFAULT_SAMPLE_RATE * PIP_GAP_MS) / 1000;
+int PIP_FADE_SAMPLES = (DEFAULT_SAMPLE_RATE * PIP_FADE_MS) / 1000;
 
 // Array de ganancia que necesita button_control.cpp
 const float gain_levels[5] = {0.0f, 0.25f, 0.50f, 0.75f, 1.0f};
@@ -35,6 +37,26 @@ float samples_to_ms(int samples) {
     return ((float)samples * 1000.0f / SAMPLE_RATE);
 }
 
+// Bloques múltiplos de BUFFER_SIZE_STEP: el WDRC recalcula la ganancia
+// siempre sobre sub-bloques completos
+bool is_supported_audio_format(int sample_rate, int buffer_size) {
+    bool rate_ok = false;
+    for (int i = 0; i < SAMPLE_RATE_COUNT; i++) {
+        if (SUPPORTED_SAMPLE_RATES[i] == sample_rate) rate_ok = true;
+    }
+    return rate_ok && buffer_size >= MIN_BUFFER_SIZE && buffer_size <= MAX_BUFFER_SIZE &&
+           buffer_size % BUFFER_SIZE_STEP == 0;
+}
+
+// Solo con la tarea de audio parada: Core 0 lee estas variables en cada bloque
+void set_audio_format(int sample_rate, int buffer_size) {
+    SAMPLE_RATE = sample_rate;
+    BUFFER_SIZE = buffer_size;
+    PIP_SAMPLES = (sample_rate * PIP_DURATION_MS) / 1000;
+    PIP_GAP_SAMPLES = (sample_rate * PIP_GAP_MS) / 1000;
+    PIP_FADE_SAMPLES = (sample_rate * PIP_FADE_MS) / 1000;
+}
+
 // Función de validación del sistema
 bool validate_system_config() {
     // Verificar que el buffer no cause latencia excesiva
@@ -121,10 +143,13 @@ const AudioConfig DEFAULT_CONFIG = []() {
         // Limitador - Desactivado por defecto
         .limiter_enabled = false,
         .limiter_threshold = -6.0f,  // -6dB para prevenir clipping
+        .limiter_lookahead = LIMITER_LOOKAHEAD_MS,
         
-        // Conectividad (futuro) - Todo desactivado por defecto
+        // Conectividad - Todo desactivado por defecto
         .bluetooth_enabled = false,
         .cross_mode_enabled = false,
+        .cross_mode = MODE_STANDALONE,
+        .cross_pair_id = 0,
         
         // Checksum se calculará después
         .checksum = 0
@@ -398,6 +423,16 @@ bool validate_audio_config(const AudioConfig* config) {
         return false;
     }
     
+    if (config->limiter_lookahead < LIMITER_MIN_LOOKAHEAD_MS ||
+        config->limiter_lookahead > LIMITER_MAX_LOOKAHEAD_MS) {
+        return false;
+    }
+    
+    // Verificar modo de conectividad
+    if (config->cross_mode_enabled && config->cross_mode > MODE_CROSS_TRANSMITTER) {
+        return false;
+    }
+    
     // Verificar checksum
     uint32_t calculated_checksum = calculate_default_checksum(config);
     if (calculated_checksum != config->checksum) {
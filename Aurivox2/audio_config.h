@@ -5,7 +5,6 @@
 #ifndef AUDIO_CONFIG_H
 #define AUDIO_CONFIG_H
 
-#include "driver/i2s.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 
@@ -28,6 +27,35 @@
 #define I2S_DAC_LRC     7   // D7 - Left/Right Clock (Word Select)
 #define I2S_DAC_DIN     8   // D8 - Data Input al DAC
 
+// Driver I2S (audio_hardware.cpp):
+//   LEGACY: driver/i2s.h, i2s_read/i2s_write bloqueantes con timeout de 10 ms
+//   STD:    canales i2s_std de ESP-IDF 5; las ISR del DMA notifican a la
+//           tarea de audio, que despierta una vez por buffer sin timeouts
+#define AUDIO_I2S_DRIVER_LEGACY 0
+#define AUDIO_I2S_DRIVER_STD    1
+#ifndef AUDIO_I2S_DRIVER
+#define AUDIO_I2S_DRIVER        AUDIO_I2S_DRIVER_LEGACY
+#endif
+
+// Solo con AUDIO_I2S_DRIVER_STD: micrófono y DAC en un único puerto
+// full-duplex con BCLK/WS comunes (sin deriva entre relojes). El DAC se
+// cablea a D2/D4 (I2S_MIC_BCLK/I2S_MIC_LRCL) en lugar de D6/D7
+#ifndef AUDIO_I2S_FULL_DUPLEX
+#define AUDIO_I2S_FULL_DUPLEX   0
+#endif
+
+#if AUDIO_I2S_FULL_DUPLEX && AUDIO_I2S_DRIVER != AUDIO_I2S_DRIVER_STD
+#error "AUDIO_I2S_FULL_DUPLEX requiere AUDIO_I2S_DRIVER_STD"
+#endif
+
+#if AUDIO_I2S_DRIVER == AUDIO_I2S_DRIVER_STD
+#include "driver/i2s_std.h"
+#define AUDIO_I2S_DRIVER_NAME   (AUDIO_I2S_FULL_DUPLEX ? "i2s_std full-duplex" : "i2s_std")
+#else
+#include "driver/i2s.h"
+#define AUDIO_I2S_DRIVER_NAME   "legacy"
+#endif
+
 // Pines de botones
 #define BTN_GAIN_UP     3   // D3 - Botón subir ganancia
 #define BTN_GAIN_DOWN   0   // D0 - Botón bajar ganancia  
@@ -36,16 +64,38 @@
 // ==================== CONFIGURACIONES DE AUDIO ====================
 
 // Parámetros básicos de audio (definidos como variables en audio_config.cpp)
-// Estos valores están disponibles como extern variables, no como #define
+// Estos valores están disponibles como extern variables, no como #define:
+// SAMPLE_RATE y BUFFER_SIZE arrancan con los valores por defecto y se
+// cambian en runtime con el comando 'format' (switch_audio_format())
 #define LATENCY_TARGET_MS   25  // Latencia objetivo en ms
 
+#define DEFAULT_SAMPLE_RATE     16000
+#define DEFAULT_BUFFER_SIZE     128
+#define MIN_BUFFER_SIZE         32
+#define MAX_BUFFER_SIZE         512     // Dimensiona todos los buffers de bloque
+#define BUFFER_SIZE_STEP        16      // Bloques múltiplos de WDRC_CONTROL_SAMPLES
+#define MAX_SAMPLE_RATE         44100   // Dimensiona los buffers en muestras por segundo
+#define SAMPLE_RATE_COUNT       4       // 16 / 22.05 / 32 / 44.1 kHz (SUPPORTED_SAMPLE_RATES)
+
 // Puertos I2S (definidos como variables en audio_config.cpp)
 // Estos valores están disponibles como extern variables, no como #define
 
+// Ruta DSP: 0 = float, 1 = coma fija Q4.27 con saturación (dsp_fixed.h).
+// Ambas rutas se compilan siempre; 'dsp_compare' mide el SNR de una frente a otra
+#ifndef DSP_FIXED_POINT
+#define DSP_FIXED_POINT     0
+#endif
+
 // Tipos de datos de audio
 typedef int32_t mic_sample_t;   // Micrófono: 32-bit
 typedef int16_t dac_sample_t;   // DAC: 16-bit
+#if DSP_FIXED_POINT
+typedef int32_t dsp_sample_t;   // Procesamiento DSP: Q4.27
+#define DSP_SAMPLE_FORMAT   "Q4.27"
+#else
 typedef float   dsp_sample_t;   // Procesamiento DSP: float
+#define DSP_SAMPLE_FORMAT   "float"
+#endif
 
 // ==================== CONFIGURACIONES DE BOTONES ====================
 
@@ -59,11 +109,16 @@ typedef float   dsp_sample_t;   // Procesamiento DSP: float
 #define PIP_AMPLITUDE       0.5   // 50% amplitud para pips
 #define PIP_DURATION_MS     200   // 200ms por pip
 #define PIP_GAP_MS          100   // 100ms entre pips
+#define PIP_FADE_MS         5     // Rampa coseno al inicio/fin de cada pip
+#define PIP_DUCK_GAIN       0.25f // Audio del micrófono bajo el pip (-12 dB)
+#define PIP_WAVETABLE_BITS  8     // Tabla de seno de 256 puntos
 #define PI                  3.14159265359
 
 // Calcular samples por pip (usando variables extern)
-// Nota: PIP_SAMPLES se calculará en runtime ya que SAMPLE_RATE es variable
-extern const int PIP_SAMPLES;
+// Nota: PIP_SAMPLES se calcula en runtime ya que SAMPLE_RATE es variable
+extern int PIP_SAMPLES;
+extern int PIP_GAP_SAMPLES;
+extern int PIP_FADE_SAMPLES;
 
 // ==================== CONFIGURACIONES DSP ====================
 
@@ -93,22 +148,38 @@ extern const int PIP_SAMPLES;
 #define WDRC_RELEASE_MIN_MS     10.0f
 #define WDRC_RELEASE_MAX_MS     5000.0f
 
+// Anticipación del limitador (latencia añadida; comando 'limiter <ms>')
+#define LIMITER_LOOKAHEAD_MS      1.0f
+#define LIMITER_MIN_LOOKAHEAD_MS  0.5f
+#define LIMITER_MAX_LOOKAHEAD_MS  2.0f    // Dimensiona la línea de retardo (a MAX_SAMPLE_RATE)
+
+// ==================== ARRANQUE ====================
+
+// 1: setup() arranca el audio primero (configuración de RTC o de firmware)
+// y la tarea de control abre NVS, los comandos y los botones después.
+// 0: orden clásico, con la espera de 2 s y el banner antes del audio
+#ifndef AUDIO_FAST_BOOT
+#define AUDIO_FAST_BOOT     1
+#endif
+
 // ==================== CONFIGURACIONES DE MEMORIA ====================
 
 // Configuraciones NVS
 #define NVS_NAMESPACE       "audio_config"
-#define CONFIG_VERSION      1
+#define CONFIG_VERSION      2       // 2: anticipación del limitador
 #define MAX_PRESET_NAME     32
 
 // Límites de memoria
 #define MIN_FREE_HEAP       50000   // RAM mínima requerida (50KB)
 #define STACK_SIZE_AUDIO    4096    // Stack para tarea de audio (4KB)
-#define STACK_SIZE_CONTROL  4096    // Stack para tarea de control (4KB)
+#define STACK_SIZE_CONTROL  (AUDIO_FAST_BOOT ? 6144 : 4096)   // + NVS y banner en el arranque rápido
+#define STACK_SIZE_RADIO    3072    // Tarea del enlace CROS (ADPCM + esp_now_send)
 
 // ==================== PRIORIDADES DE TAREAS ====================
 
 #define PRIORITY_AUDIO_TASK     2   // Prioridad alta para audio
 #define PRIORITY_CONTROL_TASK   1   // Prioridad menor para control
+#define PRIORITY_RADIO_TASK     2   // Enlace CROS en Core 1: una trama por bloque sin esperar al Serial
 
 // ==================== ESTRUCTURAS DE DATOS ====================
 
@@ -116,9 +187,9 @@ extern const int PIP_SAMPLES;
 struct HighpassConfig {
   bool enabled;
   float cutoff_freq;
-  float alpha;        // Coeficiente calculado
-  float prev_input;   // Estado anterior
-  float prev_output;  // Estado anterior
+  // Biquad Butterworth 2º orden, formato ESP-DSP
+  float coeffs[5];    // b0, b1, b2, a1, a2 (a0 = 1)
+  float state[2];     // Forma directa II: w[n-1], w[n-2]
 };
 
 // Estructura para banda del ecualizador
@@ -128,12 +199,10 @@ struct EQBand {
   float gain_db;       // Ganancia en dB
   float gain_linear;   // Ganancia lineal
   float Q;             // Factor de calidad
-  // Coeficientes del filtro biquad
-  float b0, b1, b2;    // Numerador
-  float a1, a2;        // Denominador (a0 = 1)
-  // Estados del filtro
-  float x1, x2;        // Entradas anteriores
-  float y1, y2;        // Salidas anteriores
+  // Coeficientes del filtro biquad (formato ESP-DSP)
+  float coeffs[5];     // b0, b1, b2, a1, a2 (a0 = 1)
+  // Estado del filtro
+  float state[2];      // Forma directa II: w[n-1], w[n-2]
 };
 
 // Estructura para ecualizador completo
@@ -149,20 +218,27 @@ struct WDRCConfig {
   float ratio;         // Ratio de compresión
   float attack_ms;     // Tiempo de attack
   float release_ms;    // Tiempo de release
+  // Coeficientes calculados (tasa de control)
+  float alpha_attack;
+  float alpha_release;
   // Estados internos (calculados)
-  float envelope;      // Envolvente del detector
-  float gain_reduction; // Reducción de ganancia actual
+  float envelope;      // Envolvente del detector (dB)
+  float gain_reduction; // Reducción de ganancia actual (dB)
+  float gain_linear;   // Ganancia aplicada (interpolada por muestra)
 };
 
 // Estructura para limitador
 struct LimiterConfig {
   bool enabled;
   float threshold_db;  // Umbral del limitador
-  float attack_ms;     // Tiempo de attack
+  float attack_ms;     // Rampa de ataque (= anticipación)
   float release_ms;    // Tiempo de release
-  // Estados internos
-  float envelope;      // Envolvente del detector
-  float gain_reduction; // Reducción de ganancia
+  float lookahead_ms;  // Anticipación en ms, ya redondeada a muestras
+  // Coeficientes calculados
+  float threshold_linear;
+  float alpha_release;
+  int delay_samples;   // Anticipación en muestras
+  // Estado (línea de retardo, envolvente): LimiterState en dsp_pipeline.cpp
 };
 
 // Estructura principal de configuración
@@ -190,10 +266,13 @@ struct AudioConfig {
   // Limitador
   bool limiter_enabled;
   float limiter_threshold;
+  float limiter_lookahead;    // Anticipación (ms, LIMITER_MIN/MAX_LOOKAHEAD_MS)
   
-  // Bluetooth (futuro)
-  bool bluetooth_enabled;
-  bool cross_mode_enabled;
+  // Conectividad
+  bool bluetooth_enabled;     // Futuro
+  bool cross_mode_enabled;    // Enlace ESP-NOW entre audífonos (cros_link.h)
+  uint8_t cross_mode;         // ConnectivityMode del enlace
+  uint8_t cross_pair_id;      // Par de audífonos: se ignoran las tramas de otros pares
   
   // Checksum para integridad
   uint32_t checksum;
@@ -201,15 +280,16 @@ struct AudioConfig {
 
 // ==================== SISTEMA DE PIPS ====================
 
+// Estado del generador: solo lo modifica Core 0 (mix_pip_audio).
+// Duraciones en muestras, no en millis(): el timing sigue al reloj I2S.
 struct PipSystem {
   bool active;
   int total_pips;
   int remaining_pips;
-  int samples_in_current_pip;
-  unsigned long pip_start_time;
-  unsigned long pip_gap_start;
+  int segment_samples;       // Muestras restantes del pip o gap actual
+  int pip_position;          // Muestras ya generadas del pip actual
   bool in_gap;
-  float phase;
+  uint32_t phase;            // Acumulador de fase (2^32 = un ciclo)
 };
 
 // ==================== ENUMERACIONES ====================
@@ -233,12 +313,31 @@ enum PresetType {
   PRESET_CUSTOM
 };
 
-// Modos de conectividad (futuro)
+// Etapas del perfilador de ciclos (ver cycle_profiler.h, comando 'perf')
+enum AudioProfileStage {
+  PROF_I2S_READ,        // Incluye la espera del DMA
+  PROF_TO_FLOAT,
+  PROF_AFC_FILTER,      // Resta de la realimentación estimada (feedback_canceller.h)
+  PROF_HPF,
+  PROF_EQ,
+  PROF_WDRC,
+  PROF_LIMITER,
+  PROF_OUTPUT_GAIN,
+  PROF_PIPS,
+  PROF_TO_INT16,
+  PROF_I2S_WRITE,
+  PROF_AFC_ADAPT,       // Actualización NLMS, tras enviar el bloque al DAC
+  PROF_DSP_TOTAL,       // Conversión → pipeline → pips → conversión
+  PROF_STAGE_COUNT
+};
+
+// Modos de conectividad (cross_mode de AudioConfig, ver cros_link.h)
 enum ConnectivityMode {
   MODE_STANDALONE,
-  MODE_CROSS,
-  MODE_BICROSS,
-  MODE_BLUETOOTH_ONLY
+  MODE_CROSS,               // Receptor: solo el micrófono del otro audífono
+  MODE_BICROSS,             // Receptor: micrófono local + remoto
+  MODE_BLUETOOTH_ONLY,      // Futuro
+  MODE_CROSS_TRANSMITTER    // Emisor: envía su micrófono al otro audífono
 };
 
 // ==================== CONSTANTES GLOBALES ====================
@@ -253,12 +352,18 @@ extern const float EQ_FREQUENCIES[EQ_BANDS_COUNT];
 // Configuración por defecto
 extern const AudioConfig DEFAULT_CONFIG;
 
-// Variables de hardware (definidas en audio_config.cpp)
-#define SAMPLE_RATE     16000
-#define BUFFER_SIZE     128
+// Frecuencias de muestreo admitidas por 'format' (Hz)
+extern const int SUPPORTED_SAMPLE_RATES[SAMPLE_RATE_COUNT];
+
+// Variables de hardware (definidas en audio_config.cpp).
+// Formato activo: solo cambia con la tarea de audio parada (set_audio_format)
+extern int SAMPLE_RATE;                 // DEFAULT_SAMPLE_RATE al arrancar
+extern int BUFFER_SIZE;                 // DEFAULT_BUFFER_SIZE al arrancar (≤ MAX_BUFFER_SIZE)
 extern const i2s_port_t I2S_PORT_MIC;  // I2S_NUM_0
-extern const i2s_port_t I2S_PORT_DAC;   // I2S_NUM_1
-extern const int PIP_SAMPLES;      // Calculado: (SAMPLE_RATE * PIP_DURATION_MS) / 1000
+extern const i2s_port_t I2S_PORT_DAC;   // I2S_NUM_1 (I2S_NUM_0 en full-duplex)
+extern int PIP_SAMPLES;      // Calculado: (SAMPLE_RATE * PIP_DURATION_MS) / 1000
+extern int PIP_GAP_SAMPLES;  // Calculado: (SAMPLE_RATE * PIP_GAP_MS) / 1000
+extern int PIP_FADE_SAMPLES; // Calculado: (SAMPLE_RATE * PIP_FADE_MS) / 1000
 
 // ==================== MACROS ÚTILES ====================
 
@@ -273,13 +378,21 @@ extern const int PIP_SAMPLES;      // Calculado: (SAMPLE_RATE * PIP_DURATION_MS)
 extern float ms_to_samples(float ms);
 extern float samples_to_ms(int samples);
 
+// Formato de audio: validación y cambio de las variables (audio_config.cpp)
+extern bool is_supported_audio_format(int sample_rate, int buffer_size);
+extern void set_audio_format(int sample_rate, int buffer_size);
+
 // ==================== VERIFICACIONES DE COMPILACIÓN ====================
 
 // Verificar que el buffer no cause latencia excesiva
-#if (BUFFER_SIZE * 1000 / SAMPLE_RATE) > LATENCY_TARGET_MS
+#if (DEFAULT_BUFFER_SIZE * 1000 / DEFAULT_SAMPLE_RATE) > LATENCY_TARGET_MS
 #warning "Buffer size may cause excessive latency"
 #endif
 
+#if DEFAULT_BUFFER_SIZE < MIN_BUFFER_SIZE || DEFAULT_BUFFER_SIZE > MAX_BUFFER_SIZE
+#error "DEFAULT_BUFFER_SIZE fuera de [MIN_BUFFER_SIZE, MAX_BUFFER_SIZE]"
+#endif
+
 // Verificar configuración de memoria
 #if STACK_SIZE_AUDIO < 2048
 #error "Audio task stack size too small"
@@ -299,7 +412,7 @@ extern float samples_to_ms(int samples);
 // ==================== COMENTARIOS DE DESARROLLO ====================
 
 /*
- * ESTRUCTURA DEL PIPELINE DSP PLANIFICADO:
+ * ESTRUCTURA DEL PIPELINE DSP (implementado en dsp_pipeline.cpp):
  * 
  * Micrófono (32-bit) → 
  * ↓
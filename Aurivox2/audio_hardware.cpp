@@ -3,9 +3,17 @@
 // Hardware: XIAO ESP32S3 + micrófono ICS-43434 + DAC MAX98357A
 // Configuración estable que no se modificará frecuentemente
 #include "audio_config.h"
-#include "driver/i2s.h"
+#include "audio_hardware.h"
+#include "dsp_pipeline.h"
+#include "latency_test.h"
+#include "dsp_kernels.h"     // AUDIO_IRAM
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
 #include "esp_err.h"
+#include "esp_timer.h"
 #include "Arduino.h"
+#include <atomic>
 
 // ==================== DEFINICIONES DE PINES ====================
 
@@ -21,19 +29,237 @@
 
 // ==================== CONFIGURACIONES DE AUDIO ====================
 
-// Parámetros de audio (referenciados desde main)
-//extern const int SAMPLE_RATE;      // 16000 Hz
-//extern const int BUFFER_SIZE;      // 128 muestras
+// Parámetros de audio (audio_config.cpp): SAMPLE_RATE y BUFFER_SIZE son
+// el formato activo; initialize_i2s_hardware() los toma en cada llamada
 //extern const i2s_port_t I2S_PORT_MIC;  // I2S_NUM_0
 //extern const i2s_port_t I2S_PORT_DAC;  // I2S_NUM_1
 
+// ==================== BUFFERS DMA Y EVENTOS ====================
+
+#define I2S_DMA_BUF_COUNT       2     // Buffers DMA por puerto
+#define I2S_EVENT_QUEUE_LEN     8     // Eventos del driver en cola (1 por buffer DMA, LEGACY)
+#define I2S_IO_TIMEOUT_MS       10    // Espera máxima de i2s_read/i2s_write (LEGACY)
+#define BLOCK_LATE_FACTOR       1.5f  // Periodo > 1.5 × nominal → bloque tardío
+
 // ==================== VARIABLES DE ESTADO ====================
 
 static bool i2s_hardware_initialized = false;
 static bool audio_streams_running = false;
 
+#if AUDIO_I2S_DRIVER == AUDIO_I2S_DRIVER_STD
+static i2s_chan_handle_t mic_chan = NULL;
+static i2s_chan_handle_t dac_chan = NULL;
+
+// Tarea que espera los bloques del micrófono (la registra audio_read_block)
+static std::atomic<TaskHandle_t> audio_task(NULL);
+
+// Contadores de las ISR del DMA, volcados a stream_stats por Core 0
+static std::atomic<uint32_t> isr_rx_buffers(0);
+static std::atomic<uint32_t> isr_tx_buffers(0);
+static std::atomic<uint32_t> isr_rx_overflows(0);
+static std::atomic<uint32_t> isr_tx_underruns(0);
+#else
+// Colas de eventos del driver: RX_Q_OVF = overflow, TX_Q_OVF = underrun
+static QueueHandle_t mic_event_queue = NULL;
+static QueueHandle_t dac_event_queue = NULL;
+#endif
+
+// Contadores de flujo: solo los escribe Core 0 (account_audio_*)
+static audio_stream_stats_t stream_stats;
+static int64_t last_block_time_us = 0;
+static std::atomic<bool> stats_reset_pending(false);
+static std::atomic<bool> stats_resync_pending(true);  // Ignorar el hueco tras start/stop
+
+static uint32_t nominal_block_us = 0;   // BUFFER_SIZE / SAMPLE_RATE del formato configurado
+
 // ==================== FUNCIONES PRIVADAS ====================
 
+#if AUDIO_I2S_DRIVER == AUDIO_I2S_DRIVER_STD
+
+/*
+ * Canales i2s_std (ESP-IDF 5):
+ * ==========================
+ *
+ *   DMA RX lleno ──▶ on_recv (ISR) ──▶ vTaskNotifyGiveFromISR ──▶ audioTask
+ *                                                                    │
+ *   DMA TX libre ◀── i2s_channel_write ◀── DSP ◀── i2s_channel_read ◀┘
+ *
+ * Un buffer DMA = un bloque (dma_frame_num = BUFFER_SIZE): la tarea
+ * despierta exactamente una vez por bloque, sin sondeo ni timeouts.
+ * La lectura posterior no espera: el buffer ya está en la cola del
+ * driver (o llega en microsegundos si la ISR corre en el otro core).
+ *
+ * Full-duplex: TX y RX del mismo controlador comparten BCLK/WS, así que
+ * micrófono y DAC no pueden derivar y la diferencia RX-TX de 'i2s_stats'
+ * queda fija. El DAC usa entonces slots de 32 bits (BCLK común = 64·fs);
+ * el MAX98357A detecta el formato por la relación BCLK/LRC.
+ */
+
+// Callbacks del DMA: contexto de interrupción, en IRAM
+static bool IRAM_ATTR on_mic_recv(i2s_chan_handle_t handle, i2s_event_data_t* event, void* user_ctx) {
+    isr_rx_buffers.fetch_add(1, std::memory_order_relaxed);
+    TaskHandle_t task = audio_task.load(std::memory_order_acquire);
+    BaseType_t woken = pdFALSE;
+    if (task) vTaskNotifyGiveFromISR(task, &woken);
+    return woken == pdTRUE;
+}
+
+static bool IRAM_ATTR on_mic_overflow(i2s_chan_handle_t handle, i2s_event_data_t* event, void* user_ctx) {
+    isr_rx_overflows.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+static bool IRAM_ATTR on_dac_sent(i2s_chan_handle_t handle, i2s_event_data_t* event, void* user_ctx) {
+    isr_tx_buffers.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+static bool IRAM_ATTR on_dac_underrun(i2s_chan_handle_t handle, i2s_event_data_t* event, void* user_ctx) {
+    isr_tx_underruns.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+static i2s_chan_config_t audio_channel_config(i2s_port_t port) {
+    i2s_chan_config_t config = I2S_CHANNEL_DEFAULT_CONFIG(port, I2S_ROLE_MASTER);
+    config.dma_desc_num = I2S_DMA_BUF_COUNT;   // 2 buffers DMA
+    config.dma_frame_num = BUFFER_SIZE;        // 1 buffer = 1 bloque = 1 notificación
+    config.auto_clear = true;                  // TX sin datos → silencio
+    return config;
+}
+
+// Borrar los canales creados (fallo de configuración)
+static void release_i2s_channels() {
+    if (mic_chan) i2s_del_channel(mic_chan);
+    if (dac_chan) i2s_del_channel(dac_chan);
+    mic_chan = NULL;
+    dac_chan = NULL;
+}
+
+// Configurar el micrófono I2S (en full-duplex crea también el canal del DAC)
+static esp_err_t configure_microphone() {
+    Serial.println("🎤 Configurando micrófono ICS-43434 (i2s_std)...");
+
+    i2s_chan_config_t chan_config = audio_channel_config(I2S_PORT_MIC);
+#if AUDIO_I2S_FULL_DUPLEX
+    esp_err_t err = i2s_new_channel(&chan_config, &dac_chan, &mic_chan);
+#else
+    esp_err_t err = i2s_new_channel(&chan_config, NULL, &mic_chan);
+#endif
+    if (err != ESP_OK) {
+        Serial.printf("❌ Error creando canal micrófono: %s\n", esp_err_to_name(err));
+        return err;
+    }
+
+    // Philips 32-bit mono, canal izquierdo (pin L/R del ICS-43434 a GND)
+    i2s_std_config_t std_config = {
+        .clk_cfg = I2S_STD_CLK_DEFAULT_CONFIG(SAMPLE_RATE),
+        .slot_cfg = I2S_STD_PHILIPS_SLOT_DEFAULT_CONFIG(I2S_DATA_BIT_WIDTH_32BIT, I2S_SLOT_MODE_MONO),
+        .gpio_cfg = {
+            .mclk = I2S_GPIO_UNUSED,               // No MCLK
+            .bclk = (gpio_num_t)I2S_MIC_BCLK,      // D2 - Bit Clock
+            .ws = (gpio_num_t)I2S_MIC_LRCL,        // D4 - Word Select
+            .dout = I2S_GPIO_UNUSED,               // No hay salida de datos
+            .din = (gpio_num_t)I2S_MIC_DOUT,       // D5 - Entrada de datos
+        },
+    };
+    std_config.slot_cfg.slot_mask = I2S_STD_SLOT_LEFT;
+
+    err = i2s_channel_init_std_mode(mic_chan, &std_config);
+    if (err != ESP_OK) {
+        Serial.printf("❌ Error configurando micrófono: %s\n", esp_err_to_name(err));
+        return err;
+    }
+
+    i2s_event_callbacks_t callbacks = {
+        .on_recv = on_mic_recv,
+        .on_recv_q_ovf = on_mic_overflow,
+        .on_sent = NULL,
+        .on_send_q_ovf = NULL,
+    };
+    err = i2s_channel_register_event_callback(mic_chan, &callbacks, NULL);
+    if (err != ESP_OK) {
+        Serial.printf("❌ Error registrando callbacks micrófono: %s\n", esp_err_to_name(err));
+        return err;
+    }
+
+    Serial.println("✅ Micrófono ICS-43434 configurado correctamente");
+    Serial.printf("   📍 BCLK: D%d, LRCL: D%d, DOUT: D%d\n", I2S_MIC_BCLK, I2S_MIC_LRCL, I2S_MIC_DOUT);
+
+    return ESP_OK;
+}
+
+// Configurar el DAC I2S
+static esp_err_t configure_dac() {
+    Serial.println("🔊 Configurando DAC MAX98357A (i2s_std)...");
+
+#if AUDIO_I2S_FULL_DUPLEX
+    const int bclk_pin = I2S_MIC_BCLK;   // Reloj común con el micrófono
+    const int ws_pin = I2S_MIC_LRCL;
+    esp_err_t err = ESP_OK;              // Canal creado con el micrófono
+#else
+    const int bclk_pin = I2S_DAC_BCLK;
+    const int ws_pin = I2S_DAC_LRC;
+    i2s_chan_config_t chan_config = audio_channel_config(I2S_PORT_DAC);
+    esp_err_t err = i2s_new_channel(&chan_config, &dac_chan, NULL);
+    if (err != ESP_OK) {
+        Serial.printf("❌ Error creando canal DAC: %s\n", esp_err_to_name(err));
+        return err;
+    }
+#endif
+
+    // Philips 16-bit mono, solo canal izquierdo
+    i2s_std_config_t std_config = {
+        .clk_cfg = I2S_STD_CLK_DEFAULT_CONFIG(SAMPLE_RATE),
+        .slot_cfg = I2S_STD_PHILIPS_SLOT_DEFAULT_CONFIG(I2S_DATA_BIT_WIDTH_16BIT, I2S_SLOT_MODE_MONO),
+        .gpio_cfg = {
+            .mclk = I2S_GPIO_UNUSED,               // No MCLK
+            .bclk = (gpio_num_t)bclk_pin,
+            .ws = (gpio_num_t)ws_pin,
+            .dout = (gpio_num_t)I2S_DAC_DIN,       // D8 - Salida de datos
+            .din = I2S_GPIO_UNUSED,                // No hay entrada de datos
+        },
+    };
+    std_config.slot_cfg.slot_mask = I2S_STD_SLOT_LEFT;
+#if AUDIO_I2S_FULL_DUPLEX
+    // Mismo marco que RX: BCLK = 64·fs y WS al 50 % (32 + 32 ciclos). Con el
+    // ws_width de 16 del formato 16 bits el WS compartido dejaría de ser
+    // simétrico y el ICS-43434 perdería el encuadre de sus slots
+    std_config.slot_cfg.slot_bit_width = I2S_SLOT_BIT_WIDTH_32BIT;
+    std_config.slot_cfg.ws_width = 32;
+#endif
+
+    err = i2s_channel_init_std_mode(dac_chan, &std_config);
+    if (err != ESP_OK) {
+        Serial.printf("❌ Error configurando DAC: %s\n", esp_err_to_name(err));
+        return err;
+    }
+
+    i2s_event_callbacks_t callbacks = {
+        .on_recv = NULL,
+        .on_recv_q_ovf = NULL,
+        .on_sent = on_dac_sent,
+        .on_send_q_ovf = on_dac_underrun,
+    };
+    err = i2s_channel_register_event_callback(dac_chan, &callbacks, NULL);
+    if (err != ESP_OK) {
+        Serial.printf("❌ Error registrando callbacks DAC: %s\n", esp_err_to_name(err));
+        return err;
+    }
+
+    Serial.println("✅ DAC MAX98357A configurado correctamente");
+    Serial.printf("   📍 BCLK: D%d, LRC: D%d, DIN: D%d%s\n", bclk_pin, ws_pin, I2S_DAC_DIN,
+                  AUDIO_I2S_FULL_DUPLEX ? " (reloj compartido con el micrófono)" : "");
+
+    return ESP_OK;
+}
+
+static esp_err_t start_microphone() { return i2s_channel_enable(mic_chan); }
+static esp_err_t start_dac()        { return i2s_channel_enable(dac_chan); }
+static void stop_microphone()       { i2s_channel_disable(mic_chan); }
+static void stop_dac()              { i2s_channel_disable(dac_chan); }
+
+#else  // AUDIO_I2S_DRIVER_LEGACY
+
 // Configurar el micrófono I2S
 static esp_err_t configure_microphone() {
     Serial.println("🎤 Configurando micrófono ICS-43434...");
@@ -46,8 +272,8 @@ static esp_err_t configure_microphone() {
         .channel_format = I2S_CHANNEL_FMT_ONLY_LEFT,   // Solo canal izquierdo
         .communication_format = I2S_COMM_FORMAT_STAND_I2S,
         .intr_alloc_flags = ESP_INTR_FLAG_LEVEL1,      // Prioridad alta para audio
-        .dma_buf_count = 2,                            // 2 buffers DMA
-        .dma_buf_len = BUFFER_SIZE,                    // 128 muestras por buffer
+        .dma_buf_count = I2S_DMA_BUF_COUNT,            // 2 buffers DMA
+        .dma_buf_len = BUFFER_SIZE,                    // 1 buffer = 1 bloque
         .use_apll = false,                             // No usar APLL para estabilidad
         .tx_desc_auto_clear = false,                   // No auto-clear (solo RX)
         .fixed_mclk = 0,                              // MCLK automático
@@ -64,8 +290,8 @@ static esp_err_t configure_microphone() {
         .data_in_num = I2S_MIC_DOUT         // D5 - Entrada de datos
     };
 
-    // Instalar driver I2S para micrófono
-    esp_err_t err = i2s_driver_install(I2S_PORT_MIC, &i2s_config_mic, 0, NULL);
+    // Instalar driver I2S para micrófono (con cola de eventos para overflows)
+    esp_err_t err = i2s_driver_install(I2S_PORT_MIC, &i2s_config_mic, I2S_EVENT_QUEUE_LEN, &mic_event_queue);
     if (err != ESP_OK) {
         Serial.printf("❌ Error instalando driver micrófono: %s\n", esp_err_to_name(err));
         return err;
@@ -97,8 +323,8 @@ static esp_err_t configure_dac() {
         .channel_format = I2S_CHANNEL_FMT_ONLY_LEFT,   // Solo canal izquierdo
         .communication_format = I2S_COMM_FORMAT_STAND_I2S,
         .intr_alloc_flags = ESP_INTR_FLAG_LEVEL1,      // Prioridad alta para audio
-        .dma_buf_count = 2,                            // 2 buffers DMA
-        .dma_buf_len = BUFFER_SIZE,                    // 128 muestras por buffer
+        .dma_buf_count = I2S_DMA_BUF_COUNT,            // 2 buffers DMA
+        .dma_buf_len = BUFFER_SIZE,                    // 1 buffer = 1 bloque
         .use_apll = false,                             // No usar APLL para estabilidad
         .tx_desc_auto_clear = true,                    // Auto-clear para TX
         .fixed_mclk = 0,                              // MCLK automático
@@ -115,8 +341,8 @@ static esp_err_t configure_dac() {
         .data_in_num = I2S_PIN_NO_CHANGE    // No hay entrada de datos
     };
 
-    // Instalar driver I2S para DAC
-    esp_err_t err = i2s_driver_install(I2S_PORT_DAC, &i2s_config_dac, 0, NULL);
+    // Instalar driver I2S para DAC (con cola de eventos para underruns)
+    esp_err_t err = i2s_driver_install(I2S_PORT_DAC, &i2s_config_dac, I2S_EVENT_QUEUE_LEN, &dac_event_queue);
     if (err != ESP_OK) {
         Serial.printf("❌ Error instalando driver DAC: %s\n", esp_err_to_name(err));
         return err;
@@ -136,6 +362,17 @@ static esp_err_t configure_dac() {
     return ESP_OK;
 }
 
+static void release_i2s_channels() {
+    i2s_driver_uninstall(I2S_PORT_MIC);
+}
+
+static esp_err_t start_microphone() { return i2s_start(I2S_PORT_MIC); }
+static esp_err_t start_dac()        { return i2s_start(I2S_PORT_DAC); }
+static void stop_microphone()       { i2s_stop(I2S_PORT_MIC); }
+static void stop_dac()              { i2s_stop(I2S_PORT_DAC); }
+
+#endif  // AUDIO_I2S_DRIVER
+
 // ==================== FUNCIONES PÚBLICAS ====================
 
 // Inicializar todo el hardware I2S
@@ -150,11 +387,15 @@ void initialize_i2s_hardware() {
     Serial.printf("📊 Sample Rate: %d Hz\n", SAMPLE_RATE);
     Serial.printf("📦 Buffer Size: %d muestras\n", BUFFER_SIZE);
     Serial.printf("⏱️ Latencia base: %.1f ms\n", (float)BUFFER_SIZE / SAMPLE_RATE * 1000);
+    Serial.printf("🧩 Driver I2S: %s\n", AUDIO_I2S_DRIVER_NAME);
 
     // Configurar micrófono
     esp_err_t mic_result = configure_microphone();
     if (mic_result != ESP_OK) {
         Serial.println("❌ FALLO EN CONFIGURACIÓN DE MICRÓFONO");
+#if AUDIO_I2S_DRIVER == AUDIO_I2S_DRIVER_STD
+        release_i2s_channels();
+#endif
         return;
     }
 
@@ -162,17 +403,36 @@ void initialize_i2s_hardware() {
     esp_err_t dac_result = configure_dac();
     if (dac_result != ESP_OK) {
         Serial.println("❌ FALLO EN CONFIGURACIÓN DE DAC");
-        // Desinstalar micrófono si el DAC falla
-        i2s_driver_uninstall(I2S_PORT_MIC);
+        // Liberar micrófono si el DAC falla
+        release_i2s_channels();
         return;
     }
 
     i2s_hardware_initialized = true;
+    nominal_block_us = (uint32_t)((uint64_t)BUFFER_SIZE * 1000000ULL / SAMPLE_RATE);
     Serial.println("────────────────────────────────");
     Serial.println("✅ HARDWARE I2S INICIALIZADO CORRECTAMENTE");
     Serial.printf("💾 RAM libre después de init: %d bytes\n", ESP.getFreeHeap());
 }
 
+// Liberar ambos puertos para reconfigurarlos con otro formato
+void deinitialize_i2s_hardware() {
+    if (!i2s_hardware_initialized) return;
+    if (audio_streams_running) stop_audio_streams();
+
+#if AUDIO_I2S_DRIVER == AUDIO_I2S_DRIVER_STD
+    release_i2s_channels();
+#else
+    i2s_driver_uninstall(I2S_PORT_MIC);
+    i2s_driver_uninstall(I2S_PORT_DAC);
+    mic_event_queue = NULL;   // Las colas las libera el driver
+    dac_event_queue = NULL;
+#endif
+
+    i2s_hardware_initialized = false;
+    Serial.println("🔧 Hardware I2S liberado");
+}
+
 // Iniciar streams de audio
 void start_audio_streams() {
     if (!i2s_hardware_initialized) {
@@ -188,21 +448,22 @@ void start_audio_streams() {
     Serial.println("🚀 Iniciando streams de audio...");
 
     // Iniciar micrófono
-    esp_err_t mic_start = i2s_start(I2S_PORT_MIC);
+    esp_err_t mic_start = start_microphone();
     if (mic_start != ESP_OK) {
         Serial.printf("❌ Error iniciando micrófono: %s\n", esp_err_to_name(mic_start));
         return;
     }
 
     // Iniciar DAC
-    esp_err_t dac_start = i2s_start(I2S_PORT_DAC);
+    esp_err_t dac_start = start_dac();
     if (dac_start != ESP_OK) {
         Serial.printf("❌ Error iniciando DAC: %s\n", esp_err_to_name(dac_start));
-        i2s_stop(I2S_PORT_MIC);  // Detener micrófono si DAC falla
+        stop_microphone();  // Detener micrófono si DAC falla
         return;
     }
 
     audio_streams_running = true;
+    stats_resync_pending.store(true, std::memory_order_release);
     Serial.println("✅ Streams de audio iniciados correctamente");
     Serial.println("🎵 Audio en tiempo real activo");
 }
@@ -217,18 +478,18 @@ void stop_audio_streams() {
     Serial.println("⏹️ Deteniendo streams de audio...");
 
     // Detener streams
-    i2s_stop(I2S_PORT_MIC);
-    i2s_stop(I2S_PORT_DAC);
+    stop_microphone();
+    stop_dac();
 
     audio_streams_running = false;
+    stats_resync_pending.store(true, std::memory_order_release);
     Serial.println("✅ Streams de audio detenidos");
 }
 
-// Reiniciar streams de audio (útil para sleep/wake)
+// Reiniciar streams de audio (Core 0 aparcado; los canales siguen instalados)
 void restart_audio_streams() {
     Serial.println("🔄 Reiniciando streams de audio...");
     stop_audio_streams();
-    delay(100);  // Pequeña pausa para estabilidad
     start_audio_streams();
 }
 
@@ -248,9 +509,21 @@ void get_audio_performance_info() {
     Serial.println("════════════════════════════════════");
     Serial.printf("🔧 Hardware inicializado: %s\n", i2s_hardware_initialized ? "SÍ" : "NO");
     Serial.printf("🎵 Streams ejecutándose: %s\n", audio_streams_running ? "SÍ" : "NO");
+    Serial.printf("🧩 Driver I2S: %s\n", AUDIO_I2S_DRIVER_NAME);
     Serial.printf("📊 Sample Rate: %d Hz\n", SAMPLE_RATE);
     Serial.printf("📦 Buffer Size: %d muestras\n", BUFFER_SIZE);
-    Serial.printf("⏱️ Latencia teórica: %.1f ms\n", (float)BUFFER_SIZE / SAMPLE_RATE * 1000);
+    Serial.printf("⏱️ Latencia teórica: %.1f ms (bloque + %d buffers DMA de salida + %.1f ms de limitador)\n",
+                  get_current_audio_latency_ms(), I2S_DMA_BUF_COUNT,
+                  get_current_audio_latency_ms() - get_audio_loop_latency_ms());
+    latency_result_t measured;
+    if (get_measured_latency(&measured)) {
+        Serial.printf("⏱️ Latencia medida (loopback): %.2f ms, σ %.2f ms, máx %.2f ms\n",
+                      measured.mean_ms, measured.stddev_ms, measured.max_ms);
+    } else {
+        Serial.println("⏱️ Latencia medida: sin medir ('latency' con el lazo DAC → micrófono)");
+    }
+    Serial.printf("📉 Overflows RX / underruns TX: %lu / %lu (detalle: 'i2s_stats')\n",
+                  (unsigned long)stream_stats.rx_overflows, (unsigned long)stream_stats.tx_underruns);
     Serial.printf("🎤 Puerto micrófono: I2S_%d\n", I2S_PORT_MIC);
     Serial.printf("🔊 Puerto DAC: I2S_%d\n", I2S_PORT_DAC);
     Serial.printf("💾 RAM libre: %d bytes\n", ESP.getFreeHeap());
@@ -266,8 +539,13 @@ void diagnose_i2s_hardware() {
     Serial.println("📍 CONFIGURACIÓN DE PINES:");
     Serial.printf("   Micrófono - BCLK: D%d, LRCL: D%d, DOUT: D%d\n",
                   I2S_MIC_BCLK, I2S_MIC_LRCL, I2S_MIC_DOUT);
+#if AUDIO_I2S_FULL_DUPLEX
+    Serial.printf("   DAC - BCLK: D%d, LRC: D%d (compartidos), DIN: D%d\n",
+                  I2S_MIC_BCLK, I2S_MIC_LRCL, I2S_DAC_DIN);
+#else
     Serial.printf("   DAC - BCLK: D%d, LRC: D%d, DIN: D%d\n",
                   I2S_DAC_BCLK, I2S_DAC_LRC, I2S_DAC_DIN);
+#endif
 
     // Verificar estado de drivers
     Serial.println("\n🔧 ESTADO DE DRIVERS:");
@@ -293,3 +571,268 @@ void diagnose_i2s_hardware() {
 
     Serial.println("═══════════════════════════════════");
 }
+
+// ==================== LATENCIA Y MEMORIA ====================
+
+// Captura de un bloque + cola DMA del DAC llena (i2s_write bloquea hasta
+// que se libera un buffer, así que en régimen la cola está siempre llena)
+float get_audio_loop_latency_ms() {
+    return (float)((1 + I2S_DMA_BUF_COUNT) * BUFFER_SIZE) * 1000.0f / SAMPLE_RATE;
+}
+
+// Micrófono → altavoz: E/S + anticipación del limitador
+float get_current_audio_latency_ms() {
+    return get_audio_loop_latency_ms() + (float)get_dsp_latency_samples() * 1000.0f / SAMPLE_RATE;
+}
+
+float get_audio_dma_cushion_ms() {
+    return (float)((I2S_DMA_BUF_COUNT - 1) * BUFFER_SIZE) * 1000.0f / SAMPLE_RATE;
+}
+
+void get_audio_memory_usage(size_t* total_allocated, size_t* dma_buffers, size_t* driver_overhead) {
+    const size_t rx_bytes = I2S_DMA_BUF_COUNT * BUFFER_SIZE * sizeof(int32_t);
+    const size_t tx_bytes = I2S_DMA_BUF_COUNT * BUFFER_SIZE * sizeof(int16_t);
+#if AUDIO_I2S_DRIVER == AUDIO_I2S_DRIVER_STD
+    // Descriptores DMA (lldesc_t, 12 bytes) + cola de punteros a buffer de cada canal
+    const size_t overhead = 2 * I2S_DMA_BUF_COUNT * (12 + sizeof(void*));
+#else
+    // Colas de eventos + descriptores DMA (lldesc_t, 12 bytes) de ambos puertos
+    const size_t overhead = 2 * I2S_EVENT_QUEUE_LEN * sizeof(i2s_event_t) +
+                            2 * I2S_DMA_BUF_COUNT * 12;
+#endif
+
+    if (dma_buffers) *dma_buffers = rx_bytes + tx_bytes;
+    if (driver_overhead) *driver_overhead = overhead;
+    if (total_allocated) *total_allocated = rx_bytes + tx_bytes + overhead;
+}
+
+// ==================== CONTABILIDAD DEL FLUJO (CORE 0) ====================
+
+/*
+ * Cada buffer DMA genera un evento del driver (LEGACY) o un callback
+ * (STD): *_DONE/on_recv/on_sent si todo fue bien, *_Q_OVF si la cola
+ * de buffers estaba llena en la interrupción:
+ *
+ *   RX_Q_OVF: Core 0 no leyó a tiempo → se pisó el buffer más antiguo
+ *   TX_Q_OVF: Core 0 no escribió a tiempo → el DAC repitió/borró audio
+ *
+ * La diferencia acumulada rx_dma_buffers - tx_dma_buffers es constante
+ * si micrófono y DAC van al mismo ritmo; si crece o decrece de forma
+ * sostenida, los relojes derivan.
+ */
+
+static std::atomic<uint32_t> window_jitter_max_us(0);   // Máximo por ventana del monitor
+
+static void AUDIO_IRAM clear_stream_stats() {
+    memset(&stream_stats, 0, sizeof(stream_stats));
+}
+
+#if AUDIO_I2S_DRIVER == AUDIO_I2S_DRIVER_STD
+static void AUDIO_IRAM drain_i2s_events() {
+    stream_stats.rx_dma_buffers += isr_rx_buffers.exchange(0, std::memory_order_relaxed);
+    stream_stats.tx_dma_buffers += isr_tx_buffers.exchange(0, std::memory_order_relaxed);
+    stream_stats.rx_overflows += isr_rx_overflows.exchange(0, std::memory_order_relaxed);
+    stream_stats.tx_underruns += isr_tx_underruns.exchange(0, std::memory_order_relaxed);
+}
+#else
+static void AUDIO_IRAM drain_i2s_events() {
+    i2s_event_t event;
+    while (mic_event_queue && xQueueReceive(mic_event_queue, &event, 0) == pdTRUE) {
+        if (event.type == I2S_EVENT_RX_DONE) {
+            stream_stats.rx_dma_buffers++;
+        } else if (event.type == I2S_EVENT_RX_Q_OVF) {
+            stream_stats.rx_dma_buffers++;
+            stream_stats.rx_overflows++;
+        } else if (event.type == I2S_EVENT_DMA_ERROR) {
+            stream_stats.dma_errors++;
+        }
+    }
+    while (dac_event_queue && xQueueReceive(dac_event_queue, &event, 0) == pdTRUE) {
+        if (event.type == I2S_EVENT_TX_DONE) {
+            stream_stats.tx_dma_buffers++;
+        } else if (event.type == I2S_EVENT_TX_Q_OVF) {
+            stream_stats.tx_dma_buffers++;
+            stream_stats.tx_underruns++;
+        } else if (event.type == I2S_EVENT_DMA_ERROR) {
+            stream_stats.dma_errors++;
+        }
+    }
+}
+#endif
+
+// ==================== E/S DE BLOQUES (CORE 0) ====================
+
+#if AUDIO_I2S_DRIVER == AUDIO_I2S_DRIVER_STD
+
+size_t AUDIO_IRAM audio_read_block(int32_t* buffer, size_t bytes) {
+    if (!audio_task.load(std::memory_order_relaxed)) {
+        audio_task.store(xTaskGetCurrentTaskHandle(), std::memory_order_release);
+    }
+
+    // Una notificación por buffer DMA lleno (las pendientes se conservan)
+    ulTaskNotifyTake(pdFALSE, portMAX_DELAY);
+
+    size_t bytes_read = 0;
+    esp_err_t result = i2s_channel_read(mic_chan, buffer, bytes, &bytes_read, portMAX_DELAY);
+    account_audio_read(result, bytes_read, bytes);
+    return result == ESP_OK ? bytes_read : 0;
+}
+
+size_t AUDIO_IRAM audio_write_block(const int16_t* buffer, size_t bytes) {
+    size_t bytes_written = 0;
+    esp_err_t result = i2s_channel_write(dac_chan, buffer, bytes, &bytes_written, portMAX_DELAY);
+    account_audio_write(result, bytes_written, bytes);
+    return bytes_written;
+}
+
+#else
+
+size_t AUDIO_IRAM audio_read_block(int32_t* buffer, size_t bytes) {
+    size_t bytes_read = 0;
+    esp_err_t result = i2s_read(I2S_PORT_MIC, buffer, bytes, &bytes_read, pdMS_TO_TICKS(I2S_IO_TIMEOUT_MS));
+    account_audio_read(result, bytes_read, bytes);
+    return result == ESP_OK ? bytes_read : 0;
+}
+
+size_t AUDIO_IRAM audio_write_block(const int16_t* buffer, size_t bytes) {
+    size_t bytes_written = 0;
+    esp_err_t result = i2s_write(I2S_PORT_DAC, buffer, bytes, &bytes_written, pdMS_TO_TICKS(I2S_IO_TIMEOUT_MS));
+    account_audio_write(result, bytes_written, bytes);
+    return bytes_written;
+}
+
+#endif
+
+void AUDIO_IRAM account_audio_read(esp_err_t result, size_t bytes_read, size_t bytes_requested) {
+    if (result != ESP_OK || bytes_read == 0) {
+        stream_stats.read_timeouts++;
+    } else if (bytes_read < bytes_requested) {
+        stream_stats.short_reads++;
+    }
+}
+
+void AUDIO_IRAM account_audio_write(esp_err_t result, size_t bytes_written, size_t bytes_requested) {
+    if (result != ESP_OK || bytes_written < bytes_requested) {
+        stream_stats.short_writes++;
+    }
+}
+
+void AUDIO_IRAM account_audio_block_done() {
+    if (stats_reset_pending.load(std::memory_order_acquire)) {
+        clear_stream_stats();
+        stats_reset_pending.store(false, std::memory_order_release);
+        stats_resync_pending.store(true, std::memory_order_relaxed);
+    }
+
+    const int64_t now = esp_timer_get_time();
+    if (stats_resync_pending.exchange(false, std::memory_order_acq_rel)) {
+        // Primer bloque tras start/stop/reset: sin periodo de referencia
+        last_block_time_us = now;
+    } else {
+        uint32_t period = (uint32_t)(now - last_block_time_us);
+        uint32_t jitter = period > nominal_block_us ? period - nominal_block_us
+                                                    : nominal_block_us - period;
+        last_block_time_us = now;
+
+        if (stream_stats.periods == 0 || period < stream_stats.period_min_us) {
+            stream_stats.period_min_us = period;
+        }
+        if (period > stream_stats.period_max_us) stream_stats.period_max_us = period;
+        if (jitter > stream_stats.jitter_max_us) stream_stats.jitter_max_us = jitter;
+        if (jitter > window_jitter_max_us.load(std::memory_order_relaxed)) {
+            window_jitter_max_us.store(jitter, std::memory_order_relaxed);
+        }
+        if (period > BLOCK_LATE_FACTOR * nominal_block_us) stream_stats.late_blocks++;
+        stream_stats.jitter_sum_us += jitter;
+        stream_stats.periods++;
+    }
+
+    stream_stats.blocks++;
+    drain_i2s_events();
+}
+
+// ==================== ESTADÍSTICAS DEL FLUJO (CORE 1) ====================
+
+void get_audio_stream_stats(audio_stream_stats_t* stats) {
+    // Instantánea: Core 0 sigue escribiendo, los campos pueden diferir en un bloque
+    memcpy(stats, &stream_stats, sizeof(*stats));
+}
+
+void reset_audio_stream_stats() {
+    stats_reset_pending.store(true, std::memory_order_release);
+}
+
+void print_audio_stream_stats() {
+    audio_stream_stats_t s;
+    get_audio_stream_stats(&s);
+    const uint32_t jitter_avg = s.periods > 0 ? (uint32_t)(s.jitter_sum_us / s.periods) : 0;
+    const int32_t dma_offset = (int32_t)(s.rx_dma_buffers - s.tx_dma_buffers);
+
+    Serial.println("\n📈 FLUJO DE AUDIO I2S");
+    Serial.println("════════════════════════════════════");
+    Serial.printf("📦 Bloques procesados: %lu (periodo nominal %lu us)\n",
+                  (unsigned long)s.blocks, (unsigned long)nominal_block_us);
+    Serial.printf("🎤 RX overflows: %lu | lecturas cortas: %lu | timeouts: %lu\n",
+                  (unsigned long)s.rx_overflows, (unsigned long)s.short_reads,
+                  (unsigned long)s.read_timeouts);
+    Serial.printf("🔊 TX underruns: %lu | escrituras cortas: %lu\n",
+                  (unsigned long)s.tx_underruns, (unsigned long)s.short_writes);
+    Serial.printf("⚠️ Errores DMA: %lu\n", (unsigned long)s.dma_errors);
+    if (s.periods > 0) {
+        Serial.printf("⏱️ Periodo min/max: %lu/%lu us | jitter avg/max: %lu/%lu us\n",
+                      (unsigned long)s.period_min_us, (unsigned long)s.period_max_us,
+                      (unsigned long)jitter_avg, (unsigned long)s.jitter_max_us);
+        Serial.printf("🐢 Bloques tardíos (> %.1fx nominal): %lu\n",
+                      BLOCK_LATE_FACTOR, (unsigned long)s.late_blocks);
+    }
+    Serial.printf("🔁 Buffers DMA RX/TX: %lu/%lu (diferencia %+ld)\n",
+                  (unsigned long)s.rx_dma_buffers, (unsigned long)s.tx_dma_buffers,
+                  (long)dma_offset);
+
+    // Orientación sobre la causa de los cortes
+    if (s.rx_overflows > 0 || s.late_blocks > 0 || s.read_timeouts > 0) {
+        Serial.println("💡 Core 0 no llega a tiempo (DSP o bloqueos): revisar 'perf'");
+    } else if (s.tx_underruns > 0) {
+        Serial.println("💡 Underruns sin overflows: posible deriva de reloj RX/TX");
+    } else if (s.blocks > 0) {
+        Serial.println("✅ Sin cortes registrados");
+    }
+    Serial.println("════════════════════════════════════");
+}
+
+// Una línea por segundo con los incrementos de cada contador
+void monitor_i2s_realtime_stats(uint32_t duration_seconds) {
+    audio_stream_stats_t prev, cur;
+    get_audio_stream_stats(&prev);
+    window_jitter_max_us.store(0, std::memory_order_relaxed);
+
+    Serial.printf("\n📡 MONITOR I2S (%lu s, cualquier tecla para salir)\n", (unsigned long)duration_seconds);
+    Serial.println("   t  bloques  ovf  und  cortR  cortW  tout  jit_avg  jit_max  tardíos  RX-TX");
+
+    for (uint32_t t = 1; t <= duration_seconds; t++) {
+        delay(1000);
+        get_audio_stream_stats(&cur);
+        uint32_t periods = cur.periods - prev.periods;
+        uint32_t jitter_avg = periods > 0 ? (uint32_t)((cur.jitter_sum_us - prev.jitter_sum_us) / periods) : 0;
+
+        Serial.printf("%4lu %8lu %4lu %4lu %6lu %6lu %5lu %6lu us %6lu us %8lu %+6ld\n",
+                      (unsigned long)t,
+                      (unsigned long)(cur.blocks - prev.blocks),
+                      (unsigned long)(cur.rx_overflows - prev.rx_overflows),
+                      (unsigned long)(cur.tx_underruns - prev.tx_underruns),
+                      (unsigned long)(cur.short_reads - prev.short_reads),
+                      (unsigned long)(cur.short_writes - prev.short_writes),
+                      (unsigned long)(cur.read_timeouts - prev.read_timeouts),
+                      (unsigned long)jitter_avg,
+                      (unsigned long)window_jitter_max_us.exchange(0, std::memory_order_relaxed),
+                      (unsigned long)(cur.late_blocks - prev.late_blocks),
+                      (long)(int32_t)(cur.rx_dma_buffers - cur.tx_dma_buffers));
+        prev = cur;
+
+        if (Serial.available()) {
+            while (Serial.available()) Serial.read();
+            break;
+        }
+    }
+    Serial.println("✅ Monitor I2S finalizado");
+}
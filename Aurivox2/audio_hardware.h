@@ -40,8 +40,8 @@ void stop_audio_streams(void);
 /**
  * @brief Reiniciar streams de audio
  * 
- * Combina stop_audio_streams() + delay + start_audio_streams()
- * para reinicio limpio del sistema de audio.
+ * stop_audio_streams() + start_audio_streams() sin pausa: los drivers
+ * y los buffers DMA no se reinstalan. Con Core 0 aparcado.
  */
 void restart_audio_streams(void);
 
@@ -63,6 +63,92 @@ bool is_i2s_hardware_ready(void);
  */
 bool are_audio_streams_running(void);
 
+// ==================== E/S DE BLOQUES (CORE 0) ====================
+
+/**
+ * @brief Esperar y leer un bloque del micrófono
+ *
+ * LEGACY: i2s_read con timeout de 10 ms. STD: la tarea duerme hasta que
+ * la ISR del DMA notifica un buffer lleno (una vez por bloque, sin
+ * timeout) y lo recoge del driver.
+ *
+ * @param[out] buffer Destino (BUFFER_SIZE palabras de 32 bits del formato activo)
+ * @param bytes Tamaño de buffer en bytes
+ * @return Bytes leídos; 0 si no hay bloque que procesar (contabilizado)
+ */
+size_t audio_read_block(int32_t* buffer, size_t bytes);
+
+/**
+ * @brief Escribir un bloque al DAC
+ *
+ * Bloquea hasta que hay un buffer DMA libre (LEGACY: como mucho 10 ms).
+ *
+ * @return Bytes escritos (escrituras cortas contabilizadas)
+ */
+size_t audio_write_block(const int16_t* buffer, size_t bytes);
+
+// ==================== CONTABILIDAD DEL FLUJO DE AUDIO ====================
+
+/**
+ * @brief Contadores del flujo I2S (escritos solo por Core 0)
+ *
+ * Los overflows/underruns salen de las colas de eventos del driver
+ * (LEGACY) o de los callbacks del DMA (STD);
+ * el jitter es la desviación entre bloques completados consecutivos
+ * respecto al periodo nominal BUFFER_SIZE / SAMPLE_RATE.
+ */
+typedef struct {
+    uint32_t blocks;               // Bloques completados
+    uint32_t rx_overflows;         // I2S_EVENT_RX_Q_OVF: lectura tardía, audio perdido
+    uint32_t tx_underruns;         // I2S_EVENT_TX_Q_OVF: escritura tardía, DAC sin datos
+    uint32_t dma_errors;           // I2S_EVENT_DMA_ERROR en cualquier puerto
+    uint32_t read_timeouts;        // Lectura sin datos (LEGACY: timeout de 10 ms)
+    uint32_t short_reads;          // Menos bytes que un bloque completo
+    uint32_t short_writes;         // Escritura incompleta o con error
+    uint32_t rx_dma_buffers;       // Buffers DMA completados por el micrófono
+    uint32_t tx_dma_buffers;       // Buffers DMA consumidos por el DAC
+    uint32_t periods;              // Periodos medidos (excluye el primero tras start)
+    uint32_t period_min_us;
+    uint32_t period_max_us;
+    uint32_t jitter_max_us;        // max |periodo - nominal|
+    uint64_t jitter_sum_us;        // Σ |periodo - nominal| (media = suma / periods)
+    uint32_t late_blocks;          // Periodo > 1.5 × nominal
+} audio_stream_stats_t;
+
+/**
+ * @brief Registrar el resultado de una lectura (solo Core 0)
+ */
+void account_audio_read(esp_err_t result, size_t bytes_read, size_t bytes_requested);
+
+/**
+ * @brief Registrar el resultado de una escritura (solo Core 0)
+ */
+void account_audio_write(esp_err_t result, size_t bytes_written, size_t bytes_requested);
+
+/**
+ * @brief Cerrar un bloque: mide el periodo y vacía los eventos I2S
+ *
+ * Solo Core 0, una vez por bloque tras audio_write_block(). No bloquea.
+ */
+void account_audio_block_done(void);
+
+/**
+ * @brief Copiar los contadores actuales (instantánea desde Core 1)
+ *
+ * @param[out] stats Estructura destino
+ */
+void get_audio_stream_stats(audio_stream_stats_t* stats);
+
+/**
+ * @brief Pedir poner a cero los contadores (efectivo en el siguiente bloque)
+ */
+void reset_audio_stream_stats(void);
+
+/**
+ * @brief Mostrar contadores acumulados y posible causa de los cortes
+ */
+void print_audio_stream_stats(void);
+
 // ==================== FUNCIONES DE INFORMACIÓN Y DIAGNÓSTICO ====================
 
 /**
@@ -94,12 +180,36 @@ void diagnose_i2s_hardware(void);
  * @brief Obtener latencia actual del sistema de audio
  * 
  * Calcula la latencia teórica basada en el tamaño de buffer
- * y sample rate actual.
+ * y sample rate actual: un bloque de captura + la cola DMA del DAC +
+ * la anticipación del limitador (get_dsp_latency_samples()).
  * 
- * @return Latencia en milisegundos (float)
+ * @return Latencia micrófono → altavoz en milisegundos (float)
  */
 float get_current_audio_latency_ms(void);
 
+/**
+ * @brief Latencia teórica del lazo DAC → micrófono
+ *
+ * Solo E/S: un bloque de captura + la cola DMA del DAC. Es lo que mide
+ * run_latency_test() (el MLS entra en el bloque ya procesado) y el
+ * retardo del AFC, cuya referencia es ese mismo bloque: el retardo del
+ * limitador ya va dentro de la referencia.
+ *
+ * @return Latencia en milisegundos (float)
+ */
+float get_audio_loop_latency_ms(void);
+
+/**
+ * @brief Tiempo que aguanta el DMA con Core 0 parado
+ *
+ * Mientras se escribe en flash los dos cores se detienen y solo el DMA
+ * sigue: el buffer en curso más los llenos sin leer (I2S_DMA_BUF_COUNT - 1
+ * bloques). Una parada más larga pierde audio (overflow RX / underrun TX).
+ *
+ * @return Colchón en milisegundos con el formato activo
+ */
+float get_audio_dma_cushion_ms(void);
+
 /**
  * @brief Obtener información detallada de memoria de audio
  * 
@@ -152,6 +262,7 @@ void exit_i2s_low_power_mode(void);
  * 
  * @return true si la calibración fue exitosa
  * @return false si se detectaron problemas
+ * @see freq_response.cpp (silencio + multitono en las bandas del EQ, < 0.5 s)
  */
 bool run_audio_system_calibration(void);
 
@@ -162,7 +273,8 @@ bool run_audio_system_calibration(void);
  * de ruido de fondo del micrófono en condiciones de silencio.
  * 
  * @param duration_ms Duración de la medición en milisegundos
- * @return Nivel de ruido RMS en dB SPL (aproximado)
+ * @return Nivel de ruido RMS en dB SPL (aproximado); NAN sin audio
+ * @see freq_response.cpp
  */
 float measure_microphone_noise_floor(uint32_t duration_ms);
 
@@ -175,6 +287,7 @@ float measure_microphone_noise_floor(uint32_t duration_ms);
  * @param test_frequencies Array de frecuencias a probar (Hz)
  * @param num_frequencies Número de frecuencias en el array
  * @return true si todas las frecuencias pasan la prueba
+ * @see freq_response.cpp (un Goertzel por frecuencia en una sola pasada)
  */
 bool test_frequency_response(const float* test_frequencies, size_t num_frequencies);
 
@@ -193,10 +306,14 @@ void set_i2s_debug_logging(bool enable);
 /**
  * @brief Mostrar estadísticas en tiempo real del I2S
  * 
- * Muestra información continua sobre el rendimiento del I2S:
+ * Muestra información continua sobre el rendimiento del I2S, una línea
+ * por segundo con los incrementos de cada contador:
  * - Buffers procesados
- * - Underruns/overruns
- * - Throughput actual
+ * - Underruns/overruns, lecturas/escrituras cortas y timeouts
+ * - Jitter medio y máximo entre bloques
+ * - Diferencia de buffers DMA RX-TX (deriva de reloj)
+ * 
+ * Bloquea Core 1; se interrumpe con cualquier carácter por Serial.
  * 
  * @param duration_seconds Duración del monitoreo
  */
@@ -210,30 +327,19 @@ void monitor_i2s_realtime_stats(uint32_t duration_seconds);
  */
 void generate_hardware_support_report(void);
 
-// ==================== FUNCIONES EXPERIMENTALES ====================
-
-/**
- * @brief Cambiar sample rate dinámicamente (EXPERIMENTAL)
- * 
- * Permite cambiar el sample rate sin reinicializar completamente
- * el hardware I2S.
- * 
- * @warning Esta función es experimental y puede causar glitches
- * @param new_sample_rate Nuevo sample rate en Hz
- * @return true si el cambio fue exitoso
- */
-bool change_sample_rate_dynamic(uint32_t new_sample_rate);
+// ==================== CAMBIO DE FORMATO ====================
 
 /**
- * @brief Ajustar tamaño de buffer dinámicamente (EXPERIMENTAL)
+ * @brief Liberar drivers y canales I2S (detiene antes los streams)
  * 
- * Modifica el tamaño de buffer DMA para optimizar latencia vs estabilidad.
+ * Para cambiar SAMPLE_RATE/BUFFER_SIZE: la frecuencia fija los relojes y
+ * el bloque la longitud de los buffers DMA, así que ambos puertos se
+ * vuelven a crear con initialize_i2s_hardware() y el nuevo formato.
  * 
- * @warning Función experimental, puede afectar estabilidad
- * @param new_buffer_size Nuevo tamaño de buffer en muestras
- * @return true si el cambio fue exitoso
+ * @warning La tarea de audio debe estar parada (sin lecturas/escrituras en curso)
+ * @see switch_audio_format() en Aurivox2.ino
  */
-bool adjust_buffer_size_dynamic(size_t new_buffer_size);
+void deinitialize_i2s_hardware(void);
 
 // ==================== MACROS DE CONVENIENCIA ====================
 
@@ -291,7 +397,7 @@ typedef struct {
         uint8_t lrclk_pin;             // Pin LRCLK  
         uint8_t data_pin;              // Pin DATA
         uint32_t sample_rate;          // Sample rate actual
-        i2s_bits_per_sample_t bits;    // Bits por muestra
+        uint8_t bits;                  // Bits por muestra
         bool is_active;                // Estado activo
     } microphone;
     
@@ -302,7 +408,7 @@ typedef struct {
         uint8_t lrclk_pin;             // Pin LRCLK
         uint8_t data_pin;              // Pin DATA
         uint32_t sample_rate;          // Sample rate actual
-        i2s_bits_per_sample_t bits;    // Bits por muestra
+        uint8_t bits;                  // Bits por muestra
         bool is_active;                // Estado activo
     } dac;
     
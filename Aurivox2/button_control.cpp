@@ -3,9 +3,13 @@
 // Versión limpia - Manejo de ISRs, debounce, sleep y sistema de pips
 
 #include "Arduino.h"
+#include <math.h>
+#include <atomic>
 #include "esp_sleep.h"
 #include "driver/rtc_io.h"
 #include "audio_config.h"
+#include "dsp_pipeline.h"
+#include "dsp_kernels.h"     // AUDIO_IRAM
 #include "button_control.h"  // Para acceder a los tipos definidos en el header
 
 // ==================== DEFINICIONES DE PINES ====================
@@ -18,6 +22,7 @@
 
 #define DEBOUNCE_DELAY      50    // 50ms debounce
 #define SLEEP_HOLD_TIME     3000  // 3 segundos para activar sleep
+#define SLEEP_MUTE_TIMEOUT_MS 200   // Rampa + vaciado DMA con el mayor bloque (~100 ms)
 
 // ==================== VARIABLES GLOBALES DE BOTONES ====================
 
@@ -42,37 +47,152 @@ extern const float gain_levels[5];
 // Declaraciones de funciones externas
 extern void stop_audio_streams();
 extern void start_audio_streams();
+extern bool park_audio_task();
+extern void resume_audio_task();
+extern void store_boot_config();
 
 // Declaración de función interna
 static void enter_sleep_mode();
 
 // ==================== SISTEMA DE PIPS ====================
 
-// Usar la estructura PipSystem definida en audio_config.h
-static PipSystem pip_system = {false, 0, 0, 0, 0, 0, false, 0.0};
-
-// Iniciar secuencia de pips
+/*
+ * Generador de pips por bloques (sin trig ni Serial en Core 0):
+ *
+ *   Core 1 (botones/comandos)              Core 0 (audioTask)
+ *   start/stop_pip_sequence() ──pip_request──▶ mix_pip_audio(bloque)
+ *   report_pip_events()      ◀─pip_completed── fin de secuencia
+ *
+ * El tono sale de una tabla de seno con acumulador de fase de 32 bits
+ * e interpolación lineal. Pips y gaps se cuentan en muestras. El pip se
+ * suma a la salida procesada con rampa coseno y atenúa el micrófono
+ * (PIP_DUCK_GAIN) mientras suena, en lugar de sustituirlo.
+ */
+
+#define PIP_TABLE_SIZE      (1 << PIP_WAVETABLE_BITS)
+#define PIP_STOP_REQUEST    (-1)
+
+// Usar la estructura PipSystem definida en audio_config.h (solo Core 0)
+static PipSystem pip_system = {false, 0, 0, 0, 0, false, 0};
+
+static float pip_wavetable[PIP_TABLE_SIZE + 1];   // +1: guarda para interpolar
+static uint32_t pip_phase_step = 0;               // PIP_FREQUENCY en 2^32/fs
+static uint32_t pip_fade_step = 0;                // Cuarto de ciclo en PIP_FADE_SAMPLES
+
+// Intercambio entre núcleos: >0 nueva secuencia, PIP_STOP_REQUEST, 0 nada
+static std::atomic<int> pip_request(0);
+static std::atomic<bool> pip_running(false);
+static std::atomic<int> pip_completed(0);           // Pips de la última secuencia acabada
+
+// Iniciar secuencia de pips (Core 1)
 static void start_pip_sequence(int num_pips) {
-    pip_system.active = true;
-    pip_system.total_pips = num_pips;
-    pip_system.remaining_pips = num_pips;
-    pip_system.samples_in_current_pip = PIP_SAMPLES;
-    pip_system.pip_start_time = millis();
-    pip_system.in_gap = false;
-    pip_system.phase = 0.0;
-    
+    pip_request.store(num_pips, std::memory_order_release);
     Serial.printf("🔔 Iniciando secuencia de %d pips\n", num_pips);
 }
 
-// Detener sistema de pips
+// Detener sistema de pips (Core 1)
 static void stop_pip_sequence() {
-    pip_system.active = false;
-    pip_system.remaining_pips = 0;
-    pip_system.in_gap = false;
-    pip_system.phase = 0.0;
+    pip_request.store(PIP_STOP_REQUEST, std::memory_order_release);
     Serial.println("🔔 Pips detenidos");
 }
 
+// Mensajes diferidos del generador (Core 1)
+static void report_pip_events() {
+    int completed = pip_completed.exchange(0, std::memory_order_acquire);
+    if (completed > 0) {
+        Serial.printf("🔔 Secuencia de %d pips completada\n", completed);
+    }
+}
+
+// Pasos de fase del formato activo (setup o cambio de formato, sin audio)
+void update_pip_timing() {
+    pip_phase_step = (uint32_t)((double)PIP_FREQUENCY / SAMPLE_RATE * 4294967296.0);
+    pip_fade_step = (uint32_t)(1073741824.0 / (PIP_FADE_SAMPLES > 0 ? PIP_FADE_SAMPLES : 1));
+    // Una secuencia a medias lleva duraciones del formato anterior
+    pip_request.store(PIP_STOP_REQUEST, std::memory_order_release);
+}
+
+// Tabla de seno y pasos de fase (setup, antes de la tarea de audio)
+static void initialize_pip_generator() {
+    for (int i = 0; i <= PIP_TABLE_SIZE; i++) {
+        pip_wavetable[i] = sinf(2.0f * (float)PI * i / PIP_TABLE_SIZE);
+    }
+    update_pip_timing();
+}
+
+static inline float pip_table_lookup(uint32_t phase) {
+    uint32_t index = phase >> (32 - PIP_WAVETABLE_BITS);
+    float frac = (float)(phase << PIP_WAVETABLE_BITS) * 2.3283064e-10f;  // · 2^-32
+    float a = pip_wavetable[index];
+    return a + (pip_wavetable[index + 1] - a) * frac;
+}
+
+// Aplicar la última petición de Core 1 al inicio del bloque (Core 0)
+static void AUDIO_IRAM apply_pip_request() {
+    int request = pip_request.exchange(0, std::memory_order_acquire);
+    if (request > 0) {
+        pip_system.active = true;
+        pip_system.total_pips = request;
+        pip_system.remaining_pips = request;
+        pip_system.segment_samples = PIP_SAMPLES;
+        pip_system.pip_position = 0;
+        pip_system.in_gap = false;
+        pip_system.phase = 0;
+        pip_running.store(true, std::memory_order_release);
+    } else if (request == PIP_STOP_REQUEST) {
+        pip_system.active = false;
+        pip_system.remaining_pips = 0;
+        pip_system.in_gap = false;
+        pip_running.store(false, std::memory_order_release);
+    }
+}
+
+// Fin del pip o gap actual → siguiente segmento (Core 0)
+static void AUDIO_IRAM advance_pip_segment() {
+    if (pip_system.in_gap) {
+        pip_system.in_gap = false;
+        pip_system.segment_samples = PIP_SAMPLES;
+        pip_system.pip_position = 0;
+        pip_system.phase = 0;
+    } else if (--pip_system.remaining_pips > 0) {
+        pip_system.in_gap = true;
+        pip_system.segment_samples = PIP_GAP_SAMPLES;
+    } else {
+        pip_system.active = false;
+        pip_running.store(false, std::memory_order_release);
+        pip_completed.store(pip_system.total_pips, std::memory_order_release);
+    }
+}
+
+// Sumar num_samples del pip actual al bloque (Core 0)
+static void AUDIO_IRAM mix_pip_tone(dsp_sample_t* block, int num_samples) {
+    const float amplitude = (float)PIP_AMPLITUDE;
+    const float duck_depth = 1.0f - PIP_DUCK_GAIN;
+    uint32_t phase = pip_system.phase;
+    int position = pip_system.pip_position;
+
+    for (int i = 0; i < num_samples; i++, position++) {
+        // Rampa coseno alzado: sin²(π/2 · k/F) en los F extremos del pip
+        int edge = min(position, PIP_SAMPLES - 1 - position);
+        float env = 1.0f;
+        if (edge < PIP_FADE_SAMPLES) {
+            float s = pip_table_lookup((uint32_t)edge * pip_fade_step);
+            env = s * s;
+        }
+        float tone = pip_table_lookup(phase) * amplitude;
+#if DSP_FIXED_POINT
+        float mic = q_to_float(block[i], DSP_Q_FRAC_BITS);
+        block[i] = q_from_float(mic * (1.0f - duck_depth * env) + tone * env, DSP_Q_FRAC_BITS);
+#else
+        block[i] = block[i] * (1.0f - duck_depth * env) + tone * env;
+#endif
+        phase += pip_phase_step;
+    }
+
+    pip_system.phase = phase;
+    pip_system.pip_position = position;
+}
+
 // ==================== ISRs OPTIMIZADAS ====================
 
 void IRAM_ATTR btn_gain_up_isr() {
@@ -109,6 +229,8 @@ static void handle_gain_buttons() {
         if (current_gain_level < 4) {
             current_gain_level++;
             gain_factor = gain_levels[current_gain_level];
+            set_dsp_output_gain(gain_factor);
+            store_boot_config();
             Serial.printf("🔊 Ganancia: %.0f%% (Nivel %d/5)\n", 
                           gain_factor * 100, current_gain_level + 1);
             
@@ -127,6 +249,8 @@ static void handle_gain_buttons() {
         if (current_gain_level > 0) {
             current_gain_level--;
             gain_factor = gain_levels[current_gain_level];
+            set_dsp_output_gain(gain_factor);
+            store_boot_config();
             Serial.printf("🔉 Ganancia: %.0f%% (Nivel %d/5)\n", 
                           gain_factor * 100, current_gain_level + 1);
             
@@ -195,27 +319,43 @@ static void handle_sleep_button() {
 
 // ==================== FUNCIÓN DE SLEEP MODE ====================
 
+/*
+ * Light sleep con el estado DSP conservado:
+ *
+ *   rampa a 0 ──▶ aparcar Core 0 ──▶ parar I2S ──▶ light sleep
+ *                                                     │ D1
+ *   rampa a 1 ◀── espera mic ◀── reanudar Core 0 ◀── I2S en marcha
+ *
+ * Los drivers I2S y sus buffers DMA siguen instalados (solo se paran los
+ * canales) y el light sleep conserva la SRAM: los sets DSP, con sus
+ * estados de filtros y la envolvente del WDRC, están intactos al
+ * despertar. No hay que reinstalar nada ni recargar la configuración.
+ */
+
 static void enter_sleep_mode() {
     Serial.println("💤 Iniciando secuencia de sleep...");
     
     // Detener sistema de pips
     stop_pip_sequence();
     
-    // Marcar sistema como durmiendo
-    audio_processing_active = false;
-    system_sleeping = true;
+    // Salida a cero con rampa y cola DMA vaciada antes de parar: sin pop
+    set_dsp_output_mute(true);
+    const uint32_t mute_start = millis();
+    while (!is_dsp_output_muted() && millis() - mute_start < SLEEP_MUTE_TIMEOUT_MS) {
+        vTaskDelay(pdMS_TO_TICKS(1));
+    }
     
-    Serial.println("💤 Deteniendo streams de audio...");
+    // Core 0 entre bloques: ningún read/write queda esperando a un canal parado
+    if (!park_audio_task()) {
+        Serial.println("⚠️ La tarea de audio no se detiene a tiempo");
+    }
+    system_sleeping = true;
     stop_audio_streams();
     
-    // Pequeña pausa para estabilidad
-    delay(100);
-    
-    Serial.println("💤 Configurando wake-up por botón D1...");
     // Configurar wake-up solo por botón D1 (BTN_SLEEP)
     esp_sleep_enable_ext0_wakeup(GPIO_NUM_1, 0);  // Wake up cuando D1 = LOW
     
-    Serial.println("💤 Entrando en light sleep...");
+    Serial.println("💤 Entrando en light sleep (wake: botón D1)...");
     Serial.flush();  // Asegurar que se imprima antes del sleep
     
     // Entrar en light sleep
@@ -223,17 +363,19 @@ static void enter_sleep_mode() {
     
     // ==================== AL DESPERTAR ====================
     
-    Serial.println("⚡ DESPERTANDO del sleep...");
-    
-    // Restaurar estado del sistema
+    // Primero el audio, los mensajes después
+    const uint32_t wake_us = micros();
+    start_audio_streams();
     system_sleeping = false;
-    audio_processing_active = true;
+    set_dsp_output_mute(false);   // DSP_UNMUTE_HOLD_MS en silencio y rampa de subida
+    resume_audio_task();
+    const uint32_t resume_us = micros() - wake_us;
+    
     btn_sleep_held = false;
     sleep_sequence_started = false;
     
-    Serial.println("⚡ Reiniciando streams de audio...");
-    start_audio_streams();
-    
+    Serial.printf("⚡ DESPERTANDO: audio en marcha en %.1f ms (+%d ms hasta volumen pleno)\n",
+                  resume_us / 1000.0f, DSP_UNMUTE_HOLD_MS + DSP_MUTE_RAMP_MS);
     Serial.printf("⚡ Sistema restaurado - Ganancia: %.0f%% (Nivel %d/5)\n", 
                   gain_factor * 100, current_gain_level + 1);
     
@@ -248,6 +390,9 @@ void initialize_buttons() {
     Serial.println("🔘 INICIALIZANDO SISTEMA DE BOTONES");
     Serial.println("────────────────────────────────────");
     
+    // Tabla de seno del generador de pips
+    initialize_pip_generator();
+    
     // Configurar pines como entrada con pull-up
     pinMode(BTN_GAIN_UP, INPUT_PULLUP);
     pinMode(BTN_GAIN_DOWN, INPUT_PULLUP);
@@ -274,6 +419,8 @@ void initialize_buttons() {
 
 // Manejar eventos de botones (llamada desde Core 1)
 void handle_button_events() {
+    report_pip_events();
+
     if (system_sleeping) {
         return;  // No procesar botones si el sistema está durmiendo
     }
@@ -282,63 +429,33 @@ void handle_button_events() {
     handle_sleep_button();
 }
 
-// Procesar audio de pips (llamada desde Core 0)
-bool process_pip_audio(int16_t* buffer, int num_samples) {
-    if (!pip_system.active) {
-        return false;  // No hay pips activos
-    }
-    
-    const float phase_increment = 2.0 * PI * PIP_FREQUENCY / SAMPLE_RATE;
-    
-    for (int i = 0; i < num_samples; i++) {
-        if (pip_system.in_gap) {
-            // Silencio entre pips
-            buffer[i] = 0;
-            
-            // Verificar si termina el gap
-            if (millis() - pip_system.pip_gap_start >= PIP_GAP_MS) {
-                pip_system.in_gap = false;
-                pip_system.samples_in_current_pip = PIP_SAMPLES;
-                pip_system.pip_start_time = millis();
-            }
-        } else {
-            // Generar tono del pip
-            if (pip_system.samples_in_current_pip > 0) {
-                buffer[i] = (int16_t)(sin(pip_system.phase) * PIP_AMPLITUDE * 32767);
-                pip_system.phase += phase_increment;
-                if (pip_system.phase >= 2.0 * PI) {
-                    pip_system.phase -= 2.0 * PI;
-                }
-                pip_system.samples_in_current_pip--;
-            } else {
-                // Termina este pip
-                pip_system.remaining_pips--;
-                if (pip_system.remaining_pips > 0) {
-                    // Iniciar gap antes del siguiente pip
-                    pip_system.in_gap = true;
-                    pip_system.pip_gap_start = millis();
-                    buffer[i] = 0;
-                } else {
-                    // Terminar secuencia completa
-                    pip_system.active = false;
-                    buffer[i] = 0;
-                    Serial.printf("🔔 Secuencia de %d pips completada\n", pip_system.total_pips);
-                }
-            }
+// Mezclar pips en el bloque procesado (llamada desde Core 0)
+void AUDIO_IRAM mix_pip_audio(dsp_sample_t* block, int num_samples) {
+    apply_pip_request();
+
+    int done = 0;
+    while (pip_system.active && done < num_samples) {
+        int run = min(pip_system.segment_samples, num_samples - done);
+        if (!pip_system.in_gap) {
+            mix_pip_tone(block + done, run);
+        }
+        done += run;
+        pip_system.segment_samples -= run;
+        if (pip_system.segment_samples == 0) {
+            advance_pip_segment();
         }
     }
-    
-    return true;  // Se procesaron pips
 }
 
 // Verificar si hay pips activos
 bool are_pips_active() {
-    return pip_system.active;
+    return pip_request.load(std::memory_order_acquire) > 0 ||
+           pip_running.load(std::memory_order_acquire);
 }
 
 // Forzar detener pips (útil para comandos)
 void force_stop_pips() {
-    if (pip_system.active) {
+    if (are_pips_active()) {
         stop_pip_sequence();
     }
 }
@@ -356,11 +473,14 @@ void get_button_status() {
     Serial.println("");
     Serial.printf("🎚️ Ganancia actual: %.0f%% (Nivel %d/5)\n", 
                   gain_factor * 100, current_gain_level + 1);
-    Serial.printf("🔔 Pips activos: %s\n", pip_system.active ? "SÍ" : "NO");
-    if (pip_system.active) {
+    Serial.printf("🔔 Pips activos: %s\n", are_pips_active() ? "SÍ" : "NO");
+    if (are_pips_active()) {
+        // Instantánea del estado de Core 0 (solo diagnóstico)
         Serial.printf("   └─ Pips restantes: %d/%d\n", pip_system.remaining_pips, pip_system.total_pips);
         Serial.printf("   └─ En gap: %s\n", pip_system.in_gap ? "SÍ" : "NO");
     }
+    Serial.printf("   └─ Tono: %d Hz, %d ms + %d ms gap, rampa %d ms (%d muestras)\n",
+                  PIP_FREQUENCY, PIP_DURATION_MS, PIP_GAP_MS, PIP_FADE_MS, PIP_FADE_SAMPLES);
     Serial.printf("💤 Sistema durmiendo: %s\n", system_sleeping ? "SÍ" : "NO");
     Serial.printf("🎵 Audio activo: %s\n", audio_processing_active ? "SÍ" : "NO");
     Serial.println("════════════════════════════════════");
@@ -381,10 +501,12 @@ void test_button_system() {
         Serial.printf("🔔 Probando %d pip(s)...\n", i);
         start_pip_sequence(i);
         
-        // Esperar a que terminen los pips
-        while (pip_system.active) {
+        // Esperar a que terminen los pips (con límite si el audio está parado)
+        unsigned long timeout = millis() + i * (PIP_DURATION_MS + PIP_GAP_MS) + 500;
+        while (are_pips_active() && (long)(millis() - timeout) < 0) {
             delay(50);
         }
+        report_pip_events();
         delay(500);  // Pausa entre tests
     }
     
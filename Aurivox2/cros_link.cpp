@@ -0,0 +1,618 @@
+// ==================== CROS_LINK.CPP ====================
+// Enlace de audio entre audífonos (CROS/BiCROS) por ESP-NOW para Aurivox v3.0
+
+#include "Arduino.h"
+#include <string.h>
+#include <atomic>
+#include "esp_wifi.h"
+#include "esp_now.h"
+#include "esp_event.h"
+#include "esp_netif.h"
+#include "esp_idf_version.h"
+#include "cros_link.h"
+#include "dsp_fixed.h"
+#include "dsp_kernels.h"     // AUDIO_IRAM
+#include "memory_plan.h"
+
+/*
+ * UN BLOQUE POR TRAMA, SIN TOCAR LOS PLAZOS DE CORE 0
+ * =================================================
+ *
+ *  EMISOR                                  RECEPTOR
+ *  Core 0          Core 1 (tarea radio)    Core 1 (tarea WiFi)       Core 0
+ *  mic ─▶ int16 ─▶ [anillo] ─▶ ADPCM ─▶ ESP-NOW ─▶ ADPCM⁻¹ ─▶ [jitter] ─▶ mezcla ─▶ DSP
+ *        (aviso)   TX_SLOTS    + cabecera  (aire)   cb recv   SLOTS = seq&7
+ *
+ * Core 0 solo copia muestras y lee/escribe índices atómicos: codificar,
+ * enviar y decodificar pasan en Core 1 (la tarea del driver WiFi se fija
+ * a Core 1 en esp_wifi_init). ADPCM IMA: 4 bits por muestra, un bloque de
+ * 128 muestras son 64 bytes + 15 de cabecera.
+ *
+ * Buffer de recepción: ranura = seq & (SLOTS - 1), publicada con un
+ * seqlock (seq inválido → datos → seq) para que Core 0 nunca lea un
+ * bloque a medio escribir. Core 0 reproduce next_seq y mantiene
+ * 'depth' bloques de colchón detrás del último recibido:
+ *
+ *   recibidos    ... [n-3] [n-2] [n-1] [ n ]       depth = 2
+ *                                 ▲
+ *                              next_seq = n - depth + 1
+ *
+ *   - ranura vacía con seq ≤ último: trama perdida → ocultación, avanza
+ *   - aún no ha llegado (seq > último): se repite sin avanzar; absorbe
+ *     que el reloj I2S del receptor corra más que el del emisor
+ *   - colchón > depth + CROS_LINK_DRIFT_MARGIN: salto al colchón nominal
+ *     (reloj del emisor más rápido, o ráfaga tras un corte)
+ *
+ * Ocultación: el último bloque bueno se repite a -6 dB por bloque perdido.
+ * Tras CROS_LINK_TIMEOUT_MS sin tramas el enlace se da por caído y el
+ * receptor vuelve a su micrófono.
+ */
+
+#define JITTER_MASK         (CROS_LINK_JITTER_SLOTS - 1)
+#define TX_MASK             (CROS_LINK_TX_SLOTS - 1)
+#define SLOT_EMPTY          0xFFFFFFFFu
+#define STATS_SMOOTHING     0.05f
+#define ESPNOW_OVERHEAD     43          // Cabecera 802.11 de acción + IE de fabricante + FCS (bytes)
+#define PHY_PREAMBLE_US     192         // Preámbulo largo DSSS a 1 Mbps
+
+extern float samples_to_ms(int samples);
+extern float get_current_audio_latency_ms();
+
+static const uint8_t BROADCAST_ADDRESS[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+// IMA ADPCM
+static const int16_t ADPCM_STEPS[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+    253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+    3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442,
+    11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
+    32767
+};
+static const int8_t ADPCM_INDEX_STEP[8] = {-1, -1, -1, -1, 2, 4, 6, 8};
+
+struct AdpcmState {
+    int predictor;
+    int index;
+};
+
+struct TxSlot {
+    uint32_t seq;
+    uint32_t capture_us;
+    uint16_t sample_rate;
+    uint16_t samples;
+    int16_t audio[CROS_LINK_MAX_BLOCK];
+};
+
+struct JitterSlot {
+    std::atomic<uint32_t> seq;
+    uint32_t arrival_us;
+    uint16_t capture_age_us;
+    uint16_t samples;
+    int16_t audio[CROS_LINK_MAX_BLOCK];
+};
+
+// Contadores: cada uno lo escribe un único contexto; el comando los lee
+struct LinkCounters {
+    uint32_t tx_frames, tx_errors, tx_overflows;
+    uint32_t rx_frames, rx_lost, rx_late, rx_mismatched;
+    uint32_t concealed, underruns, resyncs, link_drops;
+};
+
+// Peticiones de Core 1
+static std::atomic<int> link_mode(MODE_STANDALONE);
+static std::atomic<int> link_pair_id(0);
+static std::atomic<int> depth_request(CROS_LINK_DEFAULT_DEPTH);
+static std::atomic<bool> play_reset_request(false);
+static std::atomic<bool> rx_restart_request(false);
+static std::atomic<bool> wait_max_reset_request(false);
+
+// Emisión: head lo escribe Core 0, tail la tarea de radio
+static TxSlot tx_ring[CROS_LINK_TX_SLOTS];
+static std::atomic<uint32_t> tx_head(0);
+static std::atomic<uint32_t> tx_tail(0);
+static uint32_t tx_seq = 0;                         // Solo Core 0
+static AdpcmState tx_adpcm = {0, 0};                // Solo la tarea de radio
+
+// Recepción: ranuras y newest los escribe la tarea WiFi, played_seq Core 0
+static JitterSlot jitter[CROS_LINK_JITTER_SLOTS];
+static std::atomic<uint32_t> rx_generation(0);      // +1 en cada (re)arranque de la secuencia
+static std::atomic<uint32_t> rx_first_seq(0);
+static std::atomic<uint32_t> newest_seq(0);
+static std::atomic<uint32_t> played_seq(0);         // Siguiente bloque por reproducir
+static volatile uint16_t rx_frame_bytes = 0;
+
+// Reproducción: solo Core 0 (Core 1 lee el diagnóstico)
+static uint32_t play_generation = 0;
+static uint32_t first_seq = 0;
+static uint32_t next_seq = 0;
+static int missing_run = 0;
+static int16_t remote_block[CROS_LINK_MAX_BLOCK];
+static int16_t last_remote[CROS_LINK_MAX_BLOCK];
+static volatile bool playing = false;
+static volatile int buffered_blocks = 0;
+static volatile float wait_avg_us = 0.0f;
+static volatile uint32_t wait_max_us = 0;
+static volatile float capture_age_avg_us = 0.0f;
+
+static volatile LinkCounters counters = {};
+static LinkCounters counters_baseline = {};         // Solo Core 1 ('cros reset')
+
+// Radio: solo Core 1
+static bool radio_ready = false;
+static TaskHandle_t radio_task_handle = NULL;
+
+// ==================== ADPCM ====================
+
+// Reconstrucción común a codificador y decodificador: mismo estado en los dos
+static inline int adpcm_update(AdpcmState* st, uint8_t code) {
+    const int step = ADPCM_STEPS[st->index];
+    int delta = step >> 3;
+    if (code & 4) delta += step;
+    if (code & 2) delta += step >> 1;
+    if (code & 1) delta += step >> 2;
+    st->predictor = CLAMP(st->predictor + ((code & 8) ? -delta : delta), -32768, 32767);
+    st->index = CLAMP(st->index + ADPCM_INDEX_STEP[code & 7], 0, 88);
+    return st->predictor;
+}
+
+static inline uint8_t adpcm_encode(AdpcmState* st, int sample) {
+    int step = ADPCM_STEPS[st->index];
+    int diff = sample - st->predictor;
+    uint8_t code = 0;
+    if (diff < 0) {
+        code = 8;
+        diff = -diff;
+    }
+    if (diff >= step) { code |= 4; diff -= step; }
+    step >>= 1;
+    if (diff >= step) { code |= 2; diff -= step; }
+    step >>= 1;
+    if (diff >= step) code |= 1;
+    adpcm_update(st, code);
+    return code;
+}
+
+// ==================== CORE 0 ====================
+
+#if DSP_FIXED_POINT
+static const int32_t BICROS_GAIN_Q = (int32_t)(CROS_LINK_BICROS_GAIN * DSP_Q_GAIN_ONE);
+
+static inline dsp_sample_t from_remote(int16_t x) {
+    return (int32_t)x * (1 << (DSP_Q_FRAC_BITS - 15));
+}
+
+static inline dsp_sample_t mix_bicros(dsp_sample_t local, int16_t x) {
+    return q_mul_gain(local, BICROS_GAIN_Q) + q_mul_gain(from_remote(x), BICROS_GAIN_Q);
+}
+#else
+static inline dsp_sample_t from_remote(int16_t x) {
+    return x * (1.0f / 32768.0f);
+}
+
+static inline dsp_sample_t mix_bicros(dsp_sample_t local, int16_t x) {
+    return (local + from_remote(x)) * CROS_LINK_BICROS_GAIN;
+}
+#endif
+
+void AUDIO_IRAM cros_link_capture(const int32_t* mic, int num_samples) {
+    if (link_mode.load(std::memory_order_relaxed) != MODE_CROSS_TRANSMITTER ||
+        num_samples > CROS_LINK_MAX_BLOCK) {
+        return;
+    }
+    const uint32_t head = tx_head.load(std::memory_order_relaxed);
+    if (head - tx_tail.load(std::memory_order_acquire) >= CROS_LINK_TX_SLOTS) {
+        counters.tx_overflows = counters.tx_overflows + 1;
+        tx_seq++;   // El receptor lo ve como pérdida
+        return;
+    }
+
+    TxSlot* slot = &tx_ring[head & TX_MASK];
+    for (int i = 0; i < num_samples; i++) {
+        slot->audio[i] = (int16_t)(mic[i] >> 16);
+    }
+    slot->seq = tx_seq++;
+    slot->capture_us = micros();
+    slot->sample_rate = SAMPLE_RATE;
+    slot->samples = num_samples;
+    tx_head.store(head + 1, std::memory_order_release);
+
+    if (radio_task_handle) xTaskNotifyGive(radio_task_handle);
+}
+
+// Copia consistente de la ranura de seq (seqlock); false si no está
+static bool AUDIO_IRAM read_slot(uint32_t seq, int num_samples, uint32_t* arrival_us, uint16_t* age_us) {
+    JitterSlot* slot = &jitter[seq & JITTER_MASK];
+    if (slot->seq.load(std::memory_order_acquire) != seq || slot->samples != num_samples) {
+        return false;
+    }
+    memcpy(remote_block, slot->audio, num_samples * sizeof(int16_t));
+    *arrival_us = slot->arrival_us;
+    *age_us = slot->capture_age_us;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot->seq.load(std::memory_order_relaxed) == seq;
+}
+
+void AUDIO_IRAM cros_link_mix(dsp_sample_t* block, int num_samples) {
+    const int mode = link_mode.load(std::memory_order_acquire);
+    if (mode != MODE_CROSS && mode != MODE_BICROSS) {
+        playing = false;
+        return;
+    }
+
+    const uint32_t generation = rx_generation.load(std::memory_order_acquire);
+    const uint32_t newest = newest_seq.load(std::memory_order_acquire);
+    if (play_reset_request.exchange(false, std::memory_order_acq_rel)) {
+        play_generation = generation;
+        first_seq = newest + 1;     // Cebar con bloques nuevos
+        playing = false;
+    }
+    if (generation == 0) return;
+    if (generation != play_generation) {
+        play_generation = generation;
+        first_seq = rx_first_seq.load(std::memory_order_relaxed);
+        playing = false;
+    }
+
+    // Cebado: audio local hasta tener el colchón completo
+    const int depth = depth_request.load(std::memory_order_relaxed);
+    if (!playing) {
+        if ((int32_t)(newest - first_seq) + 1 < depth) return;
+        next_seq = newest - depth + 1;
+        missing_run = 0;
+        memset(last_remote, 0, sizeof(last_remote));
+        playing = true;
+    }
+
+    int32_t ahead = (int32_t)(newest - next_seq);
+    if (ahead > depth - 1 + CROS_LINK_DRIFT_MARGIN) {
+        next_seq = newest - depth + 1;
+        ahead = depth - 1;
+        counters.resyncs = counters.resyncs + 1;
+    }
+
+    bool have_frame = false;
+    uint32_t arrival_us = 0;
+    uint16_t age_us = 0;
+    if (ahead < 0) {
+        counters.underruns = counters.underruns + 1;     // Se repite sin avanzar
+    } else {
+        have_frame = read_slot(next_seq, num_samples, &arrival_us, &age_us);
+        if (!have_frame) counters.concealed = counters.concealed + 1;
+        next_seq++;
+    }
+    played_seq.store(next_seq, std::memory_order_release);
+    buffered_blocks = ahead > 0 ? ahead : 0;
+
+    if (have_frame) {
+        missing_run = 0;
+        memcpy(last_remote, remote_block, num_samples * sizeof(int16_t));
+
+        const uint32_t wait = micros() - arrival_us;
+        if (wait_max_reset_request.exchange(false, std::memory_order_relaxed)) wait_max_us = 0;
+        if (wait > wait_max_us) wait_max_us = wait;
+        wait_avg_us = wait_avg_us + STATS_SMOOTHING * (wait - wait_avg_us);
+        capture_age_avg_us = capture_age_avg_us + STATS_SMOOTHING * (age_us - capture_age_avg_us);
+    } else {
+        const int timeout_blocks = CROS_LINK_TIMEOUT_MS * SAMPLE_RATE / (1000 * num_samples);
+        if (++missing_run > timeout_blocks) {
+            playing = false;
+            first_seq = newest + 1;
+            counters.link_drops = counters.link_drops + 1;
+            return;
+        }
+        // Ocultación: último bloque bueno, -6 dB por cada bloque sin trama
+        for (int i = 0; i < num_samples; i++) {
+            last_remote[i] = last_remote[i] / 2;
+        }
+        memcpy(remote_block, last_remote, num_samples * sizeof(int16_t));
+    }
+
+    if (mode == MODE_CROSS) {
+        for (int i = 0; i < num_samples; i++) block[i] = from_remote(remote_block[i]);
+    } else {
+        for (int i = 0; i < num_samples; i++) block[i] = mix_bicros(block[i], remote_block[i]);
+    }
+}
+
+// ==================== CORE 1: RADIO ====================
+
+static int encode_frame(const TxSlot* slot, uint8_t* frame) {
+    CrosFrameHeader header;
+    header.magic = CROS_LINK_MAGIC;
+    header.pair_id = (uint8_t)link_pair_id.load(std::memory_order_relaxed);
+    header.seq = slot->seq;
+    header.sample_rate = slot->sample_rate;
+    header.samples = slot->samples;
+    header.predictor = (int16_t)tx_adpcm.predictor;
+    header.step_index = (uint8_t)tx_adpcm.index;
+
+    uint8_t* payload = frame + sizeof(header);
+    for (int i = 0; i < slot->samples; i += 2) {
+        const uint8_t low = adpcm_encode(&tx_adpcm, slot->audio[i]);
+        const uint8_t high = i + 1 < slot->samples ? adpcm_encode(&tx_adpcm, slot->audio[i + 1]) : 0;
+        payload[i / 2] = low | (high << 4);
+    }
+
+    const uint32_t age = micros() - slot->capture_us;
+    header.capture_age_us = age > UINT16_MAX ? UINT16_MAX : (uint16_t)age;
+    memcpy(frame, &header, sizeof(header));
+    return sizeof(header) + (slot->samples + 1) / 2;
+}
+
+static void radio_task(void* parameter) {
+    static uint8_t frame[CROS_LINK_MAX_FRAME];
+
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        uint32_t tail = tx_tail.load(std::memory_order_relaxed);
+        while (tail != tx_head.load(std::memory_order_acquire)) {
+            const int len = encode_frame(&tx_ring[tail & TX_MASK], frame);
+            tx_tail.store(++tail, std::memory_order_release);
+
+            if (!radio_ready || link_mode.load(std::memory_order_relaxed) != MODE_CROSS_TRANSMITTER) continue;
+            if (esp_now_send(BROADCAST_ADDRESS, frame, len) == ESP_OK) {
+                counters.tx_frames = counters.tx_frames + 1;
+            } else {
+                counters.tx_errors = counters.tx_errors + 1;
+            }
+        }
+    }
+}
+
+// Tarea del driver WiFi (Core 1): decodifica directamente en su ranura
+static void receive_frame(const uint8_t* data, int len) {
+    const int mode = link_mode.load(std::memory_order_relaxed);
+    if ((mode != MODE_CROSS && mode != MODE_BICROSS) || len < (int)sizeof(CrosFrameHeader)) return;
+
+    CrosFrameHeader header;
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != CROS_LINK_MAGIC || header.pair_id != link_pair_id.load(std::memory_order_relaxed)) {
+        return;     // Otro par u otro tráfico ESP-NOW
+    }
+    if (header.sample_rate != SAMPLE_RATE || header.samples != BUFFER_SIZE ||
+        len != (int)(sizeof(header) + (header.samples + 1) / 2)) {
+        counters.rx_mismatched = counters.rx_mismatched + 1;
+        return;
+    }
+    const uint32_t arrival_us = micros();
+    counters.rx_frames = counters.rx_frames + 1;
+    rx_frame_bytes = len;
+
+    // Secuencia nueva: primera trama, reset local o emisor reiniciado (seq hacia atrás)
+    const uint32_t seq = header.seq;
+    const int32_t ahead = (int32_t)(seq - newest_seq.load(std::memory_order_relaxed));
+    const bool restart = rx_restart_request.exchange(false, std::memory_order_acq_rel) ||
+                         rx_generation.load(std::memory_order_relaxed) == 0 ||
+                         ahead <= -CROS_LINK_JITTER_SLOTS;
+    if (restart) {
+        for (int s = 0; s < CROS_LINK_JITTER_SLOTS; s++) {
+            jitter[s].seq.store(SLOT_EMPTY, std::memory_order_relaxed);
+        }
+    } else if (ahead > 1) {
+        counters.rx_lost = counters.rx_lost + (ahead - 1);
+    } else if (ahead == 0) {
+        return;     // Duplicada
+    } else if (ahead < 0) {
+        if ((int32_t)(seq - played_seq.load(std::memory_order_acquire)) < 0) {
+            counters.rx_late = counters.rx_late + 1;
+            return;
+        }
+        if (counters.rx_lost > 0) counters.rx_lost = counters.rx_lost - 1;   // Hueco recuperado
+    }
+
+    JitterSlot* slot = &jitter[seq & JITTER_MASK];
+    slot->seq.store(SLOT_EMPTY, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    AdpcmState state = {header.predictor, CLAMP((int)header.step_index, 0, 88)};
+    const uint8_t* payload = data + sizeof(header);
+    for (int i = 0; i < header.samples; i++) {
+        const uint8_t code = (i & 1) ? (payload[i / 2] >> 4) : (payload[i / 2] & 0x0F);
+        slot->audio[i] = (int16_t)adpcm_update(&state, code);
+    }
+    slot->samples = header.samples;
+    slot->arrival_us = arrival_us;
+    slot->capture_age_us = header.capture_age_us;
+    slot->seq.store(seq, std::memory_order_release);
+
+    if (restart) {
+        rx_first_seq.store(seq, std::memory_order_relaxed);
+        newest_seq.store(seq, std::memory_order_release);
+        rx_generation.fetch_add(1, std::memory_order_release);
+    } else if (ahead > 0) {
+        newest_seq.store(seq, std::memory_order_release);
+    }
+}
+
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+static void on_receive(const esp_now_recv_info_t* info, const uint8_t* data, int len) {
+    receive_frame(data, len);
+}
+#else
+static void on_receive(const uint8_t* mac, const uint8_t* data, int len) {
+    receive_frame(data, len);
+}
+#endif
+
+static void radio_stop() {
+    esp_now_deinit();
+    esp_wifi_stop();
+    esp_wifi_deinit();
+    radio_ready = false;
+}
+
+static bool radio_start() {
+    if (radio_ready) return true;
+
+    esp_netif_init();
+    esp_err_t err = esp_event_loop_create_default();
+    if (err == ESP_ERR_INVALID_STATE) err = ESP_OK;     // Ya creado
+
+    // El driver WiFi, y con él los callbacks de ESP-NOW, en Core 1
+    wifi_init_config_t wifi_config = WIFI_INIT_CONFIG_DEFAULT();
+    wifi_config.wifi_task_core_id = 1;
+    if (err == ESP_OK) err = esp_wifi_init(&wifi_config);
+    if (err == ESP_OK) err = esp_wifi_set_storage(WIFI_STORAGE_RAM);
+    if (err == ESP_OK) err = esp_wifi_set_mode(WIFI_MODE_STA);
+    if (err == ESP_OK) err = esp_wifi_start();
+    if (err == ESP_OK) err = esp_wifi_set_ps(WIFI_PS_NONE);    // Sin esperas de beacon
+    if (err == ESP_OK) err = esp_wifi_set_channel(CROS_LINK_CHANNEL, WIFI_SECOND_CHAN_NONE);
+    if (err == ESP_OK) err = esp_now_init();
+    if (err == ESP_OK) err = esp_now_register_recv_cb(on_receive);
+    if (err == ESP_OK) {
+        esp_now_peer_info_t peer = {};
+        memcpy(peer.peer_addr, BROADCAST_ADDRESS, sizeof(BROADCAST_ADDRESS));
+        peer.channel = CROS_LINK_CHANNEL;
+        peer.ifidx = WIFI_IF_STA;
+        peer.encrypt = false;
+        err = esp_now_add_peer(&peer);
+    }
+    if (err != ESP_OK) {
+        Serial.printf("❌ Radio ESP-NOW: %s\n", esp_err_to_name(err));
+        radio_stop();
+        return false;
+    }
+
+    if (!radio_task_handle) {
+        xTaskCreatePinnedToCore(radio_task, "CrosRadio", STACK_SIZE_RADIO, NULL,
+                                PRIORITY_RADIO_TASK, &radio_task_handle, 1);
+        if (radio_task_handle) memory_register_task(radio_task_handle, "CrosRadio", STACK_SIZE_RADIO, false);
+    }
+    radio_ready = true;
+    return true;
+}
+
+// ==================== CORE 1: CONTROL ====================
+
+bool cros_link_configure(ConnectivityMode mode, uint8_t pair_id) {
+    if (mode == MODE_BLUETOOTH_ONLY) return false;
+    if (mode != MODE_STANDALONE && BUFFER_SIZE > CROS_LINK_MAX_BLOCK) {
+        Serial.printf("❌ Enlace CROS: bloque de %d muestras > %d por trama ('format')\n",
+                      BUFFER_SIZE, CROS_LINK_MAX_BLOCK);
+        mode = MODE_STANDALONE;
+    }
+
+    // Core 0 deja de usar el enlace antes de tocar la radio
+    link_mode.store(MODE_STANDALONE, std::memory_order_release);
+    link_pair_id.store(pair_id, std::memory_order_relaxed);
+    if (mode == MODE_STANDALONE) {
+        if (radio_ready) radio_stop();
+        return BUFFER_SIZE <= CROS_LINK_MAX_BLOCK;
+    }
+    if (!radio_start()) return false;
+
+    cros_link_reset();
+    link_mode.store(mode, std::memory_order_release);
+    return true;
+}
+
+void cros_link_set_depth(int blocks) {
+    depth_request.store(CLAMP(blocks, 1, CROS_LINK_MAX_DEPTH), std::memory_order_relaxed);
+    play_reset_request.store(true, std::memory_order_release);
+}
+
+void cros_link_reset() {
+    rx_restart_request.store(true, std::memory_order_release);
+    play_reset_request.store(true, std::memory_order_release);
+}
+
+void cros_link_reset_stats() {
+    counters_baseline.tx_frames = counters.tx_frames;
+    counters_baseline.tx_errors = counters.tx_errors;
+    counters_baseline.tx_overflows = counters.tx_overflows;
+    counters_baseline.rx_frames = counters.rx_frames;
+    counters_baseline.rx_lost = counters.rx_lost;
+    counters_baseline.rx_late = counters.rx_late;
+    counters_baseline.rx_mismatched = counters.rx_mismatched;
+    counters_baseline.concealed = counters.concealed;
+    counters_baseline.underruns = counters.underruns;
+    counters_baseline.resyncs = counters.resyncs;
+    counters_baseline.link_drops = counters.link_drops;
+    wait_max_reset_request.store(true, std::memory_order_relaxed);
+}
+
+ConnectivityMode cros_link_mode() {
+    return (ConnectivityMode)link_mode.load(std::memory_order_relaxed);
+}
+
+const char* cros_link_mode_name(ConnectivityMode mode) {
+    switch (mode) {
+        case MODE_STANDALONE:        return "autónomo";
+        case MODE_CROSS:             return "CROS receptor";
+        case MODE_BICROSS:           return "BiCROS receptor";
+        case MODE_BLUETOOTH_ONLY:    return "Bluetooth";
+        case MODE_CROSS_TRANSMITTER: return "CROS emisor";
+    }
+    return "?";
+}
+
+void cros_link_get_status(cros_link_status_t* status) {
+    status->mode = cros_link_mode();
+    status->pair_id = (uint8_t)link_pair_id.load(std::memory_order_relaxed);
+    status->radio_ready = radio_ready;
+    status->link_up = playing;
+    status->depth_blocks = depth_request.load(std::memory_order_relaxed);
+    status->buffered_blocks = buffered_blocks;
+
+    status->tx_frames = counters.tx_frames - counters_baseline.tx_frames;
+    status->tx_errors = counters.tx_errors - counters_baseline.tx_errors;
+    status->tx_overflows = counters.tx_overflows - counters_baseline.tx_overflows;
+    status->rx_frames = counters.rx_frames - counters_baseline.rx_frames;
+    status->rx_lost = counters.rx_lost - counters_baseline.rx_lost;
+    status->rx_late = counters.rx_late - counters_baseline.rx_late;
+    status->rx_mismatched = counters.rx_mismatched - counters_baseline.rx_mismatched;
+    status->concealed = counters.concealed - counters_baseline.concealed;
+    status->underruns = counters.underruns - counters_baseline.underruns;
+    status->resyncs = counters.resyncs - counters_baseline.resyncs;
+    status->link_drops = counters.link_drops - counters_baseline.link_drops;
+
+    status->capture_age_ms = capture_age_avg_us / 1000.0f;
+    status->air_ms = rx_frame_bytes > 0
+        ? (PHY_PREAMBLE_US + (rx_frame_bytes + ESPNOW_OVERHEAD) * 8 * 1e6f / CROS_LINK_AIR_RATE_BPS) / 1000.0f
+        : 0.0f;
+    status->wait_ms = wait_avg_us / 1000.0f;
+    status->wait_max_ms = wait_max_us / 1000.0f;
+
+    // Audífonos iguales: la E/S local equivale a la captura remota + la salida local
+    status->latency_ms = get_current_audio_latency_ms() + status->capture_age_ms +
+                         status->air_ms + status->wait_ms;
+}
+
+void print_cros_link_status() {
+    cros_link_status_t st;
+    cros_link_get_status(&st);
+
+    Serial.printf("\n📡 ENLACE CROS/BiCROS (ESP-NOW canal %d, ADPCM 4 bits, par %d)\n",
+                  CROS_LINK_CHANNEL, st.pair_id);
+    Serial.printf("   Modo: %s | radio %s\n", cros_link_mode_name(st.mode),
+                  st.radio_ready ? "✅ ACTIVA" : "❌ APAGADA");
+    if (st.mode == MODE_STANDALONE) return;
+
+    const uint32_t frame_bytes = sizeof(CrosFrameHeader) + (BUFFER_SIZE + 1) / 2;
+    Serial.printf("   Trama: %d muestras en %lu bytes (%.1f kbit/s)\n", BUFFER_SIZE,
+                  (unsigned long)frame_bytes, frame_bytes * 8.0f * SAMPLE_RATE / BUFFER_SIZE / 1000.0f);
+
+    if (st.mode == MODE_CROSS_TRANSMITTER) {
+        Serial.printf("   Enviadas: %lu | errores esp_now_send: %lu | anillo lleno: %lu\n",
+                      (unsigned long)st.tx_frames, (unsigned long)st.tx_errors,
+                      (unsigned long)st.tx_overflows);
+        return;
+    }
+
+    const uint32_t expected = st.rx_frames + st.rx_lost;
+    Serial.printf("   Enlace: %s | colchón %d bloques (%.1f ms), ahora %d\n",
+                  st.link_up ? "✅ AUDIO REMOTO" : "⏳ SIN TRAMAS (audio local)",
+                  st.depth_blocks, samples_to_ms(st.depth_blocks * BUFFER_SIZE), st.buffered_blocks);
+    Serial.printf("   Recibidas: %lu | perdidas: %lu (%.2f%%) | tarde: %lu | otro formato: %lu\n",
+                  (unsigned long)st.rx_frames, (unsigned long)st.rx_lost,
+                  expected > 0 ? 100.0f * st.rx_lost / expected : 0.0f,
+                  (unsigned long)st.rx_late, (unsigned long)st.rx_mismatched);
+    Serial.printf("   Ocultados: %lu | sin trama aún: %lu | resincronías: %lu | caídas: %lu\n",
+                  (unsigned long)st.concealed, (unsigned long)st.underruns,
+                  (unsigned long)st.resyncs, (unsigned long)st.link_drops);
+    Serial.printf("   Latencia mic remoto → DAC: %.1f ms (E/S %.1f + emisor %.2f + aire ≈%.2f + colchón %.1f, máx %.1f)\n",
+                  st.latency_ms, get_current_audio_latency_ms(), st.capture_age_ms,
+                  st.air_ms, st.wait_ms, st.wait_max_ms);
+}
@@ -0,0 +1,148 @@
+// ==================== CROS_LINK.H ====================
+// Enlace de audio entre audífonos (CROS/BiCROS) por ESP-NOW para Aurivox v3.0
+// Captura y mezcla en Core 0, radio (ADPCM + ESP-NOW) en Core 1
+
+#ifndef CROS_LINK_H
+#define CROS_LINK_H
+
+#include <stdint.h>
+#include "audio_config.h"
+
+// ==================== PARÁMETROS ====================
+
+#define CROS_LINK_CHANNEL         1       // Canal WiFi de ESP-NOW (igual en los dos audífonos)
+#define CROS_LINK_MAGIC           0xC5
+#define CROS_LINK_MAX_FRAME       250     // ESP_NOW_MAX_DATA_LEN
+#define CROS_LINK_MAX_BLOCK       464     // Muestras por trama: 4 bits/muestra + cabecera ≤ 250 bytes
+#define CROS_LINK_JITTER_SLOTS    8       // Bloques del buffer de recepción (potencia de 2)
+#define CROS_LINK_DEFAULT_DEPTH   2       // Bloques de colchón antes de reproducir
+#define CROS_LINK_MAX_DEPTH       4
+#define CROS_LINK_DRIFT_MARGIN    2       // Bloques sobre el colchón antes de descartar (deriva de relojes)
+#define CROS_LINK_TX_SLOTS        4       // Bloques del anillo Core 0 → tarea de radio (potencia de 2)
+#define CROS_LINK_TIMEOUT_MS      100     // Sin tramas: enlace caído, vuelve el audio local
+#define CROS_LINK_BICROS_GAIN     0.7071f // Local y remoto a -3 dB (potencia constante)
+#define CROS_LINK_AIR_RATE_BPS    1000000 // Tasa PHY por defecto de ESP-NOW (estimación del aire)
+
+#if (CROS_LINK_JITTER_SLOTS & (CROS_LINK_JITTER_SLOTS - 1)) != 0 || \
+    (CROS_LINK_TX_SLOTS & (CROS_LINK_TX_SLOTS - 1)) != 0
+#error "CROS_LINK_JITTER_SLOTS y CROS_LINK_TX_SLOTS deben ser potencia de 2"
+#endif
+
+#if CROS_LINK_MAX_DEPTH + CROS_LINK_DRIFT_MARGIN >= CROS_LINK_JITTER_SLOTS
+#error "CROS_LINK_JITTER_SLOTS no cubre el colchón máximo más el margen de deriva"
+#endif
+
+/*
+ * TRAMA (un bloque de audio por trama, little-endian)
+ * ===================================================
+ *
+ *   CrosFrameHeader │ ADPCM IMA, 2 muestras por byte (nibble bajo primero)
+ *
+ * El estado del codificador (predictor, índice de paso) al inicio del
+ * bloque viaja en la cabecera: cada trama se decodifica sola y una
+ * pérdida no arrastra error a las siguientes.
+ */
+
+struct __attribute__((packed)) CrosFrameHeader {
+  uint8_t magic;
+  uint8_t pair_id;            // cross_pair_id de AudioConfig
+  uint32_t seq;               // Bloque desde el arranque del emisor
+  uint16_t sample_rate;
+  uint16_t samples;
+  int16_t predictor;
+  uint8_t step_index;
+  uint16_t capture_age_us;    // Emisor: fin de la captura → esp_now_send
+};
+
+static_assert(sizeof(CrosFrameHeader) + CROS_LINK_MAX_BLOCK / 2 <= CROS_LINK_MAX_FRAME,
+              "CROS_LINK_MAX_BLOCK no cabe en una trama ESP-NOW");
+
+// ==================== TIPOS ====================
+
+// Estado para el comando 'cros' (Core 1, copia aproximada)
+typedef struct {
+  ConnectivityMode mode;
+  uint8_t pair_id;
+  bool radio_ready;
+  bool link_up;               // Receptor reproduciendo audio remoto
+  int depth_blocks;
+  int buffered_blocks;        // Bloques recibidos por delante del que suena
+  uint32_t tx_frames;
+  uint32_t tx_errors;         // esp_now_send rechazado
+  uint32_t tx_overflows;      // Anillo de Core 0 lleno (tarea de radio atrasada)
+  uint32_t rx_frames;
+  uint32_t rx_lost;           // Huecos de seq que no llegaron
+  uint32_t rx_late;           // Llegaron cuando su bloque ya había sonado
+  uint32_t rx_mismatched;     // Par correcto pero formato de audio distinto
+  uint32_t concealed;         // Bloques reproducidos sin trama (ocultación)
+  uint32_t underruns;         // Bloques sin trama todavía (reloj del receptor más rápido)
+  uint32_t resyncs;           // Descartes por colchón excesivo (reloj del emisor más rápido)
+  uint32_t link_drops;
+  float capture_age_ms;       // Media en el emisor (de la cabecera)
+  float air_ms;               // Estimada con la longitud de trama
+  float wait_ms;              // Llegada → reproducción en el receptor (media)
+  float wait_max_ms;
+  float latency_ms;           // Micrófono remoto → salida al DAC local
+} cros_link_status_t;
+
+// ==================== FUNCIONES ====================
+
+/**
+ * @brief Arrancar/parar la radio y fijar el papel del audífono (Core 1)
+ *
+ * MODE_STANDALONE apaga WiFi. El resto inicializa WiFi en modo estación
+ * solo para ESP-NOW, con la tarea del driver fijada a Core 1, y crea la
+ * tarea de radio (Core 1). Falla con bloques de más de CROS_LINK_MAX_BLOCK.
+ *
+ * @param mode MODE_CROSS_TRANSMITTER, MODE_CROSS, MODE_BICROSS o MODE_STANDALONE
+ * @param pair_id Solo se aceptan tramas del mismo par (varios pares en una sala)
+ * @return true si el modo quedó aplicado
+ */
+bool cros_link_configure(ConnectivityMode mode, uint8_t pair_id);
+
+/**
+ * @brief Colchón del buffer de recepción en bloques (1 - CROS_LINK_MAX_DEPTH)
+ *
+ * Más bloques aguantan más jitter de radio a costa de un bloque de
+ * latencia cada uno. Se aplica volviendo a cebar el buffer.
+ */
+void cros_link_set_depth(int blocks);
+
+/**
+ * @brief Vaciar emisión y recepción tras un cambio de formato
+ *
+ * Con Core 0 aparcado (switch_audio_format). Las tramas del otro
+ * audífono con el formato anterior se descartan y cuentan.
+ */
+void cros_link_reset(void);
+void cros_link_reset_stats(void);
+
+/**
+ * @brief Copiar el bloque del micrófono al anillo de emisión (Core 0)
+ *
+ * Solo en MODE_CROSS_TRANSMITTER: Q31 → int16 y aviso a la tarea de
+ * radio, que codifica y envía. Nunca espera: con el anillo lleno el
+ * bloque se descarta y se cuenta.
+ */
+void cros_link_capture(const int32_t* mic, int num_samples);
+
+/**
+ * @brief Audio remoto en el bloque de entrada del pipeline (Core 0)
+ *
+ * MODE_CROSS sustituye el micrófono local, MODE_BICROSS suma los dos a
+ * CROS_LINK_BICROS_GAIN. Sin enlace (cebando, caído) el bloque no cambia.
+ *
+ * @param block Bloque tras el AFC, antes de process_dsp_pipeline()
+ */
+void cros_link_mix(dsp_sample_t* block, int num_samples);
+
+ConnectivityMode cros_link_mode(void);
+const char* cros_link_mode_name(ConnectivityMode mode);
+
+/**
+ * @brief Contadores, latencia y pérdidas (Core 1)
+ */
+void cros_link_get_status(cros_link_status_t* status);
+void print_cros_link_status(void);
+
+#endif // CROS_LINK_H
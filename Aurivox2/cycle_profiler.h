@@ -0,0 +1,77 @@
+#ifndef CYCLE_PROFILER_H
+#define CYCLE_PROFILER_H
+
+#include "Arduino.h"
+#include <stdint.h>
+
+/*
+ * PERFILADOR DE CICLOS POR ETAPA
+ * =============================
+ *
+ * Mide el coste real de cada etapa del bloque de audio con el contador
+ * de ciclos de la CPU (CCOUNT), pensado para dejarlo activo en campo:
+ *
+ *   uint32_t t = profiler_cycles();
+ *   etapa_a(bloque);   t = profiler_lap(STAGE_A, t);
+ *   etapa_b(bloque);   t = profiler_lap(STAGE_B, t);
+ *   profiler_block_end();
+ *
+ * Por etapa: min/avg/max exactos e histograma en cuartos de octava
+ * (4 bins por potencia de 2, resolución ~19 %) del que sale el p99.
+ * Coste por etapa: una lectura de CCOUNT y ~15 instrucciones enteras,
+ * sin floats ni divisiones en la ruta de audio.
+ *
+ * El informe expresa cada etapa en % del presupuesto de tiempo real
+ * (ciclos disponibles por bloque = f_cpu · BUFFER_SIZE / SAMPLE_RATE).
+ *
+ * Archivo idéntico en Aurivox/ y Aurivox2/: mantener ambas copias
+ * sincronizadas. Cada sketch define su propio enum de etapas.
+ */
+
+#ifndef CYCLE_PROFILER_ENABLED
+#define CYCLE_PROFILER_ENABLED  1   // 0 = profiler_cycles()/profiler_lap() vacíos
+#endif
+
+#define PROFILER_MAX_STAGES     16
+#define PROFILER_HIST_BINS      80  // 2^4 .. 2^24 ciclos
+
+static inline uint32_t profiler_cycles() {
+#if CYCLE_PROFILER_ENABLED
+    return ESP.getCycleCount();
+#else
+    return 0;
+#endif
+}
+
+// Nombres y presupuesto por bloque (setup, antes de la tarea de audio)
+void profiler_init(const char* const* stage_names, int num_stages, uint32_t block_budget_cycles);
+
+// Presupuesto nuevo sin borrar estadísticas (cambio del reloj de la CPU)
+void profiler_set_budget(uint32_t block_budget_cycles);
+
+// Sumar una medida a la etapa (solo desde la tarea de audio)
+void profiler_record(int stage, uint32_t cycles);
+
+// Registrar la etapa que empezó en start; devuelve el inicio de la siguiente
+static inline uint32_t profiler_lap(int stage, uint32_t start) {
+#if CYCLE_PROFILER_ENABLED
+    uint32_t now = profiler_cycles();
+    profiler_record(stage, now - start);
+    return now;
+#else
+    (void)stage;
+    (void)start;
+    return 0;
+#endif
+}
+
+// Fin de bloque en la tarea de audio: aplica un reset pendiente
+void profiler_block_end();
+
+// Pedir borrar estadísticas (desde cualquier tarea; efectivo al fin de bloque)
+void profiler_reset();
+
+// Tabla min/avg/max/p99 y % del presupuesto por etapa
+void profiler_print();
+
+#endif
@@ -0,0 +1,126 @@
+// ==================== DSP_FIXED.CPP ====================
+// Kernels en coma fija (Q4.27 / Q2.30 / Q7.24) para Aurivox v3.0
+
+#include "Arduino.h"
+#include <math.h>
+#include "dsp_fixed.h"
+#include "dsp_kernels.h"     // AUDIO_IRAM, kernels enteros
+
+// ==================== CONVERSIONES ====================
+
+void AUDIO_IRAM dsp_q_from_mic(const int32_t* in, int32_t* out, int n) {
+  for (int i = 0; i < n; i++) {
+    out[i] = in[i] >> DSP_Q_HEADROOM_BITS;
+  }
+}
+
+// Redondeo, desplazamiento, saturación y empaquetado: kernel PIE en el S3
+void AUDIO_IRAM dsp_q_to_int16(const int32_t* in, int16_t* out, int n, int out_step) {
+  dsp_int32_to_int16(in, out, n, DSP_Q_FRAC_BITS - 15, out_step);
+}
+
+void AUDIO_IRAM dsp_q_from_float(const float* in, int32_t* out, int n) {
+  for (int i = 0; i < n; i++) {
+    out[i] = q_from_float(in[i], DSP_Q_FRAC_BITS);
+  }
+}
+
+void AUDIO_IRAM dsp_q_to_float(const int32_t* in, float* out, int n) {
+  for (int i = 0; i < n; i++) {
+    out[i] = q_to_float(in[i], DSP_Q_FRAC_BITS);
+  }
+}
+
+// ==================== GANANCIA Y NIVEL ====================
+
+void AUDIO_IRAM dsp_q_gain(int32_t* x, int n, int32_t gain) {
+  if (gain == DSP_Q_GAIN_ONE) return;
+  for (int i = 0; i < n; i++) {
+    x[i] = q_mul_gain(x[i], gain);
+  }
+}
+
+int32_t AUDIO_IRAM dsp_q_peak(const int32_t* x, int n) {
+  return dsp_peak_int32(x, n);
+}
+
+// Q4.27 >> 8 = Q4.19: el cuadrado cabe en 46 bits, la suma de 128 en 53
+float AUDIO_IRAM dsp_q_mean_square(const int32_t* x, int n) {
+  int64_t acc = 0;
+  for (int i = 0; i < n; i++) {
+    int32_t s = x[i] >> 8;
+    acc += (int64_t)s * s;
+  }
+  const float scale = 1.0f / ((float)(1 << (DSP_Q_FRAC_BITS - 8)) * (float)(1 << (DSP_Q_FRAC_BITS - 8)));
+  return (float)acc * scale / n;
+}
+
+// ==================== BIQUADS ====================
+
+static int32_t quantize_coeff(float c, int frac_bits) {
+  double scaled = round((double)c * (double)(1LL << frac_bits));
+  return (int32_t)fmin(fmax(scaled, -2147483648.0), 2147483647.0);
+}
+
+void dsp_q_biquad_design(QBiquad* bq, const float* coeffs) {
+  // Bits fraccionarios de b: los más que deja Σ|b| (ver márgenes en dsp_fixed.h)
+  double b_sum = fabs(coeffs[0]) + fabs(coeffs[1]) + fabs(coeffs[2]);
+  int b_frac = DSP_Q_COEFF_BITS;
+  while (b_frac > 0 && b_sum * (double)(1LL << b_frac) > (double)(1LL << DSP_Q_B_SUM_BITS)) {
+    b_frac--;
+  }
+
+  for (int k = 0; k < 3; k++) {
+    bq->b[k] = quantize_coeff(coeffs[k], b_frac);
+  }
+  bq->a[0] = quantize_coeff(coeffs[3], DSP_Q_COEFF_BITS);
+  bq->a[1] = quantize_coeff(coeffs[4], DSP_Q_COEFF_BITS);
+  bq->b_frac = b_frac;
+  bq->a_shift = DSP_Q_COEFF_BITS - b_frac;
+}
+
+void AUDIO_IRAM dsp_q_biquad_reset(QBiquad* bq) {
+  bq->x1 = bq->x2 = 0;
+  bq->y1 = bq->y2 = 0;
+  bq->error = 0;
+}
+
+/*
+ * y[n] = b0·x[n] + b1·x[n-1] + b2·x[n-2] - (a1·y[n-1] + a2·y[n-2]) · 2^-a_shift
+ *
+ * Acumulador Q.(27 + b_frac) en int64; la salida se trunca a Q4.27 con
+ * saturación y los b_frac bits descartados entran en la muestra siguiente.
+ */
+void AUDIO_IRAM dsp_q_biquad_cascade(int32_t* x, int n, QBiquad* const* stages, int count) {
+  for (int s = 0; s < count; s++) {
+    QBiquad* bq = stages[s];
+    const int32_t b0 = bq->b[0], b1 = bq->b[1], b2 = bq->b[2];
+    const int32_t a1 = bq->a[0], a2 = bq->a[1];
+    const int frac = bq->b_frac;
+    const int a_shift = bq->a_shift;
+    const int64_t frac_mask = ((int64_t)1 << frac) - 1;
+    int32_t x1 = bq->x1, x2 = bq->x2;
+    int32_t y1 = bq->y1, y2 = bq->y2;
+    int64_t error = bq->error;
+
+    for (int i = 0; i < n; i++) {
+      int32_t x0 = x[i];
+      int64_t acc = (int64_t)b0 * x0 + (int64_t)b1 * x1 + (int64_t)b2 * x2;
+      acc -= ((int64_t)a1 * y1 + (int64_t)a2 * y2) >> a_shift;
+      acc += error;
+      int32_t y0 = q_sat32(acc >> frac);
+      error = acc & frac_mask;
+      x2 = x1;
+      x1 = x0;
+      y2 = y1;
+      y1 = y0;
+      x[i] = y0;
+    }
+
+    bq->x1 = x1;
+    bq->x2 = x2;
+    bq->y1 = y1;
+    bq->y2 = y2;
+    bq->error = (int32_t)error;
+  }
+}
@@ -0,0 +1,115 @@
+// ==================== DSP_FIXED.H ====================
+// Aritmética en coma fija con saturación para el pipeline DSP de Aurivox v3.0
+// Ruta seleccionada con DSP_FIXED_POINT (audio_config.h)
+
+#ifndef DSP_FIXED_H
+#define DSP_FIXED_H
+
+#include <stdint.h>
+
+/*
+ * FORMATOS:
+ *
+ *   muestras      int32  Q4.27   palabra Q31 del micrófono >> 4: 24 dB de
+ *                                margen para EQ/ganancia sin saturar
+ *   biquads a1,a2 int32  Q2.30   |a1| < 2, |a2| < 1 (filtros estables)
+ *   biquads b0-b2 int32  Q.b_frac b_frac ≤ 30 según Σ|b| (shelf +20 dB ≈ 10)
+ *   ganancias     int32  Q7.24   WDRC y ganancia final (≤ 1)
+ *   acumulador    int64          productos 32×32
+ *
+ * Biquad en forma directa I: los estados son muestras de entrada/salida
+ * (acotadas), no la señal interna de la forma II, que en coma fija
+ * desborda con las bandas de mucha ganancia. El resto del truncado se
+ * suma en la muestra siguiente (realimentación de error de 1er orden):
+ * el ruido de redondeo queda fuera de las bajas frecuencias.
+ *
+ * Los polos de baja frecuencia (HPF, shelf grave) tienen a1 ≈ -2 y
+ * a2 ≈ 1: con 14 bits fraccionarios su error de cuantización dominaba
+ * el ruido frente a float. Con 30 bits queda por debajo del de la FPU.
+ *
+ * Márgenes del acumulador con muestras hasta 2^31 (saturación Q4.27):
+ *   Σ|b|·2^b_frac ≤ 2^29        → parte b    ≤ 2^60
+ *   |a1| + |a2| < 3, en Q2.30   → parte a    < 3·2^61 (antes de alinear)
+ * La parte a se alinea a la escala de b con >> (30 - b_frac). Con
+ * b_frac = 30 (Σ|b| ≤ 0.5) no se desplaza y la suma queda < 7·2^60;
+ * con b_frac ≤ 29, < 2^62. El resto del truncado suma < 2^30: siempre
+ * por debajo de 2^63.
+ *
+ * Los niveles del WDRC (log10/pow) siguen en float a la tasa de control
+ * (1 cada WDRC_CONTROL_SAMPLES): por muestra solo hay enteros.
+ */
+
+#define DSP_Q_FRAC_BITS     27
+#define DSP_Q_HEADROOM_BITS (31 - DSP_Q_FRAC_BITS)
+#define DSP_Q_COEFF_BITS    30      // a1, a2 (Q2.30); máximo para b
+#define DSP_Q_B_SUM_BITS    29      // Σ|b| · 2^b_frac ≤ 2^29
+#define DSP_Q_GAIN_BITS     24
+
+#define DSP_Q_ONE           (1 << DSP_Q_FRAC_BITS)
+#define DSP_Q_GAIN_ONE      (1 << DSP_Q_GAIN_BITS)
+
+// Biquad cuantizado + estado propio (forma directa I)
+struct QBiquad {
+  int32_t b[3];        // b0, b1, b2 con b_frac bits fraccionarios
+  int32_t a[2];        // a1, a2 en Q2.30
+  int8_t b_frac;       // Bits fraccionarios de b y del acumulador
+  int8_t a_shift;      // DSP_Q_COEFF_BITS - b_frac: parte a → escala de b
+  int32_t x1, x2;      // x[n-1], x[n-2]
+  int32_t y1, y2;      // y[n-1], y[n-2]
+  int32_t error;       // Resto del último truncado (realimentación de error)
+};
+
+// ==================== CONVERSIONES Y SATURACIÓN ====================
+
+static inline int32_t q_sat32(int64_t x) {
+  if (x > INT32_MAX) return INT32_MAX;
+  if (x < INT32_MIN) return INT32_MIN;
+  return (int32_t)x;
+}
+
+static inline int32_t q_from_float(float x, int frac_bits) {
+  float scaled = x * (float)(1LL << frac_bits);
+  if (scaled >= 2147483647.0f) return INT32_MAX;
+  if (scaled <= -2147483648.0f) return INT32_MIN;
+  return (int32_t)(scaled + (scaled >= 0.0f ? 0.5f : -0.5f));
+}
+
+static inline float q_to_float(int32_t x, int frac_bits) {
+  return (float)x * (1.0f / (float)(1LL << frac_bits));
+}
+
+// x · gain (Q7.24) con redondeo y saturación
+static inline int32_t q_mul_gain(int32_t x, int32_t gain) {
+  return q_sat32(((int64_t)x * gain + (1 << (DSP_Q_GAIN_BITS - 1))) >> DSP_Q_GAIN_BITS);
+}
+
+// ==================== KERNELS POR BLOQUE ====================
+
+// Palabras Q31 del micrófono → Q4.27
+void dsp_q_from_mic(const int32_t* in, int32_t* out, int n);
+
+// Q4.27 → int16 con redondeo y saturación; out[i·out_step]
+void dsp_q_to_int16(const int32_t* in, int16_t* out, int n, int out_step);
+
+// float [-1, 1] ↔ Q4.27 (comparación con la ruta float y host)
+void dsp_q_from_float(const float* in, int32_t* out, int n);
+void dsp_q_to_float(const int32_t* in, float* out, int n);
+
+// x[i] = sat(x[i] · gain), gain en Q7.24
+void dsp_q_gain(int32_t* x, int n, int32_t gain);
+
+// max |x[i]| (Q4.27)
+int32_t dsp_q_peak(const int32_t* x, int n);
+
+// Σ x[i]² / n en unidades de escala completa (1.0 = 0 dBFS)
+float dsp_q_mean_square(const int32_t* x, int n);
+
+// Cuantizar coeficientes float {b0, b1, b2, a1, a2} (a0 = 1); no toca el estado
+void dsp_q_biquad_design(QBiquad* bq, const float* coeffs);
+
+void dsp_q_biquad_reset(QBiquad* bq);
+
+// Cascada de biquads in-place (etapas en orden)
+void dsp_q_biquad_cascade(int32_t* x, int n, QBiquad* const* stages, int count);
+
+#endif // DSP_FIXED_H
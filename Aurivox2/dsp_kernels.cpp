@@ -0,0 +1,477 @@
+#include "Arduino.h"
+#include <math.h>
+#include "dsp_kernels.h"
+
+#if DSP_KERNELS_OPTIMIZED
+#include "esp_dsp.h"
+#endif
+
+/*
+ * Las versiones escalares se compilan siempre: son la implementación
+ * del ESP32 original y la referencia del benchmark en el S3.
+ */
+
+// ==================== REFERENCIA ESCALAR ====================
+
+static void AUDIO_IRAM scalar_int32_to_float(const int32_t* in, float* out, int n, int shift) {
+    const float scale = ldexpf(1.0f, -shift);
+    for (int i = 0; i < n; i++) {
+        out[i] = (float)in[i] * scale;
+    }
+}
+
+static void AUDIO_IRAM scalar_float_to_int16(const float* in, int16_t* out, int n, int shift, int out_step) {
+    const float scale = ldexpf(1.0f, shift);
+    for (int i = 0; i < n; i++) {
+        float s = in[i] * scale;
+        if (s > 32767.0f) s = 32767.0f;
+        if (s < -32768.0f) s = -32768.0f;
+        out[i * out_step] = (int16_t)s;
+    }
+}
+
+static void AUDIO_IRAM scalar_int32_to_int16(const int32_t* in, int16_t* out, int n, int shift, int out_step) {
+    const int64_t rounding = shift > 0 ? (int64_t)1 << (shift - 1) : 0;
+    for (int i = 0; i < n; i++) {
+        int64_t s = ((int64_t)in[i] + rounding) >> shift;
+        s = (s > 32767) ? 32767 : ((s < -32768) ? -32768 : s);
+        out[i * out_step] = (int16_t)s;
+    }
+}
+
+static int32_t AUDIO_IRAM scalar_peak_int32(const int32_t* x, int n) {
+    uint32_t peak = 0;
+    for (int i = 0; i < n; i++) {
+        uint32_t a = x[i] < 0 ? (uint32_t)(-(int64_t)x[i]) : (uint32_t)x[i];
+        peak = a > peak ? a : peak;
+    }
+    return peak > INT32_MAX ? INT32_MAX : (int32_t)peak;
+}
+
+static void AUDIO_IRAM scalar_gain(const float* in, float* out, int n, float gain) {
+    for (int i = 0; i < n; i++) {
+        out[i] = in[i] * gain;
+    }
+}
+
+static void AUDIO_IRAM scalar_multiply(const float* a, const float* b, float* out, int n) {
+    for (int i = 0; i < n; i++) {
+        out[i] = a[i] * b[i];
+    }
+}
+
+static float AUDIO_IRAM scalar_peak(const float* x, int n) {
+    float peak = 0.0f;
+    for (int i = 0; i < n; i++) {
+        float a = fabsf(x[i]);
+        if (a > peak) peak = a;
+    }
+    return peak;
+}
+
+static float AUDIO_IRAM scalar_energy(const float* x, int n) {
+    float acc = 0.0f;
+    for (int i = 0; i < n; i++) {
+        acc += x[i] * x[i];
+    }
+    return acc;
+}
+
+static float AUDIO_IRAM scalar_dot(const float* a, const float* b, int n) {
+    float acc = 0.0f;
+    for (int i = 0; i < n; i++) {
+        acc += a[i] * b[i];
+    }
+    return acc;
+}
+
+static void AUDIO_IRAM scalar_axpy(const float* x, float* y, int n, float k) {
+    for (int i = 0; i < n; i++) {
+        y[i] += k * x[i];
+    }
+}
+
+// Forma directa II, mismo orden de operaciones que dsps_biquad_f32_ansi
+static void AUDIO_IRAM scalar_biquad_cascade(float* x, int n, float* const* coeffs, float* const* states, int stages) {
+    for (int s = 0; s < stages; s++) {
+        const float* c = coeffs[s];
+        float* w = states[s];
+        float w0 = w[0], w1 = w[1];
+        for (int i = 0; i < n; i++) {
+            float d0 = x[i] - c[3] * w0 - c[4] * w1;
+            x[i] = c[0] * d0 + c[1] * w0 + c[2] * w1;
+            w1 = w0;
+            w0 = d0;
+        }
+        w[0] = w0;
+        w[1] = w1;
+    }
+}
+
+// ==================== KERNELS ====================
+
+#if DSP_KERNELS_OPTIMIZED
+
+// FLOAT.S / TRUNC.S aplican la escala 2^imm sin multiplicación extra
+static inline float float_q31(int32_t x) {
+    float f;
+    asm ("float.s %0, %1, 31" : "=f"(f) : "a"(x));
+    return f;
+}
+
+static inline int32_t trunc_q15(float f) {
+    int32_t r;
+    asm ("trunc.s %0, %1, 15" : "=a"(r) : "f"(f));  // Satura a int32 fuera de rango
+    return r;
+}
+
+void AUDIO_IRAM dsp_int32_to_float(const int32_t* in, float* out, int n, int shift) {
+    if (shift != 31) {
+        scalar_int32_to_float(in, out, n, shift);
+        return;
+    }
+    for (int i = 0; i < n; i++) {
+        out[i] = float_q31(in[i]);
+    }
+}
+
+void AUDIO_IRAM dsp_float_to_int16(const float* in, int16_t* out, int n, int shift, int out_step) {
+    if (shift != 15) {
+        scalar_float_to_int16(in, out, n, shift, out_step);
+        return;
+    }
+    for (int i = 0; i < n; i++) {
+        int32_t s = trunc_q15(in[i]);
+        s = (s > 32767) ? 32767 : ((s < -32768) ? -32768 : s);  // CLAMPS 15
+        out[i * out_step] = (int16_t)s;
+    }
+}
+
+/*
+ * KERNELS PIE (enteros)
+ * =====================
+ *
+ *  in (int32, 16 B alineado)          q0 = [x0 x1 x2 x3]   q1 = [x4 x5 x6 x7]
+ *        │  EE.VADDS.S32 + redondeo   (saturando: no da la vuelta)
+ *        │  EE.VSR.32 >> SAR
+ *        │  EE.VMIN.S32 32767 / EE.VMAX.S32 -32768
+ *        ▼  EE.VUNZIP.16 q0, q1       q0 = mitades bajas de los 8 carriles
+ *  out (int16) ◀── EE.VST.128          8 muestras por vuelta
+ *
+ * La suma saturada solo difiere de la de 64 bits de la referencia en
+ * muestras que saturan después igualmente (shift ≤ 16). Los registros q
+ * no los asigna el compilador; cada kernel los usa dentro de un único
+ * bloque asm con bucle sin overhead (LOOPGTZ). Solo los usan la tarea
+ * de audio (Core 0) y el benchmark (Core 1), cada uno en su core.
+ */
+
+static const int32_t PIE_INT16_MAX = 32767;
+static const int32_t PIE_INT16_MIN = -32768;
+
+static inline bool pie_aligned(const void* a, const void* b) {
+    return (((uintptr_t)a | (uintptr_t)b) & 15) == 0;
+}
+
+void AUDIO_IRAM dsp_int32_to_int16(const int32_t* in, int16_t* out, int n, int shift, int out_step) {
+    const int blocks = n >> 3;
+    if (out_step != 1 || shift < 0 || shift > 16 || blocks == 0 || !pie_aligned(in, out)) {
+        scalar_int32_to_int16(in, out, n, shift, out_step);
+        return;
+    }
+    const int32_t rounding = shift > 0 ? 1 << (shift - 1) : 0;
+    const int32_t* src = in;
+    int16_t* dst = out;
+    asm volatile (
+        "wsr.sar        %[shift]\n"
+        "ee.vldbc.32    q4, %[lo]\n"
+        "ee.vldbc.32    q5, %[hi]\n"
+        "ee.vldbc.32    q6, %[rnd]\n"
+        "loopgtz        %[blocks], 1f\n"
+        "ee.vld.128.ip  q0, %[src], 16\n"
+        "ee.vld.128.ip  q1, %[src], 16\n"
+        "ee.vadds.s32   q0, q0, q6\n"
+        "ee.vadds.s32   q1, q1, q6\n"
+        "ee.vsr.32      q0, q0\n"
+        "ee.vsr.32      q1, q1\n"
+        "ee.vmin.s32    q0, q0, q5\n"
+        "ee.vmin.s32    q1, q1, q5\n"
+        "ee.vmax.s32    q0, q0, q4\n"
+        "ee.vmax.s32    q1, q1, q4\n"
+        "ee.vunzip.16   q0, q1\n"
+        "ee.vst.128.ip  q0, %[dst], 16\n"
+        "1:\n"
+        : [src] "+r"(src), [dst] "+r"(dst)
+        : [shift] "r"(shift), [blocks] "r"(blocks), [lo] "r"(&PIE_INT16_MIN),
+          [hi] "r"(&PIE_INT16_MAX), [rnd] "r"(&rounding)
+        : "memory");
+    const int done = blocks << 3;
+    scalar_int32_to_int16(in + done, out + done, n - done, shift, 1);
+}
+
+int32_t AUDIO_IRAM dsp_peak_int32(const int32_t* x, int n) {
+    const int blocks = n >> 2;
+    if (blocks == 0 || !pie_aligned(x, x)) {
+        return scalar_peak_int32(x, n);
+    }
+    int32_t lanes[8] __attribute__((aligned(16)));
+    const int32_t* src = x;
+    int32_t* dst = lanes;
+    asm volatile (
+        "ee.zero.q      q0\n"                 // máximo por carril
+        "ee.zero.q      q1\n"                 // mínimo por carril
+        "loopgtz        %[blocks], 1f\n"
+        "ee.vld.128.ip  q2, %[src], 16\n"
+        "ee.vmax.s32    q0, q0, q2\n"
+        "ee.vmin.s32    q1, q1, q2\n"
+        "1:\n"
+        "ee.vst.128.ip  q0, %[dst], 16\n"
+        "ee.vst.128.ip  q1, %[dst], 16\n"
+        : [src] "+r"(src), [dst] "+r"(dst)
+        : [blocks] "r"(blocks)
+        : "memory");
+    int32_t hi = lanes[0], lo = lanes[4];
+    for (int l = 1; l < 4; l++) {
+        hi = lanes[l] > hi ? lanes[l] : hi;
+        lo = lanes[4 + l] < lo ? lanes[4 + l] : lo;
+    }
+    const int done = blocks << 2;
+    int32_t peak = scalar_peak_int32(x + done, n - done);
+    hi = hi > peak ? hi : peak;
+    const int32_t neg = lo == INT32_MIN ? INT32_MAX : -lo;
+    return neg > hi ? neg : hi;
+}
+
+void AUDIO_IRAM dsp_gain(const float* in, float* out, int n, float gain) {
+    dsps_mulc_f32(in, out, n, gain, 1, 1);
+}
+
+void AUDIO_IRAM dsp_multiply(const float* a, const float* b, float* out, int n) {
+    dsps_mul_f32(a, b, out, n, 1, 1, 1);
+}
+
+float AUDIO_IRAM dsp_peak(const float* x, int n) {
+    // 4 acumuladores independientes: sin dependencia entre comparaciones
+    float p0 = 0.0f, p1 = 0.0f, p2 = 0.0f, p3 = 0.0f;
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float a0 = fabsf(x[i]), a1 = fabsf(x[i + 1]);
+        float a2 = fabsf(x[i + 2]), a3 = fabsf(x[i + 3]);
+        p0 = (a0 > p0) ? a0 : p0;
+        p1 = (a1 > p1) ? a1 : p1;
+        p2 = (a2 > p2) ? a2 : p2;
+        p3 = (a3 > p3) ? a3 : p3;
+    }
+    for (; i < n; i++) {
+        float a = fabsf(x[i]);
+        p0 = (a > p0) ? a : p0;
+    }
+    p0 = (p1 > p0) ? p1 : p0;
+    p2 = (p3 > p2) ? p3 : p2;
+    return (p2 > p0) ? p2 : p0;
+}
+
+float AUDIO_IRAM dsp_energy(const float* x, int n) {
+    float acc = 0.0f;
+    dsps_dotprod_f32(x, x, &acc, n);
+    return acc;
+}
+
+float AUDIO_IRAM dsp_dot(const float* a, const float* b, int n) {
+    float acc = 0.0f;
+    dsps_dotprod_f32(a, b, &acc, n);
+    return acc;
+}
+
+void AUDIO_IRAM dsp_axpy(const float* x, float* y, int n, float k) {
+    // Sin dependencia entre muestras: 4 cargas/MADD.S en vuelo
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float y0 = y[i] + k * x[i], y1 = y[i + 1] + k * x[i + 1];
+        float y2 = y[i + 2] + k * x[i + 2], y3 = y[i + 3] + k * x[i + 3];
+        y[i] = y0;
+        y[i + 1] = y1;
+        y[i + 2] = y2;
+        y[i + 3] = y3;
+    }
+    for (; i < n; i++) {
+        y[i] += k * x[i];
+    }
+}
+
+void AUDIO_IRAM dsp_biquad_cascade(float* x, int n, float* const* coeffs, float* const* states, int stages) {
+    for (int s = 0; s < stages; s++) {
+        dsps_biquad_f32(x, x, n, coeffs[s], states[s]);
+    }
+}
+
+#else
+
+void AUDIO_IRAM dsp_int32_to_int16(const int32_t* in, int16_t* out, int n, int shift, int out_step) {
+    scalar_int32_to_int16(in, out, n, shift, out_step);
+}
+
+int32_t AUDIO_IRAM dsp_peak_int32(const int32_t* x, int n) {
+    return scalar_peak_int32(x, n);
+}
+
+void AUDIO_IRAM dsp_int32_to_float(const int32_t* in, float* out, int n, int shift) {
+    scalar_int32_to_float(in, out, n, shift);
+}
+
+void AUDIO_IRAM dsp_float_to_int16(const float* in, int16_t* out, int n, int shift, int out_step) {
+    scalar_float_to_int16(in, out, n, shift, out_step);
+}
+
+void AUDIO_IRAM dsp_gain(const float* in, float* out, int n, float gain) {
+    scalar_gain(in, out, n, gain);
+}
+
+void AUDIO_IRAM dsp_multiply(const float* a, const float* b, float* out, int n) {
+    scalar_multiply(a, b, out, n);
+}
+
+float AUDIO_IRAM dsp_peak(const float* x, int n) {
+    return scalar_peak(x, n);
+}
+
+float AUDIO_IRAM dsp_energy(const float* x, int n) {
+    return scalar_energy(x, n);
+}
+
+float AUDIO_IRAM dsp_dot(const float* a, const float* b, int n) {
+    return scalar_dot(a, b, n);
+}
+
+void AUDIO_IRAM dsp_axpy(const float* x, float* y, int n, float k) {
+    scalar_axpy(x, y, n, k);
+}
+
+void AUDIO_IRAM dsp_biquad_cascade(float* x, int n, float* const* coeffs, float* const* states, int stages) {
+    scalar_biquad_cascade(x, n, coeffs, states, stages);
+}
+
+#endif
+
+// ==================== MICRO-BENCHMARK ====================
+
+#define BENCH_RUNS      32
+#define BENCH_STAGES    6
+
+// Mejor de BENCH_RUNS ejecuciones (descarta interrupciones y caché fría)
+template <typename F>
+static uint32_t measure_cycles(F fn) {
+    uint32_t best = UINT32_MAX;
+    for (int r = 0; r < BENCH_RUNS; r++) {
+        uint32_t start = ESP.getCycleCount();
+        fn();
+        uint32_t elapsed = ESP.getCycleCount() - start;
+        if (elapsed < best) best = elapsed;
+    }
+    return best;
+}
+
+static float max_abs_diff(const float* a, const float* b, int n) {
+    float diff = 0.0f;
+    for (int i = 0; i < n; i++) {
+        float d = fabsf(a[i] - b[i]);
+        if (d > diff) diff = d;
+    }
+    return diff;
+}
+
+static void print_bench(const char* name, uint32_t kernel, uint32_t scalar, float error) {
+    Serial.printf("  %-18s %6lu ciclos (%5.2f/muestra) | escalar %6lu | x%.2f | err %.2e\n",
+                  name, (unsigned long)kernel, (float)kernel / DSP_KERNELS_BENCH_SIZE,
+                  (unsigned long)scalar, (float)scalar / kernel, error);
+}
+
+void dsp_kernels_benchmark() {
+    const int n = DSP_KERNELS_BENCH_SIZE;
+    static int32_t pcm32[DSP_KERNELS_BENCH_SIZE] __attribute__((aligned(16)));
+    static int16_t pcm16[DSP_KERNELS_BENCH_SIZE] __attribute__((aligned(16)));
+    static int16_t ref16[DSP_KERNELS_BENCH_SIZE] __attribute__((aligned(16)));
+    static float in[DSP_KERNELS_BENCH_SIZE] __attribute__((aligned(16)));
+    static float out[DSP_KERNELS_BENCH_SIZE] __attribute__((aligned(16)));
+    static float ref[DSP_KERNELS_BENCH_SIZE] __attribute__((aligned(16)));
+    static float coeff_bank[BENCH_STAGES][5];
+    static float state_bank[2][BENCH_STAGES][2];
+    float* coeffs[BENCH_STAGES];
+    float* states[BENCH_STAGES];
+    float* ref_states[BENCH_STAGES];
+
+    // Señal de prueba: dos tonos con picos por encima de escala completa
+    for (int i = 0; i < n; i++) {
+        float s = 0.7f * sinf(0.05f * i) + 0.5f * sinf(0.71f * i);
+        in[i] = s;
+        pcm32[i] = (int32_t)(0.8f * sinf(0.05f * i) * 2147483647.0f);
+    }
+    // Pasa-bajos estable (Butterworth fc = fs/8) repetido en cada etapa
+    for (int s = 0; s < BENCH_STAGES; s++) {
+        const float c[5] = {0.0976f, 0.1953f, 0.0976f, -0.9428f, 0.3333f};
+        memcpy(coeff_bank[s], c, sizeof(c));
+        coeffs[s] = coeff_bank[s];
+        states[s] = state_bank[0][s];
+        ref_states[s] = state_bank[1][s];
+    }
+
+    Serial.printf("\n⏱️ BENCHMARK DE KERNELS DSP (%d muestras, %s)\n", n,
+                  DSP_KERNELS_OPTIMIZED ? "ESP32-S3 optimizado" : "C escalar");
+
+    uint32_t k, r;
+    float err, e1, e2;
+
+    k = measure_cycles([&]() { dsp_int32_to_float(pcm32, out, n, 31); });
+    r = measure_cycles([&]() { scalar_int32_to_float(pcm32, ref, n, 31); });
+    print_bench("int32 → float", k, r, max_abs_diff(out, ref, n));
+
+    k = measure_cycles([&]() { dsp_float_to_int16(in, pcm16, n, 15, 1); });
+    r = measure_cycles([&]() { scalar_float_to_int16(in, ref16, n, 15, 1); });
+    err = 0.0f;
+    for (int i = 0; i < n; i++) err = fmaxf(err, fabsf((float)(pcm16[i] - ref16[i])));
+    print_bench("float → int16 sat", k, r, err);
+
+    // >> 15: los picos de pcm32 (0.8 · 2^31) saturan, el resto no
+    k = measure_cycles([&]() { dsp_int32_to_int16(pcm32, pcm16, n, 15, 1); });
+    r = measure_cycles([&]() { scalar_int32_to_int16(pcm32, ref16, n, 15, 1); });
+    err = 0.0f;
+    for (int i = 0; i < n; i++) err = fmaxf(err, fabsf((float)(pcm16[i] - ref16[i])));
+    print_bench("int32 → int16 sat", k, r, err);
+
+    int32_t p1 = 0, p2 = 0;
+    k = measure_cycles([&]() { p1 = dsp_peak_int32(pcm32, n); });
+    r = measure_cycles([&]() { p2 = scalar_peak_int32(pcm32, n); });
+    print_bench("pico int32", k, r, fabsf((float)p1 - (float)p2));
+
+    k = measure_cycles([&]() { dsp_gain(in, out, n, 0.5f); });
+    r = measure_cycles([&]() { scalar_gain(in, ref, n, 0.5f); });
+    print_bench("ganancia", k, r, max_abs_diff(out, ref, n));
+
+    k = measure_cycles([&]() { dsp_multiply(in, in, out, n); });
+    r = measure_cycles([&]() { scalar_multiply(in, in, ref, n); });
+    print_bench("multiplicación", k, r, max_abs_diff(out, ref, n));
+
+    k = measure_cycles([&]() { e1 = dsp_peak(in, n); });
+    r = measure_cycles([&]() { e2 = scalar_peak(in, n); });
+    print_bench("pico", k, r, fabsf(e1 - e2));
+
+    k = measure_cycles([&]() { e1 = dsp_energy(in, n); });
+    r = measure_cycles([&]() { e2 = scalar_energy(in, n); });
+    print_bench("energía (RMS)", k, r, fabsf(e1 - e2) / e2);
+
+    k = measure_cycles([&]() { e1 = dsp_dot(in, out, n); });
+    r = measure_cycles([&]() { e2 = scalar_dot(in, out, n); });
+    print_bench("producto escalar", k, r, fabsf(e1 - e2) / fmaxf(fabsf(e2), 1e-20f));
+
+    memcpy(ref, out, sizeof(ref));
+    k = measure_cycles([&]() { dsp_axpy(in, out, n, 1e-3f); });
+    r = measure_cycles([&]() { scalar_axpy(in, ref, n, 1e-3f); });
+    print_bench("axpy", k, r, max_abs_diff(out, ref, n));
+
+    // Cascada: se procesa siempre la misma entrada para comparar salidas
+    memset(state_bank, 0, sizeof(state_bank));
+    k = measure_cycles([&]() { memcpy(out, in, sizeof(out));
+                               dsp_biquad_cascade(out, n, coeffs, states, BENCH_STAGES); });
+    r = measure_cycles([&]() { memcpy(ref, in, sizeof(ref));
+                               scalar_biquad_cascade(ref, n, coeffs, ref_states, BENCH_STAGES); });
+    print_bench("biquad x6", k, r, max_abs_diff(out, ref, n));
+}
@@ -0,0 +1,1251 @@
+// ==================== DSP_PIPELINE.CPP ====================
+// Pipeline DSP por bloques para Aurivox v3.0
+// Todas las etapas trabajan sobre el bloque completo de BUFFER_SIZE muestras
+
+#include "Arduino.h"
+#include <math.h>
+#include <atomic>
+#include "audio_config.h"
+#include "dsp_kernels.h"
+#include "cycle_profiler.h"
+#include "dsp_pipeline.h"
+
+/*
+ * FLUJO POR BLOQUE (Core 0):
+ *
+ *   int32 mic ──▶ float ──▶ [HPF] ──▶ [EQ × N] ──▶ [WDRC] ──▶ [Limitador] ──▶ × ganancia ──▶ int16 DAC
+ *            (o Q4.27)
+ *
+ * - HPF y EQ: una sola cascada de biquads (dsp_biquad_cascade, que en el
+ *   S3 usa la versión aes3 de dsps_biquad_f32)
+ * - EQ: solo se ejecutan las bandas con ganancia distinta de 0 dB
+ * - WDRC: detector RMS cada WDRC_CONTROL_SAMPLES, ganancia interpolada
+ * - Limitador: anticipación de 0.5-2 ms (línea de retardo + máximo
+ *   deslizante); sin picos en la ventana el bloque solo se retrasa
+ *
+ * La decisión de ejecutar cada etapa se toma una vez por bloque.
+ *
+ * Con DSP_FIXED_POINT = 1 el mismo flujo corre en Q4.27 (dsp_fixed.h):
+ * biquads cuantizados en forma directa I, ganancias Q7.24 y limitador
+ * entero; solo el detector del WDRC (1 vez por sub-bloque) usa float.
+ */
+
+// ==================== INTERCAMBIO DE PARÁMETROS (TRIPLE BUFFER) ====================
+
+/*
+ * Core 1 nunca modifica parámetros que Core 0 esté usando:
+ *
+ *   Core 1 (control)              compartido               Core 0 (audio)
+ *   ┌───────────┐   exchange   ┌──────────────┐  exchange  ┌───────────┐
+ *   │ back      │ ───────────▶ │ middle|FRESH │ ─────────▶ │ front     │
+ *   │ (escribe) │ ◀─────────── │              │ ◀───────── │ (procesa) │
+ *   └───────────┘              └──────────────┘            └───────────┘
+ *
+ * Cada set pertenece en todo momento a un único lado. Core 1 copia el
+ * set completo en back (desde la caché de presets, más abajo) y lo
+ * publica con un solo intercambio atómico;
+ * Core 0 lo adopta al inicio de un bloque si FRESH está activo. Ninguno
+ * de los dos espera al otro.
+ *
+ * Los estados de filtros/detectores viven en el set de Core 0 y se
+ * trasladan al set nuevo al adoptarlo, así el cambio no produce saltos.
+ */
+
+#define PARAM_SET_COUNT     3
+#define PARAM_INDEX_MASK    0x03
+#define PARAM_FRESH         0x04    // Bit "set nuevo sin consumir" en middle
+#define PARAM_CROSSFADE     0x08    // El set nuevo entra con fundido (cambio de preset)
+
+static DSPPipeline param_sets[PARAM_SET_COUNT];
+static std::atomic<uint8_t> middle_index(1);
+static std::atomic<uint8_t> front_index(0);   // Escrito por Core 0 (diagnóstico)
+static uint8_t back_index = 2;                // Solo Core 1
+
+// Última configuración publicada (solo Core 1)
+static AudioConfig published_config;
+static float published_gain = 1.0f;
+
+static volatile uint32_t param_swaps = 0;
+
+// Estados que sobreviven a un cambio de parámetros
+struct DSPState {
+    float hpf_state[2];
+    float eq_state[EQ_BANDS_COUNT][2];
+    QBiquad hpf_q;
+    QBiquad eq_q[EQ_BANDS_COUNT];
+    float wdrc_envelope;
+    float wdrc_gain_linear;
+    float wdrc_gain_reduction;
+};
+
+// Solo el estado de un biquad Q (los coeficientes son del set nuevo)
+static void AUDIO_IRAM copy_q_state(QBiquad* dst, const QBiquad* src) {
+    dst->x1 = src->x1;
+    dst->x2 = src->x2;
+    dst->y1 = src->y1;
+    dst->y2 = src->y2;
+    dst->error = src->error;
+}
+
+static void AUDIO_IRAM save_state(const DSPPipeline* p, DSPState* st) {
+    memcpy(st->hpf_state, p->highpass.state, sizeof(st->hpf_state));
+    copy_q_state(&st->hpf_q, &p->highpass_q);
+    for (int b = 0; b < EQ_BANDS_COUNT; b++) {
+        memcpy(st->eq_state[b], p->equalizer.bands[b].state, sizeof(st->eq_state[b]));
+        copy_q_state(&st->eq_q[b], &p->eq_q[b]);
+    }
+    st->wdrc_envelope = p->wdrc.envelope;
+    st->wdrc_gain_linear = p->wdrc.gain_linear;
+    st->wdrc_gain_reduction = p->wdrc.gain_reduction;
+}
+
+static void AUDIO_IRAM restore_state(DSPPipeline* p, const DSPState* st) {
+    memcpy(p->highpass.state, st->hpf_state, sizeof(st->hpf_state));
+    copy_q_state(&p->highpass_q, &st->hpf_q);
+    for (int b = 0; b < EQ_BANDS_COUNT; b++) {
+        memcpy(p->equalizer.bands[b].state, st->eq_state[b], sizeof(st->eq_state[b]));
+        copy_q_state(&p->eq_q[b], &st->eq_q[b]);
+    }
+    p->wdrc.envelope = st->wdrc_envelope;
+    p->wdrc.gain_linear = st->wdrc_gain_linear;
+    p->wdrc.gain_reduction = st->wdrc_gain_reduction;
+}
+
+// ==================== DISEÑO DE FILTROS (Core 1) ====================
+
+// Fórmulas RBJ "Audio EQ Cookbook", normalizadas a a0 = 1
+
+static void normalize_biquad(float* coeffs, float b0, float b1, float b2,
+                             float a0, float a1, float a2) {
+    coeffs[0] = b0 / a0;
+    coeffs[1] = b1 / a0;
+    coeffs[2] = b2 / a0;
+    coeffs[3] = a1 / a0;
+    coeffs[4] = a2 / a0;
+}
+
+static void design_highpass(float* coeffs, float freq, float q) {
+    float w0 = 2.0f * PI * freq / SAMPLE_RATE;
+    float cs = cosf(w0);
+    float alpha = sinf(w0) / (2.0f * q);
+
+    normalize_biquad(coeffs,
+                     (1.0f + cs) / 2.0f, -(1.0f + cs), (1.0f + cs) / 2.0f,
+                     1.0f + alpha, -2.0f * cs, 1.0f - alpha);
+}
+
+static void design_peaking(float* coeffs, float freq, float gain_db, float q) {
+    float A = powf(10.0f, gain_db / 40.0f);
+    float w0 = 2.0f * PI * freq / SAMPLE_RATE;
+    float cs = cosf(w0);
+    float alpha = sinf(w0) / (2.0f * q);
+
+    normalize_biquad(coeffs,
+                     1.0f + alpha * A, -2.0f * cs, 1.0f - alpha * A,
+                     1.0f + alpha / A, -2.0f * cs, 1.0f - alpha / A);
+}
+
+// High-shelf (pendiente S = 1) para bandas demasiado cerca de Nyquist
+static void design_high_shelf(float* coeffs, float freq, float gain_db) {
+    float A = powf(10.0f, gain_db / 40.0f);
+    float w0 = 2.0f * PI * freq / SAMPLE_RATE;
+    float cs = cosf(w0);
+    float beta = 2.0f * sqrtf(A) * sinf(w0) / sqrtf(2.0f);  // 2·√A·alpha
+
+    normalize_biquad(coeffs,
+                     A * ((A + 1.0f) + (A - 1.0f) * cs + beta),
+                     -2.0f * A * ((A - 1.0f) + (A + 1.0f) * cs),
+                     A * ((A + 1.0f) + (A - 1.0f) * cs - beta),
+                     (A + 1.0f) - (A - 1.0f) * cs + beta,
+                     2.0f * ((A - 1.0f) - (A + 1.0f) * cs),
+                     (A + 1.0f) - (A - 1.0f) * cs - beta);
+}
+
+// Coeficiente de suavizado para una constante de tiempo a una tasa dada
+static float time_constant_alpha(float time_ms, float rate_hz) {
+    return expf(-1000.0f / (time_ms * rate_hz));
+}
+
+// ==================== ETAPAS DINÁMICAS (Core 0) ====================
+
+// Detector del WDRC (común a ambas rutas): nivel medio cuadrático del
+// sub-bloque → envolvente en dB → ganancia objetivo lineal
+static inline float wdrc_control_step(const WDRCConfig* wdrc, float mean_square,
+                                      float* envelope, float* reduction_db) {
+    const float slope = 1.0f - 1.0f / wdrc->ratio;
+    float level_db = 10.0f * log10f(mean_square + 1e-12f);
+
+    float alpha = (level_db > *envelope) ? wdrc->alpha_attack : wdrc->alpha_release;
+    *envelope = alpha * *envelope + (1.0f - alpha) * level_db;
+
+    float over_db = *envelope - wdrc->threshold_db;
+    *reduction_db = (over_db > 0.0f) ? over_db * slope : 0.0f;
+
+    return powf(10.0f, -*reduction_db / 20.0f);
+}
+
+// WDRC: un nivel RMS por sub-bloque, ganancia en rampa lineal
+static void AUDIO_IRAM process_wdrc(WDRCConfig* wdrc, float* block, int num_samples) {
+    float envelope = wdrc->envelope;
+    float gain = wdrc->gain_linear;
+    float reduction_db = wdrc->gain_reduction;
+
+    for (int start = 0; start < num_samples; start += WDRC_CONTROL_SAMPLES) {
+        float* chunk = block + start;
+        int count = num_samples - start;
+        if (count > WDRC_CONTROL_SAMPLES) count = WDRC_CONTROL_SAMPLES;
+
+        float target = wdrc_control_step(wdrc, dsp_energy(chunk, count) / count,
+                                         &envelope, &reduction_db);
+        float step = (target - gain) / count;
+        for (int i = 0; i < count; i++) {
+            gain += step;
+            chunk[i] *= gain;
+        }
+    }
+
+    wdrc->envelope = envelope;
+    wdrc->gain_linear = gain;
+    wdrc->gain_reduction = reduction_db;
+}
+
+// WDRC Q4.27: misma rampa con la ganancia en Q7.24
+static void AUDIO_IRAM process_wdrc_q(WDRCConfig* wdrc, int32_t* block, int num_samples) {
+    float envelope = wdrc->envelope;
+    float reduction_db = wdrc->gain_reduction;
+    int32_t gain = q_from_float(wdrc->gain_linear, DSP_Q_GAIN_BITS);
+
+    for (int start = 0; start < num_samples; start += WDRC_CONTROL_SAMPLES) {
+        int32_t* chunk = block + start;
+        int count = num_samples - start;
+        if (count > WDRC_CONTROL_SAMPLES) count = WDRC_CONTROL_SAMPLES;
+
+        float target = wdrc_control_step(wdrc, dsp_q_mean_square(chunk, count),
+                                         &envelope, &reduction_db);
+        int32_t step = (q_from_float(target, DSP_Q_GAIN_BITS) - gain) / count;
+        for (int i = 0; i < count; i++) {
+            gain += step;
+            chunk[i] = q_mul_gain(chunk[i], gain);
+        }
+    }
+
+    wdrc->envelope = envelope;
+    wdrc->gain_linear = q_to_float(gain, DSP_Q_GAIN_BITS);
+    wdrc->gain_reduction = reduction_db;
+}
+
+// ==================== LIMITADOR CON ANTICIPACIÓN (Core 0) ====================
+
+/*
+ * Mismo algoritmo que LookaheadLimiter (Aurivox/limiter.cpp): la ganancia
+ * baja ANTES de que llegue el pico y la salida nunca supera el umbral.
+ *
+ *   x ──┬──────────────▶ [retardo D] ──────────────▶ (×) ──▶ y
+ *       │                                             ▲
+ *       └─▶ máx |x| en D+1 ─▶ T/máx ─▶ release ─▶ media D+1
+ *           (deque monotónica)  g_obj      env        g
+ *
+ *   g_obj[n] = min(1, T / máx |x[n-D .. n]|)
+ *   env[n]   = g_obj[n] si baja (instantáneo), si no release exponencial
+ *              (en float sobre 1 - env: sin estancarse cerca de 1)
+ *   g[n]     = media de env[n-D .. n]        → rampa de ataque de D muestras
+ *   y[n]     = x[n-D] · g[n]
+ *
+ * Cada env[m] con m en [p, p+D] ve el pico x[p] en su ventana y
+ * env ≤ g_obj siempre, así que la media aplicada a x[p] es ≤ T/|x[p]|.
+ *
+ * El deque guarda solo posiciones: el nivel se lee de la línea de
+ * retardo, que conserva las últimas LIMITER_RING muestras. Sin picos
+ * el deque está vacío y el bloque se reduce al retardo.
+ *
+ * La línea corre siempre (también con el limitador desactivado): la
+ * latencia no cambia al activarlo y el fundido mezcla señales alineadas.
+ * Si el set trae otra anticipación, la línea ya guarda la historia: el
+ * deque y la ventana de ganancias se rehacen con la nueva D (ver
+ * retime_limiter) y el fundido tapa el salto de retardo.
+ * El estado vive fuera de los sets, uno por ruta que procesa audio: el
+ * set de Core 0 (sigue tras cada cambio de parámetros), el saliente del
+ * fundido (copia al empezar) y el de la comparación.
+ */
+
+#define LIMITER_RING        128     // Potencia de 2 > retardo máximo + 1
+#define LIMITER_MASK        (LIMITER_RING - 1)
+#define LIMITER_MAX_DELAY   ((int)(LIMITER_MAX_LOOKAHEAD_MS * MAX_SAMPLE_RATE / 1000.0f + 0.5f))
+#define LIMITER_GAIN_BITS   30      // Ganancias Q1.30 de la ruta Q4.27 (≤ 1)
+#define LIMITER_GAIN_ONE    ((int32_t)1 << LIMITER_GAIN_BITS)
+#define LIMITER_GAIN_SNAP_Q (LIMITER_GAIN_ONE / 1000000)  // Release casi en 1 → 1 (como 0.999999f)
+
+static_assert(LIMITER_MAX_DELAY + 1 < LIMITER_RING, "LIMITER_MAX_LOOKAHEAD_MS no cabe en la línea de retardo");
+
+struct LimiterState {
+    float delay_line[LIMITER_RING];        // Ruta float: entrada retrasada
+    float gain_line[LIMITER_RING];         //   envolvente por muestra (media D+1)
+    int32_t delay_line_q[LIMITER_RING];    // Ruta Q4.27
+    int32_t gain_line_q[LIMITER_RING];     //   envolvente Q1.30
+    uint32_t peak_pos[LIMITER_RING];       // Deque de picos sobre el umbral (posiciones)
+    uint32_t peak_head;
+    uint32_t peak_tail;
+    uint32_t pos;                          // Muestras procesadas (índice con LIMITER_MASK)
+    float reduction;                       // 1 - ganancia objetivo con release (ruta float)
+    int32_t envelope_q;                    // Ganancia objetivo con release (Q1.30)
+    int hold;                              // Muestras hasta que la media vuelve a 1
+    int delay;                             // D del deque y de la ventana (-1 = sin seguir)
+    float gain_reduction;                  // Mayor reducción del último bloque (dB)
+};
+
+static LimiterState front_limiter;
+static LimiterState fade_limiter;
+static LimiterState compare_limiter;
+
+static void AUDIO_IRAM reset_limiter(LimiterState* st) {
+    for (int i = 0; i < LIMITER_RING; i++) {
+        st->delay_line[i] = 0.0f;
+        st->gain_line[i] = 1.0f;
+        st->delay_line_q[i] = 0;
+        st->gain_line_q[i] = LIMITER_GAIN_ONE;
+    }
+    st->peak_head = 0;
+    st->peak_tail = 0;
+    st->pos = 0;
+    st->reduction = 0.0f;
+    st->envelope_q = LIMITER_GAIN_ONE;
+    st->hold = 0;
+    st->delay = -1;
+    st->gain_reduction = 0.0f;
+}
+
+// Sin reducción pendiente: ganancia 1 y deque vacío (se rehace al activar)
+static inline void release_limiter(LimiterState* st) {
+    st->peak_head = st->peak_tail;
+    st->reduction = 0.0f;
+    st->envelope_q = LIMITER_GAIN_ONE;
+    st->hold = 0;
+    st->delay = -1;
+    st->gain_reduction = 0.0f;
+}
+
+static inline int32_t q_abs(int32_t x) {
+    return x < 0 ? (x == INT32_MIN ? INT32_MAX : -x) : x;
+}
+
+// Solo retardo: limitador desactivado o bloque sin picos ni reducción en la ventana
+static void AUDIO_IRAM delay_limiter(LimiterState* st, int delay, float* block, int num_samples) {
+    uint32_t pos = st->pos;
+    for (int i = 0; i < num_samples; i++) {
+        st->delay_line[pos & LIMITER_MASK] = block[i];
+        st->gain_line[pos & LIMITER_MASK] = 1.0f;
+        block[i] = st->delay_line[(pos - delay) & LIMITER_MASK];
+        pos++;
+    }
+    st->pos = pos;
+}
+
+static void AUDIO_IRAM delay_limiter(LimiterState* st, int delay, int32_t* block, int num_samples) {
+    uint32_t pos = st->pos;
+    for (int i = 0; i < num_samples; i++) {
+        st->delay_line_q[pos & LIMITER_MASK] = block[i];
+        st->gain_line_q[pos & LIMITER_MASK] = LIMITER_GAIN_ONE;
+        block[i] = st->delay_line_q[(pos - delay) & LIMITER_MASK];
+        pos++;
+    }
+    st->pos = pos;
+}
+
+/*
+ * Nueva D (otro set) o limitador recién activado: las muestras de la
+ * línea que aún no han salido, [pos-D, pos), pueden traer picos que el
+ * deque no siguió. Se rehace con ellas y las ganancias de esa ventana
+ * bajan hasta T/máx: la media que reciba cada una sigue ≤ T/|x|.
+ */
+static void AUDIO_IRAM retime_limiter(LimiterState* st, float threshold, int delay) {
+    uint32_t head = st->peak_tail;
+    uint32_t tail = head;
+    for (uint32_t p = st->pos - delay; p != st->pos; p++) {
+        const float level = fabsf(st->delay_line[p & LIMITER_MASK]);
+        if (level <= threshold) continue;
+        while (head != tail &&
+               fabsf(st->delay_line[st->peak_pos[(tail - 1) & LIMITER_MASK] & LIMITER_MASK]) <= level) {
+            tail--;
+        }
+        st->peak_pos[tail & LIMITER_MASK] = p;
+        tail++;
+    }
+    st->peak_head = head;
+    st->peak_tail = tail;
+    st->delay = delay;
+    if (head == tail) return;
+
+    const float target = 1.0f - threshold / fabsf(st->delay_line[st->peak_pos[head & LIMITER_MASK] & LIMITER_MASK]);
+    if (target > st->reduction) st->reduction = target;
+    for (uint32_t p = st->pos - delay; p != st->pos; p++) {
+        st->gain_line[p & LIMITER_MASK] = fminf(st->gain_line[p & LIMITER_MASK], 1.0f - target);
+    }
+    st->hold = delay + 1;
+}
+
+static void AUDIO_IRAM retime_limiter(LimiterState* st, int32_t threshold, int delay) {
+    uint32_t head = st->peak_tail;
+    uint32_t tail = head;
+    for (uint32_t p = st->pos - delay; p != st->pos; p++) {
+        const int32_t level = q_abs(st->delay_line_q[p & LIMITER_MASK]);
+        if (level <= threshold) continue;
+        while (head != tail &&
+               q_abs(st->delay_line_q[st->peak_pos[(tail - 1) & LIMITER_MASK] & LIMITER_MASK]) <= level) {
+            tail--;
+        }
+        st->peak_pos[tail & LIMITER_MASK] = p;
+        tail++;
+    }
+    st->peak_head = head;
+    st->peak_tail = tail;
+    st->delay = delay;
+    if (head == tail) return;
+
+    const int32_t peak = q_abs(st->delay_line_q[st->peak_pos[head & LIMITER_MASK] & LIMITER_MASK]);
+    const int32_t target = (int32_t)(((int64_t)threshold << LIMITER_GAIN_BITS) / peak);
+    if (target < st->envelope_q) st->envelope_q = target;
+    for (uint32_t p = st->pos - delay; p != st->pos; p++) {
+        int32_t* gain = &st->gain_line_q[p & LIMITER_MASK];
+        if (target < *gain) *gain = target;
+    }
+    st->hold = delay + 1;
+}
+
+static void AUDIO_IRAM process_limiter(const LimiterConfig* limiter, LimiterState* st,
+                                       float* block, int num_samples) {
+    const float threshold = limiter->threshold_linear;
+    const int delay = limiter->delay_samples;
+    if (st->delay != delay) retime_limiter(st, threshold, delay);
+    if (st->peak_head == st->peak_tail && st->hold == 0 && dsp_peak(block, num_samples) <= threshold) {
+        delay_limiter(st, delay, block, num_samples);
+        st->gain_reduction = 0.0f;
+        return;
+    }
+
+    const float release = limiter->alpha_release;
+    const int window = delay + 1;
+    const float inv_window = 1.0f / window;
+    uint32_t pos = st->pos;
+    uint32_t head = st->peak_head;
+    uint32_t tail = st->peak_tail;
+    float reduction = st->reduction;
+    int hold = st->hold;
+
+    // Suma de la ventana recalculada por bloque: sin deriva de redondeo
+    float gain_sum = 0.0f;
+    for (int k = 1; k <= window; k++) {
+        gain_sum += st->gain_line[(pos - k) & LIMITER_MASK];
+    }
+
+    float min_gain = 1.0f;
+    for (int i = 0; i < num_samples; i++) {
+        const float x = block[i];
+        const float level = fabsf(x);
+        st->delay_line[pos & LIMITER_MASK] = x;
+
+        // Máximo deslizante de los niveles sobre el umbral en [pos-D, pos]
+        while (head != tail && pos - st->peak_pos[head & LIMITER_MASK] > (uint32_t)delay) {
+            head++;
+        }
+        if (level > threshold) {
+            while (head != tail &&
+                   fabsf(st->delay_line[st->peak_pos[(tail - 1) & LIMITER_MASK] & LIMITER_MASK]) <= level) {
+                tail--;
+            }
+            st->peak_pos[tail & LIMITER_MASK] = pos;
+            tail++;
+        }
+        const float target = head != tail ?
+                             1.0f - threshold / fabsf(st->delay_line[st->peak_pos[head & LIMITER_MASK] & LIMITER_MASK]) : 0.0f;
+
+        // Ataque instantáneo (la media de D+1 lo suaviza), release exponencial.
+        // Sobre la reducción y no la ganancia: 1 - (1 - g)·α se estanca a
+        // ~0.5/(1-α) ulp de 1 y el release no terminaría nunca
+        if (target > reduction) {
+            reduction = target;
+        } else {
+            reduction = target + (reduction - target) * release;
+            if (target == 0.0f && reduction < 1e-6f) reduction = 0.0f;
+        }
+        hold = reduction > 0.0f ? window : (hold > 0 ? hold - 1 : 0);
+        const float envelope = 1.0f - reduction;
+
+        gain_sum += envelope - st->gain_line[(pos - window) & LIMITER_MASK];
+        st->gain_line[pos & LIMITER_MASK] = envelope;
+
+        // La suma corrida deriva unos ulp en el bloque (~1e-6 con D = 44): el
+        // recorte al umbral solo cubre esa deriva
+        const float gain = hold > 0 ? gain_sum * inv_window : 1.0f;
+        const float y = st->delay_line[(pos - delay) & LIMITER_MASK] * gain;
+        block[i] = fminf(fmaxf(y, -threshold), threshold);
+        if (gain < min_gain) min_gain = gain;
+        pos++;
+    }
+
+    st->pos = pos;
+    st->peak_head = head;
+    st->peak_tail = tail;
+    st->reduction = reduction;
+    st->hold = hold;
+    st->gain_reduction = -LINEAR_TO_DB(min_gain);
+}
+
+// Limitador Q4.27: ganancias Q1.30 (el truncado del release se acumula
+// hasta 1/(1-α) LSB: en Q7.24 serían ~5e-5), una división solo cuando
+// cambia el pico de la ventana
+static void AUDIO_IRAM process_limiter_q(const DSPPipeline* p, LimiterState* st,
+                                         int32_t* block, int num_samples) {
+    const int32_t threshold = p->limiter_threshold_q;
+    const int delay = p->limiter.delay_samples;
+    if (st->delay != delay) retime_limiter(st, threshold, delay);
+    if (st->peak_head == st->peak_tail && st->hold == 0 && dsp_q_peak(block, num_samples) <= threshold) {
+        delay_limiter(st, delay, block, num_samples);
+        st->gain_reduction = 0.0f;
+        return;
+    }
+
+    const int32_t release = p->limiter_release_q;
+    const int64_t inv_window = p->limiter_inv_window_q;
+    const int window = delay + 1;
+    uint32_t pos = st->pos;
+    uint32_t head = st->peak_head;
+    uint32_t tail = st->peak_tail;
+    int32_t envelope = st->envelope_q;
+    int hold = st->hold;
+
+    // Σ de D+1 ganancias Q1.30 ≤ (D+1)·2^30: por 2^31/(D+1) no pasa de 2^61
+    int64_t gain_sum = 0;
+    for (int k = 1; k <= window; k++) {
+        gain_sum += st->gain_line_q[(pos - k) & LIMITER_MASK];
+    }
+
+    int32_t peak_level = 0;               // Nivel de la cabeza del deque con target calculado
+    int32_t target_peak = LIMITER_GAIN_ONE;
+    int32_t min_gain = LIMITER_GAIN_ONE;
+    for (int i = 0; i < num_samples; i++) {
+        const int32_t x = block[i];
+        const int32_t level = q_abs(x);
+        st->delay_line_q[pos & LIMITER_MASK] = x;
+
+        while (head != tail && pos - st->peak_pos[head & LIMITER_MASK] > (uint32_t)delay) {
+            head++;
+        }
+        if (level > threshold) {
+            while (head != tail &&
+                   q_abs(st->delay_line_q[st->peak_pos[(tail - 1) & LIMITER_MASK] & LIMITER_MASK]) <= level) {
+                tail--;
+            }
+            st->peak_pos[tail & LIMITER_MASK] = pos;
+            tail++;
+        }
+        int32_t target = LIMITER_GAIN_ONE;
+        if (head != tail) {
+            const int32_t head_level = q_abs(st->delay_line_q[st->peak_pos[head & LIMITER_MASK] & LIMITER_MASK]);
+            if (head_level != peak_level) {
+                // Truncado hacia abajo: T/máx nunca por encima del real
+                peak_level = head_level;
+                target_peak = (int32_t)(((int64_t)threshold << LIMITER_GAIN_BITS) / head_level);
+            }
+            target = target_peak;
+        }
+
+        if (target < envelope) {
+            envelope = target;
+        } else {
+            // Truncado: la distancia al objetivo baja siempre (sin estancarse antes del salto a 1)
+            envelope = target - (int32_t)(((int64_t)(target - envelope) * release) >> 31);
+            if (target == LIMITER_GAIN_ONE && envelope > LIMITER_GAIN_ONE - LIMITER_GAIN_SNAP_Q) {
+                envelope = LIMITER_GAIN_ONE;
+            }
+        }
+        hold = envelope < LIMITER_GAIN_ONE ? window : (hold > 0 ? hold - 1 : 0);
+
+        gain_sum += envelope - st->gain_line_q[(pos - window) & LIMITER_MASK];
+        st->gain_line_q[pos & LIMITER_MASK] = envelope;
+
+        const int32_t gain = hold > 0 ? (int32_t)((gain_sum * inv_window) >> 31) : LIMITER_GAIN_ONE;
+        const int64_t y = (int64_t)st->delay_line_q[(pos - delay) & LIMITER_MASK] * gain;
+        block[i] = (int32_t)((y + (1 << (LIMITER_GAIN_BITS - 1))) >> LIMITER_GAIN_BITS);
+        if (gain < min_gain) min_gain = gain;
+        pos++;
+    }
+
+    st->pos = pos;
+    st->peak_head = head;
+    st->peak_tail = tail;
+    st->envelope_q = envelope;
+    st->hold = hold;
+    st->gain_reduction = -LINEAR_TO_DB(q_to_float(min_gain, LIMITER_GAIN_BITS));
+}
+
+// ==================== CONSTRUCCIÓN DEL SET (Core 1) ====================
+
+// Punteros de la cascada activa (HPF + bandas EQ activas) hacia el propio set.
+// También en Core 0: set saliente del fundido y set de la comparación
+static void AUDIO_IRAM link_cascade(DSPPipeline* p) {
+    int stages = 0;
+    if (p->highpass.enabled) {
+        p->cascade_coeffs[stages] = p->highpass.coeffs;
+        p->cascade_states[stages] = p->highpass.state;
+        p->cascade_q[stages] = &p->highpass_q;
+        stages++;
+    }
+    if (p->equalizer.enabled) {
+        for (int b = 0; b < EQ_BANDS_COUNT; b++) {
+            EQBand* band = &p->equalizer.bands[b];
+            if (!band->enabled) continue;
+            p->cascade_coeffs[stages] = band->coeffs;
+            p->cascade_states[stages] = band->state;
+            p->cascade_q[stages] = &p->eq_q[b];
+            stages++;
+        }
+    }
+    p->cascade_stages = stages;
+}
+
+// Anticipación en muestras del formato activo (la línea cubre LIMITER_MAX_LOOKAHEAD_MS)
+static int lookahead_samples(float lookahead_ms) {
+    const float ms = CLAMP(lookahead_ms, LIMITER_MIN_LOOKAHEAD_MS, LIMITER_MAX_LOOKAHEAD_MS);
+    return (int)(ms * SAMPLE_RATE / 1000.0f + 0.5f);
+}
+
+static void set_output_gain(DSPPipeline* p, float output_gain) {
+    p->output_gain = output_gain;
+    p->output_gain_q = q_from_float(output_gain, DSP_Q_GAIN_BITS);
+}
+
+// Calcula un set completo de parámetros (Core 1, nunca sobre el set de Core 0)
+static void build_pipeline(DSPPipeline* p, const AudioConfig* config, float output_gain) {
+    const float max_freq = EQ_MAX_FREQ_RATIO * SAMPLE_RATE;
+
+    // 1. Filtro pasa-altos (primera etapa de la cascada)
+    HighpassConfig* hpf = &p->highpass;
+    hpf->cutoff_freq = CLAMP(config->highpass_freq, 20.0f, max_freq);
+    design_highpass(hpf->coeffs, hpf->cutoff_freq, HPF_Q);
+    dsp_q_biquad_design(&p->highpass_q, hpf->coeffs);
+    hpf->enabled = config->highpass_enabled;
+
+    // 2. Ecualizador: solo las bandas con ganancia útil entran en la cascada
+    int active_count = 0;
+    for (int b = 0; b < EQ_BANDS_COUNT; b++) {
+        EQBand* band = &p->equalizer.bands[b];
+        band->freq = EQ_FREQUENCIES[b];
+        band->gain_db = CLAMP(config->eq_gains[b], EQ_GAIN_MIN_DB, EQ_GAIN_MAX_DB);
+        band->gain_linear = DB_TO_LINEAR(band->gain_db);
+        band->Q = EQ_DEFAULT_Q;
+
+        if (band->freq > max_freq) {
+            design_high_shelf(band->coeffs, max_freq, band->gain_db);
+        } else {
+            design_peaking(band->coeffs, band->freq, band->gain_db, band->Q);
+        }
+        dsp_q_biquad_design(&p->eq_q[b], band->coeffs);
+
+        band->enabled = fabsf(band->gain_db) >= EQ_BYPASS_DB;
+        if (band->enabled) {
+            active_count++;
+        }
+    }
+    p->eq_active_count = active_count;
+    p->equalizer.enabled = config->eq_enabled && active_count > 0;
+    link_cascade(p);
+
+    // 3. WDRC (coeficientes a la tasa de control)
+    const float control_rate = (float)SAMPLE_RATE / WDRC_CONTROL_SAMPLES;
+    WDRCConfig* wdrc = &p->wdrc;
+    wdrc->threshold_db = CLAMP(config->wdrc_threshold, WDRC_THRESHOLD_MIN_DB, WDRC_THRESHOLD_MAX_DB);
+    wdrc->ratio = CLAMP(config->wdrc_ratio, WDRC_RATIO_MIN, WDRC_RATIO_MAX);
+    wdrc->attack_ms = CLAMP(config->wdrc_attack, WDRC_ATTACK_MIN_MS, WDRC_ATTACK_MAX_MS);
+    wdrc->release_ms = CLAMP(config->wdrc_release, WDRC_RELEASE_MIN_MS, WDRC_RELEASE_MAX_MS);
+    wdrc->alpha_attack = time_constant_alpha(wdrc->attack_ms, control_rate);
+    wdrc->alpha_release = time_constant_alpha(wdrc->release_ms, control_rate);
+    wdrc->enabled = config->wdrc_enabled;
+
+    // 4. Limitador
+    LimiterConfig* limiter = &p->limiter;
+    limiter->threshold_db = CLAMP(config->limiter_threshold, -40.0f, 0.0f);
+    limiter->threshold_linear = DB_TO_LINEAR(limiter->threshold_db);
+    limiter->release_ms = LIMITER_RELEASE_MS;
+    limiter->alpha_release = time_constant_alpha(limiter->release_ms, SAMPLE_RATE);
+    limiter->delay_samples = lookahead_samples(config->limiter_lookahead);
+    limiter->lookahead_ms = limiter->delay_samples * 1000.0f / SAMPLE_RATE;
+    limiter->attack_ms = limiter->lookahead_ms;
+    p->limiter_threshold_q = q_from_float(limiter->threshold_linear, DSP_Q_FRAC_BITS);
+    p->limiter_release_q = q_from_float(limiter->alpha_release, 31);
+    p->limiter_inv_window_q = (int32_t)(((int64_t)1 << 31) / (limiter->delay_samples + 1));
+    limiter->enabled = config->limiter_enabled;
+
+    // 5. Ganancia final
+    set_output_gain(p, output_gain);
+}
+
+
+// ==================== CACHÉ DE PRESETS (Core 1) ====================
+
+/*
+ * Sets ya calculados, indexados por configuración: los presets de
+ * firmware se calculan al arrancar (y tras cambiar el formato) y las
+ * últimas DSP_PRESET_CACHE_CUSTOM configuraciones (NVS, comandos) la
+ * primera vez que se usan. Un acierto evita los sin/cos/pow de
+ * build_pipeline(): publicar es copiar el set y enlazar la cascada.
+ *
+ *   configure_dsp_pipeline ──▶ ¿en caché? ──sí──▶ copia a back ──▶ publicar
+ *                                  │                   ▲
+ *                                  └──no──▶ build_pipeline en entrada LRU
+ */
+
+#define PRESET_CACHE_BUILTIN    PRESET_CUSTOM     // PRESET_DEFAULT .. PRESET_SPEECH
+#define PRESET_CACHE_SIZE       (PRESET_CACHE_BUILTIN + DSP_PRESET_CACHE_CUSTOM)
+
+struct CachedPipeline {
+    bool valid;
+    uint32_t last_use;          // Reloj LRU (solo entradas personalizadas)
+    AudioConfig config;
+    DSPPipeline params;         // Con ganancia final 1 y estados a cero
+};
+
+static CachedPipeline preset_cache[PRESET_CACHE_SIZE];
+static uint32_t cache_clock = 0;
+static uint32_t cache_hits = 0;
+static uint32_t cache_builds = 0;
+
+extern const AudioConfig* get_preset_config(PresetType preset_type);
+
+// Solo los campos que lee build_pipeline()
+static bool same_dsp_config(const AudioConfig* a, const AudioConfig* b) {
+    if (a->highpass_enabled != b->highpass_enabled || a->highpass_freq != b->highpass_freq ||
+        a->eq_enabled != b->eq_enabled ||
+        a->wdrc_enabled != b->wdrc_enabled || a->wdrc_threshold != b->wdrc_threshold ||
+        a->wdrc_ratio != b->wdrc_ratio || a->wdrc_attack != b->wdrc_attack ||
+        a->wdrc_release != b->wdrc_release ||
+        a->limiter_enabled != b->limiter_enabled || a->limiter_threshold != b->limiter_threshold ||
+        a->limiter_lookahead != b->limiter_lookahead) {
+        return false;
+    }
+    for (int b_index = 0; b_index < EQ_BANDS_COUNT; b_index++) {
+        if (a->eq_gains[b_index] != b->eq_gains[b_index]) return false;
+    }
+    return true;
+}
+
+static void fill_cache_entry(CachedPipeline* entry, const AudioConfig* config) {
+    entry->config = *config;
+    build_pipeline(&entry->params, config, 1.0f);
+    entry->valid = true;
+    entry->last_use = ++cache_clock;
+    cache_builds++;
+}
+
+// Presets de firmware con el formato activo; las personalizadas se descartan
+static void fill_preset_cache() {
+    for (int i = 0; i < PRESET_CACHE_BUILTIN; i++) {
+        fill_cache_entry(&preset_cache[i], get_preset_config((PresetType)i));
+    }
+    for (int i = PRESET_CACHE_BUILTIN; i < PRESET_CACHE_SIZE; i++) {
+        preset_cache[i].valid = false;
+    }
+}
+
+static const DSPPipeline* cached_pipeline(const AudioConfig* config) {
+    CachedPipeline* victim = nullptr;
+    for (int i = 0; i < PRESET_CACHE_SIZE; i++) {
+        CachedPipeline* entry = &preset_cache[i];
+        if (entry->valid && same_dsp_config(&entry->config, config)) {
+            entry->last_use = ++cache_clock;
+            cache_hits++;
+            return &entry->params;
+        }
+        // Víctima: entrada personalizada libre o la usada hace más tiempo
+        if (i >= PRESET_CACHE_BUILTIN &&
+            (!victim || (victim->valid && (!entry->valid || entry->last_use < victim->last_use)))) {
+            victim = entry;
+        }
+    }
+    fill_cache_entry(victim, config);
+    return &victim->params;
+}
+
+// ==================== PUBLICACIÓN ====================
+
+// Publicar: back → middle, el set que vuelve queda libre para Core 1.
+// Un fundido pendiente sin consumir se conserva al reemplazar el set
+static void publish_pipeline(const DSPPipeline* source, bool crossfade) {
+    DSPPipeline* back = &param_sets[back_index];
+    memcpy(back, source, sizeof(*back));
+    link_cascade(back);
+    set_output_gain(back, published_gain);
+
+    uint8_t flags = PARAM_FRESH;
+    if (crossfade || (middle_index.load(std::memory_order_acquire) & PARAM_CROSSFADE)) {
+        flags |= PARAM_CROSSFADE;
+    }
+    uint8_t previous = middle_index.exchange(back_index | flags, std::memory_order_acq_rel);
+    back_index = previous & PARAM_INDEX_MASK;
+}
+
+// ==================== FUNDIDO ENTRE SETS (Core 0) ====================
+
+/*
+ * Al adoptar un set con PARAM_CROSSFADE, el set saliente se copia (con
+ * sus estados) y sigue procesando una copia de la entrada durante
+ * DSP_CROSSFADE_MS; la salida pasa de uno a otro con una rampa lineal:
+ *
+ *   bloque ──┬──▶ set nuevo ──────▶ ·g ──┐
+ *            └──▶ set saliente ───▶ ·(1-g) ──▶ Σ ──▶ salida     g: 0 → 1
+ *
+ * Duplica el coste del DSP solo mientras dura el fundido. El primer set
+ * adoptado (arranque) entra sin fundido.
+ */
+
+static DSPPipeline fade_set;
+static dsp_sample_t fade_block[MAX_BUFFER_SIZE] __attribute__((aligned(16)));
+static int fade_length = 0;
+static int fade_remaining = 0;      // Muestras de fundido pendientes (0 = sin fundido)
+static bool pipeline_started = false;
+
+#if DSP_FIXED_POINT
+// Rampa en Q0.31; la diferencia de dos muestras Q4.27 necesita 33 bits
+static void AUDIO_IRAM crossfade_block(int32_t* block, const int32_t* old, int num_samples) {
+    const int64_t one = (int64_t)1 << 31;
+    const int64_t step = one / fade_length;
+    int64_t mix = one - fade_remaining * step;
+    for (int i = 0; i < num_samples; i++) {
+        mix = mix + step < one ? mix + step : one;
+        block[i] = old[i] + (int32_t)((((int64_t)block[i] - old[i]) * mix) >> 31);
+    }
+}
+#else
+static void AUDIO_IRAM crossfade_block(float* block, const float* old, int num_samples) {
+    const float step = 1.0f / fade_length;
+    float mix = 1.0f - fade_remaining * step;
+    for (int i = 0; i < num_samples; i++) {
+        mix = fminf(mix + step, 1.0f);
+        block[i] = old[i] + (block[i] - old[i]) * mix;
+    }
+}
+#endif
+
+// Adoptar el último set publicado (Core 0, al inicio de cada bloque)
+static inline DSPPipeline* acquire_pipeline() {
+    uint8_t front = front_index.load(std::memory_order_relaxed);
+    const uint8_t pending = middle_index.load(std::memory_order_acquire);
+    if (pending & PARAM_FRESH) {
+        // El set saliente se copia antes del intercambio: después ya es de Core 1
+        const bool crossfade = (pending & PARAM_CROSSFADE) && pipeline_started;
+        if (crossfade) {
+            memcpy(&fade_set, &param_sets[front], sizeof(fade_set));
+            memcpy(&fade_limiter, &front_limiter, sizeof(fade_limiter));
+        }
+        DSPState state;
+        save_state(&param_sets[front], &state);
+        front = middle_index.exchange(front, std::memory_order_acq_rel) & PARAM_INDEX_MASK;
+        restore_state(&param_sets[front], &state);
+        front_index.store(front, std::memory_order_release);
+        param_swaps = param_swaps + 1;
+
+        if (crossfade) {
+            link_cascade(&fade_set);
+            fade_length = DSP_CROSSFADE_MS * SAMPLE_RATE / 1000;
+            fade_remaining = fade_length;
+        }
+    }
+    return &param_sets[front];
+}
+
+// ==================== SILENCIO CON RAMPA (Core 0) ====================
+
+/*
+ * Sleep/wake sin pop ni cola de audio viejo:
+ *
+ *   nivel 1 ──╮                                    ╭── 1
+ *             ╰─ 0 ─ vaciado ─┤ sleep ├─ espera ─╯
+ *              rampa   DMA     streams    micrófono  rampa
+ *
+ * Core 1 pide el silencio (mute_request) y espera mute_settled antes de
+ * parar los streams; al despertar lo quita y el bloque sale a cero hasta
+ * que pasa DSP_UNMUTE_HOLD_MS. Nivel en Q1.30 común a las dos rutas.
+ */
+
+#define MUTE_LEVEL_ONE  ((int32_t)1 << 30)
+
+static std::atomic<bool> mute_request(false);
+static std::atomic<bool> mute_settled(false);   // Core 0 → Core 1: silencio y DMA vaciado
+static int32_t mute_level = MUTE_LEVEL_ONE;     // Solo Core 0
+static bool mute_closed = false;                // Nivel 0 alcanzado con silencio pedido
+static int mute_wait = 0;                       // Muestras a cero pendientes (vaciado o espera)
+
+#if DSP_FIXED_POINT
+static void AUDIO_IRAM mute_ramp_block(int32_t* block, int num_samples, int32_t step) {
+    int32_t level = mute_level;
+    for (int i = 0; i < num_samples; i++) {
+        level = CLAMP(level + step, 0, MUTE_LEVEL_ONE);
+        block[i] = (int32_t)(((int64_t)block[i] * level) >> 30);
+    }
+    mute_level = level;
+}
+#else
+static void AUDIO_IRAM mute_ramp_block(float* block, int num_samples, int32_t step) {
+    const float scale = 1.0f / MUTE_LEVEL_ONE;
+    int32_t level = mute_level;
+    for (int i = 0; i < num_samples; i++) {
+        level = CLAMP(level + step, 0, MUTE_LEVEL_ONE);
+        block[i] *= level * scale;
+    }
+    mute_level = level;
+}
+#endif
+
+static void AUDIO_IRAM apply_output_mute(dsp_sample_t* block, int num_samples) {
+    const bool muted = mute_request.load(std::memory_order_acquire);
+    if (!muted && mute_level == MUTE_LEVEL_ONE) return;
+
+    if (mute_level == 0) {
+        if (muted != mute_closed) {
+            mute_closed = muted;
+            mute_wait = muted ? DSP_MUTE_FLUSH_BLOCKS * BUFFER_SIZE
+                              : DSP_UNMUTE_HOLD_MS * SAMPLE_RATE / 1000;
+            if (!muted) mute_settled.store(false, std::memory_order_relaxed);
+        }
+        if (muted || mute_wait > 0) {
+            memset(block, 0, num_samples * sizeof(dsp_sample_t));
+            if (mute_wait > 0) {
+                mute_wait -= num_samples;
+                if (mute_wait <= 0 && muted) mute_settled.store(true, std::memory_order_release);
+            }
+            return;
+        }
+    }
+
+    const int32_t step = MUTE_LEVEL_ONE / (DSP_MUTE_RAMP_MS * SAMPLE_RATE / 1000);
+    mute_ramp_block(block, num_samples, muted ? -step : step);
+}
+
+// ==================== RUTAS DE PROCESO (Core 0) ====================
+
+// timed = false: ruta de comparación, fuera del perfil de etapas
+static void AUDIO_IRAM run_pipeline(DSPPipeline& pipeline, LimiterState* limiter,
+                                    float* block, int num_samples, bool timed) {
+    uint32_t t = timed ? profiler_cycles() : 0;
+    auto lap = [&](int stage) { if (timed) t = profiler_lap(stage, t); };
+
+    // HPF + EQ (etapas desactivadas ya excluidas de la cascada).
+    // El HPF, si está activo, es la primera etapa: se llama aparte para
+    // medir cada filtro por separado.
+    const int hpf_stages = pipeline.highpass.enabled ? 1 : 0;
+    if (hpf_stages > 0) {
+        dsp_biquad_cascade(block, num_samples, pipeline.cascade_coeffs,
+                           pipeline.cascade_states, hpf_stages);
+    }
+    lap(PROF_HPF);
+
+    if (pipeline.cascade_stages > hpf_stages) {
+        dsp_biquad_cascade(block, num_samples, pipeline.cascade_coeffs + hpf_stages,
+                           pipeline.cascade_states + hpf_stages,
+                           pipeline.cascade_stages - hpf_stages);
+    }
+    lap(PROF_EQ);
+
+    if (pipeline.wdrc.enabled) {
+        process_wdrc(&pipeline.wdrc, block, num_samples);
+    }
+    lap(PROF_WDRC);
+
+    if (pipeline.limiter.enabled) {
+        process_limiter(&pipeline.limiter, limiter, block, num_samples);
+    } else {
+        delay_limiter(limiter, pipeline.limiter.delay_samples, block, num_samples);
+        release_limiter(limiter);
+    }
+    lap(PROF_LIMITER);
+
+    dsp_gain(block, block, num_samples, pipeline.output_gain);
+    lap(PROF_OUTPUT_GAIN);
+}
+
+static void AUDIO_IRAM run_pipeline(DSPPipeline& pipeline, LimiterState* limiter,
+                                    int32_t* block, int num_samples, bool timed) {
+    uint32_t t = timed ? profiler_cycles() : 0;
+    auto lap = [&](int stage) { if (timed) t = profiler_lap(stage, t); };
+
+    const int hpf_stages = pipeline.highpass.enabled ? 1 : 0;
+    if (hpf_stages > 0) {
+        dsp_q_biquad_cascade(block, num_samples, pipeline.cascade_q, hpf_stages);
+    }
+    lap(PROF_HPF);
+
+    if (pipeline.cascade_stages > hpf_stages) {
+        dsp_q_biquad_cascade(block, num_samples, pipeline.cascade_q + hpf_stages,
+                             pipeline.cascade_stages - hpf_stages);
+    }
+    lap(PROF_EQ);
+
+    if (pipeline.wdrc.enabled) {
+        process_wdrc_q(&pipeline.wdrc, block, num_samples);
+    }
+    lap(PROF_WDRC);
+
+    if (pipeline.limiter.enabled) {
+        process_limiter_q(&pipeline, limiter, block, num_samples);
+    } else {
+        delay_limiter(limiter, pipeline.limiter.delay_samples, block, num_samples);
+        release_limiter(limiter);
+    }
+    lap(PROF_LIMITER);
+
+    dsp_q_gain(block, num_samples, pipeline.output_gain_q);
+    lap(PROF_OUTPUT_GAIN);
+}
+
+// ==================== COMPARACIÓN COMA FIJA / FLOAT (Core 0) ====================
+
+/*
+ * La otra ruta procesa una copia del bloque de entrada con un set sombra:
+ * mismos parámetros y dinámica (envolventes) que el set de Core 0 al
+ * arrancar, biquads a cero y DSP_COMPARE_WARMUP_MS descartados hasta que
+ * sus estados convergen. Un cambio de parámetros se traslada al set
+ * sombra igual que en acquire_pipeline(), conservando sus estados.
+ *
+ *   bloque ──┬──▶ ruta activa ──▶ salida
+ *            └──▶ copia ──▶ otra ruta ──▶ Σ ref², Σ (ref - Q)², max |ref - Q|
+ *
+ * La referencia (ref) es siempre la salida de la ruta float.
+ */
+
+struct DSPCompareStats {
+    uint32_t blocks;
+    double signal_energy;
+    double error_energy;
+    float max_error;
+};
+
+static DSPPipeline compare_set;
+static std::atomic<bool> compare_request(false);
+static bool compare_active = false;           // Solo Core 0
+static uint32_t compare_swaps = 0;
+static int compare_warmup_blocks = 0;
+static DSPCompareStats compare_stats;
+#if DSP_FIXED_POINT
+static float compare_block[MAX_BUFFER_SIZE] __attribute__((aligned(16)));
+#else
+static int32_t compare_block[MAX_BUFFER_SIZE];
+#endif
+
+static void AUDIO_IRAM reset_filter_states(DSPPipeline* p) {
+    memset(p->highpass.state, 0, sizeof(p->highpass.state));
+    dsp_q_biquad_reset(&p->highpass_q);
+    for (int b = 0; b < EQ_BANDS_COUNT; b++) {
+        memset(p->equalizer.bands[b].state, 0, sizeof(p->equalizer.bands[b].state));
+        dsp_q_biquad_reset(&p->eq_q[b]);
+    }
+}
+
+static void AUDIO_IRAM update_comparison(const DSPPipeline* front) {
+    if (!compare_request.load(std::memory_order_acquire)) {
+        compare_active = false;
+        return;
+    }
+    if (!compare_active) {
+        memcpy(&compare_set, front, sizeof(compare_set));
+        reset_filter_states(&compare_set);
+        reset_limiter(&compare_limiter);
+        link_cascade(&compare_set);
+        memset(&compare_stats, 0, sizeof(compare_stats));
+        compare_warmup_blocks = (DSP_COMPARE_WARMUP_MS * SAMPLE_RATE) / (1000 * BUFFER_SIZE);
+        compare_swaps = param_swaps;
+        compare_active = true;
+    } else if (compare_swaps != param_swaps) {
+        DSPState state;
+        save_state(&compare_set, &state);
+        memcpy(&compare_set, front, sizeof(compare_set));
+        restore_state(&compare_set, &state);
+        link_cascade(&compare_set);
+        compare_swaps = param_swaps;
+    }
+}
+
+static void AUDIO_IRAM accumulate_comparison(const float* ref, const int32_t* fixed, int num_samples) {
+    if (compare_warmup_blocks > 0) {
+        compare_warmup_blocks--;
+        return;
+    }
+    float signal = 0.0f, error = 0.0f, max_error = compare_stats.max_error;
+    for (int i = 0; i < num_samples; i++) {
+        float d = ref[i] - q_to_float(fixed[i], DSP_Q_FRAC_BITS);
+        signal += ref[i] * ref[i];
+        error += d * d;
+        max_error = fmaxf(max_error, fabsf(d));
+    }
+    compare_stats.signal_energy += signal;
+    compare_stats.error_energy += error;
+    compare_stats.max_error = max_error;
+    compare_stats.blocks++;
+}
+
+// ==================== FUNCIONES PÚBLICAS ====================
+
+void initialize_dsp_pipeline() {
+    memset(param_sets, 0, sizeof(param_sets));
+    reset_limiter(&front_limiter);
+    published_config = DEFAULT_CONFIG;
+    published_gain = 1.0f;
+    fill_preset_cache();
+
+    // Antes de crear la tarea de audio: el set inicial se escribe directo en front
+    const DSPPipeline* initial = cached_pipeline(&published_config);
+    for (int i = 0; i < PARAM_SET_COUNT; i++) {
+        memcpy(&param_sets[i], initial, sizeof(param_sets[i]));
+        link_cascade(&param_sets[i]);
+        set_output_gain(&param_sets[i], published_gain);
+    }
+    DSPPipeline* front = &param_sets[front_index.load()];
+    front->wdrc.envelope = -120.0f;
+    front->wdrc.gain_linear = 1.0f;
+
+    Serial.println("✅ Pipeline DSP inicializado (procesamiento por bloques, triple buffer)");
+}
+
+void configure_dsp_pipeline(const AudioConfig* config) {
+    published_config = *config;
+    published_gain = gain_levels[CLAMP(config->gain_level, 0, GAIN_LEVELS_COUNT - 1)];
+    publish_pipeline(cached_pipeline(config), true);
+}
+
+void rebuild_dsp_pipeline() {
+    // Core 0 aparcado: la anticipación en muestras cambia con SAMPLE_RATE
+    reset_limiter(&front_limiter);
+    reset_limiter(&fade_limiter);
+    fill_preset_cache();
+    publish_pipeline(cached_pipeline(&published_config), false);
+}
+
+int get_dsp_latency_samples() {
+    return lookahead_samples(published_config.limiter_lookahead);
+}
+
+void set_dsp_output_gain(float output_gain) {
+    published_gain = output_gain;
+    publish_pipeline(cached_pipeline(&published_config), false);
+}
+
+void AUDIO_IRAM process_dsp_pipeline(dsp_sample_t* block, int num_samples) {
+    DSPPipeline& pipeline = *acquire_pipeline();
+    update_comparison(&pipeline);
+
+    const bool fading = fade_remaining > 0;
+    if (fading) {
+        memcpy(fade_block, block, num_samples * sizeof(dsp_sample_t));
+    }
+
+    if (compare_active) {
+#if DSP_FIXED_POINT
+        dsp_q_to_float(block, compare_block, num_samples);
+#else
+        dsp_q_from_float(block, compare_block, num_samples);
+#endif
+    }
+
+    run_pipeline(pipeline, &front_limiter, block, num_samples, true);
+
+    if (compare_active) {
+        run_pipeline(compare_set, &compare_limiter, compare_block, num_samples, false);
+#if DSP_FIXED_POINT
+        accumulate_comparison(compare_block, block, num_samples);
+#else
+        accumulate_comparison(block, compare_block, num_samples);
+#endif
+    }
+
+    // Tras la comparación: el fundido no cuenta como error de la coma fija
+    if (fading) {
+        run_pipeline(fade_set, &fade_limiter, fade_block, num_samples, false);
+        crossfade_block(block, fade_block, num_samples);
+        fade_remaining = fade_remaining > num_samples ? fade_remaining - num_samples : 0;
+    }
+    apply_output_mute(block, num_samples);
+    pipeline_started = true;
+}
+
+void set_dsp_output_mute(bool muted) {
+    if (muted) mute_settled.store(false, std::memory_order_relaxed);
+    mute_request.store(muted, std::memory_order_release);
+}
+
+bool is_dsp_output_muted() {
+    return mute_settled.load(std::memory_order_acquire);
+}
+
+void set_dsp_comparison(bool enabled) {
+    compare_request.store(enabled, std::memory_order_release);
+}
+
+void print_dsp_comparison() {
+    // Copia: Core 0 sigue acumulando (puede mezclar dos bloques, es diagnóstico)
+    DSPCompareStats stats;
+    memcpy(&stats, &compare_stats, sizeof(stats));
+
+    Serial.printf("\n🔬 COMPARACIÓN Q4.27 vs FLOAT (ruta activa: %s)\n", DSP_SAMPLE_FORMAT);
+    if (!compare_request.load(std::memory_order_acquire)) {
+        Serial.println("   Inactiva ('dsp_compare on' para iniciar)");
+    }
+    if (stats.blocks == 0) {
+        Serial.println("   Sin bloques comparados todavía");
+        return;
+    }
+
+    float snr_db = stats.error_energy > 0.0 ?
+                   (float)(10.0 * log10(stats.signal_energy / stats.error_energy)) : INFINITY;
+    Serial.printf("   Bloques: %lu (%.1f s) | SNR: %.1f dB | error máx: %.2e (%.1f dBFS)\n",
+                  (unsigned long)stats.blocks, (float)stats.blocks * BUFFER_SIZE / SAMPLE_RATE,
+                  snr_db, stats.max_error,
+                  stats.max_error > 0.0f ? LINEAR_TO_DB(stats.max_error) : -INFINITY);
+}
+
+void get_dsp_block_meters(DSPBlockMeters* meters) {
+    const DSPPipeline& pipeline = param_sets[front_index.load(std::memory_order_relaxed)];
+    meters->wdrc_envelope_db = pipeline.wdrc.envelope;
+    meters->wdrc_reduction_db = pipeline.wdrc.enabled ? pipeline.wdrc.gain_reduction : 0.0f;
+    meters->limiter_reduction_db = pipeline.limiter.enabled ? front_limiter.gain_reduction : 0.0f;
+}
+
+void print_dsp_pipeline_status() {
+    // Solo lectura del set de Core 0: los estados pueden estar a mitad de bloque
+    const DSPPipeline& pipeline = param_sets[front_index.load(std::memory_order_acquire)];
+
+    Serial.printf("   Ruta DSP: %s\n", DSP_SAMPLE_FORMAT);
+    Serial.printf("   Filtro Pasa-Altos: %s (%.0fHz)\n",
+                  pipeline.highpass.enabled ? "✅ ACTIVO" : "❌ DESACTIVADO",
+                  pipeline.highpass.cutoff_freq);
+
+    Serial.printf("   Ecualizador: %s (%d/%d bandas en cascada)\n",
+                  pipeline.equalizer.enabled ? "✅ ACTIVO" : "❌ DESACTIVADO",
+                  pipeline.eq_active_count, EQ_BANDS_COUNT);
+    for (int b = 0; b < EQ_BANDS_COUNT; b++) {
+        const EQBand* band = &pipeline.equalizer.bands[b];
+        Serial.printf("      %5.0fHz: %+5.1fdB%s\n", band->freq, band->gain_db,
+                      band->freq > EQ_MAX_FREQ_RATIO * SAMPLE_RATE ? " (high-shelf)" : "");
+    }
+
+    Serial.printf("   WDRC: %s (%.1fdB, %.1f:1, %.0f/%.0fms) - reducción %.1fdB\n",
+                  pipeline.wdrc.enabled ? "✅ ACTIVO" : "❌ DESACTIVADO",
+                  pipeline.wdrc.threshold_db, pipeline.wdrc.ratio,
+                  pipeline.wdrc.attack_ms, pipeline.wdrc.release_ms,
+                  pipeline.wdrc.gain_reduction);
+
+    Serial.printf("   Limitador: %s (%.1fdB, anticipación %.2f ms, release %.0f ms) - reducción %.1fdB\n",
+                  pipeline.limiter.enabled ? "✅ ACTIVO" : "❌ DESACTIVADO",
+                  pipeline.limiter.threshold_db, pipeline.limiter.lookahead_ms,
+                  pipeline.limiter.release_ms, front_limiter.gain_reduction);
+    Serial.printf("   Latencia del DSP: %d muestras (%.2f ms, también con el limitador desactivado)\n",
+                  get_dsp_latency_samples(), samples_to_ms(get_dsp_latency_samples()));
+
+    Serial.printf("   Ganancia final: %.0f%% | Cambios de parámetros aplicados: %lu\n",
+                  pipeline.output_gain * 100, (unsigned long)param_swaps);
+
+    int cached = 0;
+    for (int i = 0; i < PRESET_CACHE_SIZE; i++) {
+        if (preset_cache[i].valid) cached++;
+    }
+    Serial.printf("   Caché de presets: %d/%d sets (%d de firmware) | aciertos %lu, cálculos %lu | fundido %d ms\n",
+                  cached, PRESET_CACHE_SIZE, PRESET_CACHE_BUILTIN, (unsigned long)cache_hits,
+                  (unsigned long)cache_builds, DSP_CROSSFADE_MS);
+}
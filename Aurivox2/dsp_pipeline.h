@@ -0,0 +1,185 @@
+// ==================== DSP_PIPELINE.H ====================
+// Pipeline DSP por bloques para Aurivox v3.0
+// HPF → EQ 6 bandas → WDRC → Limitador → Ganancia final (Core 0)
+// Conversiones int32/float/int16: dsp_kernels.h (float) y dsp_fixed.h (Q4.27)
+
+#ifndef DSP_PIPELINE_H
+#define DSP_PIPELINE_H
+
+#include "audio_config.h"
+#include "dsp_fixed.h"
+
+// ==================== CONFIGURACIONES DEL PIPELINE ====================
+
+#define HPF_Q                   0.7071f   // Butterworth
+#define EQ_DEFAULT_Q            1.41f     // ~1 octava de ancho de banda
+#define EQ_MAX_FREQ_RATIO       0.4f      // Bandas sobre 0.4·fs → high-shelf
+#define EQ_BYPASS_DB            0.05f     // |ganancia| menor → banda omitida
+#define WDRC_CONTROL_SAMPLES    16        // Ganancia recalculada cada 1 ms a 16 kHz
+#define LIMITER_RELEASE_MS      50.0f     // Release del limitador de picos
+#define DSP_COMPARE_WARMUP_MS   100       // Transitorio descartado al iniciar dsp_compare
+#define DSP_PRESET_CACHE_CUSTOM 4         // Configuraciones no de firmware en caché (LRU)
+#define DSP_CROSSFADE_MS        10        // Fundido entre sets al cambiar de configuración
+#define DSP_MUTE_RAMP_MS        5         // Rampa de silencio / vuelta del audio (sleep, wake)
+#define DSP_MUTE_FLUSH_BLOCKS   3         // Bloques en silencio tras la rampa (cola DMA de salida)
+#define DSP_UNMUTE_HOLD_MS      10        // Silencio al despertar: arranque del micrófono
+
+// ==================== ESTRUCTURA DEL PIPELINE ====================
+
+// Set completo de parámetros ya calculados + estados de filtros/detectores.
+// Core 1 lo construye entero y lo publica; Core 0 solo lee coeficientes
+// y actualiza estados (ver intercambio triple buffer en dsp_pipeline.cpp).
+struct DSPPipeline {
+  HighpassConfig highpass;
+  EqualizerConfig equalizer;
+  int eq_active_count;                  // Bandas con ganancia ≠ 0
+  // Cascada de biquads activa: HPF + bandas EQ activas (punteros a coeffs/state)
+  float* cascade_coeffs[1 + EQ_BANDS_COUNT];
+  float* cascade_states[1 + EQ_BANDS_COUNT];
+  int cascade_stages;
+  // Ruta en coma fija: mismos biquads cuantizados, misma cascada.
+  // El WDRC comparte envolvente/ganancia (float) con la ruta float; los
+  // estados de los biquads son propios (forma directa I). La línea de
+  // retardo del limitador vive fuera del set (dsp_pipeline.cpp)
+  QBiquad highpass_q;
+  QBiquad eq_q[EQ_BANDS_COUNT];
+  QBiquad* cascade_q[1 + EQ_BANDS_COUNT];
+  int32_t limiter_threshold_q;          // Q4.27
+  int32_t limiter_release_q;            // alpha_release en Q0.31
+  int32_t limiter_inv_window_q;         // 2^31 / (retardo + 1): media de la ganancia
+  int32_t output_gain_q;                // Q7.24
+  WDRCConfig wdrc;
+  LimiterConfig limiter;
+  float output_gain;                    // Ganancia final lineal
+};
+
+// Estado de los detectores tras el último bloque (telemetría)
+struct DSPBlockMeters {
+  float wdrc_envelope_db;               // Envolvente RMS del WDRC (dBFS)
+  float wdrc_reduction_db;
+  float limiter_reduction_db;
+};
+
+// ==================== FUNCIONES PRINCIPALES ====================
+
+/**
+ * @brief Inicializar el pipeline DSP con todas las etapas desactivadas
+ *
+ * Debe llamarse en setup() antes de crear la tarea de audio.
+ */
+void initialize_dsp_pipeline(void);
+
+/**
+ * @brief Recalcular y publicar parámetros a partir de una configuración
+ *
+ * Toma de la caché de presets el set ya calculado (biquads del HPF/EQ,
+ * coeficientes del WDRC y del limitador) o lo calcula si la configuración
+ * es nueva, lo copia a un set libre y lo publica con un intercambio
+ * atómico. Core 0 lo adopta en el siguiente bloque con un fundido de
+ * DSP_CROSSFADE_MS. Solo se llama desde Core 1 (un único escritor).
+ * La ganancia final sale de config->gain_level.
+ *
+ * @param config Configuración de audio (presets, NVS o comandos)
+ */
+void configure_dsp_pipeline(const AudioConfig* config);
+
+/**
+ * @brief Recalcular y publicar la última configuración con el formato activo
+ *
+ * Tras set_audio_format(): biquads, constantes de tiempo del WDRC y del
+ * limitador dependen de SAMPLE_RATE y BUFFER_SIZE. Recalcula la caché de
+ * presets de firmware y descarta las configuraciones personalizadas.
+ * Sin fundido. Solo desde Core 1 con Core 0 aparcado: borra la línea de
+ * retardo del limitador, cuya longitud cambia con SAMPLE_RATE.
+ */
+void rebuild_dsp_pipeline(void);
+
+/**
+ * @brief Latencia que añade el pipeline: anticipación del limitador
+ *
+ * limiter_lookahead de la última configuración publicada (limitada a
+ * LIMITER_MIN/MAX_LOOKAHEAD_MS) en muestras del formato activo; Core 0
+ * la adopta en el bloque siguiente. La línea de retardo corre también
+ * con el limitador desactivado: la latencia no cambia al activarlo.
+ */
+int get_dsp_latency_samples(void);
+
+/**
+ * @brief Publicar una nueva ganancia final (conserva la última configuración)
+ *
+ * Sin fundido: el set sale de la caché y solo cambia la ganancia.
+ * Solo desde Core 1 (botones y comandos seriales).
+ *
+ * @param output_gain Ganancia lineal (gain_levels[])
+ */
+void set_dsp_output_gain(float output_gain);
+
+/**
+ * @brief Procesar un bloque de audio (ruta float o Q4.27 según DSP_FIXED_POINT)
+ *
+ * Ejecuta cada etapa activa sobre el bloque completo. Las etapas
+ * desactivadas se omiten enteras (no hay ramas por muestra).
+ *
+ * Al inicio adopta el último set publicado, si lo hay (sin bloqueo).
+ * Con la comparación activa ejecuta además la otra ruta sobre una copia.
+ *
+ * @param block Bloque de audio (float [-1, 1] o Q4.27), procesado in-place
+ * @param num_samples Número de muestras (≤ MAX_BUFFER_SIZE)
+ */
+void process_dsp_pipeline(dsp_sample_t* block, int num_samples);
+
+// ==================== SILENCIO CON RAMPA (SLEEP / WAKE) ====================
+
+/**
+ * @brief Silenciar o devolver la salida del DSP con rampa (Core 1)
+ *
+ * Core 0 baja la salida a cero en DSP_MUTE_RAMP_MS y la mantiene en
+ * silencio. Al quitarlo, espera DSP_UNMUTE_HOLD_MS (el micrófono aún
+ * arranca) y sube con la misma rampa. Los pips se mezclan después y no
+ * se silencian. Los estados de filtros y del WDRC no se tocan.
+ *
+ * @param muted true para silenciar
+ */
+void set_dsp_output_mute(bool muted);
+
+/**
+ * @brief ¿Salida en silencio y cola DMA de salida ya vaciada?
+ *
+ * true tras la rampa de bajada y DSP_MUTE_FLUSH_BLOCKS bloques a cero:
+ * a partir de ahí se pueden parar los streams sin pop.
+ */
+bool is_dsp_output_muted(void);
+
+// ==================== COMPARACIÓN COMA FIJA / FLOAT ====================
+
+/**
+ * @brief Activar o desactivar la comparación de rutas (Core 1)
+ *
+ * Core 0 ejecuta la otra ruta sobre una copia del bloque de entrada con
+ * un set de parámetros sombra y acumula el error frente a la ruta float.
+ * Duplica el coste del DSP mientras está activa. Al activarla se borran
+ * las estadísticas y se descartan DSP_COMPARE_WARMUP_MS de transitorio.
+ */
+void set_dsp_comparison(bool enabled);
+
+/**
+ * @brief Mostrar SNR y error máximo de la ruta Q4.27 frente a la float
+ */
+void print_dsp_comparison(void);
+
+// ==================== FUNCIONES DE INFORMACIÓN ====================
+
+/**
+ * @brief Mostrar estado y coeficientes de cada etapa por Serial
+ */
+void print_dsp_pipeline_status(void);
+
+/**
+ * @brief Detectores del WDRC y del limitador tras el último bloque
+ *
+ * Solo desde Core 0, después de process_dsp_pipeline(): lee el set en
+ * uso sin carreras (ver telemetry.h).
+ */
+void get_dsp_block_meters(DSPBlockMeters* meters);
+
+#endif // DSP_PIPELINE_H
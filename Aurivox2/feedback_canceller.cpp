@@ -0,0 +1,212 @@
+// ==================== FEEDBACK_CANCELLER.CPP ====================
+// Cancelación adaptativa de realimentación acústica para Aurivox v3.0
+
+#include "Arduino.h"
+#include <math.h>
+#include <string.h>
+#include <atomic>
+#include "feedback_canceller.h"
+#include "dsp_kernels.h"
+
+/*
+ * NLMS SOBRE LA SALIDA DEL DAC
+ * ===========================
+ *
+ *             ┌──────────────── ruta acústica F ◀───────────────┐
+ *             ▼                                                 │
+ *   mic ──▶ (Σ) ──▶ e ──▶ HPF → EQ → WDRC → ... ──▶ dac ──▶ altavoz
+ *             ▲ -                                      │
+ *             │                                        ▼
+ *             └──── ŷ = W · x ◀── [retardo D] ◀── referencia x
+ *
+ *  D = latencia de E/S (cola DMA + convertidores) - AFC_DELAY_MARGIN:
+ *  los AFC_TAPS coeficientes modelan solo la ruta, no el retardo.
+ *  D ≥ BUFFER_SIZE, así que toda la referencia de un bloque ya salió.
+ *
+ *  Por bloque de N muestras, con W fija en el bloque:
+ *
+ *    ŷ[n] = dot(W, x[n-D-L+1 .. n-D])          N productos de L taps
+ *    W   += μ / (‖x‖² + δ) · Σ e[n] · x_n       N axpy de L taps
+ *
+ *  W se guarda invertida (W[m] = w[L-1-m]) para que filtro y
+ *  actualización sean productos/axpy sobre tramos contiguos de la
+ *  referencia. La referencia se escribe dos veces (anillo espejado):
+ *  cualquier ventana de hasta AFC_RING muestras es contigua, sin módulo.
+ *
+ *  El retardo D también decorrela la entrada de la salida, que es lo
+ *  que sesga un AFC con habla o tonos; μ pequeño y la fuga de
+ *  coeficientes hacen el resto.
+ */
+
+#define AFC_RING            (AFC_MAX_DELAY + AFC_TAPS + MAX_BUFFER_SIZE)
+#define AFC_REGULARIZATION  (AFC_TAPS * 1e-7f)    // δ ≈ referencia a -70 dBFS
+#define AFC_STATS_SMOOTHING 0.02f                 // Media móvil de los niveles por bloque
+
+// Peticiones de Core 1
+static std::atomic<bool> enabled_request(AFC_DEFAULT_ENABLED);
+static std::atomic<int> delay_request(-1);
+static std::atomic<bool> reset_request(false);
+
+// Solo Core 0 (Core 1 los lee para diagnóstico)
+static float ring[2 * AFC_RING] __attribute__((aligned(16)));
+static int ring_head = 0;                    // Siguiente escritura (0 .. AFC_RING-1)
+static float weights[AFC_TAPS] __attribute__((aligned(16)));
+static float error_block[MAX_BUFFER_SIZE];
+static int window_start = -1;                // Ventana del último afc_cancel (-1 = sin adaptar)
+static int window_samples = 0;
+static int delay_samples = 0;
+static bool enabled = AFC_DEFAULT_ENABLED;
+static float block_estimate = 0.0f;          // Σŷ² y Σe² del último afc_cancel
+static float block_error = 0.0f;
+static float estimate_energy = 0.0f;         // Medias por muestra, solo bloques adaptados
+static float error_energy = 0.0f;
+static float min_reference_norm = 0.0f;      // ‖x‖² de AFC_MIN_REFERENCE_DB en L taps
+static volatile uint32_t adapted_blocks = 0;
+
+// ==================== CORE 0 ====================
+
+static void AUDIO_IRAM clear_weights() {
+    memset(weights, 0, sizeof(weights));
+    estimate_energy = 0.0f;
+    error_energy = 0.0f;
+    adapted_blocks = 0;
+}
+
+bool AUDIO_IRAM afc_begin_block() {
+    const int delay = delay_request.exchange(-1, std::memory_order_acq_rel);
+    if (delay >= 0) {
+        delay_samples = delay;
+        clear_weights();
+    }
+    if (reset_request.exchange(false, std::memory_order_acq_rel)) {
+        clear_weights();
+    }
+    enabled = enabled_request.load(std::memory_order_acquire);
+    window_start = -1;
+    return enabled;
+}
+
+void AUDIO_IRAM afc_cancel(float* mic, int num_samples) {
+    // El bloque en curso todavía no ha salido: el retardo nunca es menor que el bloque
+    const int delay = delay_samples < num_samples ? num_samples : delay_samples;
+    int start = ring_head - delay - AFC_TAPS + 1;
+    if (start < 0) start += AFC_RING;
+    const float* window = ring + start;
+
+    float estimate_sum = 0.0f;
+    float error_sum = 0.0f;
+    for (int n = 0; n < num_samples; n++) {
+        const float y = dsp_dot(weights, window + n, AFC_TAPS);
+        const float e = mic[n] - y;
+        estimate_sum += y * y;
+        error_sum += e * e;
+        error_block[n] = e;
+        mic[n] = e;
+    }
+    block_estimate = estimate_sum;
+    block_error = error_sum;
+
+    window_start = start;
+    window_samples = num_samples;
+}
+
+void AUDIO_IRAM afc_push_output(const int16_t* dac, int num_samples) {
+    const float scale = 1.0f / 32768.0f;
+    for (int i = 0; i < num_samples; i++) {
+        const float x = dac[i] * scale;
+        ring[ring_head] = x;
+        ring[ring_head + AFC_RING] = x;
+        if (++ring_head == AFC_RING) ring_head = 0;
+    }
+
+    // La ventana del bloque sigue intacta: el anillo guarda más de D + L + N muestras
+    if (window_start < 0) return;
+    const float* window = ring + window_start;
+    const int span = window_samples + AFC_TAPS - 1;
+    const float norm = dsp_energy(window, span) * AFC_TAPS / span;
+    window_start = -1;
+    if (norm < min_reference_norm) return;
+
+    // Niveles solo con referencia activa: sin salida no hay realimentación que medir
+    const float inv_n = 1.0f / window_samples;
+    estimate_energy += AFC_STATS_SMOOTHING * (block_estimate * inv_n - estimate_energy);
+    error_energy += AFC_STATS_SMOOTHING * (block_error * inv_n - error_energy);
+
+    const float step = AFC_STEP_SIZE / (norm + AFC_REGULARIZATION);
+    dsp_gain(weights, weights, AFC_TAPS, AFC_LEAKAGE);
+    for (int n = 0; n < window_samples; n++) {
+        dsp_axpy(window + n, weights, AFC_TAPS, step * error_block[n]);
+    }
+    adapted_blocks = adapted_blocks + 1;
+}
+
+// ==================== CORE 1 ====================
+
+void afc_init(int delay_samples_init) {
+    memset(ring, 0, sizeof(ring));
+    ring_head = 0;
+    window_start = -1;
+    delay_samples = CLAMP(delay_samples_init, 0, AFC_MAX_DELAY);
+    min_reference_norm = AFC_TAPS * DB_TO_LINEAR(2.0f * AFC_MIN_REFERENCE_DB);
+    delay_request.store(-1, std::memory_order_relaxed);
+    reset_request.store(false, std::memory_order_relaxed);
+    clear_weights();
+}
+
+int afc_delay_for_latency(float latency_ms) {
+    const int delay = (int)(latency_ms * SAMPLE_RATE / 1000.0f) - AFC_DELAY_MARGIN;
+    return CLAMP(delay, BUFFER_SIZE, AFC_MAX_DELAY);
+}
+
+void afc_set_enabled(bool on) {
+    if (on && !enabled_request.load(std::memory_order_relaxed)) afc_request_reset();
+    enabled_request.store(on, std::memory_order_release);
+}
+
+void afc_set_delay(int delay) {
+    delay_request.store(CLAMP(delay, BUFFER_SIZE, AFC_MAX_DELAY), std::memory_order_release);
+}
+
+void afc_request_reset() {
+    reset_request.store(true, std::memory_order_release);
+}
+
+void afc_get_status(afc_status_t* status) {
+    status->enabled = enabled_request.load(std::memory_order_acquire);
+    status->delay_samples = delay_samples;
+    status->taps = AFC_TAPS;
+    status->estimate_dbfs = estimate_energy > 0.0f ? LINEAR_TO_DB(sqrtf(estimate_energy)) : -INFINITY;
+    status->estimate_to_error_db = estimate_energy > 0.0f && error_energy > 0.0f ?
+                                   LINEAR_TO_DB(sqrtf(estimate_energy / error_energy)) : -INFINITY;
+    status->adapted_blocks = adapted_blocks;
+
+    float norm = 0.0f;
+    float peak = 0.0f;
+    status->peak_tap = 0;
+    for (int m = 0; m < AFC_TAPS; m++) {
+        const float w = weights[m];
+        norm += w * w;
+        if (fabsf(w) > peak) {
+            peak = fabsf(w);
+            status->peak_tap = AFC_TAPS - 1 - m;
+        }
+    }
+    status->path_gain_db = norm > 0.0f ? LINEAR_TO_DB(sqrtf(norm)) : -INFINITY;
+}
+
+void print_afc_status() {
+    afc_status_t st;
+    afc_get_status(&st);
+
+    Serial.printf("\n🔁 CANCELACIÓN DE REALIMENTACIÓN (NLMS, %d taps, μ %.4f)\n", st.taps, AFC_STEP_SIZE);
+    Serial.printf("   Estado: %s | retardo %d muestras (%.2f ms) + %d taps (%.2f ms)\n",
+                  st.enabled ? "✅ ACTIVA" : "❌ DESACTIVADA",
+                  st.delay_samples, samples_to_ms(st.delay_samples),
+                  st.taps, samples_to_ms(st.taps));
+    Serial.printf("   Ruta modelada: %.1f dB, pico en tap %d (%.2f ms desde la salida al DAC)\n",
+                  st.path_gain_db, st.peak_tap, samples_to_ms(st.delay_samples + st.peak_tap));
+    Serial.printf("   Realimentación cancelada: ŷ %.1f dBFS, %+.1f dB frente a lo que pasa al DSP | bloques adaptados: %lu\n",
+                  st.estimate_dbfs, st.estimate_to_error_db, (unsigned long)st.adapted_blocks);
+    Serial.println("   (el ERLE no se mide en el equipo: el micrófono siempre lleva la entrada; ver --mode afc del banco)");
+    Serial.println("   Coste por bloque: etapas 'AFC filtro' y 'AFC adaptación' de 'perf'");
+}
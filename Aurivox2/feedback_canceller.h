@@ -0,0 +1,116 @@
+// ==================== FEEDBACK_CANCELLER.H ====================
+// Cancelación adaptativa de realimentación acústica (NLMS) para Aurivox v3.0
+// Filtro y adaptación en Core 0, control y diagnóstico desde Core 1
+
+#ifndef FEEDBACK_CANCELLER_H
+#define FEEDBACK_CANCELLER_H
+
+#include <stdint.h>
+#include "audio_config.h"
+
+// ==================== PARÁMETROS ====================
+
+#define AFC_TAPS                64        // Coeficientes tras el retardo (4 ms a 16 kHz, múltiplo de 4)
+#define AFC_MAX_DELAY           2048      // Mayor retardo de la línea (muestras; 3 bloques de 512 + acústica)
+#define AFC_DELAY_MARGIN        16        // Taps de la ruta antes de la latencia de E/S (DAC/mic, acústica)
+#define AFC_STEP_SIZE           0.002f    // μ del NLMS normalizado (0 < μ < 2; pequeño = menos sesgo con tonos)
+#define AFC_LEAKAGE             0.99995f  // Fuga de coeficientes por bloque (olvida rutas antiguas)
+#define AFC_MIN_REFERENCE_DB    -70.0f    // Sin adaptación con la salida por debajo (dBFS)
+#define AFC_DEFAULT_ENABLED     true
+
+#if AFC_TAPS % 4 != 0 || AFC_TAPS > 128
+#error "AFC_TAPS debe ser múltiplo de 4 y no mayor de 128"
+#endif
+
+// ==================== TIPOS ====================
+
+// Estado para el comando 'afc' (Core 1, copia aproximada)
+typedef struct {
+  bool enabled;
+  int delay_samples;      // Retardo de la línea de referencia
+  int taps;
+  float estimate_dbfs;    // Nivel de ŷ: realimentación estimada y restada
+  float estimate_to_error_db;   // ŷ frente a e (lo que pasa al DSP)
+  float path_gain_db;     // Norma de los coeficientes: ganancia de la ruta modelada
+  int peak_tap;           // Tap de mayor |w| (0 = justo tras el retardo)
+  uint32_t adapted_blocks;
+} afc_status_t;
+
+// ==================== FUNCIONES ====================
+
+/**
+ * @brief Borrar coeficientes, historia y estadísticas
+ *
+ * Desde setup() antes de crear la tarea de audio, o con Core 0 aparcado
+ * (cambio de formato). En marcha, usar afc_request_reset().
+ *
+ * @param delay_samples Retardo inicial de la línea (ver afc_set_delay)
+ */
+void afc_init(int delay_samples);
+
+/**
+ * @brief Retardo nominal: latencia de E/S en muestras menos AFC_DELAY_MARGIN
+ *
+ * La ruta altavoz → micrófono empieza tras la cola DMA de salida, los
+ * filtros de los convertidores y el aire: los taps se dedican a la ruta
+ * y no al retardo. Nunca menor que BUFFER_SIZE (el bloque en curso aún
+ * no ha salido por el DAC).
+ *
+ * La referencia es el bloque ya procesado, así que el retardo del
+ * limitador (anticipación) queda antes de ella y no cuenta aquí.
+ *
+ * @param latency_ms Latencia del lazo DAC → micrófono (medida con
+ *                   'latency' o get_audio_loop_latency_ms())
+ */
+int afc_delay_for_latency(float latency_ms);
+
+/**
+ * @brief Peticiones de Core 1 (se aplican al inicio del siguiente bloque)
+ *
+ * Cambiar el retardo borra los coeficientes: la ruta modelada cambia.
+ */
+void afc_set_enabled(bool enabled);
+void afc_set_delay(int delay_samples);
+void afc_request_reset(void);
+
+/**
+ * @brief Inicio de bloque en Core 0: aplica peticiones pendientes
+ *
+ * @return true si hay que llamar a afc_cancel() en este bloque
+ */
+bool afc_begin_block(void);
+
+/**
+ * @brief Restar la estimación de realimentación del micrófono (Core 0)
+ *
+ * ŷ[n] = Σ w[j] · dac[n - retardo - j], con los coeficientes fijos en
+ * todo el bloque; guarda el error para la adaptación.
+ *
+ * @param mic Bloque del micrófono en float [-1, 1), in-place
+ */
+void afc_cancel(float* mic, int num_samples);
+
+/**
+ * @brief Añadir el bloque enviado al DAC a la referencia y adaptar (Core 0)
+ *
+ * Se llama siempre (también desactivado) con el bloque int16 final, el
+ * mismo que escucha el micrófono: pips y MLS de 'latency' incluidos.
+ */
+void afc_push_output(const int16_t* dac, int num_samples);
+
+/**
+ * @brief Copia del estado para diagnóstico (Core 1)
+ *
+ * Sin ERLE: mic / e incluye la entrada deseada, que el micrófono siempre
+ * capta, y se queda cerca de 0 dB aunque la realimentación baje. Se da
+ * ŷ (lo restado) frente a e, solo en bloques con la referencia por
+ * encima de AFC_MIN_REFERENCE_DB.
+ */
+void afc_get_status(afc_status_t* status);
+
+/**
+ * @brief Mostrar estado, nivel cancelado y retardo por Serial (Core 1)
+ */
+void print_afc_status(void);
+
+#endif // FEEDBACK_CANCELLER_H
@@ -0,0 +1,424 @@
+// ==================== FREQ_RESPONSE.CPP ====================
+// Respuesta en frecuencia y calibración por banco Goertzel para Aurivox v3.0
+
+#include "Arduino.h"
+#include <math.h>
+#include <string.h>
+#include <atomic>
+#include "audio_hardware.h"
+#include "freq_response.h"
+#include "latency_test.h"
+#include "dsp_kernels.h"   // AUDIO_IRAM
+
+/*
+ * MULTITONO PERIÓDICO Y UN GOERTZEL POR TONO
+ * ==========================================
+ *
+ *  Core 0, cada bloque de la prueba:
+ *
+ *   estímulo[N] (cíclico) ──▶ dac ──▶ DAC ──▶ cable / aire ──┐
+ *                                                           │
+ *   Goertzel × tonos, media, potencia ◀── mic ◀── micrófono ◀─┘
+ *
+ *  Cada tono cae en un bin exacto de la ventana, k = round(f·N / fs),
+ *  así que el estímulo se repite cada N muestras. Pasada la latencia del
+ *  lazo, cualquier tramo de N muestras del micrófono es un periodo
+ *  completo: sin ventana ni fuga entre tonos, y no hace falta alinear
+ *  la captura con la salida. Solo se evalúan los bins pedidos:
+ *
+ *    s[n] = x[n] + 2·cos(2πk/N)·s[n-1] - s[n-2]          (Core 0)
+ *    |X(k)|² = s1² + s2² - 2·cos(2πk/N)·s1·s2,  A = 2·|X(k)| / N
+ *
+ *  Fases de Schroeder (φ_m = -π·m·(m-1)/M): el pico del multitono queda
+ *  cerca del de un tono solo y cada tono puede ir a RESPONSE_LEVEL / M.
+ *
+ *  En la misma pasada salen la media (offset DC) y la potencia sin DC:
+ *  lo que no es tono es ruido + distorsión, y su parte en un bin da la
+ *  SNR de cada tono. Con 0 tonos la pasada es silencio: DC y ruido de fondo.
+ *
+ * Estados (cada transición la hace un solo core):
+ *
+ *   IDLE ──(C1)──▶ SETTLE ──(C0)──▶ ANALYZE ──(C0)──▶ DONE ──(C1)──▶ IDLE
+ *                 estímulo, lazo   estímulo + banco   niveles en Core 1
+ */
+
+#define RESPONSE_MAX_WINDOW   (RESPONSE_WINDOW_MS * MAX_SAMPLE_RATE / 1000)
+#define Q31_TO_FLOAT          (1.0f / 2147483648.0f)
+
+enum ResponseState {
+  RESPONSE_IDLE,
+  RESPONSE_SETTLE,
+  RESPONSE_ANALYZE,
+  RESPONSE_DONE
+};
+
+static std::atomic<int> test_state(RESPONSE_IDLE);
+
+// Escritos por Core 1 antes de pasar a SETTLE; Core 0 solo los lee
+static int16_t stimulus[RESPONSE_MAX_WINDOW];
+static int stimulus_length = 0;           // 0 = silencio
+static float goertzel_coeff[RESPONSE_MAX_TONES];
+static int tone_count = 0;
+static int analysis_length = 0;           // Muestras analizadas
+
+// Propiedad de Core 0 en SETTLE/ANALYZE, de Core 1 en DONE
+static int settle_samples = 0;
+static int play_pos = 0;
+static int analyzed = 0;
+static float goertzel_s1[RESPONSE_MAX_TONES];
+static float goertzel_s2[RESPONSE_MAX_TONES];
+static float dc_mean = 0.0f;              // Media de lo analizado
+static float ac_m2 = 0.0f;                // Σ (x - media)²
+static float block_samples[MAX_BUFFER_SIZE] __attribute__((aligned(16)));
+
+static response_result_t last_result;
+static bool has_result = false;
+
+extern volatile bool audio_processing_active;
+extern volatile bool system_sleeping;
+
+// ==================== CORE 0 ====================
+
+/*
+ * Media y Σ(x - media)² por bloque, combinadas con las anteriores
+ * (Chan): restar el DC al final de Σx² perdería en float el ruido de
+ * fondo, 60 dB por debajo de un offset normal.
+ */
+static void AUDIO_IRAM analyze_block(const int32_t* mic, int n) {
+  float sum = 0.0f;
+  for (int i = 0; i < n; i++) {
+    const float x = (float)mic[i] * Q31_TO_FLOAT;
+    block_samples[i] = x;
+    sum += x;
+  }
+  const float mean = sum / n;
+  float m2 = 0.0f;
+  for (int i = 0; i < n; i++) {
+    const float d = block_samples[i] - mean;
+    m2 += d * d;
+  }
+  if (analyzed == 0) {
+    dc_mean = mean;
+    ac_m2 = m2;
+  } else {
+    const float total = (float)(analyzed + n);
+    const float delta = mean - dc_mean;
+    dc_mean += delta * n / total;
+    ac_m2 += m2 + delta * delta * ((float)analyzed * n / total);
+  }
+
+  // Un tono cada vez: estado y coeficiente en registros durante el bloque
+  for (int t = 0; t < tone_count; t++) {
+    const float c = goertzel_coeff[t];
+    float s1 = goertzel_s1[t];
+    float s2 = goertzel_s2[t];
+    for (int i = 0; i < n; i++) {
+      const float s0 = block_samples[i] + c * s1 - s2;
+      s2 = s1;
+      s1 = s0;
+    }
+    goertzel_s1[t] = s1;
+    goertzel_s2[t] = s2;
+  }
+}
+
+void AUDIO_IRAM freq_response_block(const int32_t* mic, int16_t* dac, int num_samples) {
+  const int state = test_state.load(std::memory_order_acquire);
+  if (state == RESPONSE_IDLE) return;
+
+  if (state == RESPONSE_DONE) {
+    memset(dac, 0, num_samples * sizeof(int16_t));
+    return;
+  }
+
+  // SETTLE y ANALYZE: el estímulo sigue sonando sin cortes entre los dos
+  if (stimulus_length > 0) {
+    for (int i = 0; i < num_samples; i++) {
+      dac[i] = stimulus[play_pos];
+      if (++play_pos >= stimulus_length) play_pos = 0;
+    }
+  } else {
+    memset(dac, 0, num_samples * sizeof(int16_t));
+  }
+
+  if (state == RESPONSE_SETTLE) {
+    settle_samples -= num_samples;
+    if (settle_samples <= 0) {
+      memset(goertzel_s1, 0, sizeof(goertzel_s1));
+      memset(goertzel_s2, 0, sizeof(goertzel_s2));
+      dc_mean = 0.0f;
+      ac_m2 = 0.0f;
+      analyzed = 0;
+      int expected = RESPONSE_SETTLE;
+      test_state.compare_exchange_strong(expected, RESPONSE_ANALYZE, std::memory_order_acq_rel);
+    }
+    return;
+  }
+
+  const int remaining = analysis_length - analyzed;
+  const int n = num_samples < remaining ? num_samples : remaining;
+  analyze_block(mic, n);
+  analyzed += n;
+  if (analyzed >= analysis_length) {
+    int expected = RESPONSE_ANALYZE;
+    test_state.compare_exchange_strong(expected, RESPONSE_DONE, std::memory_order_release);
+  }
+}
+
+// ==================== CORE 1 ====================
+
+static float to_db(float amplitude) {
+  return 20.0f * log10f(amplitude > 1e-9f ? amplitude : 1e-9f);
+}
+
+static bool audio_running() {
+  if (audio_processing_active && !system_sleeping) return true;
+  Serial.println("❌ Error: El audio debe estar activo para la prueba");
+  return false;
+}
+
+// Bins exactos de la ventana para las frecuencias pedidas; omite las
+// que no caben (fuera de banda o en el bin de otra)
+static int plan_tones(const float* freqs, size_t count, int window, int* bins) {
+  int tones = 0;
+  for (size_t f = 0; f < count; f++) {
+    if (freqs[f] <= 0.0f || freqs[f] >= RESPONSE_MAX_FREQ_RATIO * SAMPLE_RATE) {
+      Serial.printf("   ⚠️ %.0f Hz fuera de banda a %d Hz: omitido\n", freqs[f], SAMPLE_RATE);
+      continue;
+    }
+    if (tones >= RESPONSE_MAX_TONES) {
+      Serial.printf("   ⚠️ %.0f Hz: más de %d tonos, omitido\n", freqs[f], RESPONSE_MAX_TONES);
+      continue;
+    }
+    const int k = (int)lroundf(freqs[f] * window / SAMPLE_RATE);
+    bool duplicate = k < 1;
+    for (int t = 0; t < tones; t++) {
+      if (bins[t] == k) duplicate = true;
+    }
+    if (duplicate) {
+      Serial.printf("   ⚠️ %.0f Hz comparte bin con otro tono: omitido\n", freqs[f]);
+      continue;
+    }
+    bins[tones++] = k;
+  }
+  return tones;
+}
+
+// Un periodo del multitono (fases de Schroeder) y coeficientes del banco
+static float build_stimulus(const int* bins, int tones, int window) {
+  const float amplitude = tones > 0 ? (float)RESPONSE_LEVEL / tones : 0.0f;
+  for (int t = 0; t < tones; t++) {
+    goertzel_coeff[t] = 2.0f * cosf(2.0f * (float)M_PI * bins[t] / window);
+  }
+  for (int n = 0; n < window && tones > 0; n++) {
+    float x = 0.0f;
+    for (int t = 0; t < tones; t++) {
+      const float phase = -(float)M_PI * (t + 1) * t / tones;   // m = t + 1
+      // Argumento reducido a un periodo: k·n mod N, sin perder precisión en float
+      const int cycle = (int)(((int64_t)bins[t] * n) % window);
+      x += sinf(2.0f * (float)M_PI * cycle / window + phase);
+    }
+    stimulus[n] = (int16_t)CLAMP(lroundf(amplitude * x), -32768, 32767);
+  }
+  stimulus_length = tones > 0 ? window : 0;
+  tone_count = tones;
+  return amplitude;
+}
+
+// Estímulo ya preparado: esperar la latencia del lazo y analizar 'length' muestras
+static bool run_pass(int length) {
+  latency_result_t measured;
+  const float loop_ms = get_measured_latency(&measured) ? measured.mean_ms
+                                                        : get_audio_loop_latency_ms();
+  const float settle_ms = loop_ms + RESPONSE_SETTLE_MS;
+  analysis_length = length;
+  settle_samples = (int)(settle_ms * SAMPLE_RATE / 1000.0f);
+  play_pos = 0;
+  test_state.store(RESPONSE_SETTLE, std::memory_order_release);
+
+  const uint32_t timeout_ms = (uint32_t)settle_ms + length * 1000 / SAMPLE_RATE + 500;
+  const uint32_t start = millis();
+  while (test_state.load(std::memory_order_acquire) != RESPONSE_DONE) {
+    if (millis() - start > timeout_ms) {
+      test_state.store(RESPONSE_IDLE, std::memory_order_release);
+      Serial.println("❌ La tarea de audio no entrega bloques (¿streams detenidos?)");
+      return false;
+    }
+    vTaskDelay(pdMS_TO_TICKS(2));
+  }
+  return true;
+}
+
+// Niveles de la pasada terminada (estado DONE: los acumuladores son de Core 1)
+static void evaluate_pass(const int* bins, float stimulus_amplitude, response_result_t* res) {
+  const int n = analysis_length;
+  const float dc = dc_mean;
+  const float ac_power = ac_m2 / n;
+  float residual = ac_power;
+
+  res->tones = tone_count;
+  for (int t = 0; t < tone_count; t++) {
+    const float c = goertzel_coeff[t];
+    const float s1 = goertzel_s1[t];
+    const float s2 = goertzel_s2[t];
+    const float power = s1 * s1 + s2 * s2 - c * s1 * s2;
+    const float amplitude = 2.0f * sqrtf(power > 0.0f ? power : 0.0f) / n;
+    residual -= 0.5f * amplitude * amplitude;
+
+    res->freq_hz[t] = (float)bins[t] * SAMPLE_RATE / n;
+    res->level_dbfs[t] = to_db(amplitude);
+    res->gain_db[t] = res->level_dbfs[t] - to_db(stimulus_amplitude / 32768.0f);
+  }
+  // Precisión de la resta en float: ~70 dB bajo la potencia total
+  if (residual < ac_power * 1e-7f) residual = ac_power * 1e-7f;
+  if (residual < 1e-18f) residual = 1e-18f;
+
+  // Ruido de un bin: el residual repartido en N/2 bins hasta fs/2
+  const float bin_noise = residual * 2.0f / n;
+  float gain_sum = 0.0f;
+  for (int t = 0; t < tone_count; t++) {
+    const float tone_power = powf(10.0f, res->level_dbfs[t] / 10.0f) * 0.5f;
+    res->snr_db[t] = 10.0f * log10f(tone_power / bin_noise);
+    gain_sum += res->gain_db[t];
+  }
+  res->mean_gain_db = tone_count > 0 ? gain_sum / tone_count : 0.0f;
+  res->dc_offset = dc;
+  res->dc_dbfs = to_db(fabsf(dc));
+  res->residual_dbfs = 10.0f * log10f(residual);
+}
+
+static bool tone_ok(const response_result_t* res, int t) {
+  return res->level_dbfs[t] >= RESPONSE_MIN_LEVEL_DBFS &&
+         res->snr_db[t] >= RESPONSE_MIN_SNR_DB &&
+         fabsf(res->gain_db[t] - res->mean_gain_db) <= RESPONSE_FLATNESS_DB;
+}
+
+// Multitono completo: plan, estímulo, pasada y niveles
+static bool measure_multitone(const float* freqs, size_t count, response_result_t* res) {
+  const uint32_t start = millis();
+  const int window = RESPONSE_WINDOW_MS * SAMPLE_RATE / 1000;
+  int bins[RESPONSE_MAX_TONES];
+  const int tones = plan_tones(freqs, count, window, bins);
+  if (tones == 0) {
+    Serial.println("❌ Ninguna frecuencia medible con el formato activo");
+    return false;
+  }
+  const float amplitude = build_stimulus(bins, tones, window);
+  if (!run_pass(window)) return false;
+  evaluate_pass(bins, amplitude, res);
+  test_state.store(RESPONSE_IDLE, std::memory_order_release);
+  res->duration_ms = millis() - start;
+
+  last_result = *res;
+  has_result = true;
+  return true;
+}
+
+// Silencio: offset DC y ruido de fondo del micrófono
+static bool measure_silence(int duration_ms, response_result_t* res) {
+  const uint32_t start = millis();
+  build_stimulus(NULL, 0, 0);
+  if (!run_pass(duration_ms * SAMPLE_RATE / 1000)) return false;
+  evaluate_pass(NULL, 0.0f, res);
+  test_state.store(RESPONSE_IDLE, std::memory_order_release);
+  res->duration_ms = millis() - start;
+  return true;
+}
+
+static int print_tones(const response_result_t* res) {
+  int passed = 0;
+  for (int t = 0; t < res->tones; t++) {
+    const bool ok = tone_ok(res, t);
+    if (ok) passed++;
+    Serial.printf("   %7.1f Hz  %6.1f dBFS  lazo %6.1f dB (%+5.1f)  SNR %5.1f dB %s\n",
+                  res->freq_hz[t], res->level_dbfs[t], res->gain_db[t],
+                  res->gain_db[t] - res->mean_gain_db, res->snr_db[t], ok ? "✅" : "❌");
+  }
+  return passed;
+}
+
+// ==================== API (audio_hardware.h) ====================
+
+bool test_frequency_response(const float* test_frequencies, size_t num_frequencies) {
+  if (!audio_running()) return false;
+  if (test_state.load(std::memory_order_acquire) != RESPONSE_IDLE) return false;
+
+  Serial.printf("\n📈 RESPUESTA EN FRECUENCIA (multitono, ventana %d ms, %.1f Hz por bin)\n",
+                RESPONSE_WINDOW_MS, 1000.0f / RESPONSE_WINDOW_MS);
+  Serial.println("   Salida del DAC conectada al micrófono (cable o acústico)");
+
+  response_result_t res;
+  if (!measure_multitone(test_frequencies, num_frequencies, &res)) return false;
+
+  const int passed = print_tones(&res);
+  Serial.println("────────────────────────────────────");
+  Serial.printf("📊 Lazo medio %.1f dB | DC %.1f dBFS | ruido + distorsión %.1f dBFS | %.0f ms\n",
+                res.mean_gain_db, res.dc_dbfs, res.residual_dbfs, res.duration_ms);
+  Serial.printf("%s %d/%d tonos sobre %.0f dBFS, con SNR ≥ %.0f dB y a ±%.0f dB de la media\n",
+                passed == res.tones ? "✅" : "❌", passed, res.tones,
+                RESPONSE_MIN_LEVEL_DBFS, RESPONSE_MIN_SNR_DB, RESPONSE_FLATNESS_DB);
+  return passed == res.tones;
+}
+
+float measure_microphone_noise_floor(uint32_t duration_ms) {
+  if (!audio_running()) return NAN;
+  if (test_state.load(std::memory_order_acquire) != RESPONSE_IDLE) return NAN;
+  duration_ms = CLAMP(duration_ms, 10u, 5000u);
+
+  response_result_t res;
+  if (!measure_silence(duration_ms, &res)) return NAN;
+  Serial.printf("🔇 Ruido de fondo: %.1f dBFS (~%.0f dB SPL) | DC %.1f dBFS | %lu ms en silencio\n",
+                res.residual_dbfs, res.residual_dbfs + MIC_DBFS_TO_SPL, res.dc_dbfs,
+                (unsigned long)duration_ms);
+  return res.residual_dbfs + MIC_DBFS_TO_SPL;
+}
+
+/*
+ * Autotest de fábrica / ajuste: silencio (DC y ruido de fondo) y
+ * multitono en las bandas del ecualizador. El offset DC solo se
+ * comprueba: el HPF del pipeline ya lo elimina, pero uno grande indica
+ * el formato de datos del micrófono mal configurado. Con la latencia
+ * medida ('latency') la espera del lazo es la justa.
+ */
+bool run_audio_system_calibration() {
+  if (!audio_running()) return false;
+  if (test_state.load(std::memory_order_acquire) != RESPONSE_IDLE) return false;
+
+  const uint32_t start = millis();
+  Serial.printf("\n🧪 CALIBRACIÓN DEL SISTEMA DE AUDIO (%d Hz, bloque %d)\n", SAMPLE_RATE, BUFFER_SIZE);
+  Serial.println("   Salida del DAC conectada al micrófono (cable o acústico), sala en silencio");
+
+  response_result_t silence;
+  if (!measure_silence(RESPONSE_NOISE_MS, &silence)) return false;
+  const bool dc_ok = silence.dc_dbfs <= RESPONSE_MAX_DC_DBFS;
+  const bool noise_ok = silence.residual_dbfs <= RESPONSE_MAX_NOISE_DBFS &&
+                        silence.residual_dbfs >= RESPONSE_MIN_NOISE_DBFS;
+  Serial.printf("   Offset DC: %+.6f FS (%.1f dBFS, máx %.0f) %s\n", silence.dc_offset,
+                silence.dc_dbfs, RESPONSE_MAX_DC_DBFS, dc_ok ? "✅" : "❌ formato del micrófono");
+  Serial.printf("   Ruido de fondo: %.1f dBFS (~%.0f dB SPL) %s\n", silence.residual_dbfs,
+                silence.residual_dbfs + MIC_DBFS_TO_SPL,
+                noise_ok ? "✅" : silence.residual_dbfs < RESPONSE_MIN_NOISE_DBFS
+                                      ? "❌ micrófono sin datos" : "❌ demasiado ruido");
+
+  response_result_t res;
+  if (!measure_multitone(EQ_FREQUENCIES, EQ_BANDS_COUNT, &res)) return false;
+  Serial.println("   Bandas del ecualizador:");
+  const int passed = print_tones(&res);
+
+  latency_result_t measured;
+  const bool has_latency = get_measured_latency(&measured);
+  const bool ok = dc_ok && noise_ok && passed == res.tones;
+  Serial.println("────────────────────────────────────");
+  Serial.printf("📐 Espera del lazo: %.1f ms (%s) + %d ms de transitorio\n",
+                has_latency ? measured.mean_ms : get_audio_loop_latency_ms(),
+                has_latency ? "medida con 'latency'" : "teórica", RESPONSE_SETTLE_MS);
+  Serial.printf("%s Calibración %s en %lu ms (%d/%d bandas)\n", ok ? "✅" : "❌",
+                ok ? "correcta" : "FALLIDA", (unsigned long)(millis() - start), passed, res.tones);
+  return ok;
+}
+
+bool get_frequency_response(response_result_t* result) {
+  if (!has_result) return false;
+  if (result) *result = last_result;
+  return true;
+}
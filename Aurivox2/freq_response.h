@@ -0,0 +1,68 @@
+// ==================== FREQ_RESPONSE.H ====================
+// Respuesta en frecuencia y calibración por loopback (multitono → banco Goertzel)
+// Estímulo y filtros Goertzel en Core 0, niveles e informe en Core 1
+
+#ifndef FREQ_RESPONSE_H
+#define FREQ_RESPONSE_H
+
+#include <stdint.h>
+#include "audio_config.h"
+
+// ==================== PARÁMETROS ====================
+
+#define RESPONSE_MAX_TONES        8
+#define RESPONSE_WINDOW_MS        100     // Periodo del multitono = ventana Goertzel (10 Hz por bin)
+#define RESPONSE_SETTLE_MS        20      // Tras la latencia del lazo: transitorios de DAC y micrófono
+#define RESPONSE_LEVEL            8192    // Pico del multitono en el DAC (-12 dBFS)
+#define RESPONSE_MAX_FREQ_RATIO   0.45f   // Tonos por debajo de 0.45·fs (filtros del DAC y del mic)
+#define RESPONSE_MIN_SNR_DB       20.0f   // Tono sobre el ruido de su bin
+#define RESPONSE_MIN_LEVEL_DBFS   -80.0f  // Tono en el micrófono: por debajo, lazo abierto
+#define RESPONSE_FLATNESS_DB      12.0f   // Desviación máxima de cada tono frente a la media
+#define RESPONSE_NOISE_MS         100     // Silencio de la calibración (offset DC y ruido de fondo)
+#define RESPONSE_MAX_DC_DBFS      -30.0f  // Más offset: formato del micrófono mal configurado
+#define RESPONSE_MAX_NOISE_DBFS   -60.0f  // Más ruido: entorno o micrófono defectuoso
+#define RESPONSE_MIN_NOISE_DBFS   -130.0f // Menos: el micrófono entrega ceros
+#define MIC_DBFS_TO_SPL           120.0f  // ICS-43434: -26 dBFS a 94 dB SPL
+
+// ==================== TIPOS ====================
+
+// Resultado de una pasada (multitono o silencio)
+typedef struct {
+  int tones;                              // Tonos medidos (0 en silencio)
+  float freq_hz[RESPONSE_MAX_TONES];      // Frecuencia real: bin exacto de la ventana
+  float level_dbfs[RESPONSE_MAX_TONES];   // Amplitud del tono en el micrófono
+  float gain_db[RESPONSE_MAX_TONES];      // Lazo DAC → micrófono
+  float snr_db[RESPONSE_MAX_TONES];       // Sobre el ruido de su bin
+  float mean_gain_db;
+  float dc_offset;                        // Media del micrófono (fracción del fondo de escala)
+  float dc_dbfs;
+  float residual_dbfs;                    // RMS sin DC ni tonos: ruido + distorsión
+  float duration_ms;                      // De la orden al resultado
+} response_result_t;
+
+// ==================== FUNCIONES ====================
+
+/**
+ * @brief Sustituir la salida por el estímulo y analizar el micrófono (Core 0)
+ *
+ * Se llama una vez por bloque, tras latency_test_block() y antes de
+ * escribir al DAC. Sin prueba en curso solo lee un atómico; durante la
+ * prueba la salida procesada (y los pips) se sustituye por el multitono
+ * o por silencio, y cada muestra del micrófono pasa por el banco.
+ *
+ * @param mic Bloque del micrófono tal como llega del I2S (Q31)
+ * @param dac Bloque de salida, se sobreescribe durante la prueba
+ */
+void freq_response_block(const int32_t* mic, int16_t* dac, int num_samples);
+
+/**
+ * @brief Última pasada de test_frequency_response() o de la calibración
+ *
+ * @return false si todavía no se ha medido
+ */
+bool get_frequency_response(response_result_t* result);
+
+// test_frequency_response(), run_audio_system_calibration() y
+// measure_microphone_noise_floor(): declaradas en audio_hardware.h
+
+#endif // FREQ_RESPONSE_H
@@ -0,0 +1,241 @@
+// ==================== LATENCY_TEST.CPP ====================
+// Autotest de latencia por loopback para Aurivox v3.0
+
+#include "Arduino.h"
+#include <math.h>
+#include <string.h>
+#include <atomic>
+#include "latency_test.h"
+#include "dsp_kernels.h"   // AUDIO_IRAM
+#include "dsp_pipeline.h"  // get_dsp_latency_samples
+
+/*
+ * MEDIDA POR CORRELACIÓN CON UNA MLS
+ * =================================
+ *
+ *  Core 0, bloque k:
+ *
+ *   MLS ──▶ dac[k] ──▶ DMA TX ──▶ DAC ──▶ cable / aire ──┐
+ *                                                       │
+ *   captura ◀── mic[k] ◀── DMA RX ◀── micrófono ◀───────┘
+ *
+ *  La MLS y la captura empiezan en el mismo bloque, así que el lag del
+ *  pico de   c[lag] = Σ mls[i] · captura[i + lag]   suma las colas DMA de
+ *  entrada y salida, los filtros del DAC/micrófono y el lazo: el mismo
+ *  camino que recorre el sonido del micrófono al altavoz en uso normal
+ *  (sin el retardo de grupo del propio DSP). En acústico, cada 10 cm de
+ *  separación añaden ~0.3 ms. El objetivo se compara con el peor lazo
+ *  más la anticipación del limitador, que el usuario también oye.
+ *
+ *  MLS de 1023 muestras (LFSR x^10 + x^7 + 1): su autocorrelación vale
+ *  1023 en lag 0 y -1 en el resto, así que el pico destaca incluso con
+ *  ruido o a un nivel moderado. El pico se afina a fracción de muestra
+ *  con una parábola sobre sus vecinos.
+ *
+ * Estados (cada transición la hace un solo core):
+ *
+ *   IDLE ──(C1)──▶ GAP ──(C0)──▶ CAPTURE ──(C0)──▶ DONE ──(C1)──▶ GAP / IDLE
+ *               silencio        MLS + captura     correlación en Core 1
+ */
+
+// Ventana y captura en muestras del formato activo; el buffer, para MAX_SAMPLE_RATE
+#define LATENCY_MAX_SAMPLES   (LATENCY_MAX_MS * SAMPLE_RATE / 1000)
+#define LATENCY_GAP_SAMPLES   (LATENCY_GAP_MS * SAMPLE_RATE / 1000)
+#define CAPTURE_LENGTH        (LATENCY_MLS_LENGTH + LATENCY_MAX_SAMPLES)
+#define CAPTURE_CAPACITY      (LATENCY_MLS_LENGTH + LATENCY_MAX_MS * MAX_SAMPLE_RATE / 1000)
+
+enum LatencyState {
+  LATENCY_IDLE,
+  LATENCY_GAP,
+  LATENCY_CAPTURE,
+  LATENCY_DONE
+};
+
+static std::atomic<int> test_state(LATENCY_IDLE);
+
+// Escritos por Core 1 antes de pasar a GAP; Core 0 solo los lee
+static int8_t mls[LATENCY_MLS_LENGTH];
+static int gap_samples = 0;
+
+// Propiedad de Core 0 en GAP/CAPTURE, de Core 1 en DONE
+static int16_t capture[CAPTURE_CAPACITY];
+static int capture_pos = 0;
+
+static latency_result_t last_result;
+static bool has_result = false;
+
+extern float get_audio_loop_latency_ms();
+
+// ==================== CORE 0 ====================
+
+void AUDIO_IRAM latency_test_block(const int32_t* mic, int16_t* dac, int num_samples) {
+  const int state = test_state.load(std::memory_order_acquire);
+  if (state == LATENCY_IDLE) return;
+
+  if (state == LATENCY_CAPTURE) {
+    for (int i = 0; i < num_samples; i++) {
+      const int pos = capture_pos + i;
+      dac[i] = pos < LATENCY_MLS_LENGTH ? (int16_t)(mls[pos] * LATENCY_LEVEL) : 0;
+      if (pos < CAPTURE_LENGTH) capture[pos] = (int16_t)(mic[i] >> 16);
+    }
+    capture_pos += num_samples;
+    if (capture_pos >= CAPTURE_LENGTH) {
+      int expected = LATENCY_CAPTURE;
+      test_state.compare_exchange_strong(expected, LATENCY_DONE, std::memory_order_release);
+    }
+    return;
+  }
+
+  // GAP y DONE: silencio (el lazo no debe realimentar la salida del DSP)
+  memset(dac, 0, num_samples * sizeof(int16_t));
+  if (state == LATENCY_GAP) {
+    gap_samples -= num_samples;
+    if (gap_samples <= 0) {
+      capture_pos = 0;
+      int expected = LATENCY_GAP;
+      test_state.compare_exchange_strong(expected, LATENCY_CAPTURE, std::memory_order_acq_rel);
+    }
+  }
+}
+
+// ==================== CORE 1 ====================
+
+static void generate_mls() {
+  uint32_t lfsr = 1;
+  for (int i = 0; i < LATENCY_MLS_LENGTH; i++) {
+    mls[i] = (lfsr & 1) ? 1 : -1;
+    uint32_t feedback = (lfsr ^ (lfsr >> 3)) & 1;   // Tomas 10 y 7
+    lfsr = (lfsr >> 1) | (feedback << (LATENCY_MLS_ORDER - 1));
+  }
+}
+
+static int32_t correlate_at(int lag) {
+  int32_t acc = 0;
+  const int16_t* x = capture + lag;
+  for (int i = 0; i < LATENCY_MLS_LENGTH; i++) {
+    acc += mls[i] > 0 ? x[i] : -x[i];
+  }
+  return acc;
+}
+
+// Lag del pico de |c| en muestras (fraccionario); false si no destaca
+static bool find_loopback_lag(float* lag_samples, float* peak_ratio) {
+  int best_lag = 0;
+  float best = 0.0f;
+  double energy = 0.0;
+
+  for (int lag = 0; lag <= LATENCY_MAX_SAMPLES; lag++) {
+    float c = fabsf((float)correlate_at(lag));
+    energy += (double)c * c;
+    if (c > best) {
+      best = c;
+      best_lag = lag;
+    }
+  }
+
+  const float rms = sqrtf((float)(energy / (LATENCY_MAX_SAMPLES + 1)));
+  *peak_ratio = rms > 0.0f ? best / rms : 0.0f;
+  if (*peak_ratio < LATENCY_MIN_PEAK_RATIO) return false;
+
+  // Interpolación parabólica con los vecinos
+  float offset = 0.0f;
+  if (best_lag > 0 && best_lag < LATENCY_MAX_SAMPLES) {
+    float a = fabsf((float)correlate_at(best_lag - 1));
+    float c = fabsf((float)correlate_at(best_lag + 1));
+    float denom = a - 2.0f * best + c;
+    if (denom < 0.0f) offset = 0.5f * (a - c) / denom;
+  }
+  *lag_samples = best_lag + offset;
+  return true;
+}
+
+bool run_latency_test(int runs, latency_result_t* result) {
+  if (runs < 1 || runs > LATENCY_MAX_RUNS) return false;
+  if (test_state.load(std::memory_order_acquire) != LATENCY_IDLE) return false;
+
+  generate_mls();
+  const uint32_t run_timeout_ms = LATENCY_GAP_MS + CAPTURE_LENGTH * 1000 / SAMPLE_RATE + 500;
+  float latency_ms[LATENCY_MAX_RUNS];
+  int valid = 0;
+  int failed = 0;
+
+  Serial.printf("\n⏱️ LATENCIA POR LOOPBACK (%d medidas, MLS %d muestras, ventana %d ms)\n",
+                runs, LATENCY_MLS_LENGTH, LATENCY_MAX_MS);
+  Serial.println("   Salida del DAC conectada al micrófono (cable o acústico)");
+
+  for (int r = 0; r < runs; r++) {
+    gap_samples = LATENCY_GAP_SAMPLES;
+    test_state.store(LATENCY_GAP, std::memory_order_release);
+
+    const uint32_t start = millis();
+    while (test_state.load(std::memory_order_acquire) != LATENCY_DONE) {
+      if (millis() - start > run_timeout_ms) {
+        test_state.store(LATENCY_IDLE, std::memory_order_release);
+        Serial.println("❌ La tarea de audio no entrega bloques (¿streams detenidos?)");
+        return false;
+      }
+      vTaskDelay(pdMS_TO_TICKS(5));
+    }
+
+    float lag = 0.0f;
+    float ratio = 0.0f;
+    if (find_loopback_lag(&lag, &ratio)) {
+      latency_ms[valid] = lag * 1000.0f / SAMPLE_RATE;
+      Serial.printf("   #%-2d %7.2f ms  (%.1f muestras, pico/RMS %.1f)\n",
+                    r + 1, latency_ms[valid], lag, ratio);
+      valid++;
+    } else {
+      Serial.printf("   #%-2d   ---     (pico/RMS %.1f < %.1f: sin lazo o demasiado ruido)\n",
+                    r + 1, ratio, LATENCY_MIN_PEAK_RATIO);
+      failed++;
+    }
+  }
+  test_state.store(LATENCY_IDLE, std::memory_order_release);
+
+  if (valid == 0) {
+    Serial.println("❌ Ninguna medida válida: revisar el lazo DAC → micrófono y el volumen");
+    return false;
+  }
+
+  latency_result_t res;
+  float sum = 0.0f;
+  res.min_ms = latency_ms[0];
+  res.max_ms = latency_ms[0];
+  for (int i = 0; i < valid; i++) {
+    sum += latency_ms[i];
+    res.min_ms = fminf(res.min_ms, latency_ms[i]);
+    res.max_ms = fmaxf(res.max_ms, latency_ms[i]);
+  }
+  res.mean_ms = sum / valid;
+  float var = 0.0f;
+  for (int i = 0; i < valid; i++) {
+    var += (latency_ms[i] - res.mean_ms) * (latency_ms[i] - res.mean_ms);
+  }
+  res.stddev_ms = valid > 1 ? sqrtf(var / (valid - 1)) : 0.0f;
+  res.runs = valid;
+  res.failed = failed;
+
+  last_result = res;
+  has_result = true;
+  if (result) *result = res;
+
+  Serial.println("────────────────────────────────────");
+  Serial.printf("📊 Media %.2f ms | σ %.2f ms | min/max %.2f/%.2f ms (%d válidas, %d fallidas)\n",
+                res.mean_ms, res.stddev_ms, res.min_ms, res.max_ms, valid, failed);
+  Serial.printf("📐 Teórica (bloque + DMA de salida): %.1f ms\n", get_audio_loop_latency_ms());
+
+  // Mic → altavoz: la MLS sale tras el DSP, su anticipación no entra en el lazo
+  const float dsp_ms = samples_to_ms(get_dsp_latency_samples());
+  const float total_ms = res.max_ms + dsp_ms;
+  Serial.printf("🛡️ Mic → altavoz: lazo máx %.2f ms + anticipación del limitador %.2f ms = %.2f ms\n",
+                res.max_ms, dsp_ms, total_ms);
+  Serial.printf("%s Objetivo %d ms: %s\n", total_ms <= LATENCY_TARGET_MS ? "✅" : "⚠️",
+                LATENCY_TARGET_MS, total_ms <= LATENCY_TARGET_MS ? "cumplido" : "SUPERADO");
+  return true;
+}
+
+bool get_measured_latency(latency_result_t* result) {
+  if (!has_result) return false;
+  if (result) *result = last_result;
+  return true;
+}
@@ -0,0 +1,67 @@
+// ==================== LATENCY_TEST.H ====================
+// Medida de la latencia real por loopback (MLS en el DAC → micrófono)
+// Secuencia y captura en Core 0, correlación e informe en Core 1
+
+#ifndef LATENCY_TEST_H
+#define LATENCY_TEST_H
+
+#include <stdint.h>
+#include "audio_config.h"
+
+// ==================== PARÁMETROS ====================
+
+#define LATENCY_MLS_ORDER       10      // MLS de 2^10 - 1 muestras (64 ms a 16 kHz)
+#define LATENCY_MLS_LENGTH      ((1 << LATENCY_MLS_ORDER) - 1)
+#define LATENCY_MAX_MS          100     // Mayor latencia detectable (ventana de búsqueda)
+#define LATENCY_GAP_MS          250     // Silencio antes de cada medida (eco de la medida anterior)
+#define LATENCY_LEVEL           8192    // Amplitud de la MLS en el DAC (-12 dBFS)
+#define LATENCY_MIN_PEAK_RATIO  6.0f    // Pico / RMS de la correlación para aceptar una medida
+#define LATENCY_DEFAULT_RUNS    8
+#define LATENCY_MAX_RUNS        64
+
+// ==================== TIPOS ====================
+
+// Resumen de una serie de medidas válidas
+typedef struct {
+  int runs;             // Medidas válidas
+  int failed;           // Medidas sin pico claro (lazo abierto, ruido)
+  float mean_ms;
+  float stddev_ms;      // Desviación típica entre medidas
+  float min_ms;
+  float max_ms;
+} latency_result_t;
+
+// ==================== FUNCIONES ====================
+
+/**
+ * @brief Sustituir la salida por la MLS y capturar el micrófono (Core 0)
+ *
+ * Se llama una vez por bloque, tras convertir a int16 y antes de
+ * escribir al DAC. Sin medida en curso solo lee un atómico; durante la
+ * medida la salida procesada (y los pips) se silencia.
+ *
+ * @param mic Bloque del micrófono tal como llega del I2S (Q31)
+ * @param dac Bloque de salida, se sobreescribe durante la medida
+ */
+void latency_test_block(const int32_t* mic, int16_t* dac, int num_samples);
+
+/**
+ * @brief Medir la latencia entrada→salida runs veces (Core 1)
+ *
+ * Bloquea ~0.45 s por medida. Requiere la salida del DAC conectada al
+ * micrófono (cable o acoplamiento acústico) y el audio en marcha.
+ *
+ * @param runs Medidas (1 - LATENCY_MAX_RUNS)
+ * @param[out] result Estadísticas de las medidas válidas (puede ser NULL)
+ * @return true si al menos una medida es válida
+ */
+bool run_latency_test(int runs, latency_result_t* result);
+
+/**
+ * @brief Resultado de la última serie con medidas válidas
+ *
+ * @return false si todavía no se ha medido
+ */
+bool get_measured_latency(latency_result_t* result);
+
+#endif // LATENCY_TEST_H
@@ -0,0 +1,274 @@
+// ==================== MEMORY_PLAN.CPP ====================
+// Plan de memoria de Aurivox v3.0 (registro, comprobación e informe)
+
+#include "Arduino.h"
+#include <atomic>
+#include "esp_heap_caps.h"
+#include "esp_idf_version.h"
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+#include "esp_memory_utils.h"
+#else
+#include "soc/soc_memory_layout.h"
+#endif
+#include "memory_plan.h"
+
+/*
+ * DÓNDE VIVE CADA COSA (ESP32-S3)
+ * ===============================
+ *
+ *   IRAM  0x4037xxxx   .iram0.text   AUDIO_IRAM, ISRs, FreeRTOS, heap
+ *   DRAM  0x3FCxxxxx   .data/.bss    buffers y estado de todos los módulos
+ *                      heap          solo en el arranque (I2S, WiFi, NVS)
+ *   flash 0x42xxxxxx   .text         control, comandos, ESP-DSP, libm
+ *
+ * Todo el estado del audio es estático: los buffers ya están en .bss
+ * (DRAM interna) y no hace falta un arena propio. Los de cada módulo
+ * llevan __attribute__((aligned(16))); los del bloque se registran
+ * aquí para comprobarlo en el dispositivo.
+ *
+ * Con CONFIG_HEAP_USE_HOOKS (menuconfig) cada asignación pasa por
+ * esp_heap_trace_alloc_hook() y se cuentan las de las tareas de tiempo
+ * real tras el sellado. Sin los hooks queda la caída del mínimo del heap
+ * desde el sellado, que incluye las de Core 1.
+ */
+
+// Límites de sección del enlazador (sections.ld de ESP-IDF)
+extern "C" int _iram_start, _iram_end;
+extern "C" int _data_start, _data_end;
+extern "C" int _bss_start, _bss_end;
+
+#define INTERNAL_HEAP_CAPS  (MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT)
+
+typedef struct {
+  TaskHandle_t handle;
+  const char* name;
+  uint32_t stack_bytes;
+  bool realtime;
+} TaskEntry;
+
+typedef struct {
+  const char* name;
+  const void* buffer;
+  size_t bytes;
+} BufferEntry;
+
+typedef struct {
+  const char* name;
+  const void* function;
+} CodeEntry;
+
+static TaskEntry tasks[MEMORY_PLAN_MAX_TASKS];
+static std::atomic<int> task_count(0);          // Lo lee el hook del heap
+static BufferEntry buffers[MEMORY_PLAN_MAX_BUFFERS];
+static int buffer_count = 0;
+static CodeEntry code[MEMORY_PLAN_MAX_CODE];
+static int code_count = 0;
+
+static std::atomic<bool> sealed(false);
+static size_t sealed_free = 0;                  // Heap interno libre al sellar
+static size_t sealed_minimum = 0;
+
+static std::atomic<uint32_t> realtime_allocs(0);
+static std::atomic<uint32_t> realtime_alloc_bytes(0);
+static const char* volatile last_alloc_task = NULL;
+
+static uint32_t flash_writes = 0;
+static uint32_t flash_write_last_us = 0;
+static uint32_t flash_write_max_us = 0;
+
+// ==================== COMPROBACIONES ====================
+
+static bool buffer_ok(const BufferEntry* b) {
+    return esp_ptr_internal(b->buffer) &&
+           ((uintptr_t)b->buffer & (MEMORY_BUFFER_ALIGN - 1)) == 0;
+}
+
+static bool code_ok(const CodeEntry* c) {
+    return esp_ptr_in_iram(c->function);
+}
+
+static uint32_t section_bytes(const int* start, const int* end) {
+    return (uint32_t)((const uint8_t*)end - (const uint8_t*)start);
+}
+
+// ==================== HOOK DEL HEAP ====================
+
+#if CONFIG_HEAP_USE_HOOKS
+// Desde heap_caps_malloc(), posiblemente con la caché de flash desactivada
+extern "C" void IRAM_ATTR esp_heap_trace_alloc_hook(void* ptr, size_t size, uint32_t caps) {
+    if (!sealed.load(std::memory_order_relaxed)) return;
+    const TaskHandle_t current = xTaskGetCurrentTaskHandle();
+    const int count = task_count.load(std::memory_order_acquire);
+    for (int i = 0; i < count; i++) {
+        if (tasks[i].handle == current && tasks[i].realtime) {
+            realtime_allocs.fetch_add(1, std::memory_order_relaxed);
+            realtime_alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+            last_alloc_task = tasks[i].name;
+            return;
+        }
+    }
+}
+
+extern "C" void IRAM_ATTR esp_heap_trace_free_hook(void* ptr) {
+}
+#endif
+
+// ==================== REGISTRO ====================
+
+void memory_register_task(TaskHandle_t task, const char* name, uint32_t stack_bytes, bool realtime) {
+    if (!task) task = xTaskGetCurrentTaskHandle();
+    const int count = task_count.load(std::memory_order_relaxed);
+    for (int i = 0; i < count; i++) {
+        if (tasks[i].handle == task) return;
+    }
+    if (count >= MEMORY_PLAN_MAX_TASKS) return;
+    tasks[count] = {task, name, stack_bytes, realtime};
+    task_count.store(count + 1, std::memory_order_release);
+}
+
+void memory_register_buffer(const char* name, const void* buffer, size_t bytes) {
+    if (buffer_count >= MEMORY_PLAN_MAX_BUFFERS) return;
+    buffers[buffer_count++] = {name, buffer, bytes};
+}
+
+void memory_register_code(const char* name, const void* function) {
+    if (code_count >= MEMORY_PLAN_MAX_CODE) return;
+    code[code_count++] = {name, function};
+}
+
+bool memory_plan_seal() {
+    bool ok = true;
+    for (int i = 0; i < buffer_count; i++) {
+        if (!buffer_ok(&buffers[i])) {
+            Serial.printf("⚠️ Memoria: buffer '%s' fuera de DRAM interna o sin alinear (%p)\n",
+                          buffers[i].name, buffers[i].buffer);
+            ok = false;
+        }
+    }
+    for (int i = 0; i < code_count; i++) {
+        if (!code_ok(&code[i])) {
+            Serial.printf("⚠️ Memoria: %s() se ejecuta desde flash (%p, AUDIO_CODE_IN_IRAM)\n",
+                          code[i].name, code[i].function);
+            ok = false;
+        }
+    }
+
+    sealed_free = heap_caps_get_free_size(INTERNAL_HEAP_CAPS);
+    sealed_minimum = heap_caps_get_minimum_free_size(INTERNAL_HEAP_CAPS);
+    realtime_allocs.store(0, std::memory_order_relaxed);
+    realtime_alloc_bytes.store(0, std::memory_order_relaxed);
+    sealed.store(true, std::memory_order_release);
+    return ok;
+}
+
+void memory_note_flash_write(uint32_t duration_us) {
+    flash_writes++;
+    flash_write_last_us = duration_us;
+    if (duration_us > flash_write_max_us) flash_write_max_us = duration_us;
+}
+
+// ==================== INFORME ====================
+
+extern float get_audio_dma_cushion_ms();
+
+static void print_sections() {
+    Serial.printf("   IRAM: %lu bytes de código | DRAM: .data %lu + .bss %lu bytes\n",
+                  (unsigned long)section_bytes(&_iram_start, &_iram_end),
+                  (unsigned long)section_bytes(&_data_start, &_data_end),
+                  (unsigned long)section_bytes(&_bss_start, &_bss_end));
+
+    int in_iram = 0;
+    for (int i = 0; i < code_count; i++) {
+        if (code_ok(&code[i])) in_iram++;
+    }
+    Serial.printf("   Código de audio en IRAM: %d/%d %s\n", in_iram, code_count,
+                  in_iram == code_count ? "✅" : "⚠️");
+    for (int i = 0; i < code_count; i++) {
+        if (!code_ok(&code[i])) Serial.printf("     ⚠️ %s() en flash (%p)\n", code[i].name, code[i].function);
+    }
+}
+
+static void print_buffers() {
+    size_t total = 0;
+    for (int i = 0; i < buffer_count; i++) total += buffers[i].bytes;
+    Serial.printf("   Buffers de bloque (%d, %u bytes, DRAM interna, alineados a %d):\n",
+                  buffer_count, (unsigned)total, MEMORY_BUFFER_ALIGN);
+    for (int i = 0; i < buffer_count; i++) {
+        Serial.printf("     %-12s %6u B  %p %s\n", buffers[i].name, (unsigned)buffers[i].bytes,
+                      buffers[i].buffer, buffer_ok(&buffers[i]) ? "✅" : "⚠️");
+    }
+}
+
+static void print_stacks() {
+    Serial.println("   Stacks (pico usado / reservado):");
+    const int count = task_count.load(std::memory_order_acquire);
+    for (int i = 0; i < count; i++) {
+        const TaskEntry* t = &tasks[i];
+        const uint32_t free_bytes = uxTaskGetStackHighWaterMark(t->handle);   // Bytes en ESP-IDF
+        const uint32_t used = t->stack_bytes > free_bytes ? t->stack_bytes - free_bytes : 0;
+        Serial.printf("     %-12s %5lu / %5lu B (%3.0f%%) %s\n", t->name,
+                      (unsigned long)used, (unsigned long)t->stack_bytes,
+                      100.0f * used / t->stack_bytes,
+                      free_bytes < MEMORY_STACK_MARGIN ? "⚠️ margen bajo" : "✅");
+    }
+}
+
+static void print_heap() {
+    const size_t free_bytes = heap_caps_get_free_size(INTERNAL_HEAP_CAPS);
+    const size_t largest = heap_caps_get_largest_free_block(INTERNAL_HEAP_CAPS);
+    const size_t minimum = heap_caps_get_minimum_free_size(INTERNAL_HEAP_CAPS);
+    Serial.printf("   Heap interno: %u libres de %u, mínimo %u, bloque mayor %u\n",
+                  (unsigned)free_bytes, (unsigned)heap_caps_get_total_size(INTERNAL_HEAP_CAPS),
+                  (unsigned)minimum, (unsigned)largest);
+    Serial.printf("   Fragmentación: %.1f%% (1 - bloque mayor / libre)\n",
+                  free_bytes > 0 ? 100.0f * (1.0f - (float)largest / free_bytes) : 0.0f);
+
+    const size_t psram = heap_caps_get_total_size(MALLOC_CAP_SPIRAM);
+    if (psram > 0) {
+        Serial.printf("   PSRAM: %u libres de %u (sin buffers de audio)\n",
+                      (unsigned)heap_caps_get_free_size(MALLOC_CAP_SPIRAM), (unsigned)psram);
+    }
+
+    if (!sealed.load(std::memory_order_acquire)) {
+        Serial.println("   Arranque sin terminar: plan sin sellar");
+        return;
+    }
+    Serial.printf("   Desde el arranque: libre %+d bytes, mínimo %+d bytes\n",
+                  (int)free_bytes - (int)sealed_free, (int)minimum - (int)sealed_minimum);
+#if CONFIG_HEAP_USE_HOOKS
+    const uint32_t allocs = realtime_allocs.load(std::memory_order_relaxed);
+    if (allocs == 0) {
+        Serial.println("   Asignaciones en tareas de tiempo real: 0 ✅");
+    } else {
+        Serial.printf("   ⚠️ Asignaciones en tareas de tiempo real: %lu (%lu bytes, última en %s)\n",
+                      (unsigned long)allocs,
+                      (unsigned long)realtime_alloc_bytes.load(std::memory_order_relaxed),
+                      last_alloc_task ? last_alloc_task : "?");
+    }
+#else
+    Serial.println("   Asignaciones por tarea: sin medir (CONFIG_HEAP_USE_HOOKS)");
+#endif
+}
+
+// nvs_set_blob + nvs_commit enteros: cota superior de la parada, que es la
+// operación de flash más larga dentro (un borrado de sector, decenas de ms)
+static void print_flash_writes() {
+    const float cushion_ms = get_audio_dma_cushion_ms();
+    if (flash_writes == 0) {
+        Serial.printf("   Escrituras en flash: ninguna (colchón DMA %.1f ms)\n", cushion_ms);
+        return;
+    }
+    const float max_ms = flash_write_max_us / 1000.0f;
+    Serial.printf("   Escrituras en flash (NVS): %lu, última %.1f ms, máx %.1f ms | colchón DMA %.1f ms %s\n",
+                  (unsigned long)flash_writes, flash_write_last_us / 1000.0f, max_ms, cushion_ms,
+                  max_ms <= cushion_ms ? "✅" : "⚠️ puede cortar el audio");
+}
+
+void print_memory_report() {
+    Serial.println("🧠 PLAN DE MEMORIA:");
+    print_sections();
+    print_buffers();
+    print_stacks();
+    print_heap();
+    print_flash_writes();
+}
@@ -0,0 +1,82 @@
+// ==================== MEMORY_PLAN.H ====================
+// Plan de memoria de Aurivox v3.0: código de audio en IRAM, buffers en
+// DRAM interna, márgenes de stack y estado del heap
+
+#ifndef MEMORY_PLAN_H
+#define MEMORY_PLAN_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "audio_config.h"
+
+// ==================== PARÁMETROS ====================
+
+#define MEMORY_PLAN_MAX_TASKS     6
+#define MEMORY_PLAN_MAX_BUFFERS   8
+#define MEMORY_PLAN_MAX_CODE      16
+#define MEMORY_BUFFER_ALIGN       16      // Bytes: cargas de 128 bits de ESP-DSP / PIE
+#define MEMORY_STACK_MARGIN       512     // Bytes libres mínimos en el pico de cada stack
+
+/*
+ * REGLAS DEL PLAN
+ * ===============
+ *
+ *   Core 0 (audio)        después de memory_plan_seal()
+ *   ─────────────────     ─────────────────────────────────────────
+ *   código                AUDIO_IRAM (dsp_kernels.h) → IRAM
+ *   buffers y estado      estáticos (.bss/.data) → DRAM interna, alineados
+ *   heap                  ninguna asignación (tareas de tiempo real)
+ *
+ * El registro no coloca nada: comprueba en el arranque que el enlazador
+ * dejó cada cosa donde dice el plan e informa con el comando 'memory'.
+ *
+ * Una escritura en flash (NVS) para los dos cores mientras dura, con el
+ * código en IRAM o sin él: solo el DMA sigue moviendo audio. Si dura más
+ * que el colchón DMA (get_audio_dma_cushion_ms()) hay overflow/underrun;
+ * IRAM evita los fallos de caché de después, no la parada.
+ */
+
+// ==================== FUNCIONES ====================
+
+/**
+ * @brief Registrar una tarea para el informe de stack
+ *
+ * @param task Handle de FreeRTOS (NULL = tarea actual)
+ * @param stack_bytes Stack reservado al crearla (en ESP-IDF, bytes)
+ * @param realtime true: cuenta como fallo cualquier asignación de heap
+ *                 desde esta tarea después de memory_plan_seal()
+ */
+void memory_register_task(TaskHandle_t task, const char* name, uint32_t stack_bytes, bool realtime);
+
+/**
+ * @brief Registrar un buffer de audio: DRAM interna y MEMORY_BUFFER_ALIGN
+ */
+void memory_register_buffer(const char* name, const void* buffer, size_t bytes);
+
+/**
+ * @brief Registrar una función del camino de audio (debe estar en IRAM)
+ */
+void memory_register_code(const char* name, const void* function);
+
+/**
+ * @brief Fin del arranque: heap de referencia y comprobación del plan
+ *
+ * Avisa por Serial de lo que no cumple (buffer externo o desalineado,
+ * función en flash). A partir de aquí las tareas de tiempo real no
+ * deben asignar memoria.
+ *
+ * @return true si todo lo registrado cumple el plan
+ */
+bool memory_plan_seal(void);
+
+/**
+ * @brief Duración de una escritura en flash (save_config_to_nvs) (Core 1)
+ */
+void memory_note_flash_write(uint32_t duration_us);
+
+/**
+ * @brief Secciones, buffers, stacks, heap y escrituras en flash (Core 1)
+ */
+void print_memory_report(void);
+
+#endif // MEMORY_PLAN_H
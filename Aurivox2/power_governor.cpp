@@ -0,0 +1,322 @@
+// ==================== POWER_GOVERNOR.CPP ====================
+// Gobernador de frecuencia de CPU por carga DSP medida para Aurivox v3.0
+
+#include "Arduino.h"
+#include <string.h>
+#include <atomic>
+#include "esp_idf_version.h"
+#if CONFIG_PM_ENABLE
+#include "esp_pm.h"
+#endif
+#include "power_governor.h"
+#include "cycle_profiler.h"
+#include "dsp_kernels.h"     // AUDIO_IRAM
+#include "telemetry.h"
+#include "cros_link.h"
+
+/*
+ * MEDIDA Y CONSUMO
+ * ================
+ *
+ *   Core 0 (por bloque)                  Core 1 (cada GOVERNOR_PERIOD_MS)
+ *   ciclos ocupados ─▶ máx / suma ─ ─ ─▶ exchange(0) ─▶ nivel, tiempo por
+ *                      (atómicos)                       nivel y carga en mA·s
+ *
+ * La suma va en unidades de 256 ciclos: no desborda aunque Core 1 pase
+ * minutos sin recoger la ventana (i2s_monitor, latency). Sin el
+ * perfilador (CYCLE_PROFILER_ENABLED 0) no hay medida y el reloj queda
+ * fijo en el nivel máximo.
+ *
+ * I2S toma su reloj del PLL (160 MHz), que sigue encendido en los tres
+ * niveles, y el APB se queda en 80 MHz: el audio no nota el cambio.
+ *
+ * Consumo estimado del SoC (hoja de datos ESP32-S3, modem-sleep, sin
+ * radio ni periféricos), con un core de dos ejecutando la carga medida
+ * y el de control casi siempre en espera:
+ *
+ *   I = I_espera(f) + (I_dos_cores(f) - I_espera(f)) · carga / 2
+ */
+
+#define GOVERNOR_SUM_SHIFT      8       // Suma de ciclos en unidades de 256
+
+static const int LEVEL_MHZ[GOVERNOR_LEVEL_COUNT] = {80, 160, 240};
+static const float LEVEL_IDLE_MA[GOVERNOR_LEVEL_COUNT] = {22.0f, 27.0f, 32.0f};
+static const float LEVEL_ACTIVE_MA[GOVERNOR_LEVEL_COUNT] = {31.0f, 43.0f, 56.0f};
+static const int MAX_LEVEL = GOVERNOR_LEVEL_COUNT - 1;
+
+extern volatile bool audio_processing_active;
+extern volatile bool system_sleeping;
+
+// Core 0 → Core 1
+static std::atomic<uint32_t> window_max_cycles(0);
+static std::atomic<uint32_t> window_sum(0);             // En unidades de 256 ciclos
+static std::atomic<uint32_t> window_blocks(0);
+
+// Core 1
+static bool automatic = POWER_GOVERNOR_ENABLED && CYCLE_PROFILER_ENABLED;
+static int margin_pct = GOVERNOR_DEFAULT_MARGIN_PCT;
+static int current_level = MAX_LEVEL;
+static int fixed_level = MAX_LEVEL;
+static int required_mhz = 0;
+static float load_avg = 0.0f;
+static float load_max = 0.0f;
+static uint32_t window_start_ms = 0;
+static uint32_t low_since_ms = 0;       // Desde cuándo cabe el nivel inferior
+static uint32_t last_account_ms = 0;
+
+static uint32_t level_changes = 0;
+static uint32_t boosts = 0;
+static const char* last_boost = NULL;
+static uint32_t time_in_level_ms[GOVERNOR_LEVEL_COUNT];
+static float charge_mas = 0.0f;         // mA·s estimados desde el reset
+static uint32_t charge_ms = 0;
+
+#if CONFIG_PM_ENABLE
+static esp_pm_lock_handle_t cpu_lock = NULL;
+static bool cpu_lock_held = false;
+#endif
+
+// ==================== CORE 0 ====================
+
+void AUDIO_IRAM power_governor_block(uint32_t busy_cycles) {
+    // Solo Core 0 sube el máximo; si Core 1 lo pone a 0 entre la carga y
+    // el store, el bloque cuenta en la ventana nueva
+    if (busy_cycles > window_max_cycles.load(std::memory_order_relaxed)) {
+        window_max_cycles.store(busy_cycles, std::memory_order_relaxed);
+    }
+    window_sum.fetch_add(busy_cycles >> GOVERNOR_SUM_SHIFT, std::memory_order_relaxed);
+    window_blocks.fetch_add(1, std::memory_order_release);
+}
+
+// ==================== NIVELES ====================
+
+static uint32_t block_budget_cycles(int level) {
+    return (uint32_t)((uint64_t)LEVEL_MHZ[level] * 1000000ULL * BUFFER_SIZE / SAMPLE_RATE);
+}
+
+static float estimated_current_ma(int level, float load) {
+    if (load > 1.0f) load = 1.0f;
+    return LEVEL_IDLE_MA[level] + (LEVEL_ACTIVE_MA[level] - LEVEL_IDLE_MA[level]) * load * 0.5f;
+}
+
+// Tiempo y carga eléctrica del nivel actual hasta ahora
+static void account_time() {
+    const uint32_t now = millis();
+    const uint32_t elapsed = now - last_account_ms;
+    last_account_ms = now;
+    time_in_level_ms[current_level] += elapsed;
+    const bool idle = !audio_processing_active || system_sleeping;
+    charge_mas += estimated_current_ma(current_level, idle ? 0.0f : load_avg) * elapsed / 1000.0f;
+    charge_ms += elapsed;
+}
+
+// Nivel más bajo con al menos mhz
+static int level_for_mhz(int mhz) {
+    for (int l = 0; l < MAX_LEVEL; l++) {
+        if (LEVEL_MHZ[l] >= mhz) return l;
+    }
+    return MAX_LEVEL;
+}
+
+#if CONFIG_PM_ENABLE
+/*
+ * esp_pm solo cambia de reloj en una transición de lock: se suelta, se
+ * configura el máximo nuevo y se vuelve a tomar (unos µs al mínimo).
+ */
+static void pm_apply(int level) {
+    if (cpu_lock_held) {
+        esp_pm_lock_release(cpu_lock);
+        cpu_lock_held = false;
+    }
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+    esp_pm_config_t config = {};
+#else
+    esp_pm_config_esp32s3_t config = {};
+#endif
+    config.max_freq_mhz = LEVEL_MHZ[level];
+    config.min_freq_mhz = LEVEL_MHZ[0];
+    config.light_sleep_enable = false;     // El sleep lo decide button_control
+    esp_pm_configure(&config);
+    if (cpu_lock) {
+        esp_pm_lock_acquire(cpu_lock);
+        cpu_lock_held = true;
+    }
+}
+#endif
+
+static void apply_level(int level) {
+    if (level == current_level) return;
+    account_time();
+#if CONFIG_PM_ENABLE
+    pm_apply(level);
+#else
+    setCpuFrequencyMhz(LEVEL_MHZ[level]);
+#endif
+    current_level = level;
+    level_changes++;
+
+    // Informes y telemetría en % del plazo al reloj nuevo
+    profiler_set_budget(block_budget_cycles(level));
+    if (telemetry_active()) telemetry_start(0);
+}
+
+// ==================== CORE 1 ====================
+
+void power_governor_init() {
+#if CONFIG_PM_ENABLE
+    if (!cpu_lock) esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "aurivox_dsp", &cpu_lock);
+    pm_apply(MAX_LEVEL);
+#else
+    setCpuFrequencyMhz(LEVEL_MHZ[MAX_LEVEL]);
+#endif
+    current_level = MAX_LEVEL;
+    window_start_ms = low_since_ms = last_account_ms = millis();
+}
+
+void power_governor_service() {
+    const uint32_t now = millis();
+    if (now - window_start_ms < GOVERNOR_PERIOD_MS) return;
+    window_start_ms = now;
+
+    const uint32_t max_cycles = window_max_cycles.exchange(0, std::memory_order_relaxed);
+    const uint32_t sum = window_sum.exchange(0, std::memory_order_relaxed);
+    const uint32_t blocks = window_blocks.exchange(0, std::memory_order_acquire);
+    account_time();
+
+    const bool idle = !audio_processing_active || system_sleeping;
+    if (blocks > 0) {
+        const float budget = (float)block_budget_cycles(current_level);
+        load_avg = ((float)sum * (1 << GOVERNOR_SUM_SHIFT) / blocks) / budget;
+        load_max = max_cycles / budget;
+    }
+
+    if (!automatic) {
+        apply_level(fixed_level);
+        return;
+    }
+    if (idle) {
+        load_avg = load_max = 0.0f;
+        required_mhz = 0;
+        apply_level(0);
+        low_since_ms = now;
+        return;
+    }
+    if (blocks == 0) return;    // Sin bloques en la ventana (arrancando): sin decidir
+
+    // ciclos / µs = MHz
+    const float block_us = BUFFER_SIZE * 1000000.0f / SAMPLE_RATE;
+    required_mhz = (int)(max_cycles / (block_us * (100 - margin_pct) / 100.0f)) + 1;
+    const int target = level_for_mhz(required_mhz);
+
+    if (target > current_level) {
+        apply_level(target);    // Subir sin esperar
+        low_since_ms = now;
+        return;
+    }
+    if (target == current_level) {
+        low_since_ms = now;
+        return;
+    }
+
+    // Bajar de uno en uno, con histéresis y carga baja sostenida
+    const int down_margin = margin_pct + GOVERNOR_DOWN_HYSTERESIS_PCT;
+    const float down_mhz = max_cycles / (block_us * (100 - down_margin) / 100.0f);
+    if (down_mhz > LEVEL_MHZ[current_level - 1]) {
+        low_since_ms = now;
+    } else if (now - low_since_ms >= GOVERNOR_HOLD_MS) {
+        apply_level(current_level - 1);
+        low_since_ms = now;
+    }
+}
+
+void power_governor_boost(const char* reason) {
+    if (!automatic) return;
+    boosts++;
+    last_boost = reason;
+    apply_level(MAX_LEVEL);
+    low_since_ms = millis();    // GOVERNOR_HOLD_MS midiendo el régimen nuevo
+}
+
+void power_governor_set_margin(int pct) {
+    margin_pct = CLAMP(pct, GOVERNOR_MIN_MARGIN_PCT, GOVERNOR_MAX_MARGIN_PCT);
+}
+
+bool power_governor_set_fixed(int mhz) {
+    if (mhz == 0) {
+        automatic = POWER_GOVERNOR_ENABLED && CYCLE_PROFILER_ENABLED;
+        low_since_ms = millis();
+        return true;
+    }
+    for (int l = 0; l < GOVERNOR_LEVEL_COUNT; l++) {
+        if (LEVEL_MHZ[l] == mhz) {
+            automatic = false;
+            fixed_level = l;
+            apply_level(l);
+            return true;
+        }
+    }
+    return false;
+}
+
+void power_governor_reset_stats() {
+    account_time();
+    memset(time_in_level_ms, 0, sizeof(time_in_level_ms));
+    charge_mas = 0.0f;
+    charge_ms = 0;
+    level_changes = 0;
+    boosts = 0;
+    last_boost = NULL;
+}
+
+void power_governor_get_status(power_governor_status_t* status) {
+    account_time();
+    status->automatic = automatic;
+#if CONFIG_PM_ENABLE
+    status->pm_locks = true;
+#else
+    status->pm_locks = false;
+#endif
+    status->cpu_mhz = LEVEL_MHZ[current_level];
+    status->required_mhz = required_mhz;
+    status->margin_pct = margin_pct;
+    status->load_avg = load_avg;
+    status->load_max = load_max;
+    status->level_changes = level_changes;
+    status->boosts = boosts;
+    status->last_boost = last_boost;
+    for (int l = 0; l < GOVERNOR_LEVEL_COUNT; l++) {
+        status->time_in_level_s[l] = time_in_level_ms[l] / 1000.0f;
+    }
+    const bool idle = !audio_processing_active || system_sleeping;
+    status->current_ma = estimated_current_ma(current_level, idle ? 0.0f : load_avg);
+    status->average_ma = charge_ms > 0 ? charge_mas * 1000.0f / charge_ms : status->current_ma;
+}
+
+void print_power_governor_status() {
+    power_governor_status_t s;
+    power_governor_get_status(&s);
+
+    Serial.printf("🔋 GOBERNADOR DE CPU (%s, margen %d%%, %s):\n",
+                  s.automatic ? "automático" : "nivel fijo", s.margin_pct,
+                  s.pm_locks ? "esp_pm" : "setCpuFrequencyMhz");
+    if (!CYCLE_PROFILER_ENABLED) Serial.println("   ⚠️ Sin perfilador (CYCLE_PROFILER_ENABLED 0): sin medida de carga");
+    Serial.printf("   Reloj: %d MHz (necesario %d MHz) | bloque medio %.0f%%, peor %.0f%% del plazo\n",
+                  s.cpu_mhz, s.required_mhz, s.load_avg * 100.0f, s.load_max * 100.0f);
+
+    float total_s = 0.0f;
+    for (int l = 0; l < GOVERNOR_LEVEL_COUNT; l++) total_s += s.time_in_level_s[l];
+    Serial.print("   Tiempo por nivel:");
+    for (int l = 0; l < GOVERNOR_LEVEL_COUNT; l++) {
+        Serial.printf(" %d MHz %.1f s (%.0f%%)%s", LEVEL_MHZ[l], s.time_in_level_s[l],
+                      total_s > 0.0f ? 100.0f * s.time_in_level_s[l] / total_s : 0.0f,
+                      l < MAX_LEVEL ? " |" : "\n");
+    }
+    Serial.printf("   Cambios de nivel: %lu | boosts: %lu (último: %s)\n",
+                  (unsigned long)s.level_changes, (unsigned long)s.boosts,
+                  s.last_boost ? s.last_boost : "-");
+    Serial.printf("   Corriente estimada del SoC: %.1f mA ahora, %.1f mA de media (sin radio ni periféricos)\n",
+                  s.current_ma, s.average_ma);
+    if (cros_link_mode() != MODE_STANDALONE) {
+        Serial.println("   📡 Enlace CROS activo: la radio suma bastante más que la CPU (no incluida)");
+    }
+}
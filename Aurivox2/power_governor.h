@@ -0,0 +1,115 @@
+// ==================== POWER_GOVERNOR.H ====================
+// Gobernador de frecuencia de CPU por carga DSP medida para Aurivox v3.0
+// Ciclos por bloque en Core 0 → nivel de reloj (80/160/240 MHz) en Core 1
+
+#ifndef POWER_GOVERNOR_H
+#define POWER_GOVERNOR_H
+
+#include <stdint.h>
+#include "audio_config.h"
+
+// ==================== PARÁMETROS ====================
+
+#ifndef POWER_GOVERNOR_ENABLED
+#define POWER_GOVERNOR_ENABLED        1       // 0 = 240 MHz fijos (comportamiento anterior)
+#endif
+
+#define GOVERNOR_LEVEL_COUNT          3       // 80 / 160 / 240 MHz (APB a 80 MHz en los tres)
+#define GOVERNOR_PERIOD_MS            250     // Ventana de medida del peor bloque
+#define GOVERNOR_HOLD_MS              3000    // Carga baja sostenida antes de bajar un nivel
+#define GOVERNOR_DEFAULT_MARGIN_PCT   40      // Peor bloque ≤ 60 % del plazo
+#define GOVERNOR_MIN_MARGIN_PCT       10
+#define GOVERNOR_MAX_MARGIN_PCT       80
+#define GOVERNOR_DOWN_HYSTERESIS_PCT  10      // Margen extra para bajar (sin oscilar en el límite)
+
+/*
+ * AJUSTE DEL RELOJ
+ * ================
+ *
+ * Los ciclos de un bloque apenas dependen del reloj (código en IRAM,
+ * datos en DRAM), así que el peor bloque de la ventana da directamente
+ * los MHz necesarios:
+ *
+ *   f_necesaria = ciclos_máx / (T_bloque · (1 - margen))
+ *
+ *   ciclos/bloque ─▶ máx en 250 ms ─▶ f_necesaria ─▶ nivel ≥ f
+ *                                        │
+ *   subir: inmediato                     │   bajar: un nivel, tras
+ *   boost: al activar etapas pesadas ────┘   GOVERNOR_HOLD_MS con el
+ *          (nivel máximo hasta medir)         margen + histéresis
+ *
+ * Con CONFIG_PM_ENABLE el nivel es el max_freq_mhz de esp_pm y la
+ * tarea de control retiene un lock ESP_PM_CPU_FREQ_MAX mientras hay
+ * audio (en sleep se suelta y queda el mínimo). Sin gestión de energía
+ * en el core, setCpuFrequencyMhz(). El reloj es común a los dos cores.
+ */
+
+// ==================== TIPOS ====================
+
+// Estado para el comando 'governor' (Core 1)
+typedef struct {
+  bool automatic;             // false = nivel fijo ('governor fixed')
+  bool pm_locks;              // esp_pm (CONFIG_PM_ENABLE) o setCpuFrequencyMhz()
+  int cpu_mhz;                // Nivel aplicado
+  int required_mhz;           // Con el margen, última ventana
+  int margin_pct;
+  float load_avg;             // Bloque medio / plazo, al reloj actual
+  float load_max;             // Peor bloque de la última ventana / plazo
+  uint32_t level_changes;
+  uint32_t boosts;
+  const char* last_boost;     // Motivo del último boost
+  float time_in_level_s[GOVERNOR_LEVEL_COUNT];
+  float current_ma;           // Estimación con la carga de la última ventana
+  float average_ma;           // Media de la estimación desde el reset
+} power_governor_status_t;
+
+// ==================== FUNCIONES ====================
+
+/**
+ * @brief Ciclos de CPU de un bloque en Core 0 (tarea de audio)
+ *
+ * Todo el trabajo del bloque fuera de las esperas de I2S: conversión,
+ * pipeline, AFC y telemetría. Solo actualiza dos atómicos.
+ */
+void power_governor_block(uint32_t busy_cycles);
+
+/**
+ * @brief Arranque: nivel máximo y lock de esp_pm (setup, Core 1)
+ */
+void power_governor_init(void);
+
+/**
+ * @brief Evaluar la ventana y ajustar el reloj (Core 1, cada vuelta de controlTask)
+ */
+void power_governor_service(void);
+
+/**
+ * @brief Subir al nivel máximo antes de que llegue la carga (Core 1)
+ *
+ * Para etapas que se activan de golpe (AFC, comparación Q4.27 / float,
+ * nuevo preset con fundido, enlace CROS, cambio de formato). El
+ * gobernador vuelve a bajar con las medidas del nuevo régimen.
+ *
+ * @param reason Texto estático para el informe
+ */
+void power_governor_boost(const char* reason);
+
+/**
+ * @brief Margen de seguridad bajo el plazo del bloque (Core 1)
+ *
+ * @param margin_pct GOVERNOR_MIN_MARGIN_PCT - GOVERNOR_MAX_MARGIN_PCT
+ */
+void power_governor_set_margin(int margin_pct);
+
+/**
+ * @brief Nivel fijo (80, 160 o 240 MHz) o 0 para volver al automático (Core 1)
+ *
+ * @return false si mhz no es un nivel válido
+ */
+bool power_governor_set_fixed(int mhz);
+
+void power_governor_reset_stats(void);
+void power_governor_get_status(power_governor_status_t* status);
+void print_power_governor_status(void);
+
+#endif // POWER_GOVERNOR_H
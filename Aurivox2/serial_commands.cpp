@@ -6,6 +6,17 @@
 #include "Arduino.h"
 #include "nvs_flash.h"
 #include "nvs.h"
+#include "audio_config.h"
+#include "dsp_pipeline.h"
+#include "dsp_kernels.h"
+#include "cycle_profiler.h"
+#include "latency_test.h"
+#include "freq_response.h"
+#include "feedback_canceller.h"
+#include "telemetry.h"
+#include "cros_link.h"
+#include "memory_plan.h"
+#include "power_governor.h"
 
 // ==================== VARIABLES EXTERNAS ====================
 
@@ -21,10 +32,21 @@ extern void get_audio_performance_info();
 extern void diagnose_i2s_hardware();
 extern bool is_i2s_hardware_ready();
 extern bool are_audio_streams_running();
+extern void print_audio_stream_stats();
+extern void reset_audio_stream_stats();
+extern void monitor_i2s_realtime_stats(uint32_t duration_seconds);
+extern bool switch_audio_format(int sample_rate, int buffer_size);
+extern float get_current_audio_latency_ms();
+extern float get_audio_loop_latency_ms();
+extern bool test_frequency_response(const float* test_frequencies, size_t num_frequencies);
+extern bool run_audio_system_calibration();
+extern float measure_microphone_noise_floor(uint32_t duration_ms);
 extern void get_button_status();
 extern void test_button_system();
 extern bool are_pips_active();
 extern void force_stop_pips();
+extern const AudioConfig* get_preset_config(PresetType preset_type);
+extern const char* get_preset_name(PresetType preset_type);
 
 // ==================== CONFIGURACIÓN NVS ====================
 
@@ -33,53 +55,15 @@ static bool nvs_initialized = false;
 
 // ==================== ESTRUCTURAS DE CONFIGURACIÓN ====================
 
-// Estructura base de configuración (será expandida)
-struct AudioConfig {
-  uint32_t version;
-  int gain_level;
-  
-  // Filtro pasa-altos (no implementado aún)
-  bool highpass_enabled;
-  float highpass_freq;
-  
-  // Ecualizador (no implementado aún)
-  bool eq_enabled;
-  float eq_gains[6];  // 250Hz, 500Hz, 1kHz, 2kHz, 4kHz, 8kHz
-  
-  // WDRC (no implementado aún)
-  bool wdrc_enabled;
-  float wdrc_threshold;
-  float wdrc_ratio;
-  float wdrc_attack;
-  float wdrc_release;
-  
-  // Limitador (no implementado aún)
-  bool limiter_enabled;
-  float limiter_threshold;
-  
-  uint32_t checksum;
-};
+// AudioConfig y DEFAULT_CONFIG compartidos desde audio_config.h
 
 // Configuración actual en RAM
 static AudioConfig current_config;
 
-// Configuración por defecto
-static const AudioConfig default_config = {
-  .version = 1,
-  .gain_level = 2,  // 50%
-  .highpass_enabled = false,
-  .highpass_freq = 100.0,
-  .eq_enabled = false,
-  .eq_gains = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0},
-  .wdrc_enabled = false,
-  .wdrc_threshold = -20.0,
-  .wdrc_ratio = 2.0,
-  .wdrc_attack = 10.0,
-  .wdrc_release = 100.0,
-  .limiter_enabled = false,
-  .limiter_threshold = -6.0,
-  .checksum = 0
-};
+// Última configuración aplicada, para el arranque rápido (AUDIO_FAST_BOOT):
+// sobrevive a resets por software, watchdog y deep sleep, no a un corte
+// de alimentación (entonces el checksum no cuadra y se usa DEFAULT_CONFIG)
+RTC_NOINIT_ATTR static AudioConfig rtc_boot_config;
 
 // ==================== FUNCIONES DE CONFIGURACIÓN ====================
 
@@ -94,16 +78,48 @@ static uint32_t calculate_checksum(const AudioConfig* config) {
   return checksum;
 }
 
+// Copiar la configuración activa (con la ganancia actual) a memoria RTC
+void store_boot_config() {
+  rtc_boot_config = current_config;
+  rtc_boot_config.version = CONFIG_VERSION;
+  rtc_boot_config.gain_level = current_gain_level;
+  rtc_boot_config.checksum = calculate_checksum(&rtc_boot_config);
+}
+
+// Configuración de arranque de la memoria RTC; false tras un power-on
+bool load_boot_config(AudioConfig* config) {
+  if (rtc_boot_config.version != CONFIG_VERSION ||
+      rtc_boot_config.checksum != calculate_checksum(&rtc_boot_config) ||
+      rtc_boot_config.gain_level < 0 || rtc_boot_config.gain_level >= GAIN_LEVELS_COUNT) {
+    return false;
+  }
+  *config = rtc_boot_config;
+  current_config = rtc_boot_config;
+  return true;
+}
+
+// Enlace entre audífonos según cross_mode_enabled/cross_mode (solo si cambia: arrancar la radio cuesta)
+static bool apply_connectivity_config() {
+  const ConnectivityMode mode = current_config.cross_mode_enabled
+                                ? (ConnectivityMode)current_config.cross_mode : MODE_STANDALONE;
+  cros_link_status_t link;
+  cros_link_get_status(&link);
+  if (mode == link.mode && current_config.cross_pair_id == link.pair_id) return true;
+  return cros_link_configure(mode, current_config.cross_pair_id);
+}
+
 static void sync_config_to_system() {
+  power_governor_boost("config");   // Fundido entre sets: los dos corren a la vez
   current_gain_level = current_config.gain_level;
   gain_factor = gain_levels[current_gain_level];
-  // TODO: Sincronizar otros parámetros cuando se implementen
+  configure_dsp_pipeline(&current_config);
+  apply_connectivity_config();
+  store_boot_config();
 }
 
 static void sync_system_to_config() {
-  current_config.version = 1;
+  current_config.version = CONFIG_VERSION;
   current_config.gain_level = current_gain_level;
-  // TODO: Sincronizar otros parámetros cuando se implementen
   current_config.checksum = calculate_checksum(&current_config);
 }
 
@@ -120,7 +136,8 @@ static bool load_config_from_nvs(const char* preset_name) {
   
   if (err == ESP_OK) {
     uint32_t calculated_checksum = calculate_checksum(&loaded_config);
-    if (calculated_checksum == loaded_config.checksum && loaded_config.version == 1) {
+    if (required_size == sizeof(AudioConfig) &&
+        calculated_checksum == loaded_config.checksum && loaded_config.version == CONFIG_VERSION) {
       current_config = loaded_config;
       sync_config_to_system();
       Serial.printf("✅ Configuración '%s' cargada desde memoria\n", preset_name);
@@ -145,10 +162,13 @@ static bool save_config_to_nvs(const char* preset_name) {
   
   sync_system_to_config();
   
+  // Los dos cores paran mientras se escribe la flash: se mide frente al colchón DMA
+  const uint32_t start_us = micros();
   esp_err_t err = nvs_set_blob(nvs_config_handle, preset_name, &current_config, sizeof(AudioConfig));
   
   if (err == ESP_OK) {
     err = nvs_commit(nvs_config_handle);
+    memory_note_flash_write(micros() - start_us);
     if (err == ESP_OK) {
       Serial.printf("✅ Configuración guardada como '%s'\n", preset_name);
       return true;
@@ -159,6 +179,32 @@ static bool save_config_to_nvs(const char* preset_name) {
   return false;
 }
 
+// Presets clínicos incluidos en firmware (audio_config.cpp)
+static bool load_builtin_preset(const char* preset_name) {
+  static const struct { const char* name; PresetType type; } builtin[] = {
+    {"mild", PRESET_MILD_LOSS},
+    {"moderate", PRESET_MODERATE_LOSS},
+    {"severe", PRESET_SEVERE_LOSS},
+    {"music", PRESET_MUSIC},
+    {"speech", PRESET_SPEECH},
+  };
+  
+  for (size_t i = 0; i < sizeof(builtin) / sizeof(builtin[0]); i++) {
+    if (strcmp(preset_name, builtin[i].name) == 0) {
+      // Los presets clínicos no tocan el enlace entre audífonos
+      const AudioConfig previous = current_config;
+      current_config = *get_preset_config(builtin[i].type);
+      current_config.cross_mode_enabled = previous.cross_mode_enabled;
+      current_config.cross_mode = previous.cross_mode;
+      current_config.cross_pair_id = previous.cross_pair_id;
+      sync_config_to_system();
+      Serial.printf("✅ Preset de firmware '%s' aplicado\n", get_preset_name(builtin[i].type));
+      return true;
+    }
+  }
+  return false;
+}
+
 // ==================== COMANDOS DE AYUDA ====================
 
 static void show_help() {
@@ -171,7 +217,25 @@ static void show_help() {
   Serial.println("  reset                       → Restaurar configuración default");
   Serial.println("  performance                 → Métricas de rendimiento");
   Serial.println("  diagnose                    → Diagnóstico completo");
+  Serial.println("  memory                      → IRAM, buffers, stacks por tarea, heap y escrituras flash");
   Serial.println("  test_buttons                → Test del sistema de botones");
+  Serial.println("  benchmark                   → Ciclos por bloque de cada kernel DSP");
+  Serial.println("  perf [reset]                → Ciclos por etapa del audio (min/avg/max/p99)");
+  Serial.println("  i2s_stats [reset]           → Underruns/overflows, lecturas cortas, jitter");
+  Serial.println("  i2s_monitor [segundos]      → Contadores I2S en vivo, 1 línea/s (def. 10)");
+  Serial.println("  dsp_compare [on|off]        → SNR de la ruta Q4.27 frente a float (x2 CPU)");
+  Serial.println("  latency [medidas]           → Latencia real por loopback DAC → mic (def. 8)");
+  Serial.println("  response [Hz] [Hz]          → Respuesta DAC → mic por multitono (def. bandas del EQ)");
+  Serial.println("  calibrate                   → Offset DC, ruido de fondo y bandas del EQ (autotest)");
+  Serial.println("  noise_floor [ms]            → Ruido de fondo del micrófono con la salida en silencio");
+  Serial.println("  format [Hz] [muestras]      → Ver/cambiar frecuencia y bloque (reinicia I2S)");
+  Serial.println("  afc [on|off|reset]          → Cancelación de realimentación (NLMS): estado y nivel cancelado");
+  Serial.println("  afc delay <muestras|auto>   → Retardo de la referencia (auto: latencia medida)");
+  Serial.println("  limiter [ms]                → Anticipación del limitador 0.5-2 ms (latencia añadida)");
+  Serial.println("  telemetry [on [Hz]|off]     → Stream binario COBS de medidas (1-100 Hz, def. 50)");
+  Serial.println("  telemetry_tap <pre|post|off> [x] → Audio diezmado x1-16 en el stream (def. x4)");
+  Serial.println("  governor [on|off|reset]     → Reloj de CPU por carga: tiempo por nivel y mA estimados");
+  Serial.println("  governor margin <%> | fixed <80|160|240> → Margen bajo el plazo / reloj fijo");
   Serial.println("");
   
   Serial.println("🔊 GANANCIA:");
@@ -216,6 +280,7 @@ static void show_help() {
   Serial.println("💾 CONFIGURACIÓN PERSISTENTE:");
   Serial.println("  save_preset <nombre>        → Guardar configuración actual (✅ IMPLEMENTADO)");
   Serial.println("  load_preset <nombre>        → Cargar configuración (✅ IMPLEMENTADO)");
+  Serial.println("      firmware: mild, moderate, severe, music, speech");
   Serial.println("  list_presets                → Ver configuraciones guardadas (✅ IMPLEMENTADO)");
   Serial.println("  delete_preset <nombre>      → Eliminar configuración (✅ IMPLEMENTADO)");
   Serial.println("  export_config               → Exportar config para software (✅ IMPLEMENTADO)");
@@ -232,7 +297,8 @@ static void show_help() {
   Serial.println("  enable_bluetooth            → Activar Bluetooth A2DP (🚧 NO IMPLEMENTADO)");
   Serial.println("  disable_bluetooth           → Desactivar Bluetooth (🚧 NO IMPLEMENTADO)");
   Serial.println("  pair_device                 → Emparejar dispositivo (🚧 NO IMPLEMENTADO)");
-  Serial.println("  set_cross_mode <mode>       → Modo CROSS/BiCROSS (🚧 NO IMPLEMENTADO)");
+  Serial.println("  set_cross_mode <modo> [par]  → standalone/cross/bicross/tx por ESP-NOW (✅ IMPLEMENTADO)");
+  Serial.println("  cros [depth N|reset]        → Enlace CROS: pérdidas, latencia, colchón en bloques");
   Serial.println("");
   
   Serial.println("📊 ALGORITMOS DISPONIBLES:");
@@ -247,6 +313,18 @@ static void show_help() {
 
 // ==================== COMANDOS DEL SISTEMA ====================
 
+static void print_audio_format() {
+  Serial.println("\n🎚️ FORMATO DE AUDIO");
+  Serial.printf("   Activo: %d Hz, bloque %d muestras (%.1f ms, latencia teórica %.1f ms)\n",
+                SAMPLE_RATE, BUFFER_SIZE, samples_to_ms(BUFFER_SIZE), get_current_audio_latency_ms());
+  Serial.print("   Frecuencias:");
+  for (int i = 0; i < SAMPLE_RATE_COUNT; i++) {
+    Serial.printf(" %d%s", SUPPORTED_SAMPLE_RATES[i], SUPPORTED_SAMPLE_RATES[i] == SAMPLE_RATE ? "*" : "");
+  }
+  Serial.printf(" Hz | bloque %d-%d, múltiplo de %d\n", MIN_BUFFER_SIZE, MAX_BUFFER_SIZE, BUFFER_SIZE_STEP);
+  Serial.printf("   Por defecto: %d Hz, bloque %d (al arrancar)\n", DEFAULT_SAMPLE_RATE, DEFAULT_BUFFER_SIZE);
+}
+
 static void show_status() {
   Serial.println("\n📊 ESTADO COMPLETO DEL SISTEMA");
   Serial.println("════════════════════════════════════════════════════════════");
@@ -271,24 +349,15 @@ static void show_status() {
   Serial.printf("   Ganancia: %.0f%% (Nivel %d/5)\n", gain_factor * 100, current_gain_level + 1);
   Serial.println("");
   
-  // Algoritmos (estado futuro)
+  // Algoritmos (estado del pipeline en Core 0)
   Serial.println("🎛️ ALGORITMOS DSP:");
-  Serial.printf("   Filtro Pasa-Altos: %s (%.0fHz)\n", 
-                current_config.highpass_enabled ? "🚧 NO IMPL." : "❌ DESACTIVADO", 
-                current_config.highpass_freq);
-  Serial.printf("   Ecualizador: %s\n", 
-                current_config.eq_enabled ? "🚧 NO IMPL." : "❌ DESACTIVADO");
-  Serial.printf("   WDRC: %s (%.1fdB, %.1f:1)\n", 
-                current_config.wdrc_enabled ? "🚧 NO IMPL." : "❌ DESACTIVADO",
-                current_config.wdrc_threshold, current_config.wdrc_ratio);
-  Serial.printf("   Limitador: %s (%.1fdB)\n", 
-                current_config.limiter_enabled ? "🚧 NO IMPL." : "❌ DESACTIVADO",
-                current_config.limiter_threshold);
+  print_dsp_pipeline_status();
   Serial.println("");
   
   Serial.println("📱 CONECTIVIDAD:");
   Serial.println("   Bluetooth A2DP: 🚧 NO IMPLEMENTADO");
-  Serial.println("   CROSS/BiCROSS: 🚧 NO IMPLEMENTADO");
+  Serial.printf("   CROSS/BiCROSS: %s (par %d, ver 'cros')\n",
+                cros_link_mode_name(cros_link_mode()), current_config.cross_pair_id);
   Serial.println("   WiFi Control: 🚧 NO IMPLEMENTADO");
   Serial.println("");
   
@@ -299,7 +368,7 @@ static void show_status() {
 }
 
 static void reset_to_default() {
-  current_config = default_config;
+  current_config = DEFAULT_CONFIG;
   sync_config_to_system();
   Serial.println("✅ Sistema restaurado a configuración por defecto");
   Serial.println("⚠️ Cambios en RAM - usa 'save_preset default' para hacer permanente");
@@ -313,14 +382,8 @@ static void show_performance() {
   // Llamar función de hardware para métricas I2S
   get_audio_performance_info();
   
-  // Métricas de memoria
-  Serial.println("💾 MEMORIA:");
-  Serial.printf("   RAM libre actual: %d bytes\n", ESP.getFreeHeap());
-  Serial.printf("   RAM mínima histórica: %d bytes\n", ESP.getMinFreeHeap());
-  Serial.printf("   RAM usada: %d bytes\n", 
-                ESP.getHeapSize() - ESP.getFreeHeap());
-  Serial.printf("   Fragmentación: %.1f%%\n", 
-                100.0 - (100.0 * ESP.getMaxAllocHeap() / ESP.getFreeHeap()));
+  // Métricas de memoria: IRAM, buffers, stacks por tarea y heap interno
+  print_memory_report();
   
   // Estado de tareas (información general)
   Serial.println("");
@@ -329,6 +392,12 @@ static void show_performance() {
   Serial.println("   Core 1: Control y comunicación");
   Serial.printf("   Audio activo: %s\n", audio_processing_active ? "SÍ" : "NO");
   
+  // Coste medido por etapa (la latencia teórica no dice cuánto margen queda)
+  profiler_print();
+  
+  // Reloj elegido para ese coste y consumo estimado
+  print_power_governor_status();
+  
   Serial.println("════════════════════════════════════════════════════════════");
 }
 
@@ -338,6 +407,7 @@ static void run_full_diagnose() {
   
   // Diagnóstico de hardware I2S
   diagnose_i2s_hardware();
+  print_audio_stream_stats();
   
   // Diagnóstico de botones
   get_button_status();
@@ -354,17 +424,45 @@ static void run_full_diagnose() {
     }
   }
   
+  // Stacks y heap tras el arranque; incluye la escritura NVS de la prueba
+  print_memory_report();
+  
   Serial.println("\n🎯 PRÓXIMOS MÓDULOS A IMPLEMENTAR:");
-  Serial.println("   1. 🎛️ Filtros ESP-DSP (pasa-altos)");
-  Serial.println("   2. 🎵 Ecualizador 6 bandas");
-  Serial.println("   3. 🎚️ WDRC (compresión dinámica)");
-  Serial.println("   4. 🛡️ Limitador anti-clipping");
-  Serial.println("   5. 📱 Conectividad Bluetooth");
-  Serial.println("   6. 🏥 Sistema médico completo");
+  Serial.println("   1. 🎛️ Comandos seriales para HPF/EQ/WDRC/limitador");
+  Serial.println("   2. 📱 Conectividad Bluetooth");
+  Serial.println("   3. 🏥 Sistema médico completo");
   
   Serial.println("════════════════════════════════════════════════════════════");
 }
 
+// ==================== COMANDOS DE CONECTIVIDAD ====================
+
+bool set_connectivity_mode(const char* mode) {
+  static const struct { const char* name; ConnectivityMode mode; } modes[] = {
+    {"standalone", MODE_STANDALONE},
+    {"cross", MODE_CROSS},
+    {"bicross", MODE_BICROSS},
+    {"tx", MODE_CROSS_TRANSMITTER},
+  };
+  
+  if (strcmp(mode, "bluetooth") == 0) {
+    Serial.println("🚧 Modo Bluetooth NO IMPLEMENTADO aún");
+    return false;
+  }
+  for (size_t i = 0; i < sizeof(modes) / sizeof(modes[0]); i++) {
+    if (strcmp(mode, modes[i].name) == 0) {
+      current_config.cross_mode_enabled = modes[i].mode != MODE_STANDALONE;
+      current_config.cross_mode = modes[i].mode;
+      if (modes[i].mode != MODE_STANDALONE) power_governor_boost("cros");
+      const bool applied = apply_connectivity_config();
+      store_boot_config();
+      return applied;
+    }
+  }
+  Serial.printf("❌ Modo desconocido: '%s' (standalone, cross, bicross, tx)\n", mode);
+  return false;
+}
+
 // ==================== PROCESAMIENTO DE COMANDOS ====================
 
 void handle_serial_commands() {
@@ -416,9 +514,191 @@ void handle_serial_commands() {
   } else if (command == "diagnose") {
     run_full_diagnose();
     
+  } else if (command == "memory") {
+    print_memory_report();
+    
   } else if (command == "test_buttons") {
     test_button_system();
     
+  } else if (command == "benchmark") {
+    dsp_kernels_benchmark();
+    
+  } else if (command == "perf") {
+    if (param == "reset") {
+      profiler_reset();
+      Serial.println("✅ Estadísticas del perfilador borradas");
+    } else {
+      profiler_print();
+    }
+    
+  } else if (command == "i2s_stats") {
+    if (param == "reset") {
+      reset_audio_stream_stats();
+      Serial.println("✅ Contadores I2S borrados");
+    } else {
+      print_audio_stream_stats();
+    }
+    
+  } else if (command == "i2s_monitor") {
+    int seconds = param.length() > 0 ? param.toInt() : 10;
+    if (seconds < 1 || seconds > 600) {
+      Serial.println("❌ Error: Duración debe ser 1-600 segundos");
+    } else {
+      monitor_i2s_realtime_stats(seconds);
+    }
+    
+  } else if (command == "dsp_compare") {
+    if (param == "on") {
+      power_governor_boost("dsp_compare");
+      set_dsp_comparison(true);
+      Serial.println("✅ Comparación Q4.27 / float activa ('dsp_compare' para ver el SNR)");
+    } else if (param == "off") {
+      set_dsp_comparison(false);
+      print_dsp_comparison();
+    } else {
+      print_dsp_comparison();
+    }
+    
+  } else if (command == "latency") {
+    int runs = param.length() > 0 ? param.toInt() : LATENCY_DEFAULT_RUNS;
+    if (runs < 1 || runs > LATENCY_MAX_RUNS) {
+      Serial.printf("❌ Error: Medidas debe ser 1-%d\n", LATENCY_MAX_RUNS);
+    } else if (!audio_processing_active || system_sleeping) {
+      Serial.println("❌ Error: El audio debe estar activo para medir la latencia");
+    } else {
+      latency_result_t measured;
+      if (run_latency_test(runs, &measured)) {
+        afc_set_delay(afc_delay_for_latency(measured.mean_ms));
+        Serial.printf("🔁 AFC: retardo alineado a la latencia medida (%d muestras)\n",
+                      afc_delay_for_latency(measured.mean_ms));
+      }
+    }
+    
+  } else if (command == "response") {
+    if (param.length() == 0) {
+      test_frequency_response(EQ_FREQUENCIES, EQ_BANDS_COUNT);
+    } else {
+      const float freqs[2] = {param.toFloat(), param2.toFloat()};
+      test_frequency_response(freqs, param2.length() > 0 ? 2 : 1);
+    }
+    
+  } else if (command == "calibrate") {
+    run_audio_system_calibration();
+    
+  } else if (command == "noise_floor") {
+    int duration_ms = param.length() > 0 ? param.toInt() : RESPONSE_NOISE_MS;
+    if (duration_ms < 10 || duration_ms > 5000) {
+      Serial.println("❌ Error: Duración 10-5000 ms");
+    } else {
+      measure_microphone_noise_floor(duration_ms);
+    }
+    
+  } else if (command == "telemetry") {
+    if (param == "on") {
+      Serial.println("✅ Stream binario activo: tramas COBS delimitadas por 0x00 ('telemetry off' para parar)");
+      telemetry_start(param2.length() > 0 ? param2.toInt() : TELEMETRY_DEFAULT_RATE_HZ);
+    } else if (param == "off") {
+      telemetry_stop();
+      Serial.println("✅ Stream binario parado");
+    } else {
+      print_telemetry_status();
+    }
+    
+  } else if (command == "telemetry_tap") {
+    int decimation = param2.length() > 0 ? param2.toInt() : TELEMETRY_TAP_DEFAULT_DECIMATION;
+    if (param == "pre" || param == "post" || param == "off") {
+      telemetry_set_tap(param == "pre" ? TELEMETRY_TAP_PRE :
+                        param == "post" ? TELEMETRY_TAP_POST : TELEMETRY_TAP_OFF, decimation);
+      print_telemetry_status();
+      if (!telemetry_active()) Serial.println("💡 La toma sale con el stream: 'telemetry on'");
+    } else {
+      Serial.println("❌ Error: Fuente pre, post u off");
+    }
+    
+  } else if (command == "afc") {
+    if (param == "on" || param == "off") {
+      if (param == "on") power_governor_boost("afc");
+      afc_set_enabled(param == "on");
+      Serial.printf("✅ Cancelación de realimentación %s\n", param == "on" ? "ACTIVA" : "DESACTIVADA");
+    } else if (param == "reset") {
+      afc_request_reset();
+      Serial.println("✅ Coeficientes del AFC borrados: vuelve a converger");
+    } else if (param == "delay") {
+      latency_result_t measured;
+      int delay;
+      if (param2 == "auto" || param2.length() == 0) {
+        const bool has_measure = get_measured_latency(&measured);
+        delay = afc_delay_for_latency(has_measure ? measured.mean_ms : get_audio_loop_latency_ms());
+        Serial.printf("✅ Retardo AFC: %d muestras (latencia %s)\n", delay,
+                      has_measure ? "medida con 'latency'" : "teórica");
+      } else {
+        delay = CLAMP((int)param2.toInt(), BUFFER_SIZE, AFC_MAX_DELAY);
+        Serial.printf("✅ Retardo AFC: %d muestras (%d-%d)\n", delay, BUFFER_SIZE, AFC_MAX_DELAY);
+      }
+      afc_set_delay(delay);
+    } else {
+      print_afc_status();
+    }
+    
+  } else if (command == "limiter") {
+    if (param.length() > 0) {
+      const float lookahead = param.toFloat();
+      if (lookahead < LIMITER_MIN_LOOKAHEAD_MS || lookahead > LIMITER_MAX_LOOKAHEAD_MS) {
+        Serial.printf("❌ Error: Anticipación %.1f-%.1f ms\n", LIMITER_MIN_LOOKAHEAD_MS, LIMITER_MAX_LOOKAHEAD_MS);
+      } else {
+        current_config.limiter_lookahead = lookahead;
+        sync_system_to_config();
+        sync_config_to_system();
+        Serial.println("✅ Anticipación cambiada ('save_preset default' para conservarla)");
+      }
+    }
+    Serial.printf("🛡️ Limitador: %s | anticipación %.2f ms (%d muestras, también desactivado) | latencia mic → altavoz %.1f ms\n",
+                  current_config.limiter_enabled ? "✅ ACTIVO" : "❌ DESACTIVADO",
+                  samples_to_ms(get_dsp_latency_samples()), get_dsp_latency_samples(),
+                  get_current_audio_latency_ms());
+    
+  } else if (command == "governor") {
+    if (param == "on") {
+      power_governor_set_fixed(0);
+      Serial.println("✅ Gobernador automático: reloj según la carga medida");
+    } else if (param == "off") {
+      power_governor_set_fixed(240);
+      Serial.println("✅ Gobernador parado: 240 MHz fijos");
+    } else if (param == "fixed") {
+      if (power_governor_set_fixed(param2.toInt())) {
+        Serial.printf("✅ Reloj fijo: %d MHz ('governor on' para volver al automático)\n", (int)param2.toInt());
+      } else {
+        Serial.println("❌ Error: Reloj 80, 160 o 240 MHz");
+      }
+    } else if (param == "margin") {
+      int margin = param2.toInt();
+      if (margin < GOVERNOR_MIN_MARGIN_PCT || margin > GOVERNOR_MAX_MARGIN_PCT) {
+        Serial.printf("❌ Error: Margen %d-%d%%\n", GOVERNOR_MIN_MARGIN_PCT, GOVERNOR_MAX_MARGIN_PCT);
+      } else {
+        power_governor_set_margin(margin);
+        Serial.printf("✅ Margen: peor bloque ≤ %d%% del plazo\n", 100 - margin);
+      }
+    } else if (param == "reset") {
+      power_governor_reset_stats();
+      Serial.println("✅ Tiempo por nivel y consumo estimado borrados");
+    } else {
+      print_power_governor_status();
+    }
+    
+  } else if (command == "format") {
+    if (param.length() == 0) {
+      print_audio_format();
+    } else {
+      int sample_rate = param.toInt();
+      int buffer_size = param2.length() > 0 ? param2.toInt() : BUFFER_SIZE;
+      if (!is_supported_audio_format(sample_rate, buffer_size)) {
+        Serial.printf("❌ Error: Frecuencia 16000/22050/32000/44100 Hz, bloque %d-%d múltiplo de %d\n",
+                      MIN_BUFFER_SIZE, MAX_BUFFER_SIZE, BUFFER_SIZE_STEP);
+      } else {
+        switch_audio_format(sample_rate, buffer_size);
+      }
+    }
+    
   // ==================== COMANDOS DE GANANCIA (IMPLEMENTADOS) ====================
   
   } else if (command == "set_gain_level") {
@@ -429,6 +709,8 @@ void handle_serial_commands() {
       if (level >= 1 && level <= 5) {
         current_gain_level = level - 1;
         gain_factor = gain_levels[current_gain_level];
+        set_dsp_output_gain(gain_factor);
+        store_boot_config();
         Serial.printf("✅ Ganancia ajustada: %.0f%% (Nivel %d/5)\n", 
                       gain_factor * 100, current_gain_level + 1);
         // Detener pips si están activos para evitar interferencia
@@ -459,7 +741,7 @@ void handle_serial_commands() {
       Serial.println("❌ Error: Especifica nombre del preset");
       Serial.println("   Ejemplo: load_preset mi_config");
     } else {
-      if (load_config_from_nvs(param.c_str())) {
+      if (load_config_from_nvs(param.c_str()) || load_builtin_preset(param.c_str())) {
         Serial.printf("📂 Configuración '%s' cargada y aplicada\n", param.c_str());
       }
     }
@@ -502,9 +784,11 @@ void handle_serial_commands() {
     } else if (param == "default") {
       Serial.println("❌ Error: No se puede eliminar la configuración 'default'");
     } else {
+      const uint32_t start_us = micros();
       esp_err_t err = nvs_erase_key(nvs_config_handle, param.c_str());
       if (err == ESP_OK) {
         nvs_commit(nvs_config_handle);
+        memory_note_flash_write(micros() - start_us);
         Serial.printf("🗑️ Configuración '%s' eliminada\n", param.c_str());
       } else if (err == ESP_ERR_NVS_NOT_FOUND) {
         Serial.printf("❌ Configuración '%s' no existe\n", param.c_str());
@@ -528,6 +812,9 @@ void handle_serial_commands() {
     Serial.printf("wdrc_ratio=%.1f\n", current_config.wdrc_ratio);
     Serial.printf("limiter_enabled=%d\n", current_config.limiter_enabled ? 1 : 0);
     Serial.printf("limiter_threshold=%.1f\n", current_config.limiter_threshold);
+    Serial.printf("limiter_lookahead=%.2f\n", current_config.limiter_lookahead);
+    Serial.printf("cross_mode=%d\n", current_config.cross_mode_enabled ? current_config.cross_mode : MODE_STANDALONE);
+    Serial.printf("cross_pair_id=%d\n", current_config.cross_pair_id);
     Serial.println("CONFIG_END");
     
   } else if (command == "list_algorithms") {
@@ -538,20 +825,56 @@ void handle_serial_commands() {
     Serial.println("   💾 Sistema de Configuración Persistente");
     Serial.println("   🔘 Control por Botones + Pips");
     Serial.println("   💤 Sleep Mode con Wake-up");
+    Serial.println("   🎛️ Filtro Pasa-Altos (ESP-DSP, vía presets)");
+    Serial.println("   🎵 Ecualizador 6 Bandas (250Hz-8kHz, vía presets)");
+    Serial.println("   🎚️ WDRC (Wide Dynamic Range Compression, vía presets)");
+    Serial.println("   🛡️ Limitador Anti-Clipping (vía presets)");
+    Serial.println("   🔁 Cancelación de Realimentación NLMS (comando 'afc')");
+    Serial.println("   📡 Enlace CROS/BiCROS por ESP-NOW (comando 'set_cross_mode')");
     Serial.println("");
     Serial.println("🚧 EN DESARROLLO:");
-    Serial.println("   🎛️ Filtro Pasa-Altos (ESP-DSP)");
-    Serial.println("   🎵 Ecualizador 6 Bandas (250Hz-8kHz)");
-    Serial.println("   🎚️ WDRC (Wide Dynamic Range Compression)");
-    Serial.println("   🛡️ Limitador Anti-Clipping");
+    Serial.println("   🎛️ Comandos de ajuste individual por etapa");
     Serial.println("");
     Serial.println("📅 FUTUROS:");
     Serial.println("   🔇 Expansor/Gate de Ruido");
-    Serial.println("   🎯 Anti-Feedback Adaptativo");
-    Serial.println("   📱 Bluetooth A2DP + CROSS/BiCROSS");
+    Serial.println("   📱 Bluetooth A2DP");
     Serial.println("   🏥 Sistema Médico Completo");
     Serial.println("════════════════════════════════════════");
     
+  // ==================== COMANDOS DE CONECTIVIDAD ====================
+  
+  } else if (command == "set_cross_mode") {
+    int pair_id = param2.length() > 0 ? param2.toInt() : current_config.cross_pair_id;
+    if (param.length() == 0) {
+      Serial.println("❌ Error: Modo standalone, cross, bicross o tx");
+    } else if (pair_id < 0 || pair_id > 255) {
+      Serial.println("❌ Error: Par 0-255 (igual en los dos audífonos)");
+    } else {
+      current_config.cross_pair_id = pair_id;
+      if (set_connectivity_mode(param.c_str())) {
+        Serial.printf("✅ Modo %s, par %d ('save_preset default' para conservarlo)\n",
+                      cros_link_mode_name(cros_link_mode()), pair_id);
+      }
+      print_cros_link_status();
+    }
+    
+  } else if (command == "cros") {
+    if (param == "depth") {
+      int depth = param2.toInt();
+      if (depth < 1 || depth > CROS_LINK_MAX_DEPTH) {
+        Serial.printf("❌ Error: Colchón 1-%d bloques\n", CROS_LINK_MAX_DEPTH);
+      } else {
+        cros_link_set_depth(depth);
+        Serial.printf("✅ Colchón de recepción: %d bloques (%.1f ms)\n",
+                      depth, samples_to_ms(depth * BUFFER_SIZE));
+      }
+    } else if (param == "reset") {
+      cros_link_reset_stats();
+      Serial.println("✅ Contadores del enlace borrados");
+    } else {
+      print_cros_link_status();
+    }
+    
   // ==================== COMANDOS NO IMPLEMENTADOS (RESPUESTAS APROPIADAS) ====================
   
   } else if (command.startsWith("enable_") || command.startsWith("disable_") || 
@@ -590,7 +913,7 @@ void initialize_serial_interface() {
       // Intentar cargar configuración default
       if (!load_config_from_nvs("default")) {
         Serial.println("📄 Creando configuración default inicial...");
-        current_config = default_config;
+        current_config = DEFAULT_CONFIG;
         sync_config_to_system();
         save_config_to_nvs("default");
       }
@@ -603,7 +926,7 @@ void initialize_serial_interface() {
   
   if (!nvs_initialized) {
     Serial.println("⚠️ NVS no disponible - configuración no persistente");
-    current_config = default_config;
+    current_config = DEFAULT_CONFIG;
     sync_config_to_system();
   }
   
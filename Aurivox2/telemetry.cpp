@@ -0,0 +1,382 @@
+// ==================== TELEMETRY.CPP ====================
+// Telemetría binaria y toma de audio por USB serie para Aurivox v3.0
+
+#include "Arduino.h"
+#include <math.h>
+#include <string.h>
+#include <atomic>
+#include "telemetry.h"
+#include "dsp_pipeline.h"
+#include "dsp_kernels.h"     // AUDIO_IRAM
+
+/*
+ * DE CORE 0 AL USB SIN TOCAR EL UART EN LA RUTA DE AUDIO
+ * =====================================================
+ *
+ *   Core 0 (audio)                 anillo SPSC                Core 1 (control)
+ *   medidas + toma ──▶ [len│tipo│gen│payload][len│...] ──▶ COBS + CRC ──▶ Serial
+ *                       head (Core 0)      tail (Core 1)
+ *
+ * Un solo productor y un solo consumidor: cada índice lo escribe un único
+ * core (release) y el otro solo lo lee (acquire). Los índices crecen sin
+ * límite y se enmascaran al acceder; ocupado = head - tail. Con el anillo
+ * lleno Core 0 descarta el registro entero y lo cuenta: nunca espera.
+ *
+ * Core 1 solo saca un registro cuando su trama cabe en el buffer de
+ * transmisión del USB CDC, así que controlTask tampoco se bloquea.
+ *
+ * Cada registro lleva el byte bajo de la generación con la que Core 0
+ * lo formó: al reiniciar el stream, lo pendiente y lo que Core 0 aún
+ * tuviera a medias con la configuración anterior se descarta, y ninguna
+ * trama vieja sale tras la INFO nueva.
+ */
+
+#define RING_MASK           (TELEMETRY_RING_BYTES - 1)
+#define RECORD_HEADER       3       // len + tipo + generación
+#define MAX_PAYLOAD         (sizeof(TelemetryTapHeader) + TELEMETRY_TAP_SAMPLES * sizeof(int16_t))
+#define MAX_FRAME           (2 + MAX_PAYLOAD + 2)                 // tipo, seq, payload, crc
+#define MAX_ENCODED         (MAX_FRAME + MAX_FRAME / 254 + 3)     // COBS + delimitadores
+
+static_assert(MAX_PAYLOAD <= 255, "El registro del anillo guarda la longitud en un byte");
+
+extern float samples_to_ms(int samples);
+
+// Anillo SPSC
+static uint8_t ring[TELEMETRY_RING_BYTES];
+static std::atomic<uint32_t> ring_head(0);      // Solo Core 0
+static std::atomic<uint32_t> ring_tail(0);      // Solo Core 1
+static std::atomic<uint32_t> dropped_records(0);
+
+// Peticiones de Core 1 (Core 0 las aplica al ver una generación nueva)
+static std::atomic<bool> stream_enabled(false);
+static std::atomic<uint32_t> config_generation(0);
+static std::atomic<int> requested_blocks_per_frame(1);
+static std::atomic<int> requested_tap_source(TELEMETRY_TAP_OFF);
+static std::atomic<int> requested_tap_decimation(TELEMETRY_TAP_DEFAULT_DECIMATION);
+
+// Solo Core 1
+static int stream_rate_hz = TELEMETRY_DEFAULT_RATE_HZ;
+static uint8_t frame_seq = 0;
+static uint32_t frames_sent = 0;
+static uint32_t bytes_sent = 0;
+
+// ==================== CORE 0 ====================
+
+static uint32_t applied_generation = 0;
+static int blocks_per_frame = 1;
+static int tap_source = TELEMETRY_TAP_OFF;
+static int tap_decimation = 1;
+
+static uint32_t block_count = 0;
+static int acc_blocks = 0;
+static int acc_samples = 0;
+static float acc_mic_energy = 0.0f;
+static float acc_out_energy = 0.0f;
+static int32_t acc_mic_peak = 0;
+static int32_t acc_out_peak = 0;
+static uint32_t acc_cycles = 0;
+static uint32_t acc_cycles_max = 0;
+
+static int32_t tap_sum = 0;
+static int tap_count = 0;
+static uint32_t tap_index = 0;                  // Muestras diezmadas desde el inicio
+static int tap_fill = 0;
+static uint8_t tap_record[MAX_PAYLOAD] __attribute__((aligned(4)));   // Cabecera + muestras en construcción
+
+static bool AUDIO_IRAM ring_push(uint8_t type, const void* payload, int length) {
+    const uint32_t head = ring_head.load(std::memory_order_relaxed);
+    const uint32_t tail = ring_tail.load(std::memory_order_acquire);
+    if (TELEMETRY_RING_BYTES - (head - tail) < (uint32_t)(RECORD_HEADER + length)) {
+        dropped_records.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    ring[head & RING_MASK] = (uint8_t)length;
+    ring[(head + 1) & RING_MASK] = type;
+    ring[(head + 2) & RING_MASK] = (uint8_t)applied_generation;
+    const uint8_t* bytes = (const uint8_t*)payload;
+    for (int i = 0; i < length; i++) {
+        ring[(head + RECORD_HEADER + i) & RING_MASK] = bytes[i];
+    }
+    ring_head.store(head + RECORD_HEADER + length, std::memory_order_release);
+    return true;
+}
+
+static int16_t AUDIO_IRAM to_cdb(float db) {
+    const float cdb = db * 100.0f;
+    if (cdb < -32000.0f) return -32000;
+    if (cdb > 32000.0f) return 32000;
+    return (int16_t)lrintf(cdb);
+}
+
+static void AUDIO_IRAM reset_accumulators() {
+    acc_blocks = 0;
+    acc_samples = 0;
+    acc_mic_energy = 0.0f;
+    acc_out_energy = 0.0f;
+    acc_mic_peak = 0;
+    acc_out_peak = 0;
+    acc_cycles = 0;
+    acc_cycles_max = 0;
+}
+
+static void AUDIO_IRAM apply_requests() {
+    blocks_per_frame = requested_blocks_per_frame.load(std::memory_order_relaxed);
+    tap_source = requested_tap_source.load(std::memory_order_relaxed);
+    tap_decimation = requested_tap_decimation.load(std::memory_order_relaxed);
+    block_count = 0;
+    tap_sum = 0;
+    tap_count = 0;
+    tap_index = 0;
+    tap_fill = 0;
+    reset_accumulators();
+}
+
+static void AUDIO_IRAM push_meters() {
+    DSPBlockMeters dsp;
+    get_dsp_block_meters(&dsp);
+
+    TelemetryMeters m;
+    const float inv_samples = 1.0f / acc_samples;
+    m.block = block_count;
+    m.mic_rms_cdb = to_cdb(10.0f * log10f(acc_mic_energy * inv_samples + 1e-12f));
+    m.mic_peak_cdb = to_cdb(20.0f * log10f(acc_mic_peak * (1.0f / 32768.0f) + 1e-6f));
+    m.out_rms_cdb = to_cdb(10.0f * log10f(acc_out_energy * inv_samples + 1e-12f));
+    m.out_peak_cdb = to_cdb(20.0f * log10f(acc_out_peak * (1.0f / 32768.0f) + 1e-6f));
+    m.wdrc_envelope_cdb = to_cdb(dsp.wdrc_envelope_db);
+    m.wdrc_reduction_cdb = to_cdb(dsp.wdrc_reduction_db);
+    m.limiter_reduction_cdb = to_cdb(dsp.limiter_reduction_db);
+    m.dsp_cycles_avg = acc_cycles / acc_blocks;
+    m.dsp_cycles_max = acc_cycles_max;
+    m.dropped = (uint16_t)dropped_records.load(std::memory_order_relaxed);
+    ring_push(TELEMETRY_FRAME_METERS, &m, sizeof(m));
+    reset_accumulators();
+}
+
+// Media de tap_decimation muestras (filtro de caja antes de diezmar)
+static void AUDIO_IRAM tap_block(const int32_t* mic, const int16_t* dac, int num_samples) {
+    int16_t* samples = (int16_t*)(tap_record + sizeof(TelemetryTapHeader));
+    for (int i = 0; i < num_samples; i++) {
+        tap_sum += tap_source == TELEMETRY_TAP_PRE ? (mic[i] >> 16) : dac[i];
+        if (++tap_count < tap_decimation) continue;
+
+        samples[tap_fill++] = (int16_t)(tap_sum / tap_decimation);
+        tap_sum = 0;
+        tap_count = 0;
+        tap_index++;
+        if (tap_fill == TELEMETRY_TAP_SAMPLES) {
+            TelemetryTapHeader header;
+            header.source = (uint8_t)tap_source;
+            header.decimation = (uint8_t)tap_decimation;
+            header.first_sample = tap_index - TELEMETRY_TAP_SAMPLES;
+            memcpy(tap_record, &header, sizeof(header));
+            ring_push(TELEMETRY_FRAME_TAP, tap_record, MAX_PAYLOAD);
+            tap_fill = 0;
+        }
+    }
+}
+
+void AUDIO_IRAM telemetry_audio_block(const int32_t* mic, const int16_t* dac, int num_samples,
+                           uint32_t dsp_cycles) {
+    if (!stream_enabled.load(std::memory_order_acquire)) return;
+    const uint32_t generation = config_generation.load(std::memory_order_acquire);
+    if (generation != applied_generation) {
+        applied_generation = generation;
+        apply_requests();
+    }
+
+    const float mic_scale = 1.0f / 2147483648.0f;
+    const float out_scale = 1.0f / 32768.0f;
+    float mic_energy = 0.0f;
+    float out_energy = 0.0f;
+    int32_t mic_peak = acc_mic_peak;
+    int32_t out_peak = acc_out_peak;
+    for (int i = 0; i < num_samples; i++) {
+        const float x = mic[i] * mic_scale;
+        const float y = dac[i] * out_scale;
+        mic_energy += x * x;
+        out_energy += y * y;
+        const int32_t a = abs(mic[i] >> 16);
+        const int32_t b = abs((int32_t)dac[i]);
+        if (a > mic_peak) mic_peak = a;
+        if (b > out_peak) out_peak = b;
+    }
+    acc_mic_energy += mic_energy;
+    acc_out_energy += out_energy;
+    acc_mic_peak = mic_peak;
+    acc_out_peak = out_peak;
+    acc_samples += num_samples;
+    acc_cycles += dsp_cycles;
+    if (dsp_cycles > acc_cycles_max) acc_cycles_max = dsp_cycles;
+    block_count++;
+
+    if (++acc_blocks >= blocks_per_frame) push_meters();
+    if (tap_source != TELEMETRY_TAP_OFF) tap_block(mic, dac, num_samples);
+}
+
+// ==================== CORE 1 ====================
+
+static uint16_t crc16_ccitt(const uint8_t* data, int length) {
+    uint16_t crc = 0xFFFF;
+    for (int i = 0; i < length; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+/*
+ * COBS: cada 0x00 se sustituye por la distancia al siguiente cero, así
+ * que la trama codificada no contiene ceros y 0x00 la delimita:
+ *
+ *   11 22 00 33  ──▶  03 11 22 02 33
+ */
+static int cobs_encode(const uint8_t* in, int length, uint8_t* out) {
+    int code_pos = 0;
+    int out_pos = 1;
+    uint8_t code = 1;
+    for (int i = 0; i < length; i++) {
+        if (in[i] == 0) {
+            out[code_pos] = code;
+            code_pos = out_pos++;
+            code = 1;
+            continue;
+        }
+        out[out_pos++] = in[i];
+        if (++code == 0xFF) {
+            out[code_pos] = code;
+            code_pos = out_pos++;
+            code = 1;
+        }
+    }
+    out[code_pos] = code;
+    return out_pos;
+}
+
+// Trama completa (delimitadores incluidos) en out; devuelve su longitud
+static int build_frame(uint8_t type, uint8_t seq, const uint8_t* payload, int length, uint8_t* out) {
+    uint8_t frame[MAX_FRAME];
+    frame[0] = type;
+    frame[1] = seq;
+    memcpy(frame + 2, payload, length);
+    const uint16_t crc = crc16_ccitt(frame, 2 + length);
+    frame[2 + length] = (uint8_t)(crc & 0xFF);
+    frame[3 + length] = (uint8_t)(crc >> 8);
+
+    out[0] = 0x00;
+    const int encoded = cobs_encode(frame, length + 4, out + 1);
+    out[1 + encoded] = 0x00;
+    return encoded + 2;
+}
+
+static void send_frame(uint8_t type, const uint8_t* payload, int length) {
+    uint8_t out[MAX_ENCODED];
+    const int n = build_frame(type, frame_seq, payload, length, out);
+    Serial.write(out, n);
+    frame_seq++;
+    frames_sent++;
+    bytes_sent += n;
+}
+
+void telemetry_service() {
+    uint32_t tail = ring_tail.load(std::memory_order_relaxed);
+    const uint32_t head = ring_head.load(std::memory_order_acquire);
+    const uint8_t generation = (uint8_t)config_generation.load(std::memory_order_relaxed);
+
+    while (tail != head) {
+        const int length = ring[tail & RING_MASK];
+        const uint8_t type = ring[(tail + 1) & RING_MASK];
+        if (ring[(tail + 2) & RING_MASK] != generation) {
+            // Formado con la configuración anterior (ver telemetry_start)
+            tail += RECORD_HEADER + length;
+            ring_tail.store(tail, std::memory_order_release);
+            continue;
+        }
+        uint8_t payload[MAX_PAYLOAD];
+        for (int i = 0; i < length; i++) {
+            payload[i] = ring[(tail + RECORD_HEADER + i) & RING_MASK];
+        }
+
+        uint8_t out[MAX_ENCODED];
+        const int n = build_frame(type, frame_seq, payload, length, out);
+        if (Serial.availableForWrite() < n) break;   // Se reintenta en la siguiente vuelta
+        Serial.write(out, n);
+        frame_seq++;
+        frames_sent++;
+        bytes_sent += n;
+
+        tail += RECORD_HEADER + length;
+        ring_tail.store(tail, std::memory_order_release);
+    }
+}
+
+static void send_info() {
+    TelemetryInfo info;
+    const int blocks = requested_blocks_per_frame.load(std::memory_order_relaxed);
+    info.version = TELEMETRY_PROTOCOL_VERSION;
+    info.rate_hz = (uint8_t)stream_rate_hz;
+    info.tap_source = (uint8_t)requested_tap_source.load(std::memory_order_relaxed);
+    info.tap_decimation = (uint8_t)requested_tap_decimation.load(std::memory_order_relaxed);
+    info.sample_rate = SAMPLE_RATE;
+    info.block_size = BUFFER_SIZE;
+    info.blocks_per_frame = (uint16_t)blocks;
+    info.block_budget_cycles = (uint32_t)((uint64_t)getCpuFrequencyMhz() * 1000000ULL * BUFFER_SIZE / SAMPLE_RATE);
+    send_frame(TELEMETRY_FRAME_INFO, (const uint8_t*)&info, sizeof(info));
+}
+
+void telemetry_start(int rate_hz) {
+    if (rate_hz > 0) stream_rate_hz = CLAMP(rate_hz, 1, TELEMETRY_MAX_RATE_HZ);
+    // Por exceso: la tasa efectiva nunca supera la pedida
+    const int samples_per_frame = stream_rate_hz * BUFFER_SIZE;
+    const int blocks = (SAMPLE_RATE + samples_per_frame - 1) / samples_per_frame;
+    requested_blocks_per_frame.store(blocks < 1 ? 1 : blocks, std::memory_order_relaxed);
+
+    // Lo pendiente pertenece a la configuración anterior: se descarta sin
+    // enviarlo (puede no caber en el USB); lo que Core 0 publique aún con
+    // la generación vieja lo salta telemetry_service()
+    stream_enabled.store(false, std::memory_order_release);
+    config_generation.fetch_add(1, std::memory_order_release);
+    ring_tail.store(ring_head.load(std::memory_order_acquire), std::memory_order_release);
+    send_info();
+    stream_enabled.store(true, std::memory_order_release);
+}
+
+void telemetry_stop() {
+    stream_enabled.store(false, std::memory_order_release);
+}
+
+void telemetry_set_tap(TelemetryTapSource source, int decimation) {
+    requested_tap_decimation.store(CLAMP(decimation, 1, TELEMETRY_TAP_MAX_DECIMATION),
+                                   std::memory_order_relaxed);
+    requested_tap_source.store(source, std::memory_order_relaxed);
+    if (telemetry_active()) telemetry_start(0);
+}
+
+bool telemetry_active() {
+    return stream_enabled.load(std::memory_order_acquire);
+}
+
+void print_telemetry_status() {
+    const int blocks = requested_blocks_per_frame.load(std::memory_order_relaxed);
+    const int source = requested_tap_source.load(std::memory_order_relaxed);
+    const int decimation = requested_tap_decimation.load(std::memory_order_relaxed);
+    const uint32_t pending = ring_head.load(std::memory_order_acquire) -
+                             ring_tail.load(std::memory_order_relaxed);
+
+    Serial.printf("\n📡 TELEMETRÍA BINARIA (COBS + CRC16, protocolo v%d)\n", TELEMETRY_PROTOCOL_VERSION);
+    Serial.printf("   Stream: %s | medidas cada %d bloques (%.1f Hz, %.1f ms)\n",
+                  telemetry_active() ? "✅ ACTIVO" : "❌ PARADO", blocks,
+                  (float)SAMPLE_RATE / (BUFFER_SIZE * blocks), samples_to_ms(BUFFER_SIZE * blocks));
+    if (source == TELEMETRY_TAP_OFF) {
+        Serial.println("   Toma de audio: desactivada");
+    } else {
+        Serial.printf("   Toma de audio: %s, diezmado x%d (%d Hz, %d muestras por trama)\n",
+                      source == TELEMETRY_TAP_PRE ? "micrófono (pre-DSP)" : "salida DAC (post-DSP)",
+                      decimation, SAMPLE_RATE / decimation, TELEMETRY_TAP_SAMPLES);
+    }
+    Serial.printf("   Tramas: %lu (%lu bytes) | anillo %lu/%d bytes | perdidos: %lu\n",
+                  (unsigned long)frames_sent, (unsigned long)bytes_sent,
+                  (unsigned long)pending, TELEMETRY_RING_BYTES,
+                  (unsigned long)dropped_records.load(std::memory_order_relaxed));
+}
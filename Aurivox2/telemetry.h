@@ -0,0 +1,132 @@
+// ==================== TELEMETRY.H ====================
+// Telemetría binaria y toma de audio por USB serie para Aurivox v3.0
+// Medidas en Core 0 → anillo SPSC → tramas COBS en Core 1
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+#include "audio_config.h"
+
+// ==================== PARÁMETROS ====================
+
+#define TELEMETRY_RING_BYTES        8192    // Anillo Core 0 → Core 1 (potencia de 2)
+#define TELEMETRY_MAX_RATE_HZ       100     // Tramas de medidas por segundo
+#define TELEMETRY_DEFAULT_RATE_HZ   50
+#define TELEMETRY_TAP_SAMPLES       64      // Muestras int16 por trama de audio
+#define TELEMETRY_TAP_MAX_DECIMATION 16
+#define TELEMETRY_TAP_DEFAULT_DECIMATION 4  // 16 kHz → 4 kHz (32 kbit/s de audio)
+#define TELEMETRY_PROTOCOL_VERSION  1
+
+#if (TELEMETRY_RING_BYTES & (TELEMETRY_RING_BYTES - 1)) != 0
+#error "TELEMETRY_RING_BYTES debe ser potencia de 2"
+#endif
+
+/*
+ * PROTOCOLO
+ * =========
+ *
+ *   0x00 │ COBS( tipo │ seq │ payload │ crc16 ) │ 0x00
+ *
+ * - Convive con el texto de los comandos: el texto nunca contiene 0x00 y
+ *   una trama con basura (texto intercalado) no pasa el CRC.
+ * - crc16: CCITT-FALSE (poly 0x1021, init 0xFFFF) de tipo, seq y payload,
+ *   little-endian. seq crece 1 por trama (mod 256): detecta pérdidas en
+ *   el enlace; las del anillo se cuentan en dropped.
+ * - Payloads little-endian, sin relleno. Niveles en centésimas de dB.
+ * - Los comandos siguen siendo de texto ('telemetry', 'telemetry_tap').
+ */
+
+enum TelemetryFrameType {
+  TELEMETRY_FRAME_INFO = 0x01,      // Al activar: formato del stream
+  TELEMETRY_FRAME_METERS = 0x02,    // Medidas por intervalo (≤ TELEMETRY_MAX_RATE_HZ)
+  TELEMETRY_FRAME_TAP = 0x03        // Audio diezmado antes o después del DSP
+};
+
+enum TelemetryTapSource {
+  TELEMETRY_TAP_OFF = 0,
+  TELEMETRY_TAP_PRE = 1,            // Micrófono (int32 → int16, antes del AFC)
+  TELEMETRY_TAP_POST = 2            // Bloque enviado al DAC
+};
+
+struct __attribute__((packed)) TelemetryInfo {
+  uint8_t version;
+  uint8_t rate_hz;
+  uint8_t tap_source;
+  uint8_t tap_decimation;
+  uint32_t sample_rate;
+  uint16_t block_size;
+  uint16_t blocks_per_frame;
+  uint32_t block_budget_cycles;
+};
+
+struct __attribute__((packed)) TelemetryMeters {
+  uint32_t block;                   // Bloques de audio desde el arranque del stream
+  int16_t mic_rms_cdb;              // dBFS × 100 sobre el intervalo
+  int16_t mic_peak_cdb;
+  int16_t out_rms_cdb;
+  int16_t out_peak_cdb;
+  int16_t wdrc_envelope_cdb;        // Detectores del último bloque (DSPBlockMeters)
+  int16_t wdrc_reduction_cdb;
+  int16_t limiter_reduction_cdb;
+  uint32_t dsp_cycles_avg;          // Ciclos por bloque (conversiones + pipeline)
+  uint32_t dsp_cycles_max;
+  uint16_t dropped;                 // Registros perdidos por anillo lleno (acumulado)
+};
+
+struct __attribute__((packed)) TelemetryTapHeader {
+  uint8_t source;
+  uint8_t decimation;
+  uint32_t first_sample;            // Índice de la primera muestra diezmada
+};                                  // + TELEMETRY_TAP_SAMPLES × int16
+
+// ==================== FUNCIONES ====================
+
+/**
+ * @brief Acumular un bloque y encolar las tramas que tocan (Core 0)
+ *
+ * Tras process_dsp_pipeline(), con el bloque int16 final. Inactiva solo
+ * lee un atómico. Nunca espera ni toca el UART: con el anillo lleno el
+ * registro se descarta y se cuenta.
+ *
+ * @param mic Bloque del micrófono (Q31)
+ * @param dac Bloque enviado al DAC
+ * @param dsp_cycles Ciclos de conversión + pipeline de este bloque
+ */
+void telemetry_audio_block(const int32_t* mic, const int16_t* dac, int num_samples,
+                           uint32_t dsp_cycles);
+
+/**
+ * @brief Vaciar el anillo por Serial como tramas COBS (Core 1)
+ *
+ * En cada vuelta de controlTask. Solo escribe lo que cabe en el buffer
+ * de transmisión (availableForWrite): no bloquea la tarea de control.
+ */
+void telemetry_service(void);
+
+/**
+ * @brief Activar el stream de medidas (Core 1)
+ *
+ * Envía una trama INFO y empieza con el siguiente bloque. También tras
+ * un cambio de formato (los bloques por trama dependen de él).
+ *
+ * @param rate_hz Tramas de medidas por segundo (1 - TELEMETRY_MAX_RATE_HZ; 0 = la última)
+ */
+void telemetry_start(int rate_hz);
+void telemetry_stop(void);
+
+/**
+ * @brief Toma de audio diezmada (media de decimation muestras) (Core 1)
+ *
+ * Solo con el stream activo. Nueva trama INFO si ya estaba en marcha.
+ */
+void telemetry_set_tap(TelemetryTapSource source, int decimation);
+
+bool telemetry_active(void);
+
+/**
+ * @brief Tramas, bytes y pérdidas por Serial (Core 1)
+ */
+void print_telemetry_status(void);
+
+#endif // TELEMETRY_H
@@ -0,0 +1,77 @@
+// Benchmark / regresión en host de los DSP de Aurivox (WDRC, MultibandWDRC y CrossoverWDRC)
+// Compilación y uso en host/README.md
+
+#include "Arduino.h"
+#include "config.h"
+#include "wdrc.h"
+#include "multiband_wdrc.h"
+#include "crossover_wdrc.h"
+#include "limiter.h"
+#include "cycle_profiler.h"
+#include "bench_common.h"
+
+static const char* const PROFILE_STAGE_NAMES[PROF_STAGE_COUNT] = {
+    "I2S lectura", "int32 → float", "ventana", "FFT", "bandas WDRC",
+    "IFFT", "overlap-add", "cruces LR4", "limitador", "float → int16", "I2S escritura", "DSP total"
+};
+
+int main(int argc, char** argv) {
+    BenchOptions opt;
+    if (!parse_options(argc, argv, &opt, " [--mode multiband|nr-off|wdrc|crossover|limiter]")) return 2;
+    const bool single_band = opt.mode && !strcmp(opt.mode, "wdrc");
+    const bool crossover = opt.mode && !strcmp(opt.mode, "crossover");
+    const bool nr_off = opt.mode && !strcmp(opt.mode, "nr-off");
+    const bool limiter = opt.mode && !strcmp(opt.mode, "limiter");
+
+    profiler_init(PROFILE_STAGE_NAMES, PROF_STAGE_COUNT,
+                  (uint32_t)((uint64_t)getCpuFrequencyMhz() * 1000000ULL * BUFFER_SIZE / SAMPLE_RATE));
+
+    size_t allocs_before = alloc_count;
+    static MultibandWDRC multiband;
+    static CrossoverWDRC xover;
+    static WDRC wdrc;
+    static LookaheadLimiter output_limiter;
+    wdrc.setParameters(BAND_PARAMS[1]);
+#if NOISE_REDUCTION
+    multiband.setNoiseReduction(!nr_off);
+#endif
+
+    printf("🧪 Aurivox %s | %d Hz, bloque %d | FFT %s, %d puntos, solape x%d | fast-math %d | NR %d\n",
+           single_band ? "WDRC (banda media)" : crossover ? "CrossoverWDRC" : "MultibandWDRC",
+           SAMPLE_RATE, BUFFER_SIZE, multiband.fftBackendName(), FFT_SIZE, STFT_OVERLAP, WDRC_FAST_MATH,
+           NOISE_REDUCTION && !nr_off);
+    if (limiter) {
+        printf("🧱 + limitador: techo %.1f dBFS, anticipación %.2f ms (%d muestras)\n",
+               output_limiter.thresholdDb(), output_limiter.lookaheadMs(), output_limiter.lookaheadSamples());
+    }
+    if (crossover) {
+        printf("🔀 %d bandas LR4, retardo de grupo en DC %.2f ms\n", xover.bands(), xover.groupDelayMs());
+    }
+    printf("💾 Asignaciones en construcción: %zu\n", alloc_count - allocs_before);
+
+    int result = run_bench(opt, SAMPLE_RATE, BUFFER_SIZE, [&](const float* in, float* out, int n) {
+        static float block[BUFFER_SIZE];
+        for (int offset = 0; offset < n; offset += BUFFER_SIZE) {
+            memcpy(block, in + offset, sizeof(block));
+            uint32_t t = profiler_cycles();
+            if (single_band) {
+                wdrc.processBlock(block, block, BUFFER_SIZE);
+            } else if (crossover) {
+                xover.process(block, block, BUFFER_SIZE);
+            } else {
+                multiband.process(block, block, BUFFER_SIZE);
+            }
+            if (limiter) {
+                uint32_t t_limiter = profiler_cycles();
+                output_limiter.process(block, block, BUFFER_SIZE);
+                profiler_lap(PROF_LIMITER, t_limiter);
+            }
+            profiler_lap(PROF_DSP_TOTAL, t);
+            memcpy(out + offset, block, sizeof(block));
+        }
+    });
+
+    if (limiter) printf("🧱 Reducción del último bloque: %.1f dB\n", output_limiter.gainReductionDb());
+    if (opt.profile) profiler_print();
+    return result;
+}
@@ -0,0 +1,161 @@
+// Benchmark / regresión en host del pipeline DSP de Aurivox2
+// (HPF → EQ → WDRC → limitador → ganancia). Compilación y uso en host/README.md
+
+#include "Arduino.h"
+#include "audio_config.h"
+#include "dsp_pipeline.h"
+#include "cycle_profiler.h"
+#include "feedback_canceller.h"
+#include "bench_common.h"
+
+extern const AudioConfig* get_preset_config(PresetType preset_type);
+extern const char* get_preset_name(PresetType preset_type);
+
+static const char* const PROFILE_STAGE_NAMES[PROF_STAGE_COUNT] = {
+    "I2S lectura", "int32 → float", "AFC filtro", "HPF", "EQ", "WDRC", "limitador",
+    "ganancia", "pips", "float → int16", "I2S escritura", "AFC adaptación", "DSP total"
+};
+
+// Lazo simulado altavoz → micrófono de --mode feedback/afc: latencia de E/S
+// del firmware (bloque + 2 buffers DMA) + 8 muestras de acústica, ~-12 dB
+#define FEEDBACK_IO_BLOCKS  3
+static const float FEEDBACK_PATH[] = { 0.12f, 0.20f, -0.10f, 0.06f, -0.03f, 0.01f };
+#define FEEDBACK_PATH_TAPS  (int)(sizeof(FEEDBACK_PATH) / sizeof(FEEDBACK_PATH[0]))
+#define FEEDBACK_OFFSET     8
+#define FEEDBACK_HISTORY    4096
+
+struct FeedbackLoop {
+    float history[FEEDBACK_HISTORY] = {};   // Salida int16 / 32768 ya enviada
+    int head = 0;
+    double feedback_energy = 0.0;           // Σ realimentación² (segunda mitad de la 1ª pasada)
+    double residual_energy = 0.0;           // Σ (realimentación - estimación)²
+
+    // mic - entrada: realimentación que llega al DSP (antes y después del AFC)
+    void account(const float* in, const float* before, const float* after, int n) {
+        for (int i = 0; i < n; i++) {
+            feedback_energy += (double)(before[i] - in[i]) * (before[i] - in[i]);
+            residual_energy += (double)(after[i] - in[i]) * (after[i] - in[i]);
+        }
+    }
+
+    // Micrófono = entrada + salida que vuelve por la ruta
+    void add_to_mic(const float* in, float* mic, int n) const {
+        const int delay = FEEDBACK_IO_BLOCKS * BUFFER_SIZE + FEEDBACK_OFFSET;
+        for (int i = 0; i < n; i++) {
+            float acc = in[i];
+            for (int k = 0; k < FEEDBACK_PATH_TAPS; k++) {
+                const int idx = (head + i - delay - k + 2 * FEEDBACK_HISTORY) % FEEDBACK_HISTORY;
+                acc += FEEDBACK_PATH[k] * history[idx];
+            }
+            mic[i] = acc;
+        }
+    }
+
+    // Salida cuantizada a int16 como el DAC; devuelve el bloque para el AFC
+    void push_output(const float* out, int16_t* dac, int n) {
+        for (int i = 0; i < n; i++) {
+            const float v = fminf(fmaxf(out[i] * 32768.0f, -32768.0f), 32767.0f);
+            dac[i] = (int16_t)lrintf(v);
+            history[head] = dac[i] / 32768.0f;
+            head = (head + 1) % FEEDBACK_HISTORY;
+        }
+    }
+};
+
+int main(int argc, char** argv) {
+    BenchOptions opt;
+    if (!parse_options(argc, argv, &opt, " [--preset 0-5] [--mode compare|feedback|afc] [--rate Hz] [--block N]")) return 2;
+    const bool compare = opt.mode && !strcmp(opt.mode, "compare");
+    const bool use_afc = opt.mode && !strcmp(opt.mode, "afc");
+    const bool feedback = use_afc || (opt.mode && !strcmp(opt.mode, "feedback"));
+
+    // Formato en runtime, como el comando serie 'format' (antes de construir el pipeline)
+    const int sample_rate = opt.sample_rate > 0 ? opt.sample_rate : SAMPLE_RATE;
+    const int block_size = opt.block_size > 0 ? opt.block_size : BUFFER_SIZE;
+    if (!is_supported_audio_format(sample_rate, block_size)) {
+        fprintf(stderr, "❌ Formato no soportado: %d Hz / bloque %d\n", sample_rate, block_size);
+        return 2;
+    }
+    set_audio_format(sample_rate, block_size);
+
+    PresetType preset = opt.preset >= 0 ? (PresetType)opt.preset : PRESET_DEFAULT;
+    const AudioConfig* config = get_preset_config(preset);
+    if (config == nullptr) {
+        fprintf(stderr, "❌ Preset %d sin configuración fija\n", opt.preset);
+        return 2;
+    }
+
+    profiler_init(PROFILE_STAGE_NAMES, PROF_STAGE_COUNT,
+                  (uint32_t)((uint64_t)getCpuFrequencyMhz() * 1000000ULL * BUFFER_SIZE / SAMPLE_RATE));
+
+    size_t allocs_before = alloc_count;
+    initialize_dsp_pipeline();
+    configure_dsp_pipeline(config);
+    afc_init(FEEDBACK_IO_BLOCKS * BUFFER_SIZE - AFC_DELAY_MARGIN);
+    afc_set_enabled(use_afc);
+
+    printf("🧪 Aurivox2 pipeline %s | %d Hz, bloque %d | preset %s%s%s\n",
+           DSP_SAMPLE_FORMAT, SAMPLE_RATE, BUFFER_SIZE, get_preset_name(preset),
+           compare ? " | comparación Q4.27/float" : "",
+           feedback ? (use_afc ? " | realimentación + AFC" : " | realimentación sin AFC") : "");
+    printf("💾 Asignaciones en construcción: %zu\n", alloc_count - allocs_before);
+
+    set_dsp_comparison(compare);
+
+    static FeedbackLoop loop;
+    int result = run_bench(opt, SAMPLE_RATE, BUFFER_SIZE, [&](const float* in, float* out, int n) {
+        static dsp_sample_t block[MAX_BUFFER_SIZE];
+        static float mic[MAX_BUFFER_SIZE];
+        static float uncancelled[MAX_BUFFER_SIZE];
+        static bool first_pass = true;
+        static int16_t dac[MAX_BUFFER_SIZE];
+        for (int offset = 0; offset < n; offset += BUFFER_SIZE) {
+            const float* source = in + offset;
+            if (feedback) {
+                loop.add_to_mic(source, mic, BUFFER_SIZE);
+                memcpy(uncancelled, mic, BUFFER_SIZE * sizeof(float));
+                uint32_t t = profiler_cycles();
+                if (afc_begin_block()) {
+                    afc_cancel(mic, BUFFER_SIZE);
+                    profiler_lap(PROF_AFC_FILTER, t);
+                }
+                if (first_pass && offset >= n / 2) loop.account(source, uncancelled, mic, BUFFER_SIZE);
+                source = mic;
+            }
+#if DSP_FIXED_POINT
+            dsp_q_from_float(source, block, BUFFER_SIZE);
+#else
+            memcpy(block, source, BUFFER_SIZE * sizeof(float));
+#endif
+            uint32_t t = profiler_cycles();
+            process_dsp_pipeline(block, BUFFER_SIZE);
+            profiler_lap(PROF_DSP_TOTAL, t);
+#if DSP_FIXED_POINT
+            dsp_q_to_float(block, out + offset, BUFFER_SIZE);
+#else
+            memcpy(out + offset, block, BUFFER_SIZE * sizeof(float));
+#endif
+            if (feedback) {
+                loop.push_output(out + offset, dac, BUFFER_SIZE);
+                t = profiler_cycles();
+                afc_push_output(dac, BUFFER_SIZE);
+                if (use_afc) profiler_lap(PROF_AFC_ADAPT, t);
+            }
+        }
+        first_pass = false;
+    });
+
+    if (feedback && result != 2) {
+        print_afc_status();
+        printf("🔁 Realimentación que llega al DSP (2ª mitad de la señal): %.1f dB %s\n",
+               10.0 * log10((loop.residual_energy + 1e-20) / (loop.feedback_energy + 1e-20)),
+               use_afc ? "tras el AFC" : "(sin AFC: 0 dB)");
+    }
+
+    if (compare) print_dsp_comparison();
+    if (opt.profile) {
+        print_dsp_pipeline_status();
+        profiler_print();
+    }
+    return result;
+}
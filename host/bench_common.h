@@ -0,0 +1,336 @@
+#ifndef HOST_BENCH_COMMON_H
+#define HOST_BENCH_COMMON_H
+
+/*
+ * ARNÉS DE HOST: BENCHMARK + REGRESIÓN CONTRA SALIDAS GOLDEN
+ * =========================================================
+ *
+ *   WAV / señal sintética ──▶ proceso por bloques ──▶ WAV float32
+ *                                   │                     │
+ *                          ns/muestra, asignaciones   comparación golden
+ *
+ * Código común a bench_aurivox.cpp y bench_aurivox2.cpp; cada programa
+ * lo incluye una sola vez (define operator new para contar asignaciones).
+ * Compilación y uso en host/README.md.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <new>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+// ==================== CONTADOR DE ASIGNACIONES ====================
+
+static size_t alloc_count = 0;
+static size_t alloc_bytes = 0;
+
+void* operator new(size_t size) {
+    alloc_count++;
+    alloc_bytes += size;
+    void* p = malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+// ==================== OPCIONES ====================
+
+struct BenchOptions {
+    const char* input = nullptr;      // WAV de entrada (nullptr = señal sintética)
+    const char* output = nullptr;     // WAV float32 de salida
+    const char* golden = nullptr;     // WAV de referencia
+    double tolerance = 0.0;           // 0 = comparación bit a bit
+    int repeat = 5;                   // Pasadas de medida (se toma la mejor)
+    bool profile = false;             // Tabla del perfilador de ciclos
+    bool flush_denormals = false;     // FTZ/DAZ: sin penalización por subnormales
+    const char* mode = nullptr;       // Específico de cada programa
+    int preset = -1;                  // Específico de cada programa
+    int sample_rate = 0;              // Específico de cada programa (0 = por defecto)
+    int block_size = 0;               // Específico de cada programa (0 = por defecto)
+};
+
+static void print_usage(const char* prog, const char* extra) {
+    printf("Uso: %s [--in entrada.wav] [--out salida.wav] [--golden ref.wav]\n"
+           "          [--tol max_abs] [--repeat N] [--profile] [--ftz]%s\n", prog, extra);
+}
+
+static bool parse_options(int argc, char** argv, BenchOptions* opt, const char* extra) {
+    for (int i = 1; i < argc; i++) {
+        bool has_value = i + 1 < argc;
+        if (!strcmp(argv[i], "--in") && has_value) opt->input = argv[++i];
+        else if (!strcmp(argv[i], "--out") && has_value) opt->output = argv[++i];
+        else if (!strcmp(argv[i], "--golden") && has_value) opt->golden = argv[++i];
+        else if (!strcmp(argv[i], "--tol") && has_value) opt->tolerance = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--repeat") && has_value) opt->repeat = std::max(1, atoi(argv[++i]));
+        else if (!strcmp(argv[i], "--mode") && has_value) opt->mode = argv[++i];
+        else if (!strcmp(argv[i], "--preset") && has_value) opt->preset = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--rate") && has_value) opt->sample_rate = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--block") && has_value) opt->block_size = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--profile")) opt->profile = true;
+        else if (!strcmp(argv[i], "--ftz")) opt->flush_denormals = true;
+        else {
+            print_usage(argv[0], extra);
+            return false;
+        }
+    }
+    return true;
+}
+
+// ==================== WAV ====================
+
+static uint32_t read_le(const uint8_t* p, int bytes) {
+    uint32_t v = 0;
+    for (int i = bytes - 1; i >= 0; i--) v = (v << 8) | p[i];
+    return v;
+}
+
+// PCM 16/24/32 bits o float32, mono o multicanal (se usa el canal 0)
+static bool read_wav(const char* path, std::vector<float>* samples, int* sample_rate) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "❌ No se puede abrir %s\n", path);
+        return false;
+    }
+    std::vector<uint8_t> data;
+    uint8_t buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) data.insert(data.end(), buf, buf + n);
+    fclose(f);
+
+    if (data.size() < 12 || memcmp(&data[0], "RIFF", 4) || memcmp(&data[8], "WAVE", 4)) {
+        fprintf(stderr, "❌ %s no es un WAV RIFF\n", path);
+        return false;
+    }
+
+    int format = 0, channels = 0, bits = 0;
+    size_t pos = 12;
+    while (pos + 8 <= data.size()) {
+        uint32_t chunk = read_le(&data[pos + 4], 4);
+        const uint8_t* body = &data[pos + 8];
+        if (pos + 8 + chunk > data.size()) chunk = data.size() - pos - 8;
+
+        if (!memcmp(&data[pos], "fmt ", 4) && chunk >= 16) {
+            format = read_le(body, 2);
+            channels = read_le(body + 2, 2);
+            *sample_rate = read_le(body + 4, 4);
+            bits = read_le(body + 14, 2);
+            if (format == 0xFFFE && chunk >= 26) format = read_le(body + 24, 2);  // EXTENSIBLE
+        } else if (!memcmp(&data[pos], "data", 4)) {
+            if (channels == 0 || (format != 1 && format != 3)) break;
+            int bytes = bits / 8;
+            size_t frames = chunk / (bytes * channels);
+            samples->resize(frames);
+            for (size_t i = 0; i < frames; i++) {
+                const uint8_t* s = body + i * bytes * channels;
+                float v;
+                if (format == 3 && bits == 32) {
+                    uint32_t u = read_le(s, 4);
+                    memcpy(&v, &u, 4);
+                } else if (bits == 16) {
+                    v = (int16_t)read_le(s, 2) / 32768.0f;
+                } else if (bits == 24) {
+                    v = (int32_t)(read_le(s, 3) << 8) / 2147483648.0f;
+                } else if (bits == 32) {
+                    v = (int32_t)read_le(s, 4) / 2147483648.0f;
+                } else {
+                    break;
+                }
+                (*samples)[i] = v;
+            }
+            if (channels > 1) printf("⚠️ %s: %d canales, se usa el primero\n", path, channels);
+            return true;
+        }
+        pos += 8 + chunk + (chunk & 1);
+    }
+    fprintf(stderr, "❌ %s: formato no soportado (PCM 16/24/32 o float32)\n", path);
+    return false;
+}
+
+static void write_le(FILE* f, uint32_t v, int bytes) {
+    for (int i = 0; i < bytes; i++) fputc((v >> (8 * i)) & 0xFF, f);
+}
+
+// Float32 mono: la salida golden conserva todos los bits del proceso
+static bool write_wav(const char* path, const std::vector<float>& samples, int sample_rate) {
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+        fprintf(stderr, "❌ No se puede escribir %s\n", path);
+        return false;
+    }
+    uint32_t data_bytes = samples.size() * 4;
+    fwrite("RIFF", 1, 4, f);
+    write_le(f, 36 + data_bytes, 4);
+    fwrite("WAVEfmt ", 1, 8, f);
+    write_le(f, 16, 4);
+    write_le(f, 3, 2);                  // IEEE float
+    write_le(f, 1, 2);
+    write_le(f, sample_rate, 4);
+    write_le(f, sample_rate * 4, 4);
+    write_le(f, 4, 2);
+    write_le(f, 32, 2);
+    fwrite("data", 1, 4, f);
+    write_le(f, data_bytes, 4);
+    fwrite(samples.data(), 4, samples.size(), f);
+    fclose(f);
+    return true;
+}
+
+// ==================== SEÑAL SINTÉTICA ====================
+
+/*
+ * Secuencia determinista de ~3.5 s (idéntica en cualquier máquina salvo
+ * por sinf/expf de la libm):
+ *
+ *   tono -50 dBFS │ tono + AM -10 dBFS │ ruido -30 dBFS │ barrido -20 dBFS │ impulsos │ silencio
+ */
+static std::vector<float> synth_signal(int sample_rate) {
+    const int seg = sample_rate / 2;
+    std::vector<float> x(7 * seg, 0.0f);
+    uint32_t lcg = 12345;
+    const float two_pi = 6.283185307f;
+
+    for (int i = 0; i < seg; i++) {
+        float t = (float)i / sample_rate;
+        x[i] = 0.00316f * sinf(two_pi * 500.0f * t);
+        float am = 0.5f + 0.5f * sinf(two_pi * 4.0f * t);
+        x[seg + i] = 0.316f * am * (0.7f * sinf(two_pi * 1000.0f * t) + 0.3f * sinf(two_pi * 3000.0f * t));
+        lcg = lcg * 1664525u + 1013904223u;
+        x[2 * seg + i] = 0.0316f * ((float)(int32_t)lcg / 2147483648.0f) * 1.732f;
+    }
+    // Barrido logarítmico 100 Hz → 0.45·fs en 2 segmentos
+    const float f0 = 100.0f, f1 = 0.45f * sample_rate, span = 2.0f * seg / sample_rate;
+    const float k = logf(f1 / f0);
+    for (int i = 0; i < 2 * seg; i++) {
+        float t = (float)i / sample_rate;
+        float phase = two_pi * f0 * span / k * (expf(k * t / span) - 1.0f);
+        x[3 * seg + i] = 0.1f * sinf(phase);
+    }
+    for (int i = 0; i < seg; i += sample_rate / 10) {
+        x[5 * seg + i] = 0.9f;
+    }
+    return x;
+}
+
+// ==================== MEDIDA ====================
+
+static double now_seconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void print_timing(double best_seconds, size_t samples, int sample_rate, size_t allocs, size_t bytes) {
+    double ns_per_sample = best_seconds * 1e9 / samples;
+    double budget_ns = 1e9 / sample_rate;
+    printf("⏱️ %.1f ns/muestra (%.2f%% del tiempo real a %d Hz, mejor pasada)\n",
+           ns_per_sample, 100.0 * ns_per_sample / budget_ns, sample_rate);
+    printf("💾 Asignaciones durante el proceso: %zu (%zu bytes)\n", allocs, bytes);
+}
+
+// ==================== COMPARACIÓN GOLDEN ====================
+
+// 0 = coincide, 1 = fuera de tolerancia, 2 = error de E/S
+static int compare_golden(const char* path, const std::vector<float>& out, double tolerance) {
+    std::vector<float> ref;
+    int rate = 0;
+    if (!read_wav(path, &ref, &rate)) return 2;
+    // Con otro BUFFER_SIZE la entrada se recorta a otro número de bloques
+    const size_t n = std::min(ref.size(), out.size());
+    if (ref.size() != out.size()) {
+        printf("⚠️ Golden: %zu muestras, salida %zu; se comparan las %zu primeras\n",
+               ref.size(), out.size(), n);
+    }
+
+    size_t differing = 0;
+    double max_abs = 0.0, err_energy = 0.0, ref_energy = 0.0;
+    size_t worst = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (memcmp(&ref[i], &out[i], sizeof(float)) != 0) differing++;
+        double d = fabs((double)out[i] - ref[i]);
+        if (d > max_abs) {
+            max_abs = d;
+            worst = i;
+        }
+        err_energy += d * d;
+        ref_energy += (double)ref[i] * ref[i];
+    }
+
+    if (differing == 0) {
+        printf("✅ Golden: idéntica bit a bit (%zu muestras)\n", n);
+        return 0;
+    }
+    double snr = err_energy > 0 ? 10.0 * log10(ref_energy / err_energy) : INFINITY;
+    printf("%s Golden: %zu/%zu muestras distintas, max |Δ| = %.3e (muestra %zu), SNR = %.1f dB\n",
+           max_abs <= tolerance ? "✅" : "❌", differing, n, max_abs, worst, snr);
+    return max_abs <= tolerance ? 0 : 1;
+}
+
+// ==================== BUCLE COMÚN ====================
+
+/*
+ * run: procesa el stream completo en bloques de block_size y escribe la
+ * salida (estado del proceso continuo entre pasadas). Se mide cada
+ * pasada; la salida comparada es la de la primera.
+ */
+template <typename Run>
+static int run_bench(const BenchOptions& opt, int sample_rate, int block_size, Run run) {
+    /*
+     * Las colas de los IIR en silencio caen a subnormales; en x86 cada
+     * operación con subnormales cuesta ~100 ciclos y domina la medida.
+     * --ftz los anula (cambia bits de la salida: no mezclar con goldens
+     * generados sin --ftz).
+     */
+    if (opt.flush_denormals) {
+#if defined(__SSE__)
+        _mm_setcsr(_mm_getcsr() | 0x8040);   // FTZ | DAZ
+        printf("⚙️ Subnormales anulados (FTZ/DAZ)\n");
+#else
+        printf("⚠️ --ftz solo está implementado para x86 (SSE)\n");
+#endif
+    }
+
+    std::vector<float> input;
+    if (opt.input) {
+        int rate = 0;
+        if (!read_wav(opt.input, &input, &rate)) return 2;
+        if (rate != sample_rate) {
+            printf("⚠️ %s está a %d Hz, el DSP espera %d Hz (sin remuestreo)\n", opt.input, rate, sample_rate);
+        }
+    } else {
+        input = synth_signal(sample_rate);
+    }
+    input.resize(input.size() - input.size() % block_size);   // Solo bloques completos
+    printf("🎵 Entrada: %s, %zu muestras (%.2f s)\n", opt.input ? opt.input : "señal sintética",
+           input.size(), (double)input.size() / sample_rate);
+
+    std::vector<float> output(input.size()), scratch(input.size());
+    double best = INFINITY;
+    size_t allocs = 0, bytes = 0;
+    for (int r = 0; r < opt.repeat; r++) {
+        size_t count0 = alloc_count, bytes0 = alloc_bytes;
+        double t0 = now_seconds();
+        run(input.data(), r == 0 ? output.data() : scratch.data(), (int)input.size());
+        best = std::min(best, now_seconds() - t0);
+        if (r == 0) {
+            allocs = alloc_count - count0;
+            bytes = alloc_bytes - bytes0;
+        }
+    }
+    print_timing(best, input.size(), sample_rate, allocs, bytes);
+
+    if (opt.output && !write_wav(opt.output, output, sample_rate)) return 2;
+    if (opt.output) printf("💾 Salida: %s\n", opt.output);
+    return opt.golden ? compare_golden(opt.golden, output, opt.tolerance) : 0;
+}
+
+#endif
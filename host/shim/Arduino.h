@@ -0,0 +1,61 @@
+#ifndef HOST_ARDUINO_SHIM_H
+#define HOST_ARDUINO_SHIM_H
+
+/*
+ * Arduino mínimo para compilar el código DSP en el PC (ver host/README.md).
+ * Solo lo que usan los módulos DSP: Serial, tiempo, ESP.getCycleCount().
+ *
+ * ESP.getCycleCount() devuelve el tiempo real del host convertido a
+ * ciclos de un reloj de HOST_CPU_MHZ, así el perfilador de ciclos y su
+ * % de presupuesto también tienen sentido fuera del dispositivo.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include "esp_attr.h"
+
+#ifndef HOST_CPU_MHZ
+#define HOST_CPU_MHZ    240
+#endif
+
+// PI no se define: audio_config.h de Aurivox2 trae el suyo
+
+using std::min;
+using std::max;
+
+static inline uint64_t host_elapsed_ns() {
+    static const auto origin = std::chrono::steady_clock::now();
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - origin).count();
+}
+
+static inline unsigned long millis() { return (unsigned long)(host_elapsed_ns() / 1000000ULL); }
+static inline unsigned long micros() { return (unsigned long)(host_elapsed_ns() / 1000ULL); }
+static inline void delay(unsigned long) {}
+static inline uint32_t getCpuFrequencyMhz() { return HOST_CPU_MHZ; }
+
+struct HostSerial {
+    template <typename... Args>
+    void printf(const char* fmt, Args... args) { ::printf(fmt, args...); }
+    void print(const char* s) { fputs(s, stdout); }
+    void println(const char* s = "") { puts(s); }
+    void flush() { fflush(stdout); }
+    int available() { return 0; }
+    int read() { return -1; }
+};
+
+struct HostEsp {
+    uint32_t getCycleCount() { return (uint32_t)(host_elapsed_ns() * HOST_CPU_MHZ / 1000ULL); }
+    uint32_t getFreeHeap() { return 0; }
+    uint32_t getMinFreeHeap() { return 0; }
+};
+
+inline HostSerial Serial;
+inline HostEsp ESP;
+
+#endif
@@ -0,0 +1,13 @@
+#ifndef HOST_I2S_SHIM_H
+#define HOST_I2S_SHIM_H
+
+// Solo los tipos que aparecen en audio_config.h (sin driver real)
+#include "esp_err.h"
+
+typedef enum { I2S_NUM_0, I2S_NUM_1 } i2s_port_t;
+typedef enum {
+    I2S_BITS_PER_SAMPLE_16BIT = 16,
+    I2S_BITS_PER_SAMPLE_32BIT = 32
+} i2s_bits_per_sample_t;
+
+#endif
@@ -0,0 +1,8 @@
+#ifndef HOST_ESP_ATTR_SHIM_H
+#define HOST_ESP_ATTR_SHIM_H
+
+// En el PC no hay IRAM/DRAM: las secciones de memoria no aplican
+#define IRAM_ATTR
+#define DRAM_ATTR
+
+#endif
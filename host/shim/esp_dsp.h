@@ -0,0 +1,79 @@
+#ifndef HOST_ESP_DSP_SHIM_H
+#define HOST_ESP_DSP_SHIM_H
+
+/*
+ * Subconjunto de ESP-DSP para el PC: réplica de las rutinas *_ansi de la
+ * librería (mismo orden de operaciones), no de las versiones aes3 en
+ * ensamblador. La FFT radix-4 no está replicada.
+ */
+
+#include <math.h>
+#include "esp_err.h"
+
+static float* host_fft2r_table = nullptr;
+
+static inline esp_err_t dsps_bit_rev_fc32(float* data, int N) {
+    int j = 0;
+    for (int i = 1; i < N - 1; i++) {
+        int k = N >> 1;
+        while (k <= j) {
+            j -= k;
+            k >>= 1;
+        }
+        j += k;
+        if (i < j) {
+            float t = data[2 * j];
+            data[2 * j] = data[2 * i];
+            data[2 * i] = t;
+            t = data[2 * j + 1];
+            data[2 * j + 1] = data[2 * i + 1];
+            data[2 * i + 1] = t;
+        }
+    }
+    return ESP_OK;
+}
+
+// Tabla de twiddles: N/2 pares (cos, sin) en orden bit-reverso
+static inline esp_err_t dsps_fft2r_init_fc32(float* table, int table_size) {
+    static float* owned = nullptr;
+    if (table == nullptr) {
+        delete[] owned;
+        owned = new float[table_size];
+        table = owned;
+    }
+    host_fft2r_table = table;
+    float e = M_PI * 2.0f / table_size;
+    for (int i = 0; i < (table_size >> 1); i++) {
+        table[2 * i] = cosf(i * e);
+        table[2 * i + 1] = sinf(i * e);
+    }
+    dsps_bit_rev_fc32(table, table_size >> 1);
+    return ESP_OK;
+}
+
+static inline esp_err_t dsps_fft2r_fc32(float* data, int N) {
+    const float* w = host_fft2r_table;
+    int ie = 1;
+    for (int N2 = N / 2; N2 > 0; N2 >>= 1) {
+        int ia = 0;
+        for (int j = 0; j < ie; j++) {
+            float c = w[2 * j];
+            float s = w[2 * j + 1];
+            for (int i = 0; i < N2; i++) {
+                int m = ia + N2;
+                float m_re = c * data[2 * m] + s * data[2 * m + 1];
+                float m_im = c * data[2 * m + 1] - s * data[2 * m];
+                data[2 * m] = data[2 * ia] - m_re;
+                data[2 * m + 1] = data[2 * ia + 1] - m_im;
+                data[2 * ia] = data[2 * ia] + m_re;
+                data[2 * ia + 1] = data[2 * ia + 1] + m_im;
+                ia++;
+            }
+            ia += N2;
+        }
+        ie <<= 1;
+    }
+    return ESP_OK;
+}
+
+#endif
@@ -0,0 +1 @@
+// Vacío: el código DSP no usa FreeRTOS
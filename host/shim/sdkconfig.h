@@ -0,0 +1 @@
+// Sin CONFIG_IDF_TARGET_*: dsp_kernels usa las versiones C escalares